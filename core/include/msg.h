@@ -99,6 +99,24 @@ int msg_send(msg_t *m, kernel_pid_t target_pid);
 int msg_try_send(msg_t *m, kernel_pid_t target_pid);
 
 
+/**
+ * @brief Send several messages to one thread. (non-blocking)
+ *
+ * Fills the message queue of *target_pid* with as many of the messages as
+ * fit, all in one critical section. If the target waits in msg_receive() the
+ * first message is delivered directly. Like msg_try_send() this function
+ * never blocks, it may be called from an interrupt.
+ *
+ * @param[in] m             Array of *num* preallocated ``msg_t`` structures,
+ *                          must not be NULL.
+ * @param[in] num           Number of messages in *m*.
+ * @param[in] target_pid    PID of target thread
+ *
+ * @return the number of messages sent, the first ones of *m*
+ * @return -1, on error (invalid PID)
+ */
+int msg_send_many(msg_t *m, int num, kernel_pid_t target_pid);
+
 /**
  * @brief Send a message to the current thread.
  * @details Will work only if the thread has a message queue.
@@ -156,6 +174,22 @@ int msg_receive(msg_t *m);
  */
 int msg_try_receive(msg_t *m);
 
+/**
+ * @brief Receive several messages.
+ *
+ * Takes up to *num* messages from the message queue and from threads
+ * blocked sending to the current thread, in the same order as *num* calls
+ * of msg_try_receive() would, but with interrupts disabled only once. Blocks
+ * until a message was received if there is none.
+ *
+ * @param[out] m    Array of *num* preallocated ``msg_t`` structures, must not
+ *                  be NULL.
+ * @param[in] num   Number of messages that fit into *m*.
+ *
+ * @return  the number of messages received, at least 1 if *num* > 0
+ */
+int msg_receive_many(msg_t *m, int num);
+
 /**
  * @brief Send a message, block until reply received.
  *
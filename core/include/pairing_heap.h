@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  core_util
+ * @{
+ *
+ * @file        pairing_heap.h
+ * @brief       An intrusive pairing heap
+ *
+ * @details     Drop-in alternative to @ref priority_queue.h for queues that
+ *              hold many nodes. Insertion is O(1), removal of the head and of
+ *              an arbitrary node is amortized O(log n). Unlike the priority
+ *              queue the order of nodes with equal priority is unspecified.
+ */
+
+#ifndef __PAIRING_HEAP_H
+#define __PAIRING_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+struct pairing_heap;
+
+/**
+ * data type for pairing heap nodes
+ */
+typedef struct pairing_heap_node {
+    struct pairing_heap_node *child;    /**< leftmost child */
+    struct pairing_heap_node *next;     /**< right sibling */
+    struct pairing_heap_node *prev;     /**< left sibling, or parent if leftmost */
+    struct pairing_heap *heap;          /**< heap the node is in, or NULL */
+    uint32_t priority;                  /**< node priority */
+} pairing_heap_node_t;
+
+/**
+ * data type for pairing heaps
+ */
+typedef struct pairing_heap {
+    pairing_heap_node_t *root;          /**< node with the lowest priority */
+} pairing_heap_t;
+
+/**
+ * @brief Static initializer for pairing_heap_node_t.
+ */
+#define PAIRING_HEAP_NODE_INIT { NULL, NULL, NULL, NULL, 0 }
+
+/**
+ * @brief   Initialize a pairing heap node object.
+ * @details For initialization of variables use PAIRING_HEAP_NODE_INIT
+ *          instead.
+ * @param[out] node     pre-allocated pairing_heap_node_t object, must not be NULL.
+ */
+static inline void pairing_heap_node_init(pairing_heap_node_t *node)
+{
+    pairing_heap_node_t n = PAIRING_HEAP_NODE_INIT;
+    *node = n;
+}
+
+/**
+ * @brief Static initializer for pairing_heap_t.
+ */
+#define PAIRING_HEAP_INIT { NULL }
+
+/**
+ * @brief   Initialize a pairing heap object.
+ * @details For initialization of variables use PAIRING_HEAP_INIT instead.
+ * @param[out] heap     pre-allocated pairing_heap_t object, must not be NULL.
+ */
+static inline void pairing_heap_init(pairing_heap_t *heap)
+{
+    pairing_heap_t h = PAIRING_HEAP_INIT;
+    *heap = h;
+}
+
+/**
+ * @brief get the node with the lowest priority without removing it
+ *
+ * @param[in]   heap    the heap
+ *
+ * @return              the head of the heap, NULL if empty
+ */
+static inline pairing_heap_node_t *pairing_heap_peek(const pairing_heap_t *heap)
+{
+    return heap->root;
+}
+
+/**
+ * @brief remove the heap's head
+ *
+ * @param[in,out]   heap    the heap
+ *
+ * @return                  the old head, NULL if the heap was empty
+ */
+pairing_heap_node_t *pairing_heap_remove_head(pairing_heap_t *heap);
+
+/**
+ * @brief insert `node` into `heap` based on its priority
+ *
+ * @param[in,out]   heap    the heap
+ * @param[in]       node    the node to insert, must not be in any heap
+ */
+void pairing_heap_add(pairing_heap_t *heap, pairing_heap_node_t *node);
+
+/**
+ * @brief remove `node` from `heap`
+ *
+ * @details Does nothing if `node` is not in `heap`.
+ *
+ * @param[in,out]   heap    the heap
+ * @param[in]       node    the node to remove
+ */
+void pairing_heap_remove(pairing_heap_t *heap, pairing_heap_node_t *node);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */
+#endif /* __PAIRING_HEAP_H */
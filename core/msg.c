@@ -149,6 +149,75 @@ static int _msg_send(msg_t *m, kernel_pid_t target_pid, bool block)
     return 1;
 }
 
+int msg_send_many(msg_t *m, int num, kernel_pid_t target_pid)
+{
+    if (sched_active_pid == target_pid) {
+        unsigned state = disableIRQ();
+        int sent = 0;
+
+        while (sent < num) {
+            m[sent].sender_pid = sched_active_pid;
+
+            if (!queue_msg((tcb_t *) sched_active_thread, &m[sent])) {
+                break;
+            }
+
+            sent++;
+        }
+
+        restoreIRQ(state);
+        return sent;
+    }
+
+    unsigned state = disableIRQ();
+    tcb_t *target = (tcb_t*) sched_threads[target_pid];
+    int sent = 0, woken = 0;
+
+    if (target == NULL) {
+        DEBUG("msg_send_many(): target thread does not exist\n");
+        restoreIRQ(state);
+        return -1;
+    }
+
+    /* a waiting receiver gets the first message directly */
+    if ((num > 0) && (target->status == STATUS_RECEIVE_BLOCKED)) {
+        m[0].sender_pid = inISR() ? target_pid : sched_active_pid;
+        *((msg_t*) target->wait_data) = m[0];
+        sched_set_status(target, STATUS_PENDING);
+        woken = 1;
+        sent++;
+    }
+
+    if (target->msg_array) {
+        while (sent < num) {
+            m[sent].sender_pid = inISR() ? target_pid : sched_active_pid;
+
+            if (!queue_msg(target, &m[sent])) {
+                break;
+            }
+
+            sent++;
+        }
+    }
+
+    DEBUG("msg_send_many: %i of %i messages to %" PRIkernel_pid "\n", sent, num, target_pid);
+
+    if (woken) {
+        if (inISR()) {
+            sched_context_switch_request = 1;
+        }
+        else {
+            uint16_t target_prio = target->priority;
+            restoreIRQ(state);
+            sched_switch(target_prio);
+            return sent;
+        }
+    }
+
+    restoreIRQ(state);
+    return sent;
+}
+
 int msg_send_to_self(msg_t *m)
 {
     unsigned state = disableIRQ();
@@ -336,6 +405,69 @@ static int _msg_receive(msg_t *m, int block)
     DEBUG("This should have never been reached!\n");
 }
 
+int msg_receive_many(msg_t *m, int num)
+{
+    dINT();
+
+    tcb_t *me = (tcb_t*) sched_threads[sched_active_pid];
+    int count = 0;
+
+    /* same order as num calls of msg_try_receive(): the queue first, and a
+     * waiting sender moves up into each slot taken from the queue */
+    while (count < num) {
+        int queue_index = -1;
+        priority_queue_node_t *node;
+
+        if (me->msg_array) {
+            queue_index = cib_get(&(me->msg_queue));
+        }
+
+        if (queue_index >= 0) {
+            m[count++] = me->msg_array[queue_index];
+        }
+
+        node = priority_queue_remove_head(&(me->msg_waiters));
+
+        if (node == NULL) {
+            if (queue_index < 0) {
+                break;
+            }
+
+            continue;
+        }
+
+        tcb_t *sender = (tcb_t*) node->data;
+        msg_t *sender_msg = (msg_t*) sender->wait_data;
+
+        if (queue_index >= 0) {
+            me->msg_array[cib_put(&(me->msg_queue))] = *sender_msg;
+        }
+        else {
+            m[count++] = *sender_msg;
+        }
+
+        if (sender->status != STATUS_REPLY_BLOCKED) {
+            sender->wait_data = NULL;
+            sched_set_status(sender, STATUS_PENDING);
+        }
+    }
+
+    if ((count == 0) && (num > 0)) {
+        DEBUG("msg_receive_many(): %s: No msg in queue. Going blocked.\n", sched_active_thread->name);
+        me->wait_data = (void *) m;
+        sched_set_status(me, STATUS_RECEIVE_BLOCKED);
+
+        eINT();
+        thread_yield_higher();
+
+        /* sender copied message */
+        return 1;
+    }
+
+    eINT();
+    return count;
+}
+
 int msg_init_queue(msg_t *array, int num)
 {
     /* check if num is a power of two by comparing to its complement */
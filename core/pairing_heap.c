@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_util
+ * @{
+ *
+ * @file        pairing_heap.c
+ * @brief       An intrusive pairing heap
+ *
+ * @}
+ */
+
+#include "pairing_heap.h"
+
+/**
+ * @brief   Link two subheaps, the one with the higher priority value
+ *          becomes the leftmost child of the other.
+ *
+ * @details `a` wins ties, so adding to a heap never replaces an equal root.
+ *          The `next` pointer of the winner is left untouched.
+ */
+static pairing_heap_node_t *_link(pairing_heap_node_t *a, pairing_heap_node_t *b)
+{
+    if (b->priority < a->priority) {
+        pairing_heap_node_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    b->prev = a;
+    b->next = a->child;
+
+    if (a->child) {
+        a->child->prev = b;
+    }
+
+    a->child = b;
+    return a;
+}
+
+/**
+ * @brief   Standard two-pass merge of a sibling list into one subheap.
+ */
+static pairing_heap_node_t *_merge_pairs(pairing_heap_node_t *first)
+{
+    pairing_heap_node_t *acc = NULL;
+
+    if (!first) {
+        return NULL;
+    }
+
+    /* first pass: link pairs from left to right, collecting them reversed */
+    while (first) {
+        pairing_heap_node_t *a = first;
+        pairing_heap_node_t *b = a->next;
+
+        if (b) {
+            first = b->next;
+            a = _link(a, b);
+        }
+        else {
+            first = NULL;
+        }
+
+        a->next = acc;
+        acc = a;
+    }
+
+    /* second pass: link the pairs from right to left */
+    pairing_heap_node_t *res = acc;
+    acc = acc->next;
+
+    while (acc) {
+        pairing_heap_node_t *next = acc->next;
+        res = _link(res, acc);
+        acc = next;
+    }
+
+    res->next = NULL;
+    res->prev = NULL;
+    return res;
+}
+
+static void _unlink(pairing_heap_node_t *node)
+{
+    node->child = NULL;
+    node->next = NULL;
+    node->prev = NULL;
+    node->heap = NULL;
+}
+
+static void _set_root(pairing_heap_t *heap, pairing_heap_node_t *root)
+{
+    if (root) {
+        root->next = NULL;
+        root->prev = NULL;
+    }
+
+    heap->root = root;
+}
+
+pairing_heap_node_t *pairing_heap_remove_head(pairing_heap_t *heap)
+{
+    pairing_heap_node_t *head = heap->root;
+
+    if (head) {
+        _set_root(heap, _merge_pairs(head->child));
+        _unlink(head);
+    }
+
+    return head;
+}
+
+void pairing_heap_add(pairing_heap_t *heap, pairing_heap_node_t *node)
+{
+    _unlink(node);
+    node->heap = heap;
+
+    if (heap->root) {
+        _set_root(heap, _link(heap->root, node));
+    }
+    else {
+        heap->root = node;
+    }
+}
+
+void pairing_heap_remove(pairing_heap_t *heap, pairing_heap_node_t *node)
+{
+    if (node->heap != heap) {
+        return;
+    }
+
+    if (node == heap->root) {
+        pairing_heap_remove_head(heap);
+        return;
+    }
+
+    /* cut the subtree rooted at node out of its sibling list */
+    if (node->prev->child == node) {
+        node->prev->child = node->next;
+    }
+    else {
+        node->prev->next = node->next;
+    }
+
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+
+    pairing_heap_node_t *sub = _merge_pairs(node->child);
+
+    if (sub) {
+        _set_root(heap, _link(heap->root, sub));
+    }
+
+    _unlink(node);
+}
@@ -104,6 +104,11 @@ void _native_handle_tap_input(void)
                 if (p.length > (nread - sizeof(struct nativenet_header))) {
                     warnx("_native_handle_tap_input: packet with malicious length field received, discarding");
                 }
+#ifdef NATIVENET_LOSS_PERCENT
+                else if ((rand() % 100) < NATIVENET_LOSS_PERCENT) {
+                    DEBUG("_native_handle_tap_input: dropping packet, simulated loss\n");
+                }
+#endif
                 else {
                     DEBUG("_native_handle_tap_input: received packet of length %" PRIu16 " for %" PRIu16 " from %"
                           PRIu16 "\n", p.length, p.dst, p.src);
@@ -131,7 +131,7 @@ static void riot_ccn_relay_config(int argc, char **argv)
     }
 
     if (argc < 2) {
-        printf("%s: <max_cache_entries>\n", argv[0]);
+        printf("%s: <max_cache_bytes>\n", argv[0]);
         return;
     }
 
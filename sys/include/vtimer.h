@@ -24,7 +24,11 @@
 #include <time.h>
 #include <sys/time.h>
 
+#ifdef MODULE_VTIMER_HEAP
+#include "pairing_heap.h"
+#else
 #include "priority_queue.h"
+#endif
 #include "timex.h"
 #include "msg.h"
 
@@ -36,10 +40,20 @@
  * This structure is used for declaring a vtimer. This should not be used by
  * programmers, use the vtimer_set_*-functions instead.
  *
+ * With the `vtimer_heap` module the pending timers are kept in pairing heaps
+ * instead of sorted lists, making vtimer_set() O(1) and vtimer_remove()
+ * O(log n). A heap node holds four pointers and the priority instead of a
+ * pointer, the priority and a data word, that is two words (8 bytes on
+ * 32 bit platforms) more per timer.
+ *
  * \hideinitializer
  */
 typedef struct vtimer_t {
+#ifdef MODULE_VTIMER_HEAP
+    pairing_heap_node_t priority_queue_entry;
+#else
     priority_queue_node_t priority_queue_entry;
+#endif
     timex_t absolute;
     void (*action)(struct vtimer_t *timer);
     void *arg;
@@ -126,15 +140,21 @@ int vtimer_msg_receive_timeout(msg_t *m, timex_t timeout);
  */
 void vtimer_print(vtimer_t *t);
 
+#ifndef MODULE_VTIMER_HEAP
 /**
  * @brief Prints the vtimer shortterm queue (use for debug purposes)
+ *
+ * Not available with the `vtimer_heap` module.
  */
 void vtimer_print_short_queue(void);
 
 /**
  * @brief Prints the vtimer longterm queue (use for debug purposes)
+ *
+ * Not available with the `vtimer_heap` module.
  */
 void vtimer_print_long_queue(void);
+#endif
 
 #endif
 
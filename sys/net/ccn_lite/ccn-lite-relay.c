@@ -117,8 +117,14 @@ void ccnl_ageing(void *relay, void *aux)
 
 void ccnl_retransmit(void *relay, void *aux)
 {
-    ccnl_do_retransmit(relay, aux);
-    ccnl_set_timer(TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC), ccnl_retransmit, relay, 0);
+    long usec = ccnl_do_retransmit(relay, aux);
+
+    if (usec < 0) {
+        /* nothing pending, a new interest is not due before a full period */
+        usec = TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC, CCNL_CHECK_RETRANSMIT_USEC);
+    }
+
+    ccnl_set_timer(usec, ccnl_retransmit, relay, 0);
 }
 
 void ccnl_nonce_timeout(void *relay, void *aux)
@@ -129,13 +135,13 @@ void ccnl_nonce_timeout(void *relay, void *aux)
 
 // ----------------------------------------------------------------------
 
-void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_entries, int fib_threshold_prefix, int fib_threshold_aggregate)
+void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_bytes, int fib_threshold_prefix, int fib_threshold_aggregate)
 {
     struct ccnl_if_s *i;
 
     DEBUGMSG(99, "ccnl_relay_config\n");
 
-    relay->max_cache_entries = max_cache_entries;
+    relay->max_cache_bytes = max_cache_bytes;
     relay->fib_threshold_prefix = fib_threshold_prefix;
     relay->fib_threshold_aggregate = fib_threshold_aggregate;
 
@@ -242,9 +248,9 @@ void ccnl_populate_cache(struct ccnl_relay_s *ccnl, unsigned char *buf, int data
 
     Done:
         free_prefix(prefix);
-        ccnl_free(pkt);
-        ccnl_free(nonce);
-        ccnl_free(ppkd);
+        ccnl_buf_free(pkt);
+        ccnl_buf_free(nonce);
+        ccnl_buf_free(ppkd);
     }
     else {
         DEBUGMSG(6, "  not a content object\n");
@@ -353,18 +359,19 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                 handle_populate_cache(ccnl);
                 break;
 #endif
-#if ENABLE_DEBUG
             case (CCNL_RIOT_PRINT_STAT):
-                /* cmd to print face statistics */
+                /* cmd to print face and memory pool statistics */
+#if ENABLE_DEBUG
                 for (struct ccnl_face_s *f = ccnl->faces; f; f = f->next) {
                     ccnl_face_print_stat(f);
                 }
-                break;
 #endif
+                ccnl_pool_print_stat();
+                break;
             case (CCNL_RIOT_CONFIG_CACHE):
                 /* cmd to configure the size of the cache at runtime */
-                ccnl->max_cache_entries = in.content.value;
-                DEBUGMSG(1, "max_cache_entries set to %d\n", ccnl->max_cache_entries);
+                ccnl->max_cache_bytes = in.content.value;
+                DEBUGMSG(1, "max_cache_bytes set to %d\n", ccnl->max_cache_bytes);
                 break;
             case (ENOBUFFER):
                 /* transceiver has not enough buffer to store incoming packets, one packet is dropped  */
@@ -398,11 +405,11 @@ void *ccnl_riot_relay_start(void *arg)
 
     DEBUGMSG(1, "This is ccn-lite-relay, starting at %lu:%lu\n", theRelay->startup_time.tv_sec, theRelay->startup_time.tv_usec);
     DEBUGMSG(1, "  compile time: %s %s\n", __DATE__, __TIME__);
-    DEBUGMSG(1, "  max_cache_entries: %d\n", CCNL_DEFAULT_MAX_CACHE_ENTRIES);
+    DEBUGMSG(1, "  max_cache_bytes: %d\n", CCNL_DEFAULT_MAX_CACHE_BYTES);
     DEBUGMSG(1, "  threshold_prefix: %d\n", CCNL_DEFAULT_THRESHOLD_PREFIX);
     DEBUGMSG(1, "  threshold_aggregate: %d\n", CCNL_DEFAULT_THRESHOLD_AGGREGATE);
 
-    ccnl_relay_config(theRelay, CCNL_DEFAULT_MAX_CACHE_ENTRIES, CCNL_DEFAULT_THRESHOLD_PREFIX, CCNL_DEFAULT_THRESHOLD_AGGREGATE);
+    ccnl_relay_config(theRelay, CCNL_DEFAULT_MAX_CACHE_BYTES, CCNL_DEFAULT_THRESHOLD_PREFIX, CCNL_DEFAULT_THRESHOLD_AGGREGATE);
 
     theRelay->riot_helper_pid = riot_start_helper_thread();
 
@@ -423,11 +430,18 @@ void *ccnl_riot_relay_start(void *arg)
 void *ccnl_riot_relay_helper_start(void *arg)
 {
     (void) arg;
-    unsigned long us = CCNL_CHECK_RETRANSMIT_USEC;
     mutex_lock(&theRelay->stop_lock);
     while (!theRelay->halt_flag) {
+        /* sleep until the next event is due, at most one retransmit period */
+        unsigned long us = CCNL_CHECK_RETRANSMIT_USEC;
+
         mutex_lock(&theRelay->global_lock);
-        ccnl_run_events();
+        struct timeval *next = ccnl_run_events();
+
+        if (next && 1000000 * next->tv_sec + next->tv_usec < (long) us) {
+            us = 1000000 * next->tv_sec + next->tv_usec;
+        }
+
         mutex_unlock(&theRelay->global_lock);
 
         vtimer_usleep(us);
@@ -26,6 +26,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "irq.h"
+
 #include "ccnl.h"
 #include "ccnl-core.h"
 #include "ccnl-pdu.h"
@@ -45,42 +47,29 @@ static struct ccnl_interest_s *ccnl_interest_remove(struct ccnl_relay_s *ccnl,
 void ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
                 sockunion *dest, struct ccnl_buf_s *buf);
 
-void free_2ptr_list(void *a, void *b)
-{
-    ccnl_free(a);
-    ccnl_free(b);
-}
-void free_3ptr_list(void *a, void *b, void *c)
-{
-    ccnl_free(a);
-    ccnl_free(b);
-    ccnl_free(c);
-}
-void free_4ptr_list(void *a, void *b, void *c, void *d)
-{
-    ccnl_free(a);
-    ccnl_free(b);
-    ccnl_free(c);
-    ccnl_free(d);
-}
+struct ccnl_buf_s *
+ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
 
 void free_prefix(struct ccnl_prefix_s *p)
 {
     if (p) {
-        free_4ptr_list(p->path, p->comp, p->complen, p);
+        ccnl_buf_free(p->path);
+        ccnl_pool_free(CCNL_POOL_PREFIX, p);
     }
 }
 
 void free_content(struct ccnl_content_s *c)
 {
     free_prefix(c->name);
-    free_2ptr_list(c->pkt, c);
+    ccnl_buf_free(c->pkt);
+    ccnl_buf_free(c->ppkd);
+    ccnl_pool_free(CCNL_POOL_CONTENT, c);
 }
 
 void free_forward(struct ccnl_forward_s *fwd)
 {
     free_prefix(fwd->prefix);
-    ccnl_free(fwd);
+    ccnl_pool_free(CCNL_POOL_FORWARD, fwd);
 }
 
 // ----------------------------------------------------------------------
@@ -89,14 +78,30 @@ void free_forward(struct ccnl_forward_s *fwd)
 struct ccnl_buf_s *
 ccnl_buf_new(void *data, int len)
 {
-    struct ccnl_buf_s *b = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*b) + len);
+    struct ccnl_buf_s *b = NULL;
+    int pool = CCNL_POOL_HEAP;
+
+    // the smallest pool that fits, the large one when the small one is empty
+    if (len <= CCNL_BUF_SMALL_SIZE) {
+        pool = CCNL_POOL_SMALL_BUF;
+        b = (struct ccnl_buf_s *) ccnl_pool_alloc(pool);
+    }
+
+    if (!b && len <= CCNL_BUF_LARGE_SIZE) {
+        pool = CCNL_POOL_LARGE_BUF;
+        b = (struct ccnl_buf_s *) ccnl_pool_alloc(pool);
+    }
+    else if (len > CCNL_BUF_LARGE_SIZE) {
+        b = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*b) + len);
+    }
 
     if (!b) {
         return NULL;
     }
 
-    b->next = NULL;
     b->datalen = len;
+    b->refs = 1;
+    b->pool = pool;
 
     if (data) {
         memcpy(b->data, data, len);
@@ -105,9 +110,54 @@ ccnl_buf_new(void *data, int len)
     return b;
 }
 
+// another reference to the same buffer
 struct ccnl_buf_s *buf_dup(struct ccnl_buf_s *B)
 {
-    return (B) ? ccnl_buf_new(B->data, B->datalen) : NULL;
+    if (B) {
+        unsigned state = disableIRQ();
+        B->refs++;
+        restoreIRQ(state);
+    }
+
+    return B;
+}
+
+void ccnl_buf_free(struct ccnl_buf_s *b)
+{
+    unsigned state;
+    int last;
+
+    if (!b) {
+        return;
+    }
+
+    state = disableIRQ();
+    last = (--b->refs == 0);
+    restoreIRQ(state);
+
+    if (!last) {
+        return;
+    }
+
+    if (b->pool == CCNL_POOL_HEAP) {
+        ccnl_free(b);
+    }
+    else {
+        ccnl_pool_free(b->pool, b);
+    }
+}
+
+struct ccnl_prefix_s *ccnl_prefix_new(void)
+{
+    struct ccnl_prefix_mem_s *m = ccnl_pool_alloc(CCNL_POOL_PREFIX);
+
+    if (!m) {
+        return NULL;
+    }
+
+    m->prefix.comp = m->comp;
+    m->prefix.complen = m->complen;
+    return &m->prefix;
 }
 
 int buf_equal(struct ccnl_buf_s *X, struct ccnl_buf_s *Y)
@@ -115,6 +165,33 @@ int buf_equal(struct ccnl_buf_s *X, struct ccnl_buf_s *Y)
     return ((X) && (Y) && (X->datalen == Y->datalen) && !memcmp(X->data, Y->data, X->datalen));
 }
 
+// FNV-1a, the length separates the components
+uint32_t ccnl_hash_comp(uint32_t h, unsigned char *comp, int len)
+{
+    int i;
+
+    h = (h ^ (uint32_t) len) * 16777619u;
+
+    for (i = 0; i < len; i++) {
+        h = (h ^ comp[i]) * 16777619u;
+    }
+
+    return h;
+}
+
+// hash of the first cnt components of a name
+uint32_t ccnl_prefix_hash(struct ccnl_prefix_s *p, int cnt)
+{
+    uint32_t h = CCNL_HASH_INIT;
+    int i;
+
+    for (i = 0; i < cnt; i++) {
+        h = ccnl_hash_comp(h, p->comp[i], p->complen[i]);
+    }
+
+    return h;
+}
+
 int ccnl_prefix_cmp(struct ccnl_prefix_s *name, unsigned char *md,
                     struct ccnl_prefix_s *p, int mode)
 /* returns -1 if no match at all (all modes) or exact match failed
@@ -208,33 +285,6 @@ static int data2uint(unsigned char *cp, int len)
     return val;
 }
 
-struct ccnl_nonce_s *ccnl_nonce_new(struct ccnl_buf_s *that)
-{
-    struct ccnl_nonce_s *n = (struct ccnl_nonce_s *) ccnl_malloc(sizeof(struct ccnl_nonce_s));
-
-    n->buf = buf_dup(that);
-    ccnl_get_timeval(&n->created);
-
-    n->next = NULL;
-    n->prev = NULL;
-
-    return n;
-}
-
-struct ccnl_nonce_s *ccnl_nonce_remove(struct ccnl_relay_s *ccnl, struct ccnl_nonce_s *nonce)
-{
-    DEBUGMSG(99, "ccnl_nonce_remove: %u:%u:%u:%u\n",
-             nonce->buf->data[0], nonce->buf->data[1], nonce->buf->data[2], nonce->buf->data[3]);
-
-    struct ccnl_nonce_s *next = nonce->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->nonces, nonce);
-
-    free(nonce->buf);
-    free(nonce);
-
-    return next;
-}
-
 struct ccnl_buf_s *
 ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
                                int *aok, int *min, int *max, struct ccnl_prefix_s **prefix,
@@ -247,22 +297,13 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
     struct ccnl_buf_s *buf, *n = 0, *pub = 0;
     DEBUGMSG(99, "ccnl_extract_prefix\n");
 
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    p = ccnl_prefix_new();
 
     if (!p) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
+        puts("can't get more memory, dropping ccn msg...");
         return NULL;
     }
 
-    p->comp = (unsigned char **) ccnl_malloc(
-                  CCNL_MAX_NAME_COMP * sizeof(unsigned char **));
-    p->complen = (int *) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(int));
-
-    if (!p->comp || !p->complen) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-        goto Bail;
-    }
-
     while (dehead(data, datalen, &num, &typ) == 0) {
         if (num == 0 && typ == 0) {
             break;    // end
@@ -352,6 +393,22 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
         }
     }
 
+    buf = ccnl_buf_new(start, *data - start);
+
+    if (!buf) {
+        puts("can't get more memory, dropping ccn msg...");
+        goto Bail;
+    }
+
+    // carefully rebase ptrs to new buf because of 64bit pointers:
+    if (content && *content) {
+        *content = buf->data + (*content - start);
+    }
+
+    for (num = 0; num < p->compcnt; num++) {
+        p->comp[num] = buf->data + (p->comp[num] - start);
+    }
+
     if (prefix) {
         p->comp[p->compcnt] = NULL;
         *prefix = p;
@@ -364,36 +421,21 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
         *nonce = n;
     }
     else {
-        ccnl_free(n);
+        ccnl_buf_free(n);
     }
 
     if (ppkd) {
         *ppkd = pub;
     }
     else {
-        ccnl_free(pub);
-    }
-
-    buf = ccnl_buf_new(start, *data - start);
-
-    if (!buf) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-        goto Bail;
-    }
-
-    // carefully rebase ptrs to new buf because of 64bit pointers:
-    if (content) {
-        *content = buf->data + (*content - start);
-    }
-
-    for (num = 0; num < p->compcnt; num++) {
-        p->comp[num] = buf->data + (p->comp[num] - start);
+        ccnl_buf_free(pub);
     }
 
     return buf;
 Bail:
     free_prefix(p);
-    free_2ptr_list(n, pub);
+    ccnl_buf_free(n);
+    ccnl_buf_free(pub);
     return NULL;
 }
 
@@ -416,6 +458,7 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
         if (ifndx == f->ifndx && (f->faceid == sender_id)) {
             DEBUGMSG(1, "face found! ifidx=%d sender_id=%d faceid=%d\n", ifndx, sender_id, f->faceid);
             ccnl_get_timeval(&f->last_used);
+            MRU_LIST_TOUCH(ccnl->faces, ccnl->facesend, f);
             return f;
         }
     }
@@ -469,7 +512,7 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
 #endif
 
     ccnl_get_timeval(&f->last_used);
-    DBL_LINKED_LIST_ADD(ccnl->faces, f);
+    MRU_LIST_ADD(ccnl->faces, ccnl->facesend, f);
 
     return f;
 }
@@ -479,7 +522,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
     struct ccnl_face_s *f2;
     struct ccnl_interest_s *pit;
-    struct ccnl_forward_s **ppfwd;
+    struct ccnl_forward_s *fwd;
     DEBUGMSG(1, "ccnl_face_remove relay=%p face=%p\n", (void *) ccnl, (void *) f);
 
     ccnl_sched_destroy(f->sched);
@@ -496,7 +539,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
             if ((*ppend)->face == f) {
                 pend = *ppend;
                 *ppend = pend->next;
-                ccnl_free(pend);
+                ccnl_pool_free(CCNL_POOL_PENDINT, pend);
             }
             else {
                 ppend = &(*ppend)->next;
@@ -511,22 +554,17 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
         }
     }
 
-    for (ppfwd = &ccnl->fib; *ppfwd;) {
-        if ((*ppfwd)->face == f) {
-            struct ccnl_forward_s *pfwd = *ppfwd;
-            *ppfwd = pfwd->next;
-
-            ccnl_forward_remove(ccnl, pfwd);
+    for (fwd = ccnl->fib; fwd;) {
+        if (fwd->face == f) {
+            fwd = ccnl_forward_remove(ccnl, fwd);
         }
         else {
-            ppfwd = &(*ppfwd)->next;
+            fwd = fwd->next;
         }
     }
 
-    while (f->outq) {
-        struct ccnl_buf_s *tmp = f->outq->next;
-        ccnl_free(f->outq);
-        f->outq = tmp;
+    while (f->outqlen) {
+        ccnl_buf_free(ccnl_face_dequeue(ccnl, f));
     }
 
 #if ENABLE_DEBUG
@@ -534,7 +572,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 #endif
 
     f2 = f->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->faces, f);
+    MRU_LIST_REMOVE(ccnl->faces, ccnl->facesend, f);
     ccnl_free(f);
     return f2;
 }
@@ -567,7 +605,7 @@ void ccnl_interface_cleanup(struct ccnl_if_s *i)
     for (j = 0; j < i->qlen; j++) {
         struct ccnl_txrequest_s *r = i->queue
                                      + (i->qfront + j) % CCNL_MAX_IF_QLEN;
-        ccnl_free(r->buf);
+        ccnl_buf_free(r->buf);
     }
 }
 
@@ -592,7 +630,7 @@ void ccnl_interface_CTS(void *aux1, void *aux2)
     ifc->qlen--;
 
     ccnl_ll_TX(ccnl, ifc, &req.dst, req.buf);
-    ccnl_free(req.buf);
+    ccnl_buf_free(req.buf);
 }
 
 void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
@@ -605,7 +643,7 @@ void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
 
     if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
         DEBUGMSG(2, "  DROPPING buf=%p\n", (void *) buf);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
         return;
     }
 
@@ -628,18 +666,13 @@ ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     DEBUGMSG(20, "ccnl_face_dequeue face=%p (id=%d.%d)\n", (void *) f, ccnl->id,
              f->faceid);
 
-    if (!f->outq) {
+    if (!f->outqlen) {
         return NULL;
     }
 
-    pkt = f->outq;
-    f->outq = pkt->next;
-
-    if (!pkt->next) {
-        f->outqend = NULL;
-    }
-
-    pkt->next = NULL;
+    pkt = f->outq[f->outqfront];
+    f->outqfront = (f->outqfront + 1) % CCNL_MAX_FACE_QLEN;
+    f->outqlen--;
     return pkt;
 }
 
@@ -688,27 +721,30 @@ void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                       struct ccnl_buf_s *buf)
 {
-    struct ccnl_buf_s *msg;
+    int k;
     DEBUGMSG(20, "ccnl_face_enqueue face=%p (id=%d.%d) buf=%p len=%d\n",
-             (void *) to, ccnl->id, to->faceid, (void *) buf, buf->datalen);
+             (void *) to, ccnl->id, to->faceid, (void *) buf, buf ? buf->datalen : 0);
+
+    if (!buf) {
+        return -1;
+    }
 
-    for (msg = to->outq; msg; msg = msg->next) // already in the queue?
-        if (buf_equal(msg, buf)) {
+    for (k = 0; k < to->outqlen; k++) { // already in the queue?
+        if (buf_equal(to->outq[(to->outqfront + k) % CCNL_MAX_FACE_QLEN], buf)) {
             DEBUGMSG(31, "    not enqueued because already there\n");
-            ccnl_free(buf);
+            ccnl_buf_free(buf);
             return -1;
         }
-
-    buf->next = NULL;
-
-    if (to->outqend) {
-        to->outqend->next = buf;
     }
-    else {
-        to->outq = buf;
+
+    if (to->outqlen >= CCNL_MAX_FACE_QLEN) {
+        DEBUGMSG(2, "  DROPPING buf=%p\n", (void *) buf);
+        ccnl_buf_free(buf);
+        return -1;
     }
 
-    to->outqend = buf;
+    to->outq[(to->outqfront + to->outqlen) % CCNL_MAX_FACE_QLEN] = buf;
+    to->outqlen++;
     ccnl_face_CTS(ccnl, to);
     return 0;
 }
@@ -716,39 +752,46 @@ int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
 // ----------------------------------------------------------------------
 // handling of interest messages
 
-int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
-                              struct ccnl_buf_s *nonce)
+// the retransmission queue holds interests in order of their last
+// transmission, the one at rtxend is due first
+static void ccnl_interest_rtx_add(struct ccnl_relay_s *ccnl,
+                                  struct ccnl_interest_s *i)
 {
-    struct ccnl_nonce_s *n, *last;
-    int i;
-    DEBUGMSG(99, "ccnl_nonce_find_or_append: %u:%u:%u:%u\n",
-             nonce->data[0], nonce->data[1], nonce->data[2], nonce->data[3]);
+    i->rtx_prev = NULL;
+    i->rtx_next = ccnl->rtx;
 
-    /* test for noce in nonce cache */
+    if (ccnl->rtx) {
+        ccnl->rtx->rtx_prev = i;
+    }
+    else {
+        ccnl->rtxend = i;
+    }
 
-    for (n = ccnl->nonces, i = 0; n; n = n->next, i++) {
-        DEBUGMSG(1, "known: %u:%u:%u:%u\n",
-                 n->buf->data[0], n->buf->data[1], n->buf->data[2], n->buf->data[3]);
-        if (buf_equal(n->buf, nonce)) {
-            /* nonce in cache -> known */
-            return -1;
-        }
-        if (n->next) {
-            last = n->next;
-        }
+    ccnl->rtx = i;
+}
+
+static void ccnl_interest_rtx_remove(struct ccnl_relay_s *ccnl,
+                                     struct ccnl_interest_s *i)
+{
+    if (!i->rtx_prev && ccnl->rtx != i) {
+        return; // not queued
     }
 
-    /* nonce not in local cache, add it */
-    n = ccnl_nonce_new(nonce);
-    DBL_LINKED_LIST_ADD(ccnl->nonces, n);
+    if (i->rtx_prev) {
+        i->rtx_prev->rtx_next = i->rtx_next;
+    }
+    else {
+        ccnl->rtx = i->rtx_next;
+    }
 
-    /* nonce chache full? */
-    if (i >= CCNL_MAX_NONCES) {
-        /* cache is full, drop oldest nonce: its the last element in the list */
-        ccnl_nonce_remove(ccnl, last);
+    if (i->rtx_next) {
+        i->rtx_next->rtx_prev = i->rtx_prev;
+    }
+    else {
+        ccnl->rtxend = i->rtx_prev;
     }
 
-    return 0;
+    i->rtx_next = i->rtx_prev = NULL;
 }
 
 struct ccnl_interest_s *
@@ -756,17 +799,24 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                   struct ccnl_buf_s **pkt, struct ccnl_prefix_s **prefix, int minsuffix,
                   int maxsuffix, struct ccnl_buf_s **ppkd)
 {
-    struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_calloc(1,
-                                sizeof(struct ccnl_interest_s));
+    struct ccnl_interest_s *i = (struct ccnl_interest_s *)
+                                ccnl_pool_alloc(CCNL_POOL_INTEREST);
     DEBUGMSG(99, "ccnl_new_interest\n");
 
     if (!i) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
+        puts("can't get more memory, dropping ccn msg...");
         return NULL;
     }
 
-    i->from = from;
     i->prefix = *prefix;
+
+    if (ccnl_trie_add_interest(ccnl, i) < 0) {
+        puts("can't get more memory, dropping ccn msg...");
+        ccnl_pool_free(CCNL_POOL_INTEREST, i);
+        return NULL;
+    }
+
+    i->from = from;
     *prefix = 0;
     i->pkt = *pkt;
     *pkt = 0;
@@ -775,7 +825,7 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     i->minsuffix = minsuffix;
     i->maxsuffix = maxsuffix;
     ccnl_get_timeval(&i->last_used);
-    DBL_LINKED_LIST_ADD(ccnl->pit, i);
+    MRU_LIST_ADD(ccnl->pit, ccnl->pitend, i);
     return i;
 }
 
@@ -795,8 +845,7 @@ int ccnl_interest_append_pending(struct ccnl_interest_s *i,
         last = pi;
     }
 
-    pi = (struct ccnl_pendint_s *) ccnl_calloc(1,
-            sizeof(struct ccnl_pendint_s));
+    pi = (struct ccnl_pendint_s *) ccnl_pool_alloc(CCNL_POOL_PENDINT);
     DEBUGMSG(40, "  appending a new pendint entry %p\n", (void *) pi);
 
     if (!pi) {
@@ -816,6 +865,13 @@ int ccnl_interest_append_pending(struct ccnl_interest_s *i,
     return 0;
 }
 
+static void ccnl_forward_touch(struct ccnl_relay_s *ccnl,
+                               struct ccnl_forward_s *fwd)
+{
+    ccnl_get_timeval(&fwd->last_used);
+    MRU_LIST_TOUCH(ccnl->fib, ccnl->fibend, fwd);
+}
+
 void ccnl_interest_propagate(struct ccnl_relay_s *ccnl,
                              struct ccnl_interest_s *i)
 {
@@ -824,39 +880,57 @@ void ccnl_interest_propagate(struct ccnl_relay_s *ccnl,
 
     // CONFORM: "A node MUST implement some strategy rule, even if it is only to
     // transmit an Interest Message on all listed dest faces in sequence."
-    // CCNL strategy: we forward on all FWD entries with a prefix match
-    int forward_cnt = 0;
-    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
-        int rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->prefix, CMP_LONGEST);
-        DEBUGMSG(40, "  ccnl_interest_propagate, rc=%d/%d\n", rc,
-                 fwd->prefix->compcnt);
+    // CCNL strategy: we forward on all FWD entries of the longest matching
+    // prefix that does not only lead back to the origin
+    struct ccnl_trie_node_s *path[CCNL_MAX_NAME_COMP + 1];
+    struct ccnl_trie_node_s *n = &ccnl->trie;
+    int k, depth = 0;
 
-        if (rc < fwd->prefix->compcnt) {
-            continue;
-        }
+    path[0] = n;
 
-        DEBUGMSG(40, "  ccnl_interest_propagate, fwd==%p\n", (void *) fwd);
+    for (k = 0; k < i->prefix->compcnt; k++) {
+        n = ccnl_trie_child(ccnl, n, i->prefix->comp[k], i->prefix->complen[k]);
 
-        // suppress forwarding to origin of interest, except wireless
-        if (!i->from || fwd->face != i->from
-            || (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
+        if (!n) {
+            break;
+        }
+
+        path[++depth] = n;
+    }
 
-            i->forwarded_over = fwd;
-            fwd->face->stat.send_interest[i->retries]++;
-            ccnl_get_timeval(&i->last_used);
-            ccnl_face_enqueue(ccnl, fwd->face, buf_dup(i->pkt));
-            ccnl_get_timeval(&fwd->last_used);
-            forward_cnt++;
+    int forward_cnt = 0;
+    for (; depth >= 0 && forward_cnt == 0; depth--) {
+        for (fwd = path[depth]->fib; fwd; fwd = fwd->node_next) {
+            DEBUGMSG(40, "  ccnl_interest_propagate, fwd==%p\n", (void *) fwd);
+
+            // suppress forwarding to origin of interest, except wireless
+            if (!i->from || fwd->face != i->from
+                || (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
+
+                i->forwarded_over = fwd;
+                fwd->face->stat.send_interest[i->retries]++;
+                ccnl_face_enqueue(ccnl, fwd->face, buf_dup(i->pkt));
+                ccnl_forward_touch(ccnl, fwd);
+                forward_cnt++;
+            }
         }
     }
 
     if (forward_cnt == 0) {
         DEBUGMSG(40, "  ccnl_interest_propagate: using broadcast face!\n");
         ccnl->ifs[RIOT_TRANS_IDX].broadcast_face->stat.send_interest[i->retries]++;
-        ccnl_get_timeval(&i->last_used);
         ccnl_face_enqueue(ccnl, ccnl->ifs[RIOT_TRANS_IDX].broadcast_face, buf_dup(i->pkt));
     }
 
+    // retransmission and timeout of the interest count from now on
+    ccnl_get_timeval(&i->last_used);
+    MRU_LIST_TOUCH(ccnl->pit, ccnl->pitend, i);
+    ccnl_interest_rtx_remove(ccnl, i);
+
+    if (i->retries <= CCNL_MAX_INTEREST_RETRANSMIT) {
+        ccnl_interest_rtx_add(ccnl, i);
+    }
+
     return;
 }
 
@@ -868,14 +942,18 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
 
     while (i->pending) {
         struct ccnl_pendint_s *tmp = i->pending->next;
-        ccnl_free(i->pending);
+        ccnl_pool_free(CCNL_POOL_PENDINT, i->pending);
         i->pending = tmp;
     }
 
     i2 = i->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->pit, i);
+    MRU_LIST_REMOVE(ccnl->pit, ccnl->pitend, i);
+    ccnl_interest_rtx_remove(ccnl, i);
+    ccnl_trie_remove_interest(ccnl, i);
     free_prefix(i->prefix);
-    free_3ptr_list(i->ppkd, i->pkt, i);
+    ccnl_buf_free(i->ppkd);
+    ccnl_buf_free(i->pkt);
+    ccnl_pool_free(CCNL_POOL_INTEREST, i);
     return i2;
 }
 
@@ -923,7 +1001,7 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
     //    DEBUGMSG(99, "ccnl_content_new <%s>\n",
     //            prefix == NULL ? NULL : ccnl_prefix_to_path(*prefix));
 
-    c = (struct ccnl_content_s *) ccnl_calloc(1, sizeof(struct ccnl_content_s));
+    c = (struct ccnl_content_s *) ccnl_pool_alloc(CCNL_POOL_CONTENT);
 
     if (!c) {
         return NULL;
@@ -945,58 +1023,6 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
     return c;
 }
 
-struct ccnl_content_s *
-ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
-{
-    struct ccnl_content_s *c2;
-    DEBUGMSG(99, "ccnl_content_remove: %s\n", ccnl_prefix_to_path(c->name));
-
-    c2 = c->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
-    free_content(c);
-    ccnl->contentcnt--;
-    return c2;
-}
-
-struct ccnl_content_s *
-ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
-{
-    DEBUGMSG(99, "ccnl_content_add2cache (%d/%d)\n", ccnl->contentcnt,
-             ccnl->max_cache_entries);
-
-    if (ccnl->max_cache_entries <= 0) {
-        DEBUGMSG(1, "  content store disabled...\n");
-        return NULL;
-    }
-
-    while (ccnl->max_cache_entries <= ccnl->contentcnt) {
-        DEBUGMSG(1, "  remove Least Recently Used content...\n");
-        struct ccnl_content_s *c2, *lru = NULL;
-
-        for (c2 = ccnl->contents; c2; c2 = c2->next) {
-            DEBUGMSG(1, "    '%s' -> %ld:%ld\n", ccnl_prefix_to_path(c2->name), c2->last_used.tv_sec, c2->last_used.tv_usec);
-            if (!(c2->flags & CCNL_CONTENT_FLAGS_STATIC)
-                && ((!lru) || timevaldelta(&c2->last_used, &lru->last_used) < 0)) {
-                lru = c2;
-            }
-        }
-
-        if (lru) {
-            DEBUGMSG(1, "   replaced: '%s'\n", ccnl_prefix_to_path(lru->name));
-            ccnl_content_remove(ccnl, lru);
-        }
-        else {
-            DEBUGMSG(1, "   no dynamic content to remove...\n");
-            break;
-        }
-    }
-
-    DEBUGMSG(1, "  add new content to store: '%s'\n", ccnl_prefix_to_path(c->name));
-    DBL_LINKED_LIST_ADD(ccnl->contents, c);
-    ccnl->contentcnt++;
-    return c;
-}
-
 // deliver new content c to all clients with (loosely) matching interest,
 // but only one copy per face
 // returns: number of forwards
@@ -1006,49 +1032,76 @@ int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
 {
     struct ccnl_interest_s *i;
     struct ccnl_face_s *f;
-    int cnt = 0;
+    struct ccnl_trie_node_s *path[CCNL_MAX_NAME_COMP + 2];
+    struct ccnl_trie_node_s *n = &ccnl->trie;
+    int k, depth = 0, cnt = 0;
     DEBUGMSG(99, "ccnl_content_serve_pending\n");
 
     for (f = ccnl->faces; f; f = f->next) {
         f->flags &= ~CCNL_FACE_FLAGS_SERVED;    // reply on a face only once
     }
 
-    for (i = ccnl->pit; i;) {
-        struct ccnl_pendint_s *pi;
+    // interests for a prefix of the name, or for the name and the digest
+    path[0] = n;
 
-        if (!ccnl_i_prefixof_c(i->prefix, i->ppkd, i->minsuffix, i->maxsuffix,
-                               c)) {
-            i = i->next;
-            continue;
+    for (k = 0; n && k < c->name->compcnt; k++) {
+        n = ccnl_trie_child(ccnl, n, c->name->comp[k], c->name->complen[k]);
+
+        if (n) {
+            path[++depth] = n;
         }
+    }
 
-        // CONFORM: "Data MUST only be transmitted in response to
-        // an Interest that matches the Data."
-        for (pi = i->pending; pi; pi = pi->next) {
-            if (pi->face->flags & CCNL_FACE_FLAGS_SERVED) {
-                continue;
-            }
+    if (n && n->child) {
+        n = ccnl_trie_child(ccnl, n, compute_ccnx_digest(c->pkt),
+                            SHA256_DIGEST_LENGTH);
 
-            if (pi->face == from) {
-                // the existing pending interest is from the same face
-                // as the newly arrived content is...no need to send content back
-                DEBUGMSG(1, "  detected looping content, before loop could happen\n");
+        if (n) {
+            path[++depth] = n;
+        }
+    }
+
+    // a node is freed with its last entry, but not before its children
+    for (k = 0; k <= depth; k++) {
+        for (i = path[k]->pit; i;) {
+            struct ccnl_interest_s *next = i->node_next;
+            struct ccnl_pendint_s *pi;
+
+            if (!ccnl_i_prefixof_c(i->prefix, i->ppkd, i->minsuffix, i->maxsuffix,
+                                   c)) {
+                i = next;
                 continue;
             }
 
-            pi->face->flags |= CCNL_FACE_FLAGS_SERVED;
+            // CONFORM: "Data MUST only be transmitted in response to
+            // an Interest that matches the Data."
+            for (pi = i->pending; pi; pi = pi->next) {
+                if (pi->face->flags & CCNL_FACE_FLAGS_SERVED) {
+                    continue;
+                }
 
-            DEBUGMSG(6, "  forwarding content <%s>\n",
-                     ccnl_prefix_to_path(c->name));
-            pi->face->stat.send_content[c->served_cnt % CCNL_MAX_CONTENT_SERVED_STAT]++;
-            ccnl_face_enqueue(ccnl, pi->face, buf_dup(c->pkt));
+                if (pi->face == from) {
+                    // the existing pending interest is from the same face
+                    // as the newly arrived content is...no need to send content back
+                    DEBUGMSG(1, "  detected looping content, before loop could happen\n");
+                    continue;
+                }
 
-            c->served_cnt++;
-            ccnl_get_timeval(&c->last_used);
-            cnt++;
-        }
+                pi->face->flags |= CCNL_FACE_FLAGS_SERVED;
 
-        i = ccnl_interest_remove(ccnl, i);
+                DEBUGMSG(6, "  forwarding content <%s>\n",
+                         ccnl_prefix_to_path(c->name));
+                pi->face->stat.send_content[c->served_cnt % CCNL_MAX_CONTENT_SERVED_STAT]++;
+                ccnl_face_enqueue(ccnl, pi->face, buf_dup(c->pkt));
+
+                c->served_cnt++;
+                ccnl_get_timeval(&c->last_used);
+                cnt++;
+            }
+
+            ccnl_interest_remove(ccnl, i);
+            i = next;
+        }
     }
 
     return cnt;
@@ -1060,34 +1113,30 @@ int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
  */
 struct ccnl_forward_s *ccn_forward_find_common_prefix_to_aggregate(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, int *match_len)
 {
-    if (!ccnl->fib) {
-        DEBUGMSG(999, "ccn_forward_find_common_prefix: fib was empty\n");
-        return NULL;
-    }
-
-    /* fib as at least one enty */
-    struct ccnl_forward_s *fwd2 = ccnl->fib;
-    while (fwd2) {
-        DEBUGMSG(1, "ccn_forward_find_common_prefix: '%s' vs. '%s'\n", ccnl_prefix_to_path(p), ccnl_prefix_to_path(fwd2->prefix));
-        *match_len = ccnl_prefix_cmp(fwd2->prefix, 0, p, CMP_LONGEST);
+    /* never date up a static entry */
+    return ccnl_trie_find_dynamic_forward(ccnl, p, ccnl->fib_threshold_aggregate,
+                                          match_len);
+}
 
-        /* check for threshold and never date up a static enty */
-        if ((ccnl->fib_threshold_aggregate <= *match_len) && !(fwd2->flags & CCNL_FORWARD_FLAGS_STATIC)) {
-            return fwd2;
-        }
+static struct ccnl_forward_s *ccnl_forward_new(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, struct ccnl_face_s *f, int threshold_prefix, int flags)
+{
+    struct ccnl_forward_s *fwd = ccnl_pool_alloc(CCNL_POOL_FORWARD);
 
-        fwd2 = fwd2->next;
+    if (!fwd) {
+        return NULL;
     }
 
-    return NULL;
-}
-
-static struct ccnl_forward_s *ccnl_forward_new(struct ccnl_prefix_s *p, struct ccnl_face_s *f, int threshold_prefix, int flags)
-{
-    struct ccnl_forward_s *fwd = ccnl_calloc(1, sizeof(struct ccnl_forward_s));
     fwd->prefix = ccnl_prefix_clone_strip(p, threshold_prefix);
     fwd->face = f;
     fwd->flags = flags;
+
+    if (!fwd->prefix || ccnl_trie_add_forward(ccnl, fwd) < 0) {
+        free_forward(fwd);
+        return NULL;
+    }
+
+    ccnl_get_timeval(&fwd->last_used);
+    MRU_LIST_ADD(ccnl->fib, ccnl->fibend, fwd);
     return fwd;
 }
 
@@ -1103,8 +1152,10 @@ void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix
         /* there was no prefix match with the user defined creteria. */
 
         /* create a new fib entry */
-        fwd = ccnl_forward_new(p, f, threshold_prefix, flags);
-        DBL_LINKED_LIST_ADD(ccnl->fib, fwd);
+        fwd = ccnl_forward_new(ccnl, p, f, threshold_prefix, flags);
+        if (!fwd) {
+            return;
+        }
         DEBUGMSG(999, "ccnl_content_learn_name_route: new route '%s' on face %d learned\n", ccnl_prefix_to_path(fwd->prefix), f->faceid);
     }
     else {
@@ -1113,11 +1164,13 @@ void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix
         /* if the new entry has shorter prefix */
         if (p->compcnt < fwd->prefix->compcnt) {
             /* we need to aggregate! */
-            DBL_LINKED_LIST_REMOVE(ccnl->fib, fwd);
+            ccnl_forward_remove(ccnl, fwd);
 
             /* create a new fib entry */
-            fwd = ccnl_forward_new(p, f, (p->compcnt - match_len), flags);
-            DBL_LINKED_LIST_ADD(ccnl->fib, fwd);
+            fwd = ccnl_forward_new(ccnl, p, f, (p->compcnt - match_len), flags);
+            if (!fwd) {
+                return;
+            }
             DEBUGMSG(999, "ccnl_content_learn_name_route: route '%s' on face %d replaced\n", ccnl_prefix_to_path(fwd->prefix), f->faceid);
         }
         else {
@@ -1127,7 +1180,7 @@ void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix
 
     /* refresh fwd entry */
     DEBUGMSG(999, "ccnl_content_learn_name_route refresh route '%s' on face %d\n", ccnl_prefix_to_path(fwd->prefix), f->faceid);
-    ccnl_get_timeval(&fwd->last_used);
+    ccnl_forward_touch(ccnl, fwd);
 }
 
 struct ccnl_forward_s *
@@ -1137,7 +1190,8 @@ ccnl_forward_remove(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
     DEBUGMSG(40, "ccnl_forward_remove %p\n", (void *) fwd);
 
     fwd2 = fwd->next;
-    DBL_LINKED_LIST_REMOVE(ccnl->fib, fwd);
+    MRU_LIST_REMOVE(ccnl->fib, ccnl->fibend, fwd);
+    ccnl_trie_remove_forward(ccnl, fwd);
 
     for (struct ccnl_interest_s *p = ccnl->pit; p; p = p->next) {
         if (p->forwarded_over == fwd) {
@@ -1158,51 +1212,43 @@ bool ccnl_is_timed_out(struct timeval *now, struct timeval *last_used, uint32_t
     return timevaldelta(now, &abs_timeout) > 0;
 }
 
-void ccnl_do_retransmit(void *ptr, void *dummy)
+long ccnl_do_retransmit(void *ptr, void *dummy)
 {
     (void) dummy; /* unused */
 
     struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
+    struct ccnl_interest_s *i;
+    struct timeval now;
+    long period = TIMEOUT_TO_US(CCNL_CHECK_RETRANSMIT_SEC,
+                                CCNL_CHECK_RETRANSMIT_USEC);
+    ccnl_get_timeval(&now);
 
-    for (struct ccnl_interest_s *i = relay->pit; i; i = i->next) {
-        // CONFORM: "Entries in the PIT MUST timeout rather
-        // than being held indefinitely."
-        if(i->retries <= CCNL_MAX_INTEREST_RETRANSMIT) {
-            // CONFORM: "A node MUST retransmit Interest Messages
-            // periodically for pending PIT entries."
-            DEBUGMSG(7, " retransmit %d <%s>\n", i->retries,
-                     ccnl_prefix_to_path(i->prefix));
-
-            if (i->forwarded_over
-                && !(i->forwarded_over->flags & CCNL_FORWARD_FLAGS_STATIC)
-                && (i->retries >= CCNL_MAX_INTEREST_OPTIMISTIC)) {
-                DEBUGMSG(1, "  removed dynamic forward %p\n", (void *) i->forwarded_over);
-                ccnl_forward_remove(relay, i->forwarded_over);
-            }
+    // only interests that were sent at least a period ago are visited,
+    // propagating one moves it to the front of the queue or drops it
+    while ((i = relay->rtxend)) {
+        long age = timevaldelta(&now, &i->last_used);
 
-            i->retries++;
-            ccnl_interest_propagate(relay, i);
+        if (age < period) {
+            return period - age;
         }
-    }
-}
-
-void ccnl_do_nonce_timeout(void *ptr, void *dummy)
-{
-    (void) dummy; /* unused */
 
-    struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
-
-    struct timeval now;
-    ccnl_get_timeval(&now);
-    //DEBUGMSG(99, "ccnl_do_nonce_timeout: %lu:%lu\n", now.tv_sec, now.tv_usec);
+        // CONFORM: "A node MUST retransmit Interest Messages
+        // periodically for pending PIT entries."
+        DEBUGMSG(7, " retransmit %d <%s>\n", i->retries,
+                 ccnl_prefix_to_path(i->prefix));
 
-    for (struct ccnl_nonce_s *n = relay->nonces; n;) {
-        if (ccnl_is_timed_out(&now, &n->created, CCNL_NONCE_TIMEOUT_SEC, CCNL_NONCE_TIMEOUT_USEC)) {
-            n = ccnl_nonce_remove(relay, n);
-        } else {
-            n = n->next;
+        if (i->forwarded_over
+            && !(i->forwarded_over->flags & CCNL_FORWARD_FLAGS_STATIC)
+            && (i->retries >= CCNL_MAX_INTEREST_OPTIMISTIC)) {
+            DEBUGMSG(1, "  removed dynamic forward %p\n", (void *) i->forwarded_over);
+            ccnl_forward_remove(relay, i->forwarded_over);
         }
+
+        i->retries++;
+        ccnl_interest_propagate(relay, i);
     }
+
+    return -1;
 }
 
 void ccnl_do_ageing(void *ptr, void *dummy)
@@ -1211,57 +1257,68 @@ void ccnl_do_ageing(void *ptr, void *dummy)
     (void) dummy; /* unused */
 
     struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
-    struct ccnl_interest_s *i = relay->pit;
-    struct ccnl_content_s *c = relay->contents;
+    struct ccnl_interest_s *i;
+    struct ccnl_content_s *c, *cstop = NULL;
+    struct ccnl_face_s *f, *fstop = NULL;
+    struct ccnl_forward_s *fwd, *fwdstop = NULL;
 
-    struct ccnl_face_s *f = relay->faces;
     struct timeval now;
     ccnl_get_timeval(&now);
     //DEBUGMSG(999, "ccnl_do_ageing %ld:%ld\n", now.tv_sec, now.tv_usec);
 
-    while (i) {
-        if (ccnl_is_timed_out(&now, &i->last_used, CCNL_INTEREST_TIMEOUT_SEC,
-                CCNL_INTEREST_TIMEOUT_USEC)) {
-            if (i->from->ifndx == RIOT_MSG_IDX) {
-                /* this interest was requested by an app from this node */
-                /* inform this app about this problem */
-                riot_send_nack(i->from->faceid);
-            }
-            i = ccnl_interest_remove(relay, i);
-        }
-        else {
-            i = i->next;
+    // all lists end with their least recently used entry, so we stop at the
+    // first one that did not time out. Static entries never time out, they
+    // are put back to the front when they reach the end.
+
+    // CONFORM: "Entries in the PIT MUST timeout rather
+    // than being held indefinitely."
+    while ((i = relay->pitend)
+           && ccnl_is_timed_out(&now, &i->last_used, CCNL_INTEREST_TIMEOUT_SEC,
+                                CCNL_INTEREST_TIMEOUT_USEC)) {
+        if (i->from && i->from->ifndx == RIOT_MSG_IDX) {
+            /* this interest was requested by an app from this node */
+            /* inform this app about this problem */
+            riot_send_nack(i->from->faceid);
         }
+        ccnl_interest_remove(relay, i);
     }
 
-    while (c) {
-        if (ccnl_is_timed_out(&now, &c->last_used, CCNL_CONTENT_TIMEOUT_SEC, CCNL_CONTENT_TIMEOUT_USEC)
-            && !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-            c = ccnl_content_remove(relay, c);
+    while ((c = relay->contentsend) && c != cstop) {
+        if (c->flags & CCNL_CONTENT_FLAGS_STATIC) {
+            MRU_LIST_TOUCH(relay->contents, relay->contentsend, c);
+            cstop = cstop ? cstop : c;
+        }
+        else if (ccnl_is_timed_out(&now, &c->last_used, CCNL_CONTENT_TIMEOUT_SEC, CCNL_CONTENT_TIMEOUT_USEC)) {
+            ccnl_content_remove(relay, c);
         }
         else {
-            c = c->next;
+            break;
         }
     }
 
-    while (f) {
-        if (!(f->flags & CCNL_FACE_FLAGS_STATIC)
-            && ccnl_is_timed_out(&now, &f->last_used, CCNL_FACE_TIMEOUT_SEC, CCNL_FACE_TIMEOUT_USEC)) {
-            f = ccnl_face_remove(relay, f);
+    while ((f = relay->facesend) && f != fstop) {
+        if (f->flags & CCNL_FACE_FLAGS_STATIC) {
+            MRU_LIST_TOUCH(relay->faces, relay->facesend, f);
+            fstop = fstop ? fstop : f;
+        }
+        else if (ccnl_is_timed_out(&now, &f->last_used, CCNL_FACE_TIMEOUT_SEC, CCNL_FACE_TIMEOUT_USEC)) {
+            ccnl_face_remove(relay, f);
         }
         else {
-            f = f->next;
+            break;
         }
     }
 
-    struct ccnl_forward_s *fwd = relay->fib;
-    while (fwd) {
-        if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)
-            && ccnl_is_timed_out(&now, &fwd->last_used, CCNL_FWD_TIMEOUT_SEC, CCNL_FWD_TIMEOUT_USEC)) {
-            fwd = ccnl_forward_remove(relay, fwd);
+    while ((fwd = relay->fibend) && fwd != fwdstop) {
+        if (fwd->flags & CCNL_FORWARD_FLAGS_STATIC) {
+            MRU_LIST_TOUCH(relay->fib, relay->fibend, fwd);
+            fwdstop = fwdstop ? fwdstop : fwd;
+        }
+        else if (ccnl_is_timed_out(&now, &fwd->last_used, CCNL_FWD_TIMEOUT_SEC, CCNL_FWD_TIMEOUT_USEC)) {
+            ccnl_forward_remove(relay, fwd);
         }
         else {
-            fwd = fwd->next;
+            break;
         }
     }
 }
@@ -1283,9 +1340,7 @@ void ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
         ccnl_content_remove(ccnl, ccnl->contents);
     }
 
-    while (ccnl->nonces) {
-        ccnl_nonce_remove(ccnl, ccnl->nonces);
-    }
+    ccnl_nonce_flush(ccnl);
 
     for (k = 0; k < ccnl->ifcount; k++) {
         ccnl_interface_cleanup(ccnl->ifs + k);
@@ -1337,16 +1392,15 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
         // CONFORM: Step 1:
         if (aok & 0x01) { // honor "answer-from-existing-content-store" flag
-            for (c = relay->contents; c; c = c->next) {
-                if (!ccnl_i_prefixof_c(p, ppkd, minsfx, maxsfx, c)) {
-                    continue;
-                }
+            c = ccnl_cs_lookup(relay, p, ppkd, minsfx, maxsfx);
 
+            if (c) {
                 // FIXME: should check stale bit in aok here
                 DEBUGMSG(7, "  matching content for interest, content %p\n",
                          (void *) c);
                 from->stat.send_content[c->served_cnt % CCNL_MAX_CONTENT_SERVED_STAT]++;
                 c->served_cnt++;
+                ccnl_cs_touch(relay, c);
 
                 if (from->ifndx >= 0) {
                     ccnl_face_enqueue(relay, from, buf_dup(c->pkt));
@@ -1357,9 +1411,10 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         }
 
         // CONFORM: Step 2: check whether interest is already known
-        for (i = relay->pit; i; i = i->next) {
-            if (!ccnl_prefix_cmp(i->prefix, NULL, p, CMP_EXACT)
-                && i->minsuffix == minsfx && i->maxsuffix == maxsfx
+        struct ccnl_trie_node_s *n = ccnl_trie_lookup(relay, p, p->compcnt);
+
+        for (i = n ? n->pit : NULL; i; i = i->node_next) {
+            if (i->minsuffix == minsfx && i->maxsuffix == maxsfx
                 && ((!ppkd && !i->ppkd) || buf_equal(ppkd, i->ppkd))) {
                 break;
             }
@@ -1392,11 +1447,9 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         from->stat.received_content++;
 
         // CONFORM: Step 1:
-        for (c = relay->contents; c; c = c->next) {
-            if (buf_equal(c->pkt, buf)) {
-                DEBUGMSG(1, "content is dup: skip\n");
-                goto Skip;
-            }
+        if (ccnl_cs_find_dup(relay, p, buf)) {
+            DEBUGMSG(1, "content is dup: skip\n");
+            goto Skip;
         }
 
         c = ccnl_content_new(relay, &buf, &p, &ppkd, content, contlen);
@@ -1415,9 +1468,12 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
             }
 #endif
 
-            if (relay->max_cache_entries != 0) { // it's set to -1 or a limit
+            if (relay->max_cache_bytes != 0) { // it's set to -1 or a limit
                 DEBUGMSG(7, "  adding content to cache\n");
-                ccnl_content_add2cache(relay, c);
+
+                if (!ccnl_content_add2cache(relay, c)) {
+                    free_content(c);
+                }
             }
             else {
                 DEBUGMSG(7, "  content not added to cache\n");
@@ -1430,7 +1486,9 @@ Skip:
     rc = 0;
 Done:
     free_prefix(p);
-    free_3ptr_list(buf, nonce, ppkd);
+    ccnl_buf_free(buf);
+    ccnl_buf_free(nonce);
+    ccnl_buf_free(ppkd);
     DEBUGMSG(1, "leaving\n");
     return rc;
 }
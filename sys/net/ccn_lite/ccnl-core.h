@@ -82,16 +82,52 @@ struct ccnl_if_s { // interface for packet IO
     struct ccnl_face_s *broadcast_face;
 };
 
+// one node per name prefix that PIT or FIB entries exist for, children are
+// found through a hash over the parent's prefix and the component
+struct ccnl_trie_node_s {
+    struct ccnl_trie_node_s *next, **pprev; // bucket chain
+    struct ccnl_trie_node_s *parent;
+    struct ccnl_trie_node_s *child, *sibling, **psibling;
+    struct ccnl_interest_s *pit; // interests for exactly this name
+    struct ccnl_forward_s *fib;  // forwarding entries for this prefix
+    uint32_t hash;  // of the name up to this node
+    int refs;       // children and entries
+    int dynfwd;     // non-static forwarding entries in the subtree
+    int depth;
+    int complen;
+    unsigned char comp[CCNL_TRIE_COMP_SIZE]; // the component if it fits
+    struct ccnl_buf_s *longcomp; // else a copy of it
+};
+
+struct ccnl_nonce_s {
+    struct timeval created;
+    uint32_t hash;
+    unsigned int len;
+    unsigned char data[CCNL_MAX_NONCE_LEN];
+};
+
+struct ccnl_nonce_table_s {
+    struct ccnl_nonce_s ring[CCNL_MAX_NONCES]; // in order of arrival
+    uint16_t index[CCNL_NONCE_HASH_SIZE]; // ring position + 1, 0: free slot
+    int first;  // the oldest nonce
+    int cnt;
+};
+
 struct ccnl_relay_s {
     struct timeval startup_time;
     int id;
-    struct ccnl_face_s *faces;
-    struct ccnl_forward_s *fib;
-    struct ccnl_interest_s *pit;
-    struct ccnl_content_s *contents; //, *contentsend;
-    struct ccnl_nonce_s *nonces;
+    struct ccnl_face_s *faces, *facesend; // most recently used first
+    struct ccnl_forward_s *fib, *fibend; // most recently used first
+    struct ccnl_interest_s *pit, *pitend; // most recently used first
+    struct ccnl_interest_s *rtx, *rtxend; // interests to be retransmitted
+    struct ccnl_content_s *contents, *contentsend; // most recently used first
+    struct ccnl_nonce_table_s nonces;
     int contentcnt;     // number of cached items
-    int max_cache_entries;  // -1: unlimited
+    int contentbytes;   // memory used by cached items
+    int max_cache_bytes;    // -1: unlimited, 0: cache disabled
+    struct ccnl_cs_link_s *cs_buckets[CCNL_CS_HASH_SIZE];
+    struct ccnl_trie_node_s trie; // the empty name, indexes pit and fib
+    struct ccnl_trie_node_s *trie_buckets[CCNL_TRIE_HASH_SIZE];
     struct ccnl_if_s ifs[CCNL_MAX_INTERFACES];
     int ifcount;        // number of active interfaces
     char halt_flag;
@@ -110,27 +146,57 @@ struct ccnl_relay_s {
     mutex_t stop_lock;
 };
 
+// buffers are shared, buf_dup takes a reference and ccnl_buf_free drops it,
+// the data of a buffer must not change once it got duplicated
 struct ccnl_buf_s {
-    struct ccnl_buf_s *next;
     unsigned int datalen;
+    unsigned short refs;
+    unsigned char pool; // where it came from, CCNL_POOL_HEAP or a buffer pool
     unsigned char data[1];
 };
 
-struct ccnl_nonce_s {
-    struct ccnl_nonce_s *next, *prev;
-    struct timeval created;
-    struct ccnl_buf_s *buf;
-};
-
 struct ccnl_prefix_s {
     unsigned char **comp;
     int *complen;
     int compcnt;
-    unsigned char *path; // memory for name component copies
+    struct ccnl_buf_s *path; // memory for name component copies
 };
 
+// a prefix as kept in its pool, with room for the maximum number of components
+struct ccnl_prefix_mem_s {
+    struct ccnl_prefix_s prefix;
+    unsigned char *comp[CCNL_MAX_NAME_COMP + 1]; // NULL terminated when parsed
+    int complen[CCNL_MAX_NAME_COMP];
+};
+
+#define CCNL_POOL_INTEREST      0
+#define CCNL_POOL_PENDINT       1
+#define CCNL_POOL_CONTENT       2
+#define CCNL_POOL_FORWARD       3
+#define CCNL_POOL_PREFIX        4
+#define CCNL_POOL_SMALL_BUF     5
+#define CCNL_POOL_LARGE_BUF     6
+#define CCNL_POOL_TRIE_NODE     7
+#define CCNL_POOL_COUNT         8
+#define CCNL_POOL_HEAP          CCNL_POOL_COUNT
+
+struct ccnl_pool_s {
+    const char *name;
+    unsigned char *mem;
+    unsigned int size;      // bytes per object
+    unsigned int cnt;       // objects in the pool
+    unsigned int fresh;     // objects at the end of mem that were never used
+    void *free;             // returned objects, linked through their first word
+    unsigned int used;
+    unsigned int highwater; // most objects used at the same time
+    unsigned int failed;    // allocations that found the pool exhausted, small
+                            // buffers then come from the large buffer pool
+};
+
+extern struct ccnl_pool_s ccnl_pools[CCNL_POOL_COUNT];
+
 struct ccnl_stat_s {
-    int send_interest[CCNL_MAX_INTEREST_RETRANSMIT];
+    int send_interest[CCNL_MAX_INTEREST_RETRANSMIT + 2]; // first send and retries
     int send_content[CCNL_MAX_CONTENT_SERVED_STAT];
     int received_interest;
     int received_content;
@@ -163,7 +229,8 @@ struct ccnl_face_s {
     sockunion peer;
     int flags;
     struct timeval last_used; // updated when we receive a packet
-    struct ccnl_buf_s *outq, *outqend; // queue of packets to send
+    struct ccnl_buf_s *outq[CCNL_MAX_FACE_QLEN]; // queue of packets to send
+    int outqfront, outqlen;
     struct ccnl_frag_s *frag;  // which special datagram armoring
     struct ccnl_sched_s *sched;
 
@@ -172,6 +239,8 @@ struct ccnl_face_s {
 
 struct ccnl_forward_s {
     struct ccnl_forward_s *next, *prev;
+    struct ccnl_forward_s *node_next, *node_prev; // same prefix
+    struct ccnl_trie_node_s *node;
     struct ccnl_prefix_s *prefix;
     struct ccnl_face_s *face;
     int flags;
@@ -180,15 +249,18 @@ struct ccnl_forward_s {
 
 struct ccnl_interest_s {
     struct ccnl_interest_s *next, *prev;
+    struct ccnl_interest_s *node_next, *node_prev; // same name
+    struct ccnl_trie_node_s *node;
     struct ccnl_face_s *from;
     struct ccnl_pendint_s *pending; // linked list of faces wanting that content
     struct ccnl_prefix_s *prefix;
     int minsuffix, maxsuffix;
     struct ccnl_buf_s *ppkd;       // publisher public key digest
     struct ccnl_buf_s *pkt;    // full datagram
-    struct timeval last_used;
+    struct timeval last_used; // updated when we send the interest
     int retries;
     struct ccnl_forward_s *forwarded_over;
+    struct ccnl_interest_s *rtx_next, *rtx_prev; // retransmission queue
 };
 
 struct ccnl_pendint_s { // pending interest
@@ -197,8 +269,15 @@ struct ccnl_pendint_s { // pending interest
     struct timeval last_used;
 };
 
+// a content in the content store is found under every prefix of its name
+struct ccnl_cs_link_s {
+    struct ccnl_cs_link_s *next, **pprev; // bucket chain
+    struct ccnl_content_s *content;
+    uint32_t hash;
+};
+
 struct ccnl_content_s {
-    struct ccnl_content_s *next, *prev;
+    struct ccnl_content_s *next, *prev; // LRU order while cached
     struct ccnl_prefix_s *name;
     struct ccnl_buf_s *ppkd; // publisher public key digest
     struct ccnl_buf_s *pkt; // full datagram
@@ -209,6 +288,8 @@ struct ccnl_content_s {
     // >> CCNL: currently no stale bit, old content is fully removed <<
     struct timeval last_used;
     int served_cnt;
+    struct ccnl_cs_link_s links[CCNL_MAX_NAME_COMP]; // one per name component
+    int size; // bytes accounted to the content store
 };
 
 // ----------------------------------------------------------------------
@@ -226,6 +307,28 @@ struct ccnl_content_s {
        if ((e)->next) (e)->next->prev = (e)->prev; \
   } while(0)
 
+// the same lists in order of last use, most recent first, end points to the
+// least recently used element. With a fixed timeout this is also the order
+// in which the elements expire.
+
+#define MRU_LIST_ADD(l,end,e) \
+  do { (e)->prev = NULL; \
+       DBL_LINKED_LIST_ADD(l,e); \
+       if (!(end)) (end) = (e); \
+  } while(0)
+
+#define MRU_LIST_REMOVE(l,end,e) \
+  do { if ((end) == (e)) (end) = (e)->prev; \
+       DBL_LINKED_LIST_REMOVE(l,e); \
+  } while(0)
+
+#define MRU_LIST_TOUCH(l,end,e) \
+  do { if ((l) != (e)) { \
+           MRU_LIST_REMOVE(l,end,e); \
+           MRU_LIST_ADD(l,end,e); \
+       } \
+  } while(0)
+
 // ----------------------------------------------------------------------
 // collect the USE_* macros in a string
 const char *compile_string(void);
@@ -242,6 +345,11 @@ void ccnl_core_cleanup(struct ccnl_relay_s *ccnl);
 struct ccnl_buf_s *
 ccnl_buf_new(void *data, int len);
 
+struct ccnl_buf_s *buf_dup(struct ccnl_buf_s *B);
+void ccnl_buf_free(struct ccnl_buf_s *b);
+
+struct ccnl_prefix_s *ccnl_prefix_new(void);
+
 struct ccnl_content_s *
 ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
                  struct ccnl_prefix_s **prefix, struct ccnl_buf_s **ppkd,
@@ -250,6 +358,49 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
 struct ccnl_content_s *
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 
+struct ccnl_content_s *
+ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+struct ccnl_content_s *
+ccnl_cs_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+               struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix);
+
+struct ccnl_content_s *
+ccnl_cs_find_dup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name,
+                 struct ccnl_buf_s *pkt);
+
+void ccnl_cs_touch(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+int ccnl_i_prefixof_c(struct ccnl_prefix_s *prefix, struct ccnl_buf_s *ppkd,
+                      int minsuffix, int maxsuffix, struct ccnl_content_s *c);
+
+int buf_equal(struct ccnl_buf_s *X, struct ccnl_buf_s *Y);
+
+#define CCNL_HASH_INIT  2166136261u
+
+uint32_t ccnl_hash_comp(uint32_t h, unsigned char *comp, int len);
+uint32_t ccnl_prefix_hash(struct ccnl_prefix_s *p, int cnt);
+
+struct ccnl_trie_node_s *
+ccnl_trie_child(struct ccnl_relay_s *ccnl, struct ccnl_trie_node_s *node,
+                unsigned char *comp, int complen);
+
+struct ccnl_trie_node_s *
+ccnl_trie_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, int cnt);
+
+int ccnl_trie_add_interest(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+void ccnl_trie_remove_interest(struct ccnl_relay_s *ccnl,
+                               struct ccnl_interest_s *i);
+
+int ccnl_trie_add_forward(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd);
+void ccnl_trie_remove_forward(struct ccnl_relay_s *ccnl,
+                              struct ccnl_forward_s *fwd);
+
+struct ccnl_forward_s *
+ccnl_trie_find_dynamic_forward(struct ccnl_relay_s *ccnl,
+                               struct ccnl_prefix_s *p, int min_match,
+                               int *match_len);
+
 void ccnl_content_learn_name_route(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
                                    struct ccnl_face_s *f, int threshold_prefix, int flags);
 
@@ -271,22 +422,28 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
                                struct ccnl_buf_s **nonce, struct ccnl_buf_s **ppkd,
                                unsigned char **content, int *contlen);
 
-void ccnl_do_retransmit(void *ptr, void *dummy);
+long ccnl_do_retransmit(void *ptr, void *dummy);
 void ccnl_do_ageing(void *ptr, void *dummy);
 void ccnl_do_nonce_timeout(void *ptr, void *dummy);
 
+int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
+                              struct ccnl_buf_s *nonce);
+
+void ccnl_nonce_flush(struct ccnl_relay_s *ccnl);
+
 void ccnl_interface_CTS(void *aux1, void *aux2);
 
 void ccnl_face_print_stat(struct ccnl_face_s *f);
 
+void *ccnl_pool_alloc(int pool);
+void ccnl_pool_free(int pool, void *obj);
+void ccnl_pool_print_stat(void);
+
 #define ccnl_malloc(s)  malloc(s)
 #define ccnl_calloc(n,s)    calloc(n,s)
 #define ccnl_realloc(p,s)   realloc(p,s)
 #define ccnl_free(p)        free(p)
 
-void free_2ptr_list(void *a, void *b);
-void free_3ptr_list(void *a, void *b, void *c);
-void free_4ptr_list(void *a, void *b, void *c, void *d);
 void free_prefix(struct ccnl_prefix_s *p);
 void free_content(struct ccnl_content_s *c);
 
@@ -0,0 +1,227 @@
+/*
+ * @f ccnl-cs.c
+ * @b CCN lite, content store
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Cached contents are kept in ccnl->contents in LRU order, the least
+ * recently used one is ccnl->contentsend. Every content is linked into a
+ * hash table once for each prefix of its name (/a, /a/b, /a/b/c), so an
+ * interest finds its candidates with the hash of its own name. An interest
+ * that ends with the digest of a content is found under the full name of
+ * the content. The size of the store is limited in bytes.
+ */
+
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-platform.h"
+
+static struct ccnl_cs_link_s **
+ccnl_cs_bucket(struct ccnl_relay_s *ccnl, uint32_t h)
+{
+    return &ccnl->cs_buckets[(h ^ (h >> 16)) & (CCNL_CS_HASH_SIZE - 1)];
+}
+
+static int ccnl_cs_linkcnt(struct ccnl_content_s *c)
+{
+    // a content without name is linked once under the empty name
+    return c->name->compcnt ? c->name->compcnt : 1;
+}
+
+static int ccnl_cs_size(struct ccnl_content_s *c)
+{
+    int size = sizeof(*c) + sizeof(struct ccnl_buf_s) + c->pkt->datalen
+               + sizeof(struct ccnl_prefix_mem_s);
+
+    if (c->ppkd) {
+        size += sizeof(struct ccnl_buf_s) + c->ppkd->datalen;
+    }
+
+    return size;
+}
+
+static void ccnl_cs_link(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    int i, cnt = ccnl_cs_linkcnt(c);
+
+    for (i = 0; i < cnt; i++) {
+        struct ccnl_cs_link_s *l = c->links + i;
+        struct ccnl_cs_link_s **b;
+
+        l->content = c;
+        l->hash = ccnl_prefix_hash(c->name, c->name->compcnt ? i + 1 : 0);
+        b = ccnl_cs_bucket(ccnl, l->hash);
+        l->next = *b;
+        l->pprev = b;
+
+        if (*b) {
+            (*b)->pprev = &l->next;
+        }
+
+        *b = l;
+    }
+}
+
+static void ccnl_cs_unlink(struct ccnl_content_s *c)
+{
+    int i;
+
+    // contents that were never cached are not linked
+    if (!c->links[0].pprev) {
+        return;
+    }
+
+    for (i = 0; i < ccnl_cs_linkcnt(c); i++) {
+        struct ccnl_cs_link_s *l = c->links + i;
+        *l->pprev = l->next;
+
+        if (l->next) {
+            l->next->pprev = l->pprev;
+        }
+
+        l->pprev = NULL;
+    }
+}
+
+// ----------------------------------------------------------------------
+
+struct ccnl_content_s *
+ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_content_s *c2;
+    DEBUGMSG(99, "ccnl_content_remove: %s\n", ccnl_prefix_to_path(c->name));
+
+    c2 = c->next;
+    MRU_LIST_REMOVE(ccnl->contents, ccnl->contentsend, c);
+    ccnl_cs_unlink(c);
+    ccnl->contentbytes -= c->size;
+    ccnl->contentcnt--;
+    free_content(c);
+    return c2;
+}
+
+struct ccnl_content_s *
+ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    DEBUGMSG(99, "ccnl_content_add2cache (%d/%d bytes)\n", ccnl->contentbytes,
+             ccnl->max_cache_bytes);
+
+    if (ccnl->max_cache_bytes == 0) {
+        DEBUGMSG(1, "  content store disabled...\n");
+        return NULL;
+    }
+
+    c->size = ccnl_cs_size(c);
+
+    while (ccnl->max_cache_bytes > 0
+           && ccnl->contentbytes + c->size > ccnl->max_cache_bytes) {
+        struct ccnl_content_s *lru = ccnl->contentsend;
+
+        while (lru && (lru->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            lru = lru->prev;
+        }
+
+        if (!lru) {
+            DEBUGMSG(1, "   no dynamic content to remove...\n");
+
+            // static content is kept beyond the limit
+            if (c->flags & CCNL_CONTENT_FLAGS_STATIC) {
+                break;
+            }
+
+            return NULL;
+        }
+
+        DEBUGMSG(1, "   replaced: '%s'\n", ccnl_prefix_to_path(lru->name));
+        ccnl_content_remove(ccnl, lru);
+    }
+
+    ccnl_cs_link(ccnl, c);
+    DEBUGMSG(1, "  add new content to store: '%s'\n", ccnl_prefix_to_path(c->name));
+    MRU_LIST_ADD(ccnl->contents, ccnl->contentsend, c);
+    ccnl->contentbytes += c->size;
+    ccnl->contentcnt++;
+    return c;
+}
+
+void ccnl_cs_touch(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    ccnl_get_timeval(&c->last_used);
+    MRU_LIST_TOUCH(ccnl->contents, ccnl->contentsend, c);
+}
+
+struct ccnl_content_s *
+ccnl_cs_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+               struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix)
+{
+    struct ccnl_content_s *c;
+    struct ccnl_cs_link_s *l;
+    uint32_t h;
+
+    if (prefix->compcnt == 0) {
+        // the empty name is a prefix of every name
+        for (c = ccnl->contents; c; c = c->next) {
+            if (ccnl_i_prefixof_c(prefix, ppkd, minsuffix, maxsuffix, c)) {
+                return c;
+            }
+        }
+
+        return NULL;
+    }
+
+    // contents this name is a prefix of
+    h = ccnl_prefix_hash(prefix, prefix->compcnt);
+
+    for (l = *ccnl_cs_bucket(ccnl, h); l; l = l->next) {
+        if (l->hash == h && l->content->name->compcnt >= prefix->compcnt
+            && ccnl_i_prefixof_c(prefix, ppkd, minsuffix, maxsuffix, l->content)) {
+            return l->content;
+        }
+    }
+
+    // the last component may be the digest of a content
+    h = ccnl_prefix_hash(prefix, prefix->compcnt - 1);
+
+    for (l = *ccnl_cs_bucket(ccnl, h); l; l = l->next) {
+        if (l->hash == h && l->content->name->compcnt == prefix->compcnt - 1
+            && ccnl_i_prefixof_c(prefix, ppkd, minsuffix, maxsuffix, l->content)) {
+            return l->content;
+        }
+    }
+
+    return NULL;
+}
+
+struct ccnl_content_s *
+ccnl_cs_find_dup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name,
+                 struct ccnl_buf_s *pkt)
+{
+    struct ccnl_cs_link_s *l;
+    uint32_t h = ccnl_prefix_hash(name, name->compcnt);
+
+    for (l = *ccnl_cs_bucket(ccnl, h); l; l = l->next) {
+        if (l->hash == h && l->content->name->compcnt == name->compcnt
+            && buf_equal(l->content->pkt, pkt)) {
+            return l->content;
+        }
+    }
+
+    return NULL;
+}
+
+// eof
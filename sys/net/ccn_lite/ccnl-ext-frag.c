@@ -92,7 +92,7 @@ void ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf, int ifndx,
 
     e->ifndx = ifndx;
     memcpy(&e->dest, dst, sizeof(*dst));
-    ccnl_free(e->bigpkt);
+    ccnl_buf_free(e->bigpkt);
     e->bigpkt = buf;
     e->sendoffs = 0;
 }
@@ -217,7 +217,7 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     if (datalen >= e->bigpkt->datalen) { /* fits in a single fragment */
         buf->data[flagoffs + e->flagwidth - 1] =
             CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     }
     else if (e->sendoffs == 0) { /* this is the start fragment */
@@ -225,7 +225,7 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     }
     else if (datalen >= (e->bigpkt->datalen - e->sendoffs)) { /* the end */
         buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     }
     else
@@ -302,7 +302,7 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     /* patch flag field: */
     if (datalen >= fr->bigpkt->datalen) { /* single */
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_SINGLE;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     }
     else if (fr->sendoffs == 0) { /* start */
@@ -310,7 +310,7 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     }
     else if (datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { /* end */
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     }
     else {
@@ -365,8 +365,8 @@ int ccnl_frag_nomorefragments(struct ccnl_frag_s *e)
 void ccnl_frag_destroy(struct ccnl_frag_s *e)
 {
     if (e) {
-        ccnl_free(e->bigpkt);
-        ccnl_free(e->defrag);
+        ccnl_buf_free(e->bigpkt);
+        ccnl_buf_free(e->defrag);
         ccnl_free(e);
     }
 }
@@ -402,7 +402,7 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
         if (e->defrag) {
             DEBUGMSG(17, "  >> seqnum mismatch (%d/%d), dropped defrag buf\n",
                      s->ourseq, e->recvseq);
-            ccnl_free(e->defrag);
+            ccnl_buf_free(e->defrag);
             e->defrag = NULL;
         }
     }
@@ -413,7 +413,7 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
 
             if (e->defrag) {
                 DEBUGMSG(18, "    had to drop defrag buf\n");
-                ccnl_free(e->defrag);
+                ccnl_buf_free(e->defrag);
                 e->defrag = NULL;
             }
 
@@ -426,7 +426,7 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
 
             if (e->defrag) {
                 DEBUGMSG(18, "    had to drop defrag buf\n");
-                ccnl_free(e->defrag);
+                ccnl_buf_free(e->defrag);
             }
 
             e->defrag = ccnl_buf_new(s->content, s->contlen);
@@ -446,7 +446,7 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
                 memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
             }
 
-            ccnl_free(e->defrag);
+            ccnl_buf_free(e->defrag);
             e->defrag = NULL;
             break;
 
@@ -463,12 +463,12 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
             if (buf) {
                 memcpy(buf->data, e->defrag->data, e->defrag->datalen);
                 memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
-                ccnl_free(e->defrag);
+                ccnl_buf_free(e->defrag);
                 e->defrag = buf;
                 buf = NULL;
             }
             else {
-                ccnl_free(e->defrag);
+                ccnl_buf_free(e->defrag);
                 e->defrag = NULL;
             }
 
@@ -485,7 +485,7 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
         int fraglen = buf->datalen;
         DEBUGMSG(1, "  >> reassembled fragment is %d bytes\n", buf->datalen);
         callback(relay, from, &frag, &fraglen);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
     }
 
     DEBUGMSG(1, "leaving function\n");
@@ -57,7 +57,7 @@ ccnl_prefix_clone_strip(struct ccnl_prefix_s *p, int strip)
     int i, len;
     struct ccnl_prefix_s *p2;
 
-    p2 = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    p2 = ccnl_prefix_new();
 
     if (!p2) {
         return NULL;
@@ -68,11 +68,9 @@ ccnl_prefix_clone_strip(struct ccnl_prefix_s *p, int strip)
 
     for (i = 0, len = 0; i < stripped_compcnt; len += p->complen[i++]);
 
-    p2->path = (unsigned char *) ccnl_malloc(len);
-    p2->comp = (unsigned char **) ccnl_malloc(stripped_compcnt * sizeof(char *));
-    p2->complen = (int *) ccnl_malloc(stripped_compcnt * sizeof(int));
+    p2->path = ccnl_buf_new(NULL, len);
 
-    if (!p2->comp || !p2->complen || !p2->path) {
+    if (!p2->path) {
         goto Bail;
     }
 
@@ -80,7 +78,7 @@ ccnl_prefix_clone_strip(struct ccnl_prefix_s *p, int strip)
 
     for (i = 0, len = 0; i < stripped_compcnt; len += p2->complen[i++]) {
         p2->complen[i] = p->complen[i];
-        p2->comp[i] = p2->path + len;
+        p2->comp[i] = p2->path->data + len;
         memcpy(p2->comp[i], p->comp[i], p2->complen[i]);
     }
 
@@ -410,20 +408,12 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         goto Bail;
     }
 
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    p = ccnl_prefix_new();
 
     if (!p) {
         goto Bail;
     }
 
-    p->comp = (unsigned char **) ccnl_malloc(CCNL_MAX_NAME_COMP *
-              sizeof(unsigned char *));
-    p->complen = (int *) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(int));
-
-    if (!p->comp || !p->complen) {
-        goto Bail;
-    }
-
     while (dehead(&buf, &buflen, &num, &typ) == 0) {
         if (num == 0 && typ == 0) {
             break;    // end
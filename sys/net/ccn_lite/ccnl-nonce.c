@@ -0,0 +1,177 @@
+/*
+ * @f ccnl-nonce.c
+ * @b CCN lite, detection of duplicate interests by their nonce
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Seen nonces are kept in a ring in order of arrival, so the oldest one is
+ * dropped first, both when the ring is full and when nonces time out. The
+ * ring positions are indexed by an open addressing hash table with linear
+ * probing that is at most half full. Nothing is allocated per nonce.
+ */
+
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-platform.h"
+
+#define NONCE_TIMEOUT_US    TIMEOUT_TO_US(CCNL_NONCE_TIMEOUT_SEC, \
+                                          CCNL_NONCE_TIMEOUT_USEC)
+
+static uint32_t ccnl_nonce_hash(unsigned char *data, unsigned int len)
+{
+    // nonces are random, folding their bytes is good enough
+    uint32_t h = len;
+
+    while (len--) {
+        h = ((h << 8) | (h >> 24)) ^ *data++;
+    }
+
+    return h ^ (h >> 16);
+}
+
+static int ccnl_nonce_equal(struct ccnl_nonce_s *n, uint32_t h,
+                            struct ccnl_buf_s *nonce)
+{
+    unsigned int len = nonce->datalen;
+
+    if (n->hash != h || n->len != len) {
+        return 0;
+    }
+
+    if (len > CCNL_MAX_NONCE_LEN) {
+        len = CCNL_MAX_NONCE_LEN;
+    }
+
+    return !memcmp(n->data, nonce->data, len);
+}
+
+// slot of the index that holds ring position pos
+static int ccnl_nonce_slot(struct ccnl_nonce_table_s *t, int pos)
+{
+    int k = t->ring[pos].hash & (CCNL_NONCE_HASH_SIZE - 1);
+
+    while (t->index[k] != pos + 1) {
+        k = (k + 1) & (CCNL_NONCE_HASH_SIZE - 1);
+    }
+
+    return k;
+}
+
+static void ccnl_nonce_remove_oldest(struct ccnl_nonce_table_s *t)
+{
+    int k = ccnl_nonce_slot(t, t->first), j = k;
+
+    DEBUGMSG(99, "ccnl_nonce_remove_oldest: %u\n", t->ring[t->first].hash);
+
+    // move up later entries of the probe sequence, so no tombstones are needed
+    while (1) {
+        int home;
+
+        j = (j + 1) & (CCNL_NONCE_HASH_SIZE - 1);
+
+        if (!t->index[j]) {
+            break;
+        }
+
+        home = t->ring[t->index[j] - 1].hash & (CCNL_NONCE_HASH_SIZE - 1);
+
+        // entries whose home is cyclically in (k, j] stay where they are
+        if ((k <= j) ? (k < home && home <= j) : (k < home || home <= j)) {
+            continue;
+        }
+
+        t->index[k] = t->index[j];
+        k = j;
+    }
+
+    t->index[k] = 0;
+
+    if (++t->first == CCNL_MAX_NONCES) {
+        t->first = 0;
+    }
+
+    t->cnt--;
+}
+
+int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
+                              struct ccnl_buf_s *nonce)
+{
+    struct ccnl_nonce_table_s *t = &ccnl->nonces;
+    uint32_t h = ccnl_nonce_hash(nonce->data, nonce->datalen);
+    struct ccnl_nonce_s *n;
+    int k, pos;
+    DEBUGMSG(99, "ccnl_nonce_find_or_append: %u\n", h);
+
+    for (k = h & (CCNL_NONCE_HASH_SIZE - 1); t->index[k];
+         k = (k + 1) & (CCNL_NONCE_HASH_SIZE - 1)) {
+        if (ccnl_nonce_equal(t->ring + t->index[k] - 1, h, nonce)) {
+            // nonce in cache -> known
+            return -1;
+        }
+    }
+
+    if (t->cnt == CCNL_MAX_NONCES) {
+        // cache is full, drop oldest nonce, its slot may be on our probe path
+        ccnl_nonce_remove_oldest(t);
+
+        for (k = h & (CCNL_NONCE_HASH_SIZE - 1); t->index[k];
+             k = (k + 1) & (CCNL_NONCE_HASH_SIZE - 1));
+    }
+
+    pos = t->first + t->cnt;
+
+    if (pos >= CCNL_MAX_NONCES) {
+        pos -= CCNL_MAX_NONCES;
+    }
+
+    n = t->ring + pos;
+    ccnl_get_timeval(&n->created);
+    n->hash = h;
+    n->len = nonce->datalen;
+    memcpy(n->data, nonce->data, n->len < CCNL_MAX_NONCE_LEN ?
+           n->len : CCNL_MAX_NONCE_LEN);
+
+    t->index[k] = pos + 1;
+    t->cnt++;
+    return 0;
+}
+
+void ccnl_nonce_flush(struct ccnl_relay_s *ccnl)
+{
+    memset(&ccnl->nonces.index, 0, sizeof(ccnl->nonces.index));
+    ccnl->nonces.first = 0;
+    ccnl->nonces.cnt = 0;
+}
+
+void ccnl_do_nonce_timeout(void *ptr, void *dummy)
+{
+    (void) dummy; /* unused */
+
+    struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
+    struct ccnl_nonce_table_s *t = &relay->nonces;
+
+    struct timeval now;
+    ccnl_get_timeval(&now);
+
+    // the oldest nonces come first, stop at the first one still valid
+    while (t->cnt
+           && timevaldelta(&now, &t->ring[t->first].created) > NONCE_TIMEOUT_US) {
+        ccnl_nonce_remove_oldest(t);
+    }
+}
+
+// eof
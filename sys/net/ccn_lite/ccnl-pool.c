@@ -0,0 +1,131 @@
+/*
+ * @f ccnl-pool.c
+ * @b CCN lite, fixed size pools for the objects of the relay
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Interests, pending interests, contents, forwarding entries, prefixes,
+ * buffers and the nodes of the name index are taken from static arrays of
+ * equally sized objects, so running the relay for a long time does not
+ * fragment the heap. Objects that were never used are handed out from the
+ * end of the array, returned ones are kept in a free list. Clients use the
+ * pools from their own threads, the few instructions of an allocation run
+ * with interrupts disabled.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "irq.h"
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+
+#define CCNL_BUF_MEM(SIZE) union { \
+        struct ccnl_buf_s buf; \
+        unsigned char mem[sizeof(struct ccnl_buf_s) + (SIZE)]; \
+    }
+
+static struct ccnl_interest_s interest_mem[CCNL_POOL_INTERESTS];
+static struct ccnl_pendint_s pendint_mem[CCNL_POOL_PENDINTS];
+static struct ccnl_content_s content_mem[CCNL_POOL_CONTENTS];
+static struct ccnl_forward_s forward_mem[CCNL_POOL_FORWARDS];
+static struct ccnl_prefix_mem_s prefix_mem[CCNL_POOL_PREFIXES];
+static CCNL_BUF_MEM(CCNL_BUF_SMALL_SIZE) small_buf_mem[CCNL_POOL_SMALL_BUFS];
+static CCNL_BUF_MEM(CCNL_BUF_LARGE_SIZE) large_buf_mem[CCNL_POOL_LARGE_BUFS];
+static struct ccnl_trie_node_s trie_node_mem[CCNL_POOL_TRIE_NODES];
+
+#define CCNL_POOL(NAME, MEM) { \
+        NAME, (unsigned char *) MEM, sizeof(MEM[0]), \
+        sizeof(MEM) / sizeof(MEM[0]), sizeof(MEM) / sizeof(MEM[0]), \
+        NULL, 0, 0, 0 \
+    }
+
+struct ccnl_pool_s ccnl_pools[CCNL_POOL_COUNT] = {
+    CCNL_POOL("interest", interest_mem),
+    CCNL_POOL("pendint", pendint_mem),
+    CCNL_POOL("content", content_mem),
+    CCNL_POOL("forward", forward_mem),
+    CCNL_POOL("prefix", prefix_mem),
+    CCNL_POOL("smallbuf", small_buf_mem),
+    CCNL_POOL("largebuf", large_buf_mem),
+    CCNL_POOL("trienode", trie_node_mem),
+};
+
+// returns a zeroed object, NULL if the pool is exhausted
+void *ccnl_pool_alloc(int pool)
+{
+    struct ccnl_pool_s *p = ccnl_pools + pool;
+    void *obj = NULL;
+    unsigned state = disableIRQ();
+
+    if (p->free) {
+        obj = p->free;
+        p->free = *(void **) obj;
+    }
+    else if (p->fresh) {
+        obj = p->mem + (p->cnt - p->fresh--) * p->size;
+    }
+
+    if (obj) {
+        if (++p->used > p->highwater) {
+            p->highwater = p->used;
+        }
+    }
+    else {
+        p->failed++;
+    }
+
+    restoreIRQ(state);
+
+    if (obj) {
+        memset(obj, 0, p->size);
+    }
+    else {
+        DEBUGMSG(1, "ccnl_pool_alloc: %s pool exhausted\n", p->name);
+    }
+
+    return obj;
+}
+
+void ccnl_pool_free(int pool, void *obj)
+{
+    struct ccnl_pool_s *p = ccnl_pools + pool;
+    unsigned state;
+
+    if (!obj) {
+        return;
+    }
+
+    state = disableIRQ();
+    *(void **) obj = p->free;
+    p->free = obj;
+    p->used--;
+    restoreIRQ(state);
+}
+
+void ccnl_pool_print_stat(void)
+{
+    int k;
+
+    for (k = 0; k < CCNL_POOL_COUNT; k++) {
+        struct ccnl_pool_s *p = ccnl_pools + k;
+
+        printf("  POOL %-8s size=%u used=%u/%u highwater=%u failed=%u\n",
+               p->name, p->size, p->used, p->cnt, p->highwater, p->failed);
+    }
+}
+
+// eof
@@ -0,0 +1,343 @@
+/*
+ * @f ccnl-trie.c
+ * @b CCN lite, name index of the PIT and FIB
+ *
+ * Copyright (C) 2014, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Interests and forwarding entries hang off the trie node of their name.
+ * The node for a name is reached one component at a time, every step is a
+ * lookup in a hash table over the parent's name and the component, so
+ * finding all entries on the path of a name costs one step per component.
+ * Nodes exist as long as entries or children hang off them, the root
+ * (the empty name) is part of the relay. They come from a pool and keep
+ * their component, one longer than CCNL_TRIE_COMP_SIZE bytes in a buffer,
+ * so names that collide in the hash are still told apart.
+ */
+
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+
+static struct ccnl_trie_node_s **
+ccnl_trie_bucket(struct ccnl_relay_s *ccnl, uint32_t h)
+{
+    return &ccnl->trie_buckets[(h ^ (h >> 16)) & (CCNL_TRIE_HASH_SIZE - 1)];
+}
+
+static unsigned char *
+ccnl_trie_comp(struct ccnl_trie_node_s *n)
+{
+    return n->longcomp ? n->longcomp->data : n->comp;
+}
+
+struct ccnl_trie_node_s *
+ccnl_trie_child(struct ccnl_relay_s *ccnl, struct ccnl_trie_node_s *node,
+                unsigned char *comp, int complen)
+{
+    uint32_t h = ccnl_hash_comp(node->hash, comp, complen);
+    struct ccnl_trie_node_s *n;
+
+    for (n = *ccnl_trie_bucket(ccnl, h); n; n = n->next) {
+        if (n->hash == h && n->parent == node && n->complen == complen
+            && !memcmp(ccnl_trie_comp(n), comp, complen)) {
+            return n;
+        }
+    }
+
+    return NULL;
+}
+
+static struct ccnl_trie_node_s *
+ccnl_trie_child_create(struct ccnl_relay_s *ccnl, struct ccnl_trie_node_s *node,
+                       unsigned char *comp, int complen)
+{
+    struct ccnl_trie_node_s *n = ccnl_trie_child(ccnl, node, comp, complen);
+    struct ccnl_trie_node_s **b;
+
+    if (n) {
+        return n;
+    }
+
+    n = (struct ccnl_trie_node_s *) ccnl_pool_alloc(CCNL_POOL_TRIE_NODE);
+
+    if (!n) {
+        return NULL;
+    }
+
+    if (complen > CCNL_TRIE_COMP_SIZE) {
+        n->longcomp = ccnl_buf_new(comp, complen);
+
+        if (!n->longcomp) {
+            ccnl_pool_free(CCNL_POOL_TRIE_NODE, n);
+            return NULL;
+        }
+    }
+    else {
+        memcpy(n->comp, comp, complen);
+    }
+
+    n->parent = node;
+    n->depth = node->depth + 1;
+    n->hash = ccnl_hash_comp(node->hash, comp, complen);
+    n->complen = complen;
+
+    b = ccnl_trie_bucket(ccnl, n->hash);
+    n->next = *b;
+    n->pprev = b;
+
+    if (*b) {
+        (*b)->pprev = &n->next;
+    }
+
+    *b = n;
+
+    n->sibling = node->child;
+    n->psibling = &node->child;
+
+    if (node->child) {
+        node->child->psibling = &n->sibling;
+    }
+
+    node->child = n;
+    node->refs++;
+
+    return n;
+}
+
+// drops a reference, frees nodes that are no longer needed
+static void ccnl_trie_put(struct ccnl_relay_s *ccnl, struct ccnl_trie_node_s *n)
+{
+    while (--n->refs == 0 && n != &ccnl->trie) {
+        struct ccnl_trie_node_s *parent = n->parent;
+
+        *n->pprev = n->next;
+
+        if (n->next) {
+            n->next->pprev = n->pprev;
+        }
+
+        *n->psibling = n->sibling;
+
+        if (n->sibling) {
+            n->sibling->psibling = n->psibling;
+        }
+
+        ccnl_buf_free(n->longcomp);
+        ccnl_pool_free(CCNL_POOL_TRIE_NODE, n);
+        n = parent;
+    }
+}
+
+// the node of the first cnt components of p, created if missing
+static struct ccnl_trie_node_s *
+ccnl_trie_get(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, int cnt)
+{
+    struct ccnl_trie_node_s *n = &ccnl->trie;
+    int k;
+
+    for (k = 0; k < cnt; k++) {
+        struct ccnl_trie_node_s *child = ccnl_trie_child_create(ccnl, n,
+                                         p->comp[k], p->complen[k]);
+
+        if (!child) {
+            // undo what was created on the way
+            n->refs++;
+            ccnl_trie_put(ccnl, n);
+            return NULL;
+        }
+
+        n = child;
+    }
+
+    return n;
+}
+
+struct ccnl_trie_node_s *
+ccnl_trie_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, int cnt)
+{
+    struct ccnl_trie_node_s *n = &ccnl->trie;
+    int k;
+
+    for (k = 0; n && k < cnt; k++) {
+        n = ccnl_trie_child(ccnl, n, p->comp[k], p->complen[k]);
+    }
+
+    return n;
+}
+
+// ----------------------------------------------------------------------
+
+int ccnl_trie_add_interest(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    struct ccnl_trie_node_s *n = ccnl_trie_get(ccnl, i->prefix,
+                                               i->prefix->compcnt);
+
+    if (!n) {
+        return -1;
+    }
+
+    i->node = n;
+    i->node_prev = NULL;
+    i->node_next = n->pit;
+
+    if (n->pit) {
+        n->pit->node_prev = i;
+    }
+
+    n->pit = i;
+    n->refs++;
+    return 0;
+}
+
+void ccnl_trie_remove_interest(struct ccnl_relay_s *ccnl,
+                               struct ccnl_interest_s *i)
+{
+    struct ccnl_trie_node_s *n = i->node;
+
+    if (!n) {
+        return;
+    }
+
+    if (i->node_prev) {
+        i->node_prev->node_next = i->node_next;
+    }
+    else {
+        n->pit = i->node_next;
+    }
+
+    if (i->node_next) {
+        i->node_next->node_prev = i->node_prev;
+    }
+
+    i->node = NULL;
+    ccnl_trie_put(ccnl, n);
+}
+
+int ccnl_trie_add_forward(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
+{
+    struct ccnl_trie_node_s *n = ccnl_trie_get(ccnl, fwd->prefix,
+                                               fwd->prefix->compcnt);
+
+    if (!n) {
+        return -1;
+    }
+
+    fwd->node = n;
+    fwd->node_prev = NULL;
+    fwd->node_next = n->fib;
+
+    if (n->fib) {
+        n->fib->node_prev = fwd;
+    }
+
+    n->fib = fwd;
+    n->refs++;
+
+    if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)) {
+        for (; n; n = n->parent) {
+            n->dynfwd++;
+        }
+    }
+
+    return 0;
+}
+
+void ccnl_trie_remove_forward(struct ccnl_relay_s *ccnl,
+                              struct ccnl_forward_s *fwd)
+{
+    struct ccnl_trie_node_s *n = fwd->node, *up;
+
+    if (!n) {
+        return;
+    }
+
+    if (fwd->node_prev) {
+        fwd->node_prev->node_next = fwd->node_next;
+    }
+    else {
+        n->fib = fwd->node_next;
+    }
+
+    if (fwd->node_next) {
+        fwd->node_next->node_prev = fwd->node_prev;
+    }
+
+    if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)) {
+        for (up = n; up; up = up->parent) {
+            up->dynfwd--;
+        }
+    }
+
+    fwd->node = NULL;
+    ccnl_trie_put(ccnl, n);
+}
+
+/**
+ * returns a non-static entry of the fib that has at least min_match
+ * components in common with p, preferring the longest common prefix.
+ */
+struct ccnl_forward_s *
+ccnl_trie_find_dynamic_forward(struct ccnl_relay_s *ccnl,
+                               struct ccnl_prefix_s *p, int min_match,
+                               int *match_len)
+{
+    struct ccnl_trie_node_s *n, *child;
+    struct ccnl_forward_s *fwd;
+    int k = 0;
+
+    if (min_match > p->compcnt) {
+        return NULL;
+    }
+
+    n = ccnl_trie_lookup(ccnl, p, min_match > 0 ? min_match : 0);
+
+    if (!n || !n->dynfwd) {
+        return NULL;
+    }
+
+    // follow p as long as dynamic entries are below
+    for (k = n->depth; k < p->compcnt; k++) {
+        child = ccnl_trie_child(ccnl, n, p->comp[k], p->complen[k]);
+
+        if (!child || !child->dynfwd) {
+            break;
+        }
+
+        n = child;
+    }
+
+    *match_len = k;
+
+    // any entry of the subtree has k components in common with p
+    while (1) {
+        for (fwd = n->fib; fwd; fwd = fwd->node_next) {
+            if (!(fwd->flags & CCNL_FORWARD_FLAGS_STATIC)) {
+                return fwd;
+            }
+        }
+
+        for (child = n->child; child && !child->dynfwd; child = child->sibling);
+
+        if (!child) {
+            // dynfwd out of sync, cannot happen
+            return NULL;
+        }
+
+        n = child;
+    }
+}
+
+// eof
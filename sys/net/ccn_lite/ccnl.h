@@ -51,8 +51,127 @@
 
 #define CCNL_MAX_NAME_COMP              16
 #define CCNL_MAX_IF_QLEN                64
+#define CCNL_MAX_FACE_QLEN              8
 
-#define CCNL_MAX_NONCES                 256 // for detected dups
+#ifndef CCNL_MAX_NONCES
+// nonces kept for detecting dups, must be a power of two
+#  ifdef CPU_NATIVE
+#    define CCNL_MAX_NONCES             256
+#  else
+#    define CCNL_MAX_NONCES             64
+#  endif
+#endif
+
+#ifndef CCNL_MAX_NONCE_LEN
+// bytes of a nonce that are kept, longer nonces are compared by their hash
+#  define CCNL_MAX_NONCE_LEN            8
+#endif
+
+// slots of the nonce index, keeps it at most half full
+#define CCNL_NONCE_HASH_SIZE            (2 * (CCNL_MAX_NONCES))
+
+#ifndef CCNL_CS_HASH_SIZE
+// buckets of the content store index, must be a power of two
+#  ifdef CPU_NATIVE
+#    define CCNL_CS_HASH_SIZE           256
+#  else
+#    define CCNL_CS_HASH_SIZE           32
+#  endif
+#endif
+
+#ifndef CCNL_TRIE_HASH_SIZE
+// buckets of the pit and fib name index, must be a power of two
+#  ifdef CPU_NATIVE
+#    define CCNL_TRIE_HASH_SIZE         256
+#  else
+#    define CCNL_TRIE_HASH_SIZE         32
+#  endif
+#endif
+
+#ifndef CCNL_TRIE_COMP_SIZE
+// bytes of a name component kept in a node of the pit and fib index,
+// longer components are copied to a buffer
+#  ifdef CPU_NATIVE
+#    define CCNL_TRIE_COMP_SIZE         32
+#  else
+#    define CCNL_TRIE_COMP_SIZE         16
+#  endif
+#endif
+
+// objects of the relay come from fixed size pools, allocations fail when
+// a pool is exhausted, every pool needs at least one object
+
+#ifndef CCNL_POOL_INTERESTS
+#  ifdef CPU_NATIVE
+#    define CCNL_POOL_INTERESTS         256
+#  else
+#    define CCNL_POOL_INTERESTS         16
+#  endif
+#endif
+
+#ifndef CCNL_POOL_PENDINTS
+// faces waiting for the content of an interest
+#  ifdef CPU_NATIVE
+#    define CCNL_POOL_PENDINTS          512
+#  else
+#    define CCNL_POOL_PENDINTS          32
+#  endif
+#endif
+
+#ifndef CCNL_POOL_CONTENTS
+// cached contents, plus the one being served
+#  ifdef CPU_NATIVE
+#    define CCNL_POOL_CONTENTS          512
+#  else
+#    define CCNL_POOL_CONTENTS          8
+#  endif
+#endif
+
+#ifndef CCNL_POOL_FORWARDS
+#  ifdef CPU_NATIVE
+#    define CCNL_POOL_FORWARDS          64
+#  else
+#    define CCNL_POOL_FORWARDS          16
+#  endif
+#endif
+
+#ifndef CCNL_POOL_PREFIXES
+// one per interest, content and forwarding entry, plus the one being parsed
+#  define CCNL_POOL_PREFIXES            ((CCNL_POOL_INTERESTS) + (CCNL_POOL_CONTENTS) \
+                                         + (CCNL_POOL_FORWARDS) + 4)
+#endif
+
+#ifndef CCNL_POOL_TRIE_NODES
+// nodes of the pit and fib index, names with a common prefix share them.
+// An entry needs a node for every component it does not share with another
+// one, up to CCNL_MAX_NAME_COMP. Two per entry are assumed, when the pool
+// is exhausted interests are dropped and forwarding entries refused
+#  define CCNL_POOL_TRIE_NODES          (2 * ((CCNL_POOL_INTERESTS) + (CCNL_POOL_FORWARDS)))
+#endif
+
+// buffers come in two sizes, larger ones are taken from the heap
+#ifndef CCNL_BUF_SMALL_SIZE
+// nonces, publisher digests and names of forwarding entries
+#  define CCNL_BUF_SMALL_SIZE           32
+#endif
+
+#ifndef CCNL_POOL_SMALL_BUFS
+#  define CCNL_POOL_SMALL_BUFS          ((CCNL_POOL_FORWARDS) + 16)
+#endif
+
+#ifndef CCNL_BUF_LARGE_SIZE
+// packets
+#  ifdef CPU_NATIVE
+#    define CCNL_BUF_LARGE_SIZE         256
+#  else
+#    define CCNL_BUF_LARGE_SIZE         128
+#  endif
+#endif
+
+#ifndef CCNL_POOL_LARGE_BUFS
+// interests and contents keep their packet, a few more are being sent
+#  define CCNL_POOL_LARGE_BUFS          ((CCNL_POOL_INTERESTS) + (CCNL_POOL_CONTENTS) + 8)
+#endif
 
 #define TIMEOUT_TO_US(SEC, USEC) ((SEC)*1000*1000 + (USEC))
 
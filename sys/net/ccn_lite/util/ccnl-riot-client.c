@@ -104,7 +104,9 @@ int ccnl_riot_client_get(kernel_pid_t relay_pid, char *name, char *reply_buf)
         content_len += contlen;
 
         free_prefix(p);
-        free_3ptr_list(buf, nonce, ppkd);
+        ccnl_buf_free(buf);
+        ccnl_buf_free(nonce);
+        ccnl_buf_free(ppkd);
         ccnl_free(rmsg_reply);
 
         DEBUGMSG(1, "contentlen=%d CCNL_RIOT_CHUNK_SIZE=%d\n", contlen, CCNL_RIOT_CHUNK_SIZE);
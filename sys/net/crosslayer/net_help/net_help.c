@@ -13,6 +13,7 @@
  * @author  Oliver Gesch <oliver.gesch@googlemail.com>
  */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "thread.h"
@@ -31,35 +32,110 @@ void printArrayRange(uint8_t *array, uint16_t len, char *str)
     printf("\n-----------%u-------------\n", len);
 }
 
-uint16_t csum(uint16_t sum, uint8_t *buf, uint16_t len)
+/* folds a 32 bit one's complement sum into 16 bit */
+static inline uint16_t csum_fold(uint32_t acc)
+{
+    acc = (acc & 0xffff) + (acc >> 16);
+    acc = (acc & 0xffff) + (acc >> 16);
+    return acc;
+}
+
+/*
+ * One's complement sum of buf read as 16 bit words in host byte order,
+ * buf must be 16 bit aligned. The halves of every 32 bit word are added
+ * separately so the accumulator can not overflow for len < 64 KiB.
+ */
+static uint32_t csum_words(const uint8_t *buf, uint16_t len)
 {
-    int count = len >> 1;
+    uint32_t acc = 0;
+    const uint32_t *words;
+
+    if ((((uintptr_t) buf) & 2) && (len >= 2)) {
+        acc += *((const uint16_t *) buf);
+        buf += 2;
+        len -= 2;
+    }
 
-    if (count) {
-        uint16_t carry = 0;
+    words = (const uint32_t *) buf;
 
-        do {
-            uint16_t t = (*buf << 8) + *(buf + 1);
-            count--;
-            buf += 2;
-            sum += carry;
-            sum += t;
-            carry = (t > sum);
-        } while (count);
+    while (len >= 16) {
+        uint32_t w0 = words[0];
+        uint32_t w1 = words[1];
+        uint32_t w2 = words[2];
+        uint32_t w3 = words[3];
 
-        sum += carry;
+        acc += (w0 & 0xffff) + (w0 >> 16);
+        acc += (w1 & 0xffff) + (w1 >> 16);
+        acc += (w2 & 0xffff) + (w2 >> 16);
+        acc += (w3 & 0xffff) + (w3 >> 16);
+        words += 4;
+        len -= 16;
     }
 
-    if (len & 1) {
-        uint16_t u = (*buf << 8);
-        sum += (*buf << 8);
+    while (len >= 4) {
+        acc += (*words & 0xffff) + (*words >> 16);
+        words++;
+        len -= 4;
+    }
+
+    buf = (const uint8_t *) words;
+
+    if (len >= 2) {
+        acc += *((const uint16_t *) buf);
+        buf += 2;
+        len -= 2;
+    }
 
-        if (sum < u) {
-            sum++;
-        }
+    if (len) {
+        /* pad the trailing byte with zero */
+        union {
+            uint16_t u16;
+            uint8_t u8[2];
+        } last = { .u8 = { *buf, 0 } };
+        acc += last.u16;
     }
 
-    return sum;
+    return acc;
+}
+
+uint16_t csum(uint16_t sum, uint8_t *buf, uint16_t len)
+{
+    uint32_t acc;
+
+    if ((((uintptr_t) buf) & 1) && len) {
+        /* sum from the next even address: this pairs the bytes shifted by
+         * one, which yields the byte swapped sum (RFC 1071, 2.(B)) */
+        union {
+            uint16_t u16;
+            uint8_t u8[2];
+        } first = { .u8 = { *buf, 0 } };
+        acc = byteorder_swaps(csum_fold(csum_words(buf + 1, len - 1)));
+        acc += first.u16;
+    }
+    else {
+        acc = csum_words(buf, len);
+    }
+
+    acc = NTOHS(csum_fold(acc)) + sum;
+
+    return csum_fold(acc);
+}
+
+uint16_t csum_replace16(uint16_t check, uint16_t old_val, uint16_t new_val)
+{
+    /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+    uint32_t acc = (uint16_t) ~check;
+
+    acc += (uint16_t) ~old_val;
+    acc += new_val;
+
+    return ~csum_fold(acc);
+}
+
+uint16_t csum_replace32(uint16_t check, uint32_t old_val, uint32_t new_val)
+{
+    check = csum_replace16(check, old_val >> 16, new_val >> 16);
+    return csum_replace16(check, old_val & 0xffff, new_val & 0xffff);
 }
 
 /**
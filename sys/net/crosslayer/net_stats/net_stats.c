@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_stats
+ * @{
+ *
+ * @file        net_stats.c
+ * @brief       Recording of the network statistics
+ *
+ * @}
+ */
+
+#include <string.h>
+
+#include "hwtimer.h"
+#include "irq.h"
+
+#include "net_stats.h"
+
+net_stats_t net_stats[NET_STATS_LAYER_NUMOF];
+
+void net_stats_latency(net_stats_layer_t layer, unsigned long start)
+{
+    uint32_t us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+    uint32_t v = us;
+    unsigned bucket = 0;
+
+    /* floor(log2(us)), saturating at the last bucket */
+    while ((v >>= 1) && (bucket < (NET_STATS_HIST_BUCKETS - 1))) {
+        bucket++;
+    }
+
+    net_stats[layer].latency_hist[bucket]++;
+
+    if (us > net_stats[layer].latency_max) {
+        net_stats[layer].latency_max = us;
+    }
+}
+
+void net_stats_reset(void)
+{
+    unsigned state = disableIRQ();
+    memset(net_stats, 0, sizeof(net_stats));
+    restoreIRQ(state);
+}
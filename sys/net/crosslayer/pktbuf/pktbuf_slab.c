@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file    pktbuf_slab.c
+ * @brief   Slab allocator implementation of the packet buffer
+ *
+ * The buffer is split into the slot arrays of the size classes given by
+ * PKTBUF_SLAB_CLASSES. Every class keeps a list of its free slots. The
+ * bookkeeping of a slot lives outside the buffer, so packets start word
+ * aligned and a pointer into a packet is mapped to its slot by arithmetic.
+ * All operations besides copying data take constant time and run with
+ * interrupts disabled instead of under a mutex.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "irq.h"
+#include "pktbuf.h"
+
+#define SLOT_NONE   (UINT8_MAX)
+
+#define PKTBUF_SLAB_CLASS(size, num)    + ((size) * (num))
+enum { SLAB_BYTES = 0 PKTBUF_SLAB_CLASSES };
+#undef PKTBUF_SLAB_CLASS
+
+#define PKTBUF_SLAB_CLASS(size, num)    + (num)
+enum { SLAB_SLOTS = 0 PKTBUF_SLAB_CLASSES };
+#undef PKTBUF_SLAB_CLASS
+
+#define PKTBUF_SLAB_CLASS(size, num)    + 1
+enum { SLAB_CLASSES = 0 PKTBUF_SLAB_CLASSES };
+#undef PKTBUF_SLAB_CLASS
+
+/* the preprocessor can not evaluate the enums above, so a configuration that
+ * exceeds PKTBUF_SIZE or has too many slots fails with a negative array size */
+typedef char _slab_classes_fit[((SLAB_BYTES <= PKTBUF_SIZE) &&
+                                (SLAB_SLOTS < SLOT_NONE)) ? 1 : -1];
+
+typedef struct {
+    uint16_t size;      /**< slot size */
+    uint8_t num;        /**< number of slots */
+} _slab_cfg_t;
+
+typedef struct {
+    uint16_t offset;    /**< index of the first slot in _pktbuf */
+    uint8_t first;      /**< number of the first slot */
+    uint8_t free;       /**< first free slot, SLOT_NONE if the class is full */
+} _slab_class_t;
+
+#define PKTBUF_SLAB_CLASS(size, num)    { (size), (num) },
+static const _slab_cfg_t _cfg[SLAB_CLASSES] = { PKTBUF_SLAB_CLASSES };
+#undef PKTBUF_SLAB_CLASS
+
+static uint8_t _pktbuf[SLAB_BYTES] __attribute__((aligned(4)));
+static _slab_class_t _classes[SLAB_CLASSES];
+static uint16_t _slot_size[SLAB_SLOTS];     /* requested size, 0 if free */
+static uint8_t _slot_processing[SLAB_SLOTS];
+static uint8_t _slot_next[SLAB_SLOTS];      /* free list link */
+static uint8_t _slot_class[SLAB_SLOTS];
+static uint8_t _initialized;
+
+static void _slab_init(void)
+{
+    uint16_t offset = 0;
+    uint8_t slot = 0;
+
+    for (unsigned c = 0; c < SLAB_CLASSES; c++) {
+        _classes[c].offset = offset;
+        _classes[c].first = slot;
+        _classes[c].free = (_cfg[c].num > 0) ? slot : SLOT_NONE;
+
+        for (unsigned i = 0; i < _cfg[c].num; i++, slot++) {
+            /* ascending, so consecutive allocations get ascending addresses */
+            _slot_next[slot] = (i + 1 < _cfg[c].num) ? slot + 1 : SLOT_NONE;
+            _slot_class[slot] = c;
+            _slot_size[slot] = 0;
+            _slot_processing[slot] = 0;
+        }
+
+        offset += _cfg[c].size * _cfg[c].num;
+    }
+
+    _initialized = 1;
+}
+
+static inline void *_slot_data(uint8_t slot)
+{
+    unsigned c = _slot_class[slot];
+
+    return &_pktbuf[_classes[c].offset + (slot - _classes[c].first) * _cfg[c].size];
+}
+
+/**
+ * @brief   Get the allocated slot *pkt* points into.
+ *
+ * @return  The slot, SLOT_NONE if *pkt* is in no allocated packet.
+ */
+static uint8_t _slot_find(const void *pkt)
+{
+    if ((pkt == NULL) || !pktbuf_contains(pkt) || !_initialized) {
+        return SLOT_NONE;
+    }
+
+    unsigned offset = ((const uint8_t *)pkt) - _pktbuf;
+
+    for (unsigned c = 0; c < SLAB_CLASSES; c++) {
+        unsigned end = _classes[c].offset + _cfg[c].size * _cfg[c].num;
+
+        if (offset < end) {
+            uint8_t slot = _classes[c].first + (offset - _classes[c].offset) / _cfg[c].size;
+
+            /* only the first size bytes of a slot belong to the packet */
+            if ((_slot_processing[slot] == 0) ||
+                (((const uint8_t *)pkt) >= ((uint8_t *)_slot_data(slot)) + _slot_size[slot])) {
+                return SLOT_NONE;
+            }
+
+            return slot;
+        }
+    }
+
+    return SLOT_NONE;
+}
+
+/* call with interrupts disabled */
+static uint8_t _slot_alloc(size_t size)
+{
+    if (!_initialized) {
+        _slab_init();
+    }
+
+    if (size == 0) {
+        return SLOT_NONE;
+    }
+
+    /* take the smallest fitting class with a free slot */
+    for (unsigned c = 0; c < SLAB_CLASSES; c++) {
+        if ((_cfg[c].size >= size) && (_classes[c].free != SLOT_NONE)) {
+            uint8_t slot = _classes[c].free;
+
+            _classes[c].free = _slot_next[slot];
+            _slot_size[slot] = size;
+            _slot_processing[slot] = 1;
+
+            return slot;
+        }
+    }
+
+    return SLOT_NONE;
+}
+
+/* call with interrupts disabled */
+static void _slot_release(uint8_t slot)
+{
+    if (_slot_processing[slot]-- > 1) {
+        return;
+    }
+
+    unsigned c = _slot_class[slot];
+
+    _slot_processing[slot] = 0;
+    _slot_size[slot] = 0;
+    _slot_next[slot] = _classes[c].free;
+    _classes[c].free = slot;
+}
+
+int pktbuf_contains(const void *pkt)
+{
+    return ((&(_pktbuf[0]) <= ((uint8_t *)pkt)) && (((uint8_t *)pkt) < &(_pktbuf[SLAB_BYTES])));
+}
+
+void *pktbuf_alloc(size_t size)
+{
+    unsigned state = disableIRQ();
+    uint8_t slot = _slot_alloc(size);
+
+    restoreIRQ(state);
+
+    return (slot == SLOT_NONE) ? NULL : _slot_data(slot);
+}
+
+void *pktbuf_realloc(const void *pkt, size_t size)
+{
+    uint8_t orig, new;
+    unsigned state;
+
+    if (size == 0) {
+        return NULL;
+    }
+
+    state = disableIRQ();
+    orig = _slot_find(pkt);
+
+    /* still fits into the slot */
+    if ((orig != SLOT_NONE) && (_cfg[_slot_class[orig]].size >= size)) {
+        _slot_size[orig] = size;
+        restoreIRQ(state);
+        return (void *)pkt;
+    }
+
+    new = _slot_alloc(size);
+    restoreIRQ(state);
+
+    if (new == SLOT_NONE) {
+        return NULL;
+    }
+
+    if (orig != SLOT_NONE) {
+        memcpy(_slot_data(new), _slot_data(orig), _slot_size[orig]);
+
+        state = disableIRQ();
+        _slot_release(orig);
+        restoreIRQ(state);
+    }
+    else {
+        memcpy(_slot_data(new), pkt, size);
+    }
+
+    return _slot_data(new);
+}
+
+void *pktbuf_insert(const void *data, size_t size)
+{
+    void *pkt;
+
+    if (data == NULL) {
+        return NULL;
+    }
+
+    pkt = pktbuf_alloc(size);
+
+    if (pkt != NULL) {
+        memcpy(pkt, data, size);
+    }
+
+    return pkt;
+}
+
+int pktbuf_copy(void *pkt, const void *data, size_t data_len)
+{
+    uint8_t slot;
+
+#ifdef DEVELHELP
+
+    if (data == NULL) {
+        return -EFAULT;
+    }
+
+    if (pkt == NULL) {
+        return -EINVAL;
+    }
+
+#endif /* DEVELHELP */
+
+    unsigned state = disableIRQ();
+    slot = _slot_find(pkt);
+
+    /* packet space not engough? */
+    if ((slot != SLOT_NONE) &&
+        (data_len > (size_t)((((uint8_t *)_slot_data(slot)) + _slot_size[slot]) -
+                             ((uint8_t *)pkt)))) {
+        restoreIRQ(state);
+        return -ENOMEM;
+    }
+
+    restoreIRQ(state);
+
+    memcpy(pkt, data, data_len);
+
+    return data_len;
+}
+
+void pktbuf_hold(const void *pkt)
+{
+    unsigned state = disableIRQ();
+    uint8_t slot = _slot_find(pkt);
+
+    if (slot != SLOT_NONE) {
+        _slot_processing[slot]++;
+    }
+
+    restoreIRQ(state);
+}
+
+void pktbuf_release(const void *pkt)
+{
+    unsigned state = disableIRQ();
+    uint8_t slot = _slot_find(pkt);
+
+    if (slot != SLOT_NONE) {
+        _slot_release(slot);
+    }
+
+    restoreIRQ(state);
+}
+
+#ifdef DEVELHELP
+#include <stdio.h>
+
+void pktbuf_print(void)
+{
+    printf("current pktbuf allocations:\n");
+    printf("===================================================\n");
+
+    for (unsigned c = 0; c < SLAB_CLASSES; c++) {
+        printf("class %u: %u slots of %u bytes\n", c, _cfg[c].num, _cfg[c].size);
+
+        for (unsigned i = 0; i < _cfg[c].num; i++) {
+            uint8_t slot = _classes[c].first + i;
+
+            if (_initialized && _slot_processing[slot]) {
+                printf("  slot %u (%p): size %u, processing %u\n", i, _slot_data(slot),
+                       _slot_size[slot], _slot_processing[slot]);
+            }
+        }
+    }
+
+    printf("===================================================\n");
+    printf("\n");
+}
+#endif
+
+#ifdef TEST_SUITES
+size_t pktbuf_bytes_allocated(void)
+{
+    size_t bytes = 0;
+
+    for (unsigned i = 0; i < SLAB_SLOTS; i++) {
+        bytes += _slot_size[i];
+    }
+
+    return bytes;
+}
+
+size_t pktbuf_packets_allocated(void)
+{
+    size_t packets = 0;
+
+    for (unsigned i = 0; i < SLAB_SLOTS; i++) {
+        packets += (_slot_processing[i] > 0);
+    }
+
+    return packets;
+}
+
+int pktbuf_is_empty(void)
+{
+    return (pktbuf_packets_allocated() == 0);
+}
+
+void pktbuf_reset(void)
+{
+    memset(_pktbuf, 0, SLAB_BYTES);
+    _slab_init();
+}
+#endif
+
+/** @} */
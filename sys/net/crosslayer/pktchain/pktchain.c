@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     pktchain
+ * @{
+ *
+ * @file        pktchain.c
+ * @brief       Packet chain helpers
+ *
+ * @}
+ */
+
+#include <string.h>
+
+#include "net_help.h"
+
+#ifdef MODULE_PKTBUF
+#include "pktbuf.h"
+#endif
+
+#include "pktchain.h"
+
+size_t pktchain_len(const pktchain_t *chain)
+{
+    size_t len = 0;
+
+    for (; chain != NULL; chain = chain->next) {
+        len += chain->len;
+    }
+
+    return len;
+}
+
+size_t pktchain_gather(const pktchain_t *chain, size_t offset, void *dst,
+                       size_t len)
+{
+    uint8_t *out = dst;
+
+    /* skip the nodes before offset */
+    while ((chain != NULL) && (offset >= chain->len)) {
+        offset -= chain->len;
+        chain = chain->next;
+    }
+
+    while ((chain != NULL) && (len > 0)) {
+        size_t part = chain->len - offset;
+
+        if (part > len) {
+            part = len;
+        }
+
+        memcpy(out, ((const uint8_t *)chain->data) + offset, part);
+        out += part;
+        len -= part;
+        offset = 0;
+        chain = chain->next;
+    }
+
+    return out - ((uint8_t *)dst);
+}
+
+uint16_t pktchain_csum(uint16_t sum, const pktchain_t *chain)
+{
+    uint8_t odd = 0;
+
+    for (; chain != NULL; chain = chain->next) {
+        if (!odd) {
+            sum = csum(sum, (uint8_t *)chain->data, chain->len);
+        }
+        else {
+            /* the node starts in the low byte of a word: sum it on its own
+             * and swap the bytes of the result */
+            uint16_t part = csum(0, (uint8_t *)chain->data, chain->len);
+            uint32_t s = sum + (uint16_t)((part << 8) | (part >> 8));
+
+            sum = (s & 0xffff) + (s >> 16);
+        }
+
+        odd ^= chain->len & 1;
+    }
+
+    return sum;
+}
+
+#ifdef MODULE_PKTBUF
+void *pktchain_to_pktbuf(const pktchain_t *chain)
+{
+    size_t len = pktchain_len(chain);
+    void *pkt = pktbuf_alloc(len);
+
+    if (pkt != NULL) {
+        pktchain_gather(chain, 0, pkt, len);
+    }
+
+    return pkt;
+}
+#endif
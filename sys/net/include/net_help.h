@@ -63,7 +63,42 @@ static inline uint64_t NTOHLL(uint64_t a)
 
 #define CMP_IPV6_ADDR(a, b) (memcmp(a, b, 16))
 
+/**
+ * @brief   Adds buf to a running Internet checksum (RFC 1071)
+ *
+ * @details The buffer is summed a 32 bit word at a time, it may start at
+ *          any address.
+ *
+ * @param[in] sum   sum of the preceding data, 0 to start
+ * @param[in] buf   data to add
+ * @param[in] len   length of buf in bytes, all but the last chunk of a
+ *                  checksum must have an even length
+ *
+ * @return  the one's complement sum, not complemented, in host byte order
+ */
 uint16_t csum(uint16_t sum, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief   Updates a checksum field after a 16 bit word of the covered data
+ *          changed, without summing the data again (RFC 1624, eqn. 3)
+ *
+ * @details All values must be in the same byte order. For UDP a result of
+ *          0x0000 has to be sent as 0xffff.
+ *
+ * @param[in] check     the checksum field as currently stored
+ * @param[in] old_val   the old value of the changed word
+ * @param[in] new_val   the new value of the changed word
+ *
+ * @return  the new value of the checksum field
+ */
+uint16_t csum_replace16(uint16_t check, uint16_t old_val, uint16_t new_val);
+
+/**
+ * @brief   Like csum_replace16() for a changed 32 bit word, e.g. a part of
+ *          an address
+ */
+uint16_t csum_replace32(uint16_t check, uint32_t old_val, uint32_t new_val);
+
 void printArrayRange(uint8_t *array, uint16_t len, char *str);
 
 /** @} */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_stats   Network statistics
+ * @ingroup     net
+ * @brief       Packet counters and processing latency histograms per layer
+ *              of the IPv6/6LoWPAN stack
+ *
+ * @details     The layers update their counters through the macros below,
+ *              which compile to nothing unless the `net_stats` module is
+ *              used. Latencies are taken with the hwtimer and sorted into
+ *              power of two buckets, so recording costs a few instructions
+ *              and no division.
+ * @{
+ *
+ * @file        net_stats.h
+ */
+
+#ifndef __NET_STATS_H
+#define __NET_STATS_H
+
+#include <stdint.h>
+
+#ifdef MODULE_NET_STATS
+#include "hwtimer.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of latency histogram buckets. Bucket 0 counts latencies
+ *          below 2 us, bucket i latencies in [2^i, 2^(i+1)) us and the last
+ *          bucket everything above.
+ */
+#define NET_STATS_HIST_BUCKETS  (16)
+
+/**
+ * @brief   Layers with statistics
+ */
+typedef enum {
+    NET_STATS_LOWPAN = 0,       ///< 6LoWPAN frames
+    NET_STATS_IPV6,             ///< IPv6 packets
+    NET_STATS_UDP,              ///< UDP datagrams
+    NET_STATS_TCP,              ///< TCP segments
+    NET_STATS_LAYER_NUMOF       ///< number of layers
+} net_stats_layer_t;
+
+/**
+ * @brief   Statistics of one layer
+ */
+typedef struct {
+    uint32_t rx;                ///< packets received
+    uint32_t tx;                ///< packets sent
+    uint32_t rx_dropped;        ///< received packets dropped
+    uint32_t tx_dropped;        ///< packets that could not be sent
+    uint32_t csum_errors;       ///< received packets with a wrong checksum
+    uint32_t latency_max;       ///< longest processing of a received packet in us
+    uint32_t latency_hist[NET_STATS_HIST_BUCKETS]; ///< processing latencies
+} net_stats_t;
+
+#ifdef MODULE_NET_STATS
+/**
+ * @brief   The statistics, indexed by net_stats_layer_t
+ */
+extern net_stats_t net_stats[NET_STATS_LAYER_NUMOF];
+
+/**
+ * @brief   Increments counter `field` of `layer`
+ */
+#define NET_STATS_INC(layer, field) (net_stats[(layer)].field++)
+
+/**
+ * @brief   Takes the timestamp net_stats_latency() measures from
+ */
+static inline unsigned long net_stats_start(void)
+{
+    return hwtimer_now();
+}
+
+/**
+ * @brief   Records the processing latency of a received packet
+ *
+ * @param[in] layer     the processing layer
+ * @param[in] start     timestamp taken by net_stats_start() on reception
+ */
+void net_stats_latency(net_stats_layer_t layer, unsigned long start);
+
+/**
+ * @brief   Sets all statistics to zero
+ */
+void net_stats_reset(void);
+#else
+#define NET_STATS_INC(layer, field)
+#define net_stats_start()                   (0)
+#define net_stats_latency(layer, start)     ((void)(start))
+#define net_stats_reset()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */
+#endif /* __NET_STATS_H */
@@ -42,6 +42,35 @@
 #define PKTBUF_SIZE  (6144)
 #endif  /* PKTBUF_SIZE */
 
+#if defined(MODULE_PKTBUF_SLAB) && !defined(PKTBUF_SLAB_CLASSES)
+/**
+ * @brief   Size classes of the slab allocator (module `pktbuf_slab`), as
+ *          PKTBUF_SLAB_CLASS(slot size, number of slots) in ascending order
+ *          of slot size.
+ *
+ * @detail  Packets are placed in the smallest free slot that fits, so
+ *          allocation, release and finding the packet of a pointer take
+ *          constant time and the buffer can not fragment. The slots must
+ *          fit into PKTBUF_SIZE, slot sizes should be multiples of 4 to keep
+ *          the data word aligned and there may be at most 255 slots.
+ *          Larger packets than the largest slot can not be allocated, so
+ *          it must hold a 1280 byte IPv6 packet with the meta data the
+ *          network stack puts in front of it: the forwarding queue of IPv6
+ *          adds 17 bytes, the fragmentation queue of 6LoWPAN about 32.
+ *          A received packet, its copy in the forwarding queue and a
+ *          datagram in the fragmentation queue may be full-MTU at the same
+ *          time, so the default holds 3 packets of 1280 + 64 bytes. Most of
+ *          the smaller ones are single IEEE 802.15.4 frames, which take less
+ *          than 256 bytes after header decompression. The default holds 17
+ *          packets in 6144 bytes.
+ */
+#define PKTBUF_SLAB_CLASSES \
+    PKTBUF_SLAB_CLASS(32, 4) \
+    PKTBUF_SLAB_CLASS(64, 3) \
+    PKTBUF_SLAB_CLASS(256, 7) \
+    PKTBUF_SLAB_CLASS(1280 + 64, 3)
+#endif
+
 /**
  * @brief   Allocates new packet data in the packet buffer. This also marks the
  *          allocated data as processed.
@@ -143,6 +172,16 @@ void pktbuf_print(void);
 #define pktbuf_print()  ;
 #endif
 
+/**
+ * @brief   Checks if a given pointer is stored in the packet buffer
+ *
+ * @param[in] pkt   Pointer to be checked
+ *
+ * @return  1, if *pkt* is in packet buffer
+ * @return  0, otherwise
+ */
+int pktbuf_contains(const void *pkt);
+
 /* for testing */
 #ifdef TEST_SUITES
 /**
@@ -167,16 +206,6 @@ size_t pktbuf_packets_allocated(void);
  */
 int pktbuf_is_empty(void);
 
-/**
- * @brief   Checks if a given pointer is stored in the packet buffer
- *
- * @param[in] pkt   Pointer to be checked
- *
- * @return  1, if *pkt* is in packet buffer
- * @return  0, otherwise
- */
-int pktbuf_contains(const void *pkt);
-
 /**
  * @brief   Sets the whole packet buffer to 0
  */
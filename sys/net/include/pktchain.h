@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    pktchain    Packet chains
+ * @ingroup     net
+ * @brief       Scatter-gather lists for outgoing packets
+ *
+ * @details     A packet chain is a singly linked list of data fragments that
+ *              make up one packet, like an iovec. Each layer prepends its
+ *              header as a new node, usually placed on its stack, and hands
+ *              the chain down, so the payload is not copied until the frame
+ *              is put together for the device. Node data may live anywhere,
+ *              e.g. in the application's buffer or in @ref pktbuf.h.
+ * @{
+ *
+ * @file        pktchain.h
+ */
+
+#ifndef __PKTCHAIN_H_
+#define __PKTCHAIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   A fragment of a packet.
+ */
+typedef struct pktchain_t {
+    const struct pktchain_t *next;  /**< the following fragment, NULL for the last */
+    const void *data;               /**< the data of this fragment */
+    size_t len;                     /**< the length of *data* in byte */
+} pktchain_t;
+
+/**
+ * @brief   Prepends data to a chain.
+ *
+ * @param[out] node     The node to use for the data, must stay valid as long
+ *                      as the chain is used.
+ * @param[in] data      The data to prepend.
+ * @param[in] len       The length of *data* in byte.
+ * @param[in] chain     The chain to prepend to, may be NULL.
+ *
+ * @return  The new head of the chain, i.e. *node*.
+ */
+static inline pktchain_t *pktchain_prepend(pktchain_t *node, const void *data,
+                                           size_t len,
+                                           const pktchain_t *chain)
+{
+    node->next = chain;
+    node->data = data;
+    node->len = len;
+
+    return node;
+}
+
+/**
+ * @brief   Gets the total length of a chain.
+ *
+ * @param[in] chain     A chain.
+ *
+ * @return  The summed length of all nodes in byte.
+ */
+size_t pktchain_len(const pktchain_t *chain);
+
+/**
+ * @brief   Copies a range of a chain into contiguous memory.
+ *
+ * @param[in] chain     A chain.
+ * @param[in] offset    Offset of the range in the chain.
+ * @param[out] dst      Memory to copy to, at least *len* byte.
+ * @param[in] len       Length of the range.
+ *
+ * @return  The number of bytes copied, less than *len* if the chain ends
+ *          before.
+ */
+size_t pktchain_gather(const pktchain_t *chain, size_t offset, void *dst,
+                       size_t len);
+
+/**
+ * @brief   Adds the data of a chain to a running Internet checksum.
+ *
+ * @details Other than with csum() the nodes may have odd lengths.
+ *
+ * @param[in] sum       Sum of the preceding data, 0 to start.
+ * @param[in] chain     A chain.
+ *
+ * @return  The one's complement sum, not complemented, in host byte order.
+ */
+uint16_t pktchain_csum(uint16_t sum, const pktchain_t *chain);
+
+#ifdef MODULE_PKTBUF
+/**
+ * @brief   Copies a chain into a new packet in the packet buffer, e.g. to
+ *          queue it beyond the lifetime of its nodes.
+ *
+ * @param[in] chain     A chain.
+ *
+ * @return  The packet, to be released with pktbuf_release(), NULL if the
+ *          chain is empty or the packet buffer full.
+ */
+void *pktchain_to_pktbuf(const pktchain_t *chain);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PKTCHAIN_H_ */
+/** @} */
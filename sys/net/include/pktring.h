@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @defgroup    pktring Packet Ring
+ * @brief       Lock-free ring of packet pointers between two threads
+ * @ingroup     net
+ * @{
+ *
+ * @file        pktring.h
+ * @brief       Single-producer/single-consumer ring of packet pointers
+ *
+ * @details     One thread puts packets, another one gets them. The producer
+ *              only writes the head and the consumer only writes the tail,
+ *              so neither needs a lock or has to disable interrupts. With
+ *              more than one producer or consumer the ring must be
+ *              protected by the caller.
+ */
+
+#ifndef __PKTRING_H_
+#define __PKTRING_H_
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   data type for packet rings
+ */
+typedef struct {
+    void *volatile *buf;            /**< the slots */
+    unsigned int mask;              /**< number of slots - 1 */
+    volatile unsigned int head;     /**< slots put, written by the producer */
+    volatile unsigned int tail;     /**< slots got, written by the consumer */
+} pktring_t;
+
+/**
+ * @brief   Static initializer for pktring_t.
+ *
+ * @param[in] slots     Array of `void *volatile`, its length must be a power
+ *                      of two.
+ */
+#define PKTRING_INIT(slots) { (slots), (sizeof(slots) / sizeof(slots[0])) - 1, 0, 0 }
+
+/**
+ * @brief   Initializes a packet ring.
+ * @details For initialization of variables use PKTRING_INIT instead.
+ *
+ * @param[out] ring     pre-allocated pktring_t object, must not be NULL.
+ * @param[in] slots     The slots of the ring.
+ * @param[in] size      Number of slots, must be a power of two.
+ */
+static inline void pktring_init(pktring_t *ring, void *volatile *slots,
+                                unsigned int size)
+{
+    ring->buf = slots;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+/**
+ * @brief   Number of packets in the ring.
+ *
+ * @param[in] ring  The ring.
+ *
+ * @return  The number of packets that can be got.
+ */
+static inline unsigned int pktring_avail(const pktring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+/**
+ * @brief   Adds a packet to the ring, may only be called by the producer.
+ *
+ * @param[in,out] ring  The ring.
+ * @param[in] pkt       The packet.
+ *
+ * @return  0 on success, -1 if the ring is full.
+ */
+static inline int pktring_put(pktring_t *ring, void *pkt)
+{
+    unsigned int head = ring->head;
+
+    if ((head - ring->tail) > ring->mask) {
+        return -1;
+    }
+
+    ring->buf[head & ring->mask] = pkt;
+    /* the slot is written before the consumer can see it */
+    ring->head = head + 1;
+
+    return 0;
+}
+
+/**
+ * @brief   Takes the oldest packet from the ring, may only be called by the
+ *          consumer.
+ *
+ * @param[in,out] ring  The ring.
+ *
+ * @return  The packet, NULL if the ring is empty.
+ */
+static inline void *pktring_get(pktring_t *ring)
+{
+    unsigned int tail = ring->tail;
+
+    if (tail == ring->head) {
+        return NULL;
+    }
+
+    void *pkt = ring->buf[tail & ring->mask];
+    /* the slot is read before the producer can reuse it */
+    ring->tail = tail + 1;
+
+    return pkt;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PKTRING_H_ */
+/** @} */
@@ -118,7 +118,7 @@ void send_DIO(ipv6_addr_t *destination);
  * @param[in] start_index       Describes whether a DAO must be split because of too many routing entries.
  *
  */
-void send_DAO(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index);
+void send_DAO(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint16_t start_index);
 
 /**
  * @brief Sends a DIS-message to a given destination
@@ -196,18 +196,60 @@ void *rpl_process(void *arg);
 /**
  * @brief Returns next hop from routing table.
  *
+ * The entry with the longest matching prefix is used, without one the
+ * preferred parent is returned.
+ *
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
  *
  * @param[in] addr                  Destination address
  *
- * @return Next hop address
+ * @return Next hop address. It points into the routing table, where the
+ *         entry can be deleted and reused right after the lookup, so copy
+ *         it before the routing table changes.
  *
  * */
 ipv6_addr_t *rpl_get_next_hop(ipv6_addr_t *addr);
 
 /**
- * @brief Adds routing entry to routing table
+ * @brief Finds the routing entry with the longest prefix matching a destination.
+ *
+ * @param[in] addr                  Destination address
+ *
+ * @return Routing entry address, NULL if no entry matches. Like the result
+ *         of rpl_get_next_hop() it is only valid until the routing table
+ *         changes.
+ *
+ * */
+rpl_routing_entry_t *rpl_lookup_routing_entry(ipv6_addr_t *addr);
+
+/**
+ * @brief Adds a routing entry for a prefix to routing table
+ *
+ * If an entry for the prefix exists only its lifetime is updated.
+ *
+ * @param[in] prefix                Destination prefix, bits beyond
+ *                                  prefix_len are ignored
+ * @param[in] prefix_len            Length of the prefix in bits, 128 for a
+ *                                  host route
+ * @param[in] next_hop              Next hop address
+ * @param[in] lifetime              Lifetime of the entry
+ *
+ * */
+void rpl_add_prefix_routing_entry(ipv6_addr_t *prefix, uint8_t prefix_len,
+                                  ipv6_addr_t *next_hop, uint16_t lifetime);
+
+/**
+ * @brief Deletes the routing entry for a prefix from routing table
+ *
+ * @param[in] prefix                Destination prefix
+ * @param[in] prefix_len            Length of the prefix in bits
+ *
+ * */
+void rpl_del_prefix_routing_entry(ipv6_addr_t *prefix, uint8_t prefix_len);
+
+/**
+ * @brief Adds host routing entry to routing table
  *
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
@@ -220,7 +262,7 @@ ipv6_addr_t *rpl_get_next_hop(ipv6_addr_t *addr);
 void rpl_add_routing_entry(ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t lifetime);
 
 /**
- * @brief Deletes routing entry to routing table
+ * @brief Deletes host routing entry from routing table
  *
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
@@ -231,7 +273,7 @@ void rpl_add_routing_entry(ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t li
 void rpl_del_routing_entry(ipv6_addr_t *addr);
 
 /**
- * @brief Finds routing entry for a given destination.
+ * @brief Finds host routing entry for a given destination.
  *
  * @deprecated This function is obsolete and will be removed shortly. This will be replaced with a
  * common routing information base.
@@ -243,6 +285,13 @@ void rpl_del_routing_entry(ipv6_addr_t *addr);
  * */
 rpl_routing_entry_t *rpl_find_routing_entry(ipv6_addr_t *addr);
 
+/**
+ * @brief Decrements the lifetime of every routing entry and deletes the
+ *        entries whose lifetime ran out.
+ *
+ * */
+void rpl_age_routing_table(void);
+
 /**
  * @brief Clears routing table.
  *
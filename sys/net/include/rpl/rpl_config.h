@@ -119,7 +119,24 @@ static inline bool RPL_COUNTER_GREATER_THAN(uint8_t A,uint8_t B)
 #define RPL_MAX_DODAGS 3
 #define RPL_MAX_INSTANCES 1
 #define RPL_MAX_PARENTS 5
+#ifndef RPL_MAX_ROUTING_ENTRIES
+#ifdef CPU_NATIVE
+#define RPL_MAX_ROUTING_ENTRIES 4096
+#else
 #define RPL_MAX_ROUTING_ENTRIES 128
+#endif
+#endif
+/* buckets of the routing table index, must be a power of two */
+#ifndef RPL_ROUTING_HASH_SIZE
+#ifdef CPU_NATIVE
+#define RPL_ROUTING_HASH_SIZE 1024
+#else
+#define RPL_ROUTING_HASH_SIZE 32
+#endif
+#endif
+#if RPL_MAX_ROUTING_ENTRIES >= 0xffff
+#error "RPL_MAX_ROUTING_ENTRIES must be less than 65535"
+#endif
 #define RPL_ROOT_RANK 256
 #define RPL_DEFAULT_LIFETIME 0xff
 #define RPL_LIFETIME_UNIT 2
@@ -173,10 +173,12 @@ typedef struct rpl_of_t {
 } rpl_of_t;
 
 typedef struct {
-    ipv6_addr_t address;
+    ipv6_addr_t address;    /* destination, bits beyond prefix_len are zero */
     ipv6_addr_t next_hop;
     uint16_t lifetime;
     uint8_t used;
+    uint8_t prefix_len;     /* 128 for host routes */
+    uint16_t hash_next;     /* next entry in the same bucket or free list */
 } rpl_routing_entry_t;
 
 #endif
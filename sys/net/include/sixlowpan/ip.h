@@ -29,6 +29,7 @@
 #include "inet_ntop.h"
 #include "net_if.h"
 #include "net_help.h"
+#include "pktchain.h"
 #include "sixlowpan/types.h"
 
 /**
@@ -124,6 +125,37 @@ int ipv6_sendto(const ipv6_addr_t *dest, uint8_t next_header,
  */
 int ipv6_send_packet(ipv6_hdr_t *packet);
 
+/**
+ * @brief   Send IPv6 packet with a payload given as packet chain to dest.
+ *
+ * @details The payload is not copied before it is put into the frames, so
+ *          upper layers can prepend their headers as chain nodes.
+ *
+ * @param[in] dest              Destination of this packet.
+ * @param[in] next_header       Next header ID of payload.
+ * @param[in] payload           Payload of the packet.
+ *
+ * @return  length of the packet : on success
+ *          -1                   : if no route to the given dest could be
+ *                                 obtained
+ */
+int ipv6_sendto_chain(const ipv6_addr_t *dest, uint8_t next_header,
+                      const pktchain_t *payload);
+
+/**
+ * @brief   Send an IPv6 packet defined by its header and a payload chain.
+ *
+ * @param[in] packet            Pointer to an prepared IPv6 packet header,
+ *                              the source address will be filled in.
+ * @param[in] payload           Payload of the packet, its length must match
+ *                              the length field of the header.
+ *
+ * @return  length of the packet : on success
+ *          -1                   : if no route to the given dest could be
+ *                                 obtained
+ */
+int ipv6_send_chain(ipv6_hdr_t *packet, const pktchain_t *payload);
+
 /**
  * @brief   Determines if node is a router.
  *
@@ -527,6 +559,32 @@ void ipv6_net_if_get_best_src_addr(ipv6_addr_t *src, const ipv6_addr_t *dest);
  */
 void ipv6_iface_set_routing_provider(ipv6_addr_t *(*next_hop)(ipv6_addr_t *dest));
 
+/**
+ * @brief   Counters of the forwarding path, see ipv6_get_fwd_stats().
+ */
+typedef struct {
+    uint32_t forwarded;             ///< packets sent by 6LoWPAN
+    uint32_t no_route;              ///< dropped, no next hop known
+    uint32_t hop_limit_exceeded;    ///< dropped, hop limit reached 0
+    uint32_t no_buffer;             ///< dropped, forwarding queue or pktbuf full
+    uint32_t send_failed;           ///< dropped, 6LoWPAN could not send
+} ipv6_fwd_stats_t;
+
+/**
+ * @brief   Gets the counters of the forwarding path.
+ *
+ * @param[out] stats    The counters since boot.
+ */
+void ipv6_get_fwd_stats(ipv6_fwd_stats_t *stats);
+
+/**
+ * @brief   Gets the forwarding rate.
+ *
+ * @return  Packets forwarded per second since the previous call, or since
+ *          boot for the first call.
+ */
+uint32_t ipv6_get_fwd_rate(void);
+
 /**
  * @brief Calculates the IPv6 upper-layer checksum.
  *
@@ -542,5 +600,19 @@ void ipv6_iface_set_routing_provider(ipv6_addr_t *(*next_hop)(ipv6_addr_t *dest)
  */
 uint16_t ipv6_csum(ipv6_hdr_t *ipv6_header, uint8_t *buf, uint16_t len, uint8_t proto);
 
+/**
+ * @brief Calculates the IPv6 upper-layer checksum over a packet chain.
+ *
+ * @see ipv6_csum()
+ * @param[in] ipv6_header   Pointer to the IPv6 header of the packet, only
+ *                          the addresses are used.
+ * @param[in] chain         The upper-layer header and data.
+ * @param[in] proto         Upper-layer protocol number according to RFC1700.
+ *
+ * @return The IPv6 upper-layer checksum.
+ */
+uint16_t ipv6_csum_chain(ipv6_hdr_t *ipv6_header, const pktchain_t *chain,
+                         uint8_t proto);
+
 #endif /* SIXLOWPAN_IP_H */
 /** @} */
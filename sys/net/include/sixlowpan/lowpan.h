@@ -29,6 +29,7 @@
 #include "transceiver.h"
 #include "net_help.h"
 #include "net_if.h"
+#include "pktchain.h"
 #include "sixlowpan/types.h"
 
 /**
@@ -164,6 +165,25 @@
  */
 #define LOWPAN_FRAME_RECEIVED        (UPPER_LAYER_1)
 
+/**
+ * @brief message type for notification, content.value is the length of the
+ *        datagram or 0 if sending its fragments was aborted
+ *
+ * @see sixlowpan_lowpan_frag_register()
+ */
+#define LOWPAN_FRAG_SENT             (UPPER_LAYER_3)
+
+/**
+ * @brief   Counters of datagram fragmentation, see
+ *          sixlowpan_lowpan_get_frag_stats().
+ */
+typedef struct {
+    uint32_t datagrams;         ///< datagrams whose fragments were all sent
+    uint32_t fragments;         ///< fragments sent
+    uint32_t aborted;           ///< datagrams given up after a failed fragment
+    uint32_t queue_full;        ///< datagrams dropped, fragmentation queue full
+} sixlowpan_lowpan_frag_stats_t;
+
 /**
  * @brief   Data type to configure 6LoWPAN IPv6 header compression.
  */
@@ -248,6 +268,27 @@ int sixlowpan_lowpan_border_init(int if_id);
 int sixlowpan_lowpan_sendto(int if_id, const void *dest, int dest_len,
                             uint8_t *data, uint16_t data_len);
 
+/**
+ * @brief   Send an IPv6 packet given as header and payload chain via
+ *          6LoWPAN to destination node or next hop dest.
+ *
+ * @details The payload is not copied before it is put into the frames.
+ *          With the module sixlowpan_frag_queue a packet that needs to be
+ *          fragmented is copied and its fragments are sent by a separate
+ *          thread, the function returns once it is queued.
+ *
+ * @param[in] if_id     The interface to send the data over.
+ * @param[in] dest      Hardware address of the next hop or destination node.
+ * @param[in] dest_len  Length of the destination address in byte.
+ * @param[in] header    IPv6 header of the packet.
+ * @param[in] payload   Payload of the packet, i.e. everything after the
+ *                      IPv6 header.
+ *
+ * @return  length of transmitted data on success, -1 on failure.
+ */
+int sixlowpan_lowpan_sendto_chain(int if_id, const void *dest, int dest_len,
+                                  ipv6_hdr_t *header, const pktchain_t *payload);
+
 /**
  * @brief   Set header compression status for 6LoWPAN.
  *
@@ -281,6 +322,37 @@ void sixlowpan_lowpan_bootstrapping(void);
  */
 uint8_t sixlowpan_lowpan_register(kernel_pid_t pid);
 
+/**
+ * @brief   Gets the counters of datagram fragmentation.
+ *
+ * @param[out] stats    The counters since boot.
+ */
+void sixlowpan_lowpan_get_frag_stats(sixlowpan_lowpan_frag_stats_t *stats);
+
+#ifdef MODULE_SIXLOWPAN_FRAG_QUEUE
+/**
+ * @brief   Registers a thread to be notified when the fragments of a
+ *          datagram it sent are transmitted. For every fragmented datagram
+ *          the thread gets a LOWPAN_FRAG_SENT message, in the order the
+ *          datagrams were sent.
+ *
+ * @param[in] pid   The PID of the sending thread.
+ *
+ * @return  1 on success, ENOMEM if maximum number of registrable
+ *          threads is exceeded.
+ */
+uint8_t sixlowpan_lowpan_frag_register(kernel_pid_t pid);
+
+/**
+ * @brief   Sets the pause between two fragments of a datagram, so relays
+ *          have the time to forward a fragment before the next arrives.
+ *
+ * @param[in] us    The pause in microseconds, 0 to send the fragments
+ *                  back-to-back.
+ */
+void sixlowpan_lowpan_set_frag_pacing(uint32_t us);
+#endif
+
 #if ENABLE_DEBUG
 /**
  * @brief   Print current buffer of assembled (i. e. not fragmented)
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 #include "transceiver.h"
+#include "pktchain.h"
 
 #include "sixlowpan/types.h"
 
@@ -51,6 +52,27 @@
 int sixlowpan_mac_send_ieee802154_frame(int if_id, const void *dest,
                                         uint8_t dest_len, const void *payload, uint8_t length, uint8_t mcast);
 
+/**
+ * @brief   Send an IEEE 802.15.4 frame with a payload given as packet chain.
+ *
+ * @details The chain is gathered directly into the frame buffer.
+ *
+ * @param[in]   if_id       The interface to send over (will be ignored if
+ *                          *mcast* is 1).
+ * @param[in]   dest        The destination address of the frame (will be
+ *                          ignored if *mcast* is 1).
+ * @param[in]   dest_len    The lengts of the destination address in byte.
+ * @param[in]   payload     The payload of the frame.
+ * @param[in]   mcast       send frame as multicast frame (*addr* and *if_id*
+ *                          will be ignored).
+ *
+ * @return Length of transmitted data in byte, -1 on failure
+ */
+int sixlowpan_mac_send_ieee802154_chain(int if_id, const void *dest,
+                                        uint8_t dest_len,
+                                        const pktchain_t *payload,
+                                        uint8_t mcast);
+
 /**
  * @brief   Initialise 6LoWPAN MAC layer and register it to interface layer
  *
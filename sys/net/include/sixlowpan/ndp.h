@@ -119,7 +119,8 @@ typedef struct __attribute__((packed)) {
 typedef struct __attribute__((packed)) {
     int if_id;                  ///< Interface the IPv6 address is reachable
     ///< over
-    ndp_nce_type_t type;        ///< Type of neighbor cache entry.
+    ndp_nce_type_t type;        ///< Type of neighbor cache entry, 0 if the
+    ///< entry is unused.
     ndp_nce_state_t state;      ///< State of neighbor cache entry.
     uint8_t isrouter;           ///< Flag to signify that this neighbor
     ///< is a router.
@@ -127,7 +128,17 @@ typedef struct __attribute__((packed)) {
     uint8_t lladdr[8];          ///< Link-layer address of the neighbor
     uint8_t lladdr_len;         ///< Length of link-layer address of the
     ///< neighbor
-    timex_t ltime;              ///< lifetime of entry.
+    uint32_t ltime;             ///< Seconds until a tentative or registered
+    ///< entry is removed, 0 for never.
+    uint8_t timer;              ///< Seconds until the state times out, 0 if
+    ///< it does not.
+    uint8_t probes;             ///< Solicitations sent in this state.
+    uint8_t solicit;            ///< A solicitation is due.
+    uint8_t hash_next;          ///< Next entry in the same hash bucket.
+    uint8_t lru_prev;           ///< Entry used more recently.
+    uint8_t lru_next;           ///< Entry used less recently.
+    void *queued;               ///< Packet waiting for address resolution.
+    uint16_t queued_len;        ///< Length of the waiting packet.
 } ndp_neighbor_cache_t;
 
 /**
@@ -143,10 +154,30 @@ typedef struct __attribute__((packed)) {
 } ndp_a6br_cache_t;
 
 ndp_default_router_list_t *ndp_default_router_list_search(ipv6_addr_t *ipaddr);
+
+/**
+ * @brief   Adds a neighbor to the neighbor cache or updates its entry.
+ *
+ * @details If the cache is full the least recently used entry that is not
+ *          registered is replaced.
+ *
+ * @param[in] if_id         Interface the neighbor is reachable over.
+ * @param[in] ipaddr        IPv6 address of the neighbor.
+ * @param[in] lladdr        Link-layer address of the neighbor.
+ * @param[in] lladdr_len    Length of *lladdr*, 2 or 8.
+ * @param[in] isrouter      The neighbor is a router.
+ * @param[in] state         Reachability state of the entry.
+ * @param[in] type          Type of the entry.
+ * @param[in] ltime         Lifetime of a tentative or registered entry in
+ *                          seconds, 0 for infinite.
+ *
+ * @return  NDP_OPT_ARO_STATE_SUCCESS on success,
+ *          NDP_OPT_ARO_STATE_NBR_CACHE_FULL if all entries are registered.
+ */
 uint8_t ndp_neighbor_cache_add(int if_id, const ipv6_addr_t *ipaddr,
                                const void *lladdr, uint8_t lladdr_len,
                                uint8_t isrouter, ndp_nce_state_t state,
-                               ndp_nce_type_t type, uint16_t ltime);
+                               ndp_nce_type_t type, uint32_t ltime);
 
 /**
  * @brief   Removes an address from the neighbor cache by IPv6 address.
@@ -158,7 +189,24 @@ uint8_t ndp_neighbor_cache_add(int if_id, const ipv6_addr_t *ipaddr,
  */
 uint8_t ndp_neighbor_cache_remove(const ipv6_addr_t *ipaddr);
 
+/**
+ * @brief   Searches the neighbor cache for an IPv6 address.
+ *
+ * @param[in] ipaddr        IPv6 address of the neighbor.
+ *
+ * @return  The entry of the neighbor, NULL if there is none.
+ */
 ndp_neighbor_cache_t *ndp_neighbor_cache_search(ipv6_addr_t *ipaddr);
+
+/**
+ * @brief   Searches the neighbor cache for a neighbor whose link-layer
+ *          address is known and marks the entry as recently used.
+ *
+ * @param[in] ipaddr        IPv6 address of the neighbor.
+ *
+ * @return  The entry of the neighbor, NULL if there is none or the
+ *          neighbor is still being resolved.
+ */
 ndp_neighbor_cache_t *ndp_get_ll_address(ipv6_addr_t *ipaddr);
 int ndp_addr_is_on_link(ipv6_addr_t *dest_addr);
 
@@ -164,12 +164,31 @@ typedef uint32_t  socklen_t;    ///< POSIX compatible type for address length.
 /**
  * Static TCP flow control window for window size 1.
  */
+#ifndef TRANSPORT_LAYER_SOCKET_STATIC_WINDOW
 #define TRANSPORT_LAYER_SOCKET_STATIC_WINDOW    1 * TRANSPORT_LAYER_SOCKET_STATIC_MSS
+#endif
+
+/**
+ * Size of the TCP receive ring of every socket, the advertised window is the
+ * free space in it. Segments that arrive out of order are kept in the ring
+ * as well, so a ring of several windows lets the peer keep sending while a
+ * lost segment is retransmitted. Costs MAX_SOCKETS times this in RAM.
+ */
+#ifndef TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER
+#  ifdef CPU_NATIVE
+#    define TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER   (4 * TRANSPORT_LAYER_SOCKET_STATIC_WINDOW)
+#  else
+#    define TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER   (2 * TRANSPORT_LAYER_SOCKET_STATIC_WINDOW)
+#  endif
+#endif
 
 /**
- * Maximum size of TCP buffer.
+ * Size of the TCP send buffer. Together with the window of the peer it
+ * limits the bytes in flight, one MSS makes the sender stop-and-wait.
  */
-#define TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER   1 * TRANSPORT_LAYER_SOCKET_STATIC_WINDOW
+#ifndef TRANSPORT_LAYER_SOCKET_TCP_SEND_BUFFER
+#define TRANSPORT_LAYER_SOCKET_TCP_SEND_BUFFER  4 * TRANSPORT_LAYER_SOCKET_STATIC_MSS
+#endif
 
 /**
  * Socket address type for IPv6 communication.
@@ -243,6 +262,24 @@ int32_t socket_base_recv(int s, void *buf, uint32_t len, int flags);
 int32_t socket_base_recvfrom(int s, void *buf, uint32_t len, int flags,
                                 sockaddr6_t *from, socklen_t *fromlen);
 
+/**
+ * Receives a datagram through socket *s* without copying it. *payload* is
+ * set to the data inside the @ref pktbuf, which stays allocated until the
+ * caller hands it back with pktbuf_release(). The address of the sender is
+ * stored in *from*. Only supported by datagram sockets.
+ *
+ * @param[in] s         The ID of the socket to receive from.
+ * @param[out] payload  Start of the received data in the packet buffer.
+ * @param[in] flags     Flags for possible later implementations (currently
+ *                      unused).
+ * @param[out] from     IPv6 Address of the data's sender.
+ * @param[out] fromlen  Length of address in *from* in byte (always 16).
+ *
+ * @return Number of received bytes, -1 on error.
+ */
+int32_t socket_base_recvfrom_pkt(int s, void **payload, int flags,
+                                 sockaddr6_t *from, socklen_t *fromlen);
+
 /**
  * Sends data *buf* through socket *s*. Roughly identical to POSIX's
  * <a href="http://man.he.net/man2/send">send(2)</a>.
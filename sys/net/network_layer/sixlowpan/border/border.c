@@ -37,6 +37,7 @@
 #include "serialnumber.h"
 
 #include "net_help.h"
+#include "pktbuf.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -169,20 +170,20 @@ int sixlowpan_lowpan_border_init(int if_id)
 
 void border_process_lowpan(void)
 {
-    msg_t m;
-
     while (1) {
-        msg_receive(&m);
-        ipv6_hdr_t *ipv6_buf = (ipv6_hdr_t *)m.content.ptr;
+        ipv6_hdr_t *packet = ipv6_rx_dequeue();
 
-        if (ipv6_buf->nextheader == IPV6_PROTO_NUM_ICMPV6) {
+        if (packet->nextheader == IPV6_PROTO_NUM_ICMPV6) {
+            ipv6_hdr_t *ipv6_buf = ipv6_rx_to_buf(packet);
             icmpv6_hdr_t *icmp_buf = (icmpv6_hdr_t *)(((uint8_t *)ipv6_buf) + IPV6_HDR_LEN);
 
             if (icmp_buf->type == ICMPV6_TYPE_REDIRECT) {
+                pktbuf_release(packet);
                 continue;
             }
 
             if (icmpv6_demultiplex(icmp_buf) == 0) {
+                pktbuf_release(packet);
                 continue;
             }
 
@@ -190,6 +191,7 @@ void border_process_lowpan(void)
         }
 
         /* TODO: Bei ICMPv6-Paketen entsprechende LoWPAN-Optionen verarbeiten und entfernen */
-        multiplex_send_ipv6_over_uart(ipv6_buf);
+        multiplex_send_ipv6_over_uart(packet);
+        pktbuf_release(packet);
     }
 }
@@ -29,8 +29,10 @@
 
 #include "ip.h"
 #include "icmp.h"
+#include "nbr_cache.h"
 #include "serialnumber.h"
 #include "net_help.h"
+#include "pktchain.h"
 
 #define ENABLE_DEBUG    (0)
 #if ENABLE_DEBUG
@@ -88,9 +90,6 @@
 #define OPT_ABRO_HDR_LEN                (24)
 /* authoritive border router cache size */
 #define ABR_CACHE_SIZE                  (2)
-/* neighbor cache size */
-#define NBR_CACHE_SIZE                  (8)
-#define NBR_CACHE_LTIME_TEN             (20)
 /* default router list size */
 #define DEF_RTR_LST_SIZE                    (3) /* geeigneten wert finden */
 
@@ -101,7 +100,6 @@ uint8_t ipv6_ext_hdr_len = 0;
 
 /* counter */
 uint8_t abr_count = 0;
-uint8_t nbr_count = 0;
 uint8_t def_rtr_count = 0;
 uint8_t rtr_sol_count = 0;
 uint8_t prefix_info_count = 0;
@@ -109,7 +107,6 @@ uint8_t prefix_buf_count = 0;
 
 /* datastructures */
 ndp_a6br_cache_t abr_cache[ABR_CACHE_SIZE];
-ndp_neighbor_cache_t nbr_cache[NBR_CACHE_SIZE];
 ndp_default_router_list_t def_rtr_lst[DEF_RTR_LST_SIZE];
 ndp_prefix_info_t prefix_info_buf[PREFIX_BUF_LEN];
 uint8_t prefix_buf[sizeof(ipv6_addr_t) * PREFIX_BUF_LEN];
@@ -178,10 +175,12 @@ static icmpv6_echo_request_hdr_t *get_echo_req_buf(uint8_t ext_len)
     return ((icmpv6_echo_request_hdr_t *) &buffer[LLHDR_ICMPV6HDR_LEN + ext_len]);
 }
 
+#ifdef DEBUG_ENABLED
 static icmpv6_echo_reply_hdr_t *get_echo_repl_buf(uint8_t ext_len)
 {
     return ((icmpv6_echo_reply_hdr_t *) &buffer[LLHDR_ICMPV6HDR_LEN + ext_len]);
 }
+#endif
 
 static icmpv6_router_adv_hdr_t *get_rtr_adv_buf(uint8_t ext_len)
 {
@@ -238,82 +237,60 @@ static icmpv6_ndp_opt_aro_t *get_opt_aro_buf(uint8_t ext_len, uint8_t opt_len)
     return ((icmpv6_ndp_opt_aro_t *) &buffer[LLHDR_ICMPV6HDR_LEN + ext_len + opt_len]);
 }
 
-void icmpv6_send_echo_request(ipv6_addr_t *destaddr, uint16_t id, uint16_t seq, uint8_t *data, size_t data_len)
+/* the echo header is sent from the stack and the data from where it is */
+static void icmpv6_send_echo(uint8_t type, ipv6_addr_t *destaddr, uint16_t id,
+                             uint16_t seq, uint8_t *data, size_t data_len)
 {
-    uint16_t packet_length;
-
-    ipv6_buf = ipv6_get_buf();
-    icmp_buf = get_icmpv6_buf(ipv6_ext_hdr_len);
-    icmpv6_echo_request_hdr_t *echo_buf = get_echo_req_buf(ipv6_ext_hdr_len);
-    uint8_t *echo_data_buf = ((uint8_t *)echo_buf) + sizeof(icmpv6_echo_request_hdr_t);
-
-    icmp_buf->type = ICMPV6_TYPE_ECHO_REQUEST;
-    icmp_buf->code = 0;
-    ipv6_buf->version_trafficclass = IPV6_VER;
-    ipv6_buf->trafficclass_flowlabel = 0;
-    ipv6_buf->flowlabel = 0;
-    ipv6_buf->nextheader = IPV6_PROTO_NUM_ICMPV6;
-    ipv6_buf->hoplimit = ipv6_get_default_hop_limit();
-
-    memcpy(&ipv6_buf->destaddr, destaddr, sizeof(ipv6_addr_t));
-    ipv6_net_if_get_best_src_addr(&ipv6_buf->srcaddr, &ipv6_buf->destaddr);
-    echo_buf->id = HTONS(id);
-    echo_buf->seq = HTONS(seq);
-
-    memcpy(echo_data_buf, data, data_len);
-    packet_length = IPV6_HDR_LEN + ICMPV6_HDR_LEN + ipv6_ext_hdr_len +
-                    ECHO_REQ_LEN + data_len;
-
-    ipv6_buf->length = HTONS(packet_length - IPV6_HDR_LEN);
-
-    icmp_buf->checksum = icmpv6_csum(ipv6_buf, icmp_buf);
+    ipv6_hdr_t ipv6_hdr;
+    struct __attribute__((packed)) {
+        icmpv6_hdr_t icmp;
+        icmpv6_echo_request_hdr_t echo;
+    } echo_hdr;
+    pktchain_t hdr_node, data_node;
+    pktchain_t *chain;
+
+    chain = pktchain_prepend(&data_node, data, data_len, NULL);
+    chain = pktchain_prepend(&hdr_node, &echo_hdr, sizeof(echo_hdr), chain);
+
+    echo_hdr.icmp.type = type;
+    echo_hdr.icmp.code = 0;
+    echo_hdr.icmp.checksum = 0;
+    echo_hdr.echo.id = HTONS(id);
+    echo_hdr.echo.seq = HTONS(seq);
+
+    ipv6_hdr.version_trafficclass = IPV6_VER;
+    ipv6_hdr.trafficclass_flowlabel = 0;
+    ipv6_hdr.flowlabel = 0;
+    ipv6_hdr.nextheader = IPV6_PROTO_NUM_ICMPV6;
+    ipv6_hdr.hoplimit = ipv6_get_default_hop_limit();
+    ipv6_hdr.length = HTONS(ICMPV6_HDR_LEN + ECHO_REQ_LEN + data_len);
+
+    memcpy(&ipv6_hdr.destaddr, destaddr, sizeof(ipv6_addr_t));
+    ipv6_net_if_get_best_src_addr(&ipv6_hdr.srcaddr, &ipv6_hdr.destaddr);
+
+    echo_hdr.icmp.checksum = ~ipv6_csum_chain(&ipv6_hdr, chain,
+                                              IPV6_PROTO_NUM_ICMPV6);
 
 #ifdef DEBUG_ENABLED
     char addr_str[IPV6_MAX_ADDR_STR_LEN];
-    printf("INFO: send echo request (id = %04x, seq = %d, data_len = %zu) to: %s\n",
+    printf("INFO: send echo %s (id = %04x, seq = %d, data_len = %zu) to: %s\n",
+           (type == ICMPV6_TYPE_ECHO_REQUEST) ? "request" : "reply",
            id, seq, data_len, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
-                   &ipv6_buf->destaddr));
+                   &ipv6_hdr.destaddr));
 #endif
-    ipv6_send_packet(ipv6_buf);
+    ipv6_send_chain(&ipv6_hdr, chain);
 }
 
-void icmpv6_send_echo_reply(ipv6_addr_t *destaddr, uint16_t id, uint16_t seq, uint8_t *data, size_t data_len)
+void icmpv6_send_echo_request(ipv6_addr_t *destaddr, uint16_t id, uint16_t seq, uint8_t *data, size_t data_len)
 {
-    uint16_t packet_length;
-
-    ipv6_buf = ipv6_get_buf();
-    icmp_buf = get_icmpv6_buf(ipv6_ext_hdr_len);
-    icmpv6_echo_reply_hdr_t *echo_buf = get_echo_repl_buf(ipv6_ext_hdr_len);
-    uint8_t *echo_data_buf = ((uint8_t *)echo_buf) + sizeof(icmpv6_echo_reply_hdr_t);
-
-    icmp_buf->type = ICMPV6_TYPE_ECHO_REPLY;
-    icmp_buf->code = 0;
-    ipv6_buf->version_trafficclass = IPV6_VER;
-    ipv6_buf->trafficclass_flowlabel = 0;
-    ipv6_buf->flowlabel = 0;
-    ipv6_buf->nextheader = IPV6_PROTO_NUM_ICMPV6;
-    ipv6_buf->hoplimit = ipv6_get_default_hop_limit();
-
-    memcpy(&ipv6_buf->destaddr, destaddr, sizeof(ipv6_addr_t));
-    ipv6_net_if_get_best_src_addr(&ipv6_buf->srcaddr, &ipv6_buf->destaddr);
-    echo_buf->id = HTONS(id);
-    echo_buf->seq = HTONS(seq);
-
-    memcpy(echo_data_buf, data, data_len);
-    packet_length = IPV6_HDR_LEN + ICMPV6_HDR_LEN + ipv6_ext_hdr_len +
-                    ECHO_REPL_LEN + data_len;
-
-    ipv6_buf->length = HTONS(packet_length - IPV6_HDR_LEN);
-
-    icmp_buf->checksum = icmpv6_csum(ipv6_buf, icmp_buf);
+    icmpv6_send_echo(ICMPV6_TYPE_ECHO_REQUEST, destaddr, id, seq, data,
+                     data_len);
+}
 
-#ifdef DEBUG_ENABLED
-    char addr_str[IPV6_MAX_ADDR_STR_LEN];
-    printf("INFO: send echo reply (id = %04x, seq = %d, data_len = %zu) to: %s\n",
-           id, seq, data_len, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
-                   &ipv6_buf->destaddr));
-#endif
-    ipv6_send_packet(ipv6_buf);
+void icmpv6_send_echo_reply(ipv6_addr_t *destaddr, uint16_t id, uint16_t seq, uint8_t *data, size_t data_len)
+{
+    icmpv6_send_echo(ICMPV6_TYPE_ECHO_REPLY, destaddr, id, seq, data,
+                     data_len);
 }
 
 /* send router solicitation message - RFC4861 section 4.1 */
@@ -466,7 +443,8 @@ void recv_rtr_sol(void)
                 /* new addr found, update */
                 nbr_entry->if_id = if_id;
                 memcpy(&nbr_entry->lladdr, &llao[2], lladdr_len);
-                nbr_entry->state = NDP_NCE_STATUS_STALE;
+                nbr_entry->lladdr_len = lladdr_len;
+                nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                 nbr_entry->isrouter = 0;
             }
         }
@@ -967,6 +945,7 @@ void icmpv6_send_neighbor_sol(ipv6_addr_t *src, ipv6_addr_t *dest, ipv6_addr_t *
         opt_aro_buf->status = 0;
         opt_aro_buf->reserved1 = 0;
         opt_aro_buf->reserved2 = 0;
+        opt_aro_buf->reg_ltime = HTONS(OPT_ARO_LTIME);
 
         if (net_if_get_src_address_mode(if_id) == NET_IF_TRANS_ADDR_M_SHORT) {
             net_if_get_eui64((net_if_eui64_t *) &opt_aro_buf->eui64, if_id, 1);
@@ -993,6 +972,53 @@ void icmpv6_send_neighbor_sol(ipv6_addr_t *src, ipv6_addr_t *dest, ipv6_addr_t *
     ipv6_send_packet(ipv6_buf);
 }
 
+void icmpv6_send_nbr_sol_buf(uint8_t *buf, const ipv6_addr_t *dest,
+                             const ipv6_addr_t *targ)
+{
+    int if_id = 0;          // TODO: get this somehow
+    ipv6_hdr_t *ipv6 = (ipv6_hdr_t *) buf;
+    icmpv6_hdr_t *icmp = (icmpv6_hdr_t *) &buf[IPV6_HDR_LEN];
+    icmpv6_neighbor_sol_hdr_t *nbr_sol =
+        (icmpv6_neighbor_sol_hdr_t *) &buf[IPV6_HDR_LEN + ICMPV6_HDR_LEN];
+    icmpv6_ndp_opt_stllao_t *sllao =
+        (icmpv6_ndp_opt_stllao_t *) &buf[IPV6_HDR_LEN + ICMPV6_HDR_LEN + NBR_SOL_LEN];
+    uint16_t packet_length = IPV6_HDR_LEN + ICMPV6_HDR_LEN + NBR_SOL_LEN;
+
+    ipv6->version_trafficclass = IPV6_VER;
+    ipv6->trafficclass_flowlabel = 0;
+    ipv6->flowlabel = 0;
+    ipv6->nextheader = IPV6_PROTO_NUM_ICMPV6;
+    ipv6->hoplimit = ND_HOPLIMIT;
+
+    if (dest == NULL) {
+        ipv6_addr_set_solicited_node_addr(&ipv6->destaddr, targ);
+    }
+    else {
+        memcpy(&ipv6->destaddr, dest, sizeof(ipv6_addr_t));
+    }
+
+    ipv6_net_if_get_best_src_addr(&ipv6->srcaddr, &ipv6->destaddr);
+
+    icmp->type = ICMPV6_TYPE_NEIGHBOR_SOL;
+    icmp->code = 0;
+    nbr_sol->reserved = 0;
+    memcpy(&nbr_sol->target_addr, targ, sizeof(ipv6_addr_t));
+
+    if (net_if_get_src_address_mode(if_id) == NET_IF_TRANS_ADDR_M_LONG) {
+        icmpv6_ndp_set_sllao(sllao, if_id, NDP_OPT_SLLAO_TYPE, 2);
+        packet_length += OPT_STLLAO_MAX_LEN;
+    }
+    else {
+        icmpv6_ndp_set_sllao(sllao, if_id, NDP_OPT_SLLAO_TYPE, 1);
+        packet_length += OPT_STLLAO_MIN_LEN;
+    }
+
+    ipv6->length = HTONS(packet_length - IPV6_HDR_LEN);
+    icmp->checksum = icmpv6_csum(ipv6, icmp);
+
+    ipv6_send_packet(ipv6);
+}
+
 void recv_nbr_sol(void)
 {
     int if_id = 0;  // TODO, get this somehow
@@ -1043,7 +1069,8 @@ void recv_nbr_sol(void)
                                 else {
                                     nbr_entry->if_id = if_id;
                                     memcpy(&nbr_entry->lladdr, &llao[2], 2);
-                                    nbr_entry->state = NDP_NCE_STATUS_STALE;
+                                    nbr_entry->lladdr_len = 2;
+                                    nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                                     nbr_entry->isrouter = 0;
                                 }
 
@@ -1058,7 +1085,8 @@ void recv_nbr_sol(void)
                                 else {
                                     nbr_entry->if_id = if_id;
                                     memcpy(&nbr_entry->lladdr, &llao[2], 8);
-                                    nbr_entry->state = NDP_NCE_STATUS_STALE;
+                                    nbr_entry->lladdr_len = 8;
+                                    nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                                     nbr_entry->isrouter = 0;
                                 }
 
@@ -1117,8 +1145,8 @@ void recv_nbr_sol(void)
                             /* create neighbor cache */
                             aro_state = ndp_neighbor_cache_add(if_id, &ipv6_buf->srcaddr,
                                                                &(opt_aro_buf->eui64), 8, 0,
-                                                               NDP_NCE_STATUS_STALE, NDP_NCE_TYPE_TENTATIVE,
-                                                               opt_aro_buf->reg_ltime);
+                                                               NDP_NCE_STATUS_STALE, NDP_NCE_TYPE_REGISTERED,
+                                                               NTOHS(opt_aro_buf->reg_ltime) * 60);
                         }
                         else {
                             if (memcmp(&(nbr_entry->addr.uint16[4]),
@@ -1129,11 +1157,11 @@ void recv_nbr_sol(void)
                                     ndp_neighbor_cache_remove(&nbr_entry->addr);
                                 }
                                 else {
-                                    set_remaining_time(&(nbr_entry->ltime), (uint32_t)opt_aro_buf->reg_ltime);
-                                    nbr_entry->state = NDP_NCE_STATUS_STALE;
+                                    /* the lifetime is given in minutes */
+                                    nbr_entry->ltime = NTOHS(opt_aro_buf->reg_ltime) * 60;
+                                    nbr_entry->type = NDP_NCE_TYPE_REGISTERED;
                                     nbr_entry->isrouter = 0;
-                                    memcpy(&(nbr_entry->addr.uint8[0]),
-                                           &(ipv6_buf->srcaddr.uint8[0]), 16);
+                                    nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                                 }
 
                                 aro_state = NDP_OPT_ARO_STATE_SUCCESS;
@@ -1163,10 +1191,9 @@ void recv_nbr_sol(void)
     nbr_sol_buf = get_nbr_sol_buf(ipv6_ext_hdr_len);
 
     if (ipv6_net_if_addr_match(&alist_targ, &nbr_sol_buf->target_addr) != NULL) {
-        ipv6_net_if_addr_match(&alist_dest, &ipv6_buf->destaddr);
-
-        if ((memcmp(alist_targ.addr->addr_data, alist_dest.addr->addr_data, 16) == 0) ||
-            ipv6_addr_is_solicited_node(&ipv6_buf->destaddr)) {
+        if (ipv6_addr_is_solicited_node(&ipv6_buf->destaddr) ||
+            ((ipv6_net_if_addr_match(&alist_dest, &ipv6_buf->destaddr) != NULL) &&
+             (memcmp(alist_targ.addr->addr_data, alist_dest.addr->addr_data, 16) == 0))) {
             memcpy(&(ipv6_buf->destaddr.uint8[0]),
                    &(ipv6_buf->srcaddr.uint8[0]), sizeof(ipv6_addr_t));
             memcpy(&(ipv6_buf->srcaddr.uint8[0]),
@@ -1179,7 +1206,7 @@ void recv_nbr_sol(void)
         /* solicited na */
         uint8_t flags = (ICMPV6_NEIGHBOR_ADV_FLAG_OVERRIDE | ICMPV6_NEIGHBOR_ADV_FLAG_SOLICITED);
         icmpv6_send_neighbor_adv(&(ipv6_buf->srcaddr), &(ipv6_buf->destaddr),
-                                 alist_targ.addr->addr_data, flags, 0, OPT_ARO);
+                                 alist_targ.addr->addr_data, flags, OPT_TLLAO, OPT_ARO);
     }
 }
 
@@ -1216,18 +1243,21 @@ void icmpv6_send_neighbor_adv(ipv6_addr_t *src, ipv6_addr_t *dst, ipv6_addr_t *t
     memcpy(&(nbr_adv_buf->target_addr.uint8[0]), &(tgt->uint8[0]), 16);
 
     packet_length = IPV6_HDR_LEN + ICMPV6_HDR_LEN + NBR_ADV_LEN;
+    icmpv6_opt_hdr_len = NBR_ADV_LEN;
 
-    if (sllao == OPT_SLLAO) {
-        /* set sllao option */
+    if ((sllao == OPT_SLLAO) || (sllao == OPT_TLLAO)) {
+        /* set sllao or tllao option, solicited advertisements carry the
+         * target's link-layer address */
+        uint8_t type = (sllao == OPT_SLLAO) ? NDP_OPT_SLLAO_TYPE : NDP_OPT_TLLAO_TYPE;
         opt_stllao_buf = get_opt_stllao_buf(ipv6_ext_hdr_len, icmpv6_opt_hdr_len);
 
         if (net_if_get_src_address_mode(if_id) == NET_IF_TRANS_ADDR_M_LONG) {
-            icmpv6_ndp_set_sllao(opt_stllao_buf, if_id, NDP_OPT_SLLAO_TYPE, 2);
+            icmpv6_ndp_set_sllao(opt_stllao_buf, if_id, type, 2);
             icmpv6_opt_hdr_len += OPT_STLLAO_MAX_LEN;
             packet_length += OPT_STLLAO_MAX_LEN;
         }
         else {
-            icmpv6_ndp_set_sllao(opt_stllao_buf, if_id, NDP_OPT_SLLAO_TYPE, 1);
+            icmpv6_ndp_set_sllao(opt_stllao_buf, if_id, type, 1);
             icmpv6_opt_hdr_len += OPT_STLLAO_MIN_LEN;
             packet_length += OPT_STLLAO_MIN_LEN;
         }
@@ -1241,6 +1271,7 @@ void icmpv6_send_neighbor_adv(ipv6_addr_t *src, ipv6_addr_t *dst, ipv6_addr_t *t
         opt_aro_buf->status = 0;    /* TODO */
         opt_aro_buf->reserved1 = 0;
         opt_aro_buf->reserved2 = 0;
+        opt_aro_buf->reg_ltime = HTONS(OPT_ARO_LTIME);
 
         if (net_if_get_src_address_mode(if_id) == NET_IF_TRANS_ADDR_M_SHORT) {
             net_if_get_eui64((net_if_eui64_t *) &opt_aro_buf->eui64, if_id, 1);
@@ -1303,9 +1334,8 @@ void recv_nbr_adv(void)
         if (nbr_entry != NULL) {
             int8_t new_ll = -1;
             if (llao != 0) {
-                new_ll = memcmp(&llao[2], &(nbr_entry->lladdr),
-                                nbr_entry->lladdr_len);
-                ((icmpv6_ndp_opt_stllao_t *)llao)->length = nbr_entry->lladdr_len / 8 + 1;
+                new_ll = (memcmp(&llao[2], &(nbr_entry->lladdr),
+                                 nbr_entry->lladdr_len) != 0);
             }
 
             int if_id = 0;  // TODO, get this somehow
@@ -1329,11 +1359,11 @@ void recv_nbr_adv(void)
                 }
 
                 if (nbr_adv_buf->rso & ICMPV6_NEIGHBOR_ADV_FLAG_SOLICITED) {
-                    nbr_entry->state = NDP_NCE_STATUS_REACHABLE;
+                    nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_REACHABLE);
                     /* TODO: set rechability */
                 }
                 else {
-                    nbr_entry->state = NDP_NCE_STATUS_STALE;
+                    nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                 }
 
                 nbr_entry->isrouter = nbr_adv_buf->rso & ICMPV6_NEIGHBOR_ADV_FLAG_ROUTER;
@@ -1341,7 +1371,7 @@ void recv_nbr_adv(void)
             else {
                 if (new_ll && !(nbr_adv_buf->rso & ICMPV6_NEIGHBOR_ADV_FLAG_OVERRIDE)) {
                     if (nbr_entry->state == NDP_NCE_STATUS_REACHABLE) {
-                        nbr_entry->state = NDP_NCE_STATUS_STALE;
+                        nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                     }
 
                     return;
@@ -1367,12 +1397,12 @@ void recv_nbr_adv(void)
                         }
 
                         if (nbr_adv_buf->rso & ICMPV6_NEIGHBOR_ADV_FLAG_SOLICITED) {
-                            nbr_entry->state = NDP_NCE_STATUS_REACHABLE;
+                            nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_REACHABLE);
                             /* TODO: set rechablility */
                         }
                         else {
                             if (llao != 0 && new_ll) {
-                                nbr_entry->state = NDP_NCE_STATUS_STALE;
+                                nbr_cache_set_state(nbr_entry, NDP_NCE_STATUS_STALE);
                             }
                         }
                     }
@@ -1490,32 +1520,6 @@ void icmpv6_send_parameter_prob(ipv6_addr_t *src, ipv6_addr_t *dest,
 //------------------------------------------------------------------------------
 /* neighbor cache functions */
 
-ndp_neighbor_cache_t *ndp_neighbor_cache_search(ipv6_addr_t *ipaddr)
-{
-    int i;
-
-    for (i = 0; i < NBR_CACHE_SIZE; i++) {
-        if (memcmp(&(nbr_cache[i].addr.uint8[0]), &(ipaddr->uint8[0]), 16) == 0) {
-            return &nbr_cache[i];
-        }
-    }
-
-    return NULL;
-}
-
-ndp_neighbor_cache_t *ndp_get_ll_address(ipv6_addr_t *ipaddr)
-{
-    ndp_neighbor_cache_t *nce = ndp_neighbor_cache_search(ipaddr);
-
-    if (nce == NULL || nce->type == NDP_NCE_TYPE_GC ||
-        nce->state == NDP_NCE_STATUS_INCOMPLETE) {
-        // TODO: send neighbor solicitation, wait, and recheck cache
-        return NULL;
-    }
-
-    return nce;
-}
-
 int ndp_addr_is_on_link(ipv6_addr_t *dest_addr)
 {
     int if_id = -1;
@@ -1544,67 +1548,6 @@ int ndp_addr_is_on_link(ipv6_addr_t *dest_addr)
     return 0;
 }
 
-uint8_t ndp_neighbor_cache_add(int if_id, const ipv6_addr_t *ipaddr,
-                               const void *lladdr, uint8_t lladdr_len,
-                               uint8_t isrouter, ndp_nce_state_t state,
-                               ndp_nce_type_t type, uint16_t ltime)
-{
-    (void) ltime;
-
-    if (nbr_count == NBR_CACHE_SIZE) {
-        printf("ERROR: neighbor cache full\n");
-        return NDP_OPT_ARO_STATE_NBR_CACHE_FULL;
-    }
-
-    nbr_cache[nbr_count].if_id = if_id;
-    memcpy(&(nbr_cache[nbr_count].addr), ipaddr, 16);
-    memcpy(&(nbr_cache[nbr_count].lladdr), lladdr, lladdr_len);
-    nbr_cache[nbr_count].lladdr_len = lladdr_len;
-    nbr_cache[nbr_count].isrouter = isrouter;
-    nbr_cache[nbr_count].state = state;
-    nbr_cache[nbr_count].type = type;
-
-    //vtimer_set_wakeup(&(nbr_cache[nbr_count].ltime), t,
-    /*                  nd_nbr_cache_rem_pid); */
-
-    nbr_count++;
-
-    return NDP_OPT_ARO_STATE_SUCCESS;
-}
-
-void nbr_cache_auto_rem(void)
-{
-    int i;
-
-    for (i = 0; i < NBR_CACHE_SIZE; i++) {
-        if (get_remaining_time(&(nbr_cache[i].ltime)) == 0 &&
-            nbr_cache[i].type == NDP_NCE_TYPE_TENTATIVE) {
-            memmove(&(nbr_cache[i]), &(nbr_cache[nbr_count]),
-                    sizeof(ndp_neighbor_cache_t));
-            memset(&(nbr_cache[nbr_count]), 0, sizeof(ndp_neighbor_cache_t));
-            nbr_count--;
-        }
-    }
-}
-
-uint8_t ndp_neighbor_cache_remove(const ipv6_addr_t *ipaddr)
-{
-    int i;
-    uint8_t removed = 0;
-
-    for (i = 0; i < NBR_CACHE_SIZE; i++) {
-        if (memcmp(&(nbr_cache[i].addr.uint8[0]), &(ipaddr->uint8[0]), 16) == 0) {
-            memmove(&(nbr_cache[i]), &(nbr_cache[nbr_count]),
-                    sizeof(ndp_neighbor_cache_t));
-            memset(&(nbr_cache[nbr_count]), 0, sizeof(ndp_neighbor_cache_t));
-            nbr_count--;
-            removed = 1;
-        }
-    }
-
-    return removed;
-}
-
 //------------------------------------------------------------------------------
 /* authoritive border router list functions */
 /**
@@ -44,8 +44,6 @@ enum option_types_t {
     OPT_DAC,
 };
 
-extern kernel_pid_t nd_nbr_cache_rem_pid;
-
 
 void recv_echo_req(void);
 void recv_echo_repl(void);
@@ -54,7 +52,17 @@ void recv_rtr_adv(void);
 void recv_nbr_adv(void);
 void recv_nbr_sol(void);
 
-void nbr_cache_auto_rem(void);
+/* size of a neighbor solicitation with SLLAO, see icmpv6_send_nbr_sol_buf() */
+#define ICMPV6_NBR_SOL_BUF_LEN  (IPV6_HDR_LEN + ICMPV6_HDR_LEN + 20 + 16)
+
+/* Sends a neighbor solicitation with SLLAO for the address resolution or
+ * unreachability detection of targ, built in buf of ICMPV6_NBR_SOL_BUF_LEN
+ * bytes. Unlike icmpv6_send_neighbor_sol() it leaves the buffers of the IP
+ * thread alone, so other threads can use it. If dest is NULL the solicited
+ * node multicast address of targ is used. */
+void icmpv6_send_nbr_sol_buf(uint8_t *buf, const ipv6_addr_t *dest,
+                             const ipv6_addr_t *targ);
+
 ndp_a6br_cache_t *abr_add_context(uint16_t version, ipv6_addr_t *abr_addr,
                                   uint8_t cid);
 void abr_remove_context(uint8_t cid);
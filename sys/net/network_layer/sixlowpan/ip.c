@@ -22,17 +22,24 @@
 #include <string.h>
 #include <errno.h>
 
+#include "irq.h"
 #include "vtimer.h"
 #include "mutex.h"
 #include "msg.h"
 #include "net_if.h"
+#include "thread.h"
 #include "sixlowpan/mac.h"
 
 #include "ip.h"
 #include "icmp.h"
 #include "lowpan.h"
+#include "nbr_cache.h"
 
 #include "net_help.h"
+#include "net_stats.h"
+#include "pktbuf.h"
+#include "pktchain.h"
+#include "pktring.h"
 
 #define ENABLE_DEBUG    (0)
 #if ENABLE_DEBUG
@@ -41,13 +48,11 @@ char addr_str[IPV6_MAX_ADDR_STR_LEN];
 #endif
 #include "debug.h"
 
-#define IP_PKT_RECV_BUF_SIZE        (64)
 #define LLHDR_IPV6HDR_LEN           (LL_HDR_LEN + IPV6_HDR_LEN)
 #define IPV6_NET_IF_ADDR_BUFFER_LEN (NET_IF_MAX * IPV6_NET_IF_ADDR_LIST_LEN)
 
 uint8_t ip_send_buffer[BUFFER_SIZE];
 uint8_t buffer[BUFFER_SIZE];
-msg_t ip_msg_queue[IP_PKT_RECV_BUF_SIZE];
 ipv6_hdr_t *ipv6_buf;
 icmpv6_hdr_t *icmp_buf;
 uint8_t *nextheader;
@@ -64,68 +69,91 @@ static uint8_t ipv6_net_if_addr_buffer_count = 0;
 
 static uint8_t default_hop_limit = MULTIHOP_HOPLIMIT;
 
+/* received packets in pktbuf, from lowpan_transfer to ip_process */
+static void *volatile ip_rx_slots[IPV6_RX_RING_SIZE];
+static pktring_t ip_rx_ring = PKTRING_INIT(ip_rx_slots);
+
+static ipv6_fwd_stats_t fwd_stats;
+static uint32_t fwd_rate_last_count;
+static timex_t fwd_rate_last_time;
+
+#ifdef MODULE_IPV6_FWD_QUEUE
+/* a packet waiting to be forwarded, allocated in pktbuf (hence packed) */
+typedef struct __attribute__((packed)) {
+    ipv6_addr_t next_hop;
+    uint8_t packet[];
+} ipv6_fwd_pkt_t;
+
+static char ip_fwd_buf[IP_FWD_STACKSIZE];
+static msg_t ip_fwd_msg_queue[IPV6_FWD_QUEUE_SIZE];
+static kernel_pid_t ip_fwd_pid = KERNEL_PID_UNDEF;
+#endif
+
 /* registered upper layer threads */
 kernel_pid_t sixlowip_reg[SIXLOWIP_MAX_REGISTERED];
 
 int ipv6_send_packet(ipv6_hdr_t *packet)
+{
+    pktchain_t payload;
+
+    return ipv6_send_chain(packet, pktchain_prepend(&payload,
+                                                    ((uint8_t *)packet) + IPV6_HDR_LEN,
+                                                    NTOHS(packet->length), NULL));
+}
+
+int ipv6_send_chain(ipv6_hdr_t *packet, const pktchain_t *payload)
 {
     uint16_t length = IPV6_HDR_LEN + NTOHS(packet->length);
-    ndp_neighbor_cache_t *nce;
+    ipv6_addr_t *dest = &packet->destaddr;
+    ipv6_ll_hop_t hop;
+    pktchain_t hdr;
+
+    NET_STATS_INC(NET_STATS_IPV6, tx);
 
     DEBUGF("Got a packet to send to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &packet->destaddr));
     ipv6_net_if_get_best_src_addr(&packet->srcaddr, &packet->destaddr);
 
-    if (!ipv6_addr_is_multicast(&packet->destaddr) &&
-        ndp_addr_is_on_link(&packet->destaddr)) {
-        /* not multicast, on-link */
-        nce = ndp_get_ll_address(&packet->destaddr);
-
-        if (nce == NULL || sixlowpan_lowpan_sendto(nce->if_id, &nce->lladdr,
-                nce->lladdr_len,
-                (uint8_t *)packet,
-                length) < 0) {
-            /* XXX: this is wrong, but until ND does work correctly,
-             *      this is the only way (aka the old way)*/
-            uint16_t raddr = NTOHS(packet->destaddr.uint16[7]);
-            sixlowpan_lowpan_sendto(0, &raddr, 2, (uint8_t *)packet, length);
-            /* return -1; */
-        }
-
-        return length;
+    if (ipv6_addr_is_multicast(&packet->destaddr)) {
+        /* if_id will be ignored */
+        uint16_t addr = 0xffff;
+        return sixlowpan_lowpan_sendto_chain(0, &addr, 2, packet,
+                                             payload);
     }
-    else {
-        /* see if dest should be routed to a different next hop */
-        if (ipv6_addr_is_multicast(&packet->destaddr)) {
-            /* if_id will be ignored */
-            uint16_t addr = 0xffff;
-            return sixlowpan_lowpan_sendto(0, &addr, 2, (uint8_t *)packet,
-                                           length);
-        }
 
+    if (!ndp_addr_is_on_link(&packet->destaddr)) {
+        /* see if dest should be routed to a different next hop */
         if (ip_get_next_hop == NULL) {
+            NET_STATS_INC(NET_STATS_IPV6, tx_dropped);
             return -1;
         }
 
         DEBUG("Trying to find the next hop for %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &packet->destaddr));
-        ipv6_addr_t *dest = ip_get_next_hop(&packet->destaddr);
+        dest = ip_get_next_hop(&packet->destaddr);
 
         if (dest == NULL) {
+            NET_STATS_INC(NET_STATS_IPV6, tx_dropped);
             return -1;
         }
+    }
 
-        nce = ndp_get_ll_address(dest);
+    /* the packet waits in the neighbor cache if dest must be resolved */
+    switch (nbr_cache_resolve(dest, pktchain_prepend(&hdr, packet, IPV6_HDR_LEN,
+                                                     payload), &hop)) {
+        case 1:
+            if (sixlowpan_lowpan_sendto_chain(hop.if_id, hop.addr, hop.addr_len,
+                                              packet, payload) < 0) {
+                NET_STATS_INC(NET_STATS_IPV6, tx_dropped);
+                return -1;
+            }
 
-        if (nce == NULL || sixlowpan_lowpan_sendto(nce->if_id, &nce->lladdr,
-                nce->lladdr_len,
-                (uint8_t *)packet, length) < 0) {
-            /* XXX: this is wrong, but until ND does work correctly,
-             *      this is the only way (aka the old way)*/
-            uint16_t raddr = dest->uint16[7];
-            sixlowpan_lowpan_sendto(0, &raddr, 2, (uint8_t *)packet, length);
-            /* return -1; */
-        }
+            return length;
+
+        case 0:
+            return length;
 
-        return length;
+        default:
+            NET_STATS_INC(NET_STATS_IPV6, tx_dropped);
+            return -1;
     }
 }
 
@@ -157,29 +185,28 @@ uint8_t *get_payload_buf(uint8_t ext_len)
 int ipv6_sendto(const ipv6_addr_t *dest, uint8_t next_header,
                 const uint8_t *payload, uint16_t payload_length)
 {
-    uint8_t *p_ptr;
+    pktchain_t node;
 
-    if (next_header == IPV6_PROTO_NUM_TCP) {
-        p_ptr = get_payload_buf_send(ipv6_ext_hdr_len);
-        ipv6_buf = ipv6_get_buf_send();
-    }
-    else {
-        ipv6_buf = ipv6_get_buf();
-        p_ptr = get_payload_buf(ipv6_ext_hdr_len);
-    }
+    return ipv6_sendto_chain(dest, next_header,
+                             pktchain_prepend(&node, payload, payload_length,
+                                              NULL));
+}
 
-    ipv6_buf->version_trafficclass = IPV6_VER;
-    ipv6_buf->trafficclass_flowlabel = 0;
-    ipv6_buf->flowlabel = 0;
-    ipv6_buf->nextheader = next_header;
-    ipv6_buf->hoplimit = MULTIHOP_HOPLIMIT;
-    ipv6_buf->length = HTONS(payload_length);
+int ipv6_sendto_chain(const ipv6_addr_t *dest, uint8_t next_header,
+                      const pktchain_t *payload)
+{
+    ipv6_hdr_t header;
 
-    memcpy(&(ipv6_buf->destaddr), dest, 16);
+    header.version_trafficclass = IPV6_VER;
+    header.trafficclass_flowlabel = 0;
+    header.flowlabel = 0;
+    header.nextheader = next_header;
+    header.hoplimit = MULTIHOP_HOPLIMIT;
+    header.length = HTONS(pktchain_len(payload));
 
-    memcpy(p_ptr, payload, payload_length);
+    memcpy(&(header.destaddr), dest, 16);
 
-    return ipv6_send_packet(ipv6_buf);
+    return ipv6_send_chain(&header, payload);
 }
 
 void ipv6_set_default_hop_limit(uint8_t hop_limit)
@@ -347,21 +374,216 @@ static int is_our_address(ipv6_addr_t *addr)
     return -1;
 }
 
+void ipv6_get_fwd_stats(ipv6_fwd_stats_t *stats)
+{
+    *stats = fwd_stats;
+}
+
+uint32_t ipv6_get_fwd_rate(void)
+{
+    timex_t now, elapsed;
+    uint32_t count = fwd_stats.forwarded;
+    uint64_t us;
+
+    vtimer_now(&now);
+    elapsed = timex_sub(now, fwd_rate_last_time);
+    us = timex_uint64(elapsed);
+
+    uint32_t rate = (us == 0) ? 0 :
+                    (uint32_t)(((uint64_t)(count - fwd_rate_last_count) * SEC_IN_USEC) / us);
+
+    fwd_rate_last_count = count;
+    fwd_rate_last_time = now;
+
+    return rate;
+}
+
+/* hands a packet to be forwarded to 6LoWPAN, packet may be modified */
+static void ipv6_fwd_send(ipv6_addr_t *dest, uint8_t *packet, uint16_t packet_length)
+{
+    ipv6_ll_hop_t hop;
+    pktchain_t chain;
+    int res;
+
+    NET_STATS_INC(NET_STATS_IPV6, tx);
+
+    res = nbr_cache_resolve(dest, pktchain_prepend(&chain, packet, packet_length,
+                                                   NULL), &hop);
+
+    if (res > 0) {
+        res = sixlowpan_lowpan_sendto(hop.if_id, hop.addr, hop.addr_len,
+                                      packet, packet_length);
+        ipv6_fwd_count(res);
+    }
+
+    if (res < 0) {
+        NET_STATS_INC(NET_STATS_IPV6, tx_dropped);
+    }
+
+    /* a packet queued for address resolution is not counted, the neighbor
+     * cache cannot tell forwarded from own packets when it sends it */
+}
+
+void ipv6_fwd_count(int res)
+{
+    if (res < 0) {
+        fwd_stats.send_failed++;
+    }
+    else {
+        fwd_stats.forwarded++;
+    }
+}
+
+int ipv6_fwd_get_ll_hop(ipv6_addr_t *destaddr, ipv6_ll_hop_t *hop)
+{
+    ipv6_addr_t *dest = destaddr;
+
+    if (ipv6_addr_is_multicast(destaddr) || (is_our_address(destaddr) != 0)) {
+        return 0;
+    }
+
+    if (ip_get_next_hop != NULL) {
+        dest = ip_get_next_hop(destaddr);
+    }
+
+    /* unresolved neighbors are left to ipv6_process() as well, the packet
+     * waits for the resolution there */
+    if ((dest == NULL) || (nbr_cache_resolve(dest, NULL, hop) <= 0)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+#ifdef MODULE_IPV6_FWD_QUEUE
+static void *ipv6_fwd_process(void *arg)
+{
+    (void) arg;
+
+    msg_t m_recv;
+
+    msg_init_queue(ip_fwd_msg_queue, IPV6_FWD_QUEUE_SIZE);
+
+    while (1) {
+        msg_receive(&m_recv);
+
+        ipv6_fwd_pkt_t *pkt = (ipv6_fwd_pkt_t *) m_recv.content.ptr;
+        ipv6_hdr_t *hdr = (ipv6_hdr_t *) pkt->packet;
+        ipv6_addr_t next_hop;
+
+        /* pktbuf does not align its packets */
+        memcpy(&next_hop, &pkt->next_hop, sizeof(ipv6_addr_t));
+
+        /* sent in place, the packet is copied only once on reception */
+        ipv6_fwd_send(&next_hop, pkt->packet, IPV6_HDR_LEN + NTOHS(hdr->length));
+        pktbuf_release(pkt);
+    }
+
+    return NULL;
+}
+
+/*
+ * Copies the received packet with room for the next hop, so ip_process can go
+ * on with the next one while this packet waits for the forwarding thread.
+ */
+static void ipv6_fwd_enqueue(ipv6_addr_t *dest, ipv6_hdr_t *packet,
+                             uint16_t packet_length)
+{
+    msg_t m_send;
+
+    /* one spare byte, 6LoWPAN prepends the dispatch in place if IPHC is off */
+    ipv6_fwd_pkt_t *pkt = pktbuf_alloc(sizeof(ipv6_fwd_pkt_t) + packet_length + 1);
+
+    if (pkt == NULL) {
+        DEBUG("!!! No buffer left for packet to forward.\n");
+        fwd_stats.no_buffer++;
+        NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
+        return;
+    }
+
+    memcpy(&pkt->next_hop, dest, sizeof(ipv6_addr_t));
+    memcpy(pkt->packet, packet, packet_length);
+
+    m_send.content.ptr = (char *) pkt;
+
+    if (msg_try_send(&m_send, ip_fwd_pid) != 1) {
+        DEBUG("!!! Forwarding queue is full.\n");
+        fwd_stats.no_buffer++;
+        NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
+        pktbuf_release(pkt);
+    }
+}
+#endif
+
+int ipv6_rx_enqueue(ipv6_hdr_t *packet)
+{
+    if (pktring_put(&ip_rx_ring, packet) < 0) {
+        return -1;
+    }
+
+    if (thread_getstatus(ip_process_pid) == STATUS_SLEEPING) {
+        thread_wakeup(ip_process_pid);
+    }
+
+    return 0;
+}
+
+ipv6_hdr_t *ipv6_rx_dequeue(void)
+{
+    ipv6_hdr_t *packet;
+
+    while (1) {
+        unsigned state = disableIRQ();
+
+        /* ipv6_rx_enqueue wakes us up only if we are already sleeping */
+        if (pktring_avail(&ip_rx_ring) == 0) {
+            thread_sleep();
+        }
+
+        restoreIRQ(state);
+
+        if ((packet = pktring_get(&ip_rx_ring)) != NULL) {
+            return packet;
+        }
+    }
+}
+
+ipv6_hdr_t *ipv6_rx_to_buf(ipv6_hdr_t *packet)
+{
+    ipv6_hdr_t *rx_buf = ipv6_get_buf();
+
+    if (packet != rx_buf) {
+        memcpy(rx_buf, packet, IPV6_HDR_LEN + NTOHS(packet->length));
+    }
+
+    return rx_buf;
+}
+
 void *ipv6_process(void *arg)
 {
     (void) arg;
 
-    msg_t m_recv_lowpan, m_send_lowpan;
     msg_t m_recv, m_send;
     uint8_t i;
     uint16_t packet_length;
+    ipv6_hdr_t *packet;
 
-    msg_init_queue(ip_msg_queue, IP_PKT_RECV_BUF_SIZE);
+    vtimer_now(&fwd_rate_last_time);
+
+#ifdef MODULE_IPV6_FWD_QUEUE
+    if (ip_fwd_pid == KERNEL_PID_UNDEF) {
+        ip_fwd_pid = thread_create(ip_fwd_buf, IP_FWD_STACKSIZE, PRIORITY_MAIN - 1,
+                                   CREATE_STACKTEST, ipv6_fwd_process, NULL, "ip_fwd");
+    }
+#endif
 
     while (1) {
-        msg_receive(&m_recv_lowpan);
+        packet = ipv6_rx_dequeue();
+
+        unsigned long start = net_stats_start();
+        NET_STATS_INC(NET_STATS_IPV6, rx);
 
-        ipv6_buf = (ipv6_hdr_t *)m_recv_lowpan.content.ptr;
+        ipv6_buf = packet;
 
         /* identifiy packet */
         nextheader = &ipv6_buf->nextheader;
@@ -370,7 +592,8 @@ void *ipv6_process(void *arg)
             if (sixlowip_reg[i]) {
                 msg_t m_send;
                 m_send.type = IPV6_PACKET_RECEIVED;
-                m_send.content.ptr = (char *) ipv6_buf;
+                /* they read it asynchronously, from the receive buffer */
+                m_send.content.ptr = (char *) ipv6_rx_to_buf(packet);
                 msg_send(&m_send, sixlowip_reg[i]);
             }
         }
@@ -379,19 +602,25 @@ void *ipv6_process(void *arg)
 
         /* no address configured for this node so far, exit early */
         if (addr_match < 0) {
-            msg_reply(&m_recv_lowpan, &m_send_lowpan);
+            NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
+            net_stats_latency(NET_STATS_IPV6, start);
+            pktbuf_release(packet);
             continue;
         }
         /* destination is our address */
         else if (addr_match) {
             switch (*nextheader) {
                 case (IPV6_PROTO_NUM_ICMPV6): {
+                    /* ICMPv6 works on the receive buffer and answers in place */
+                    ipv6_buf = ipv6_rx_to_buf(packet);
+                    nextheader = &ipv6_buf->nextheader;
                     icmp_buf = get_icmpv6_buf(ipv6_ext_hdr_len);
 
                     /* checksum test*/
                     if (ipv6_csum(ipv6_buf, (uint8_t *) icmp_buf, NTOHS(ipv6_buf->length),
                                   IPV6_PROTO_NUM_ICMPV6) != 0xffff) {
                         DEBUG("ERROR: wrong checksum\n");
+                        NET_STATS_INC(NET_STATS_IPV6, csum_errors);
                     }
 
                     icmpv6_demultiplex(icmp_buf);
@@ -405,6 +634,7 @@ void *ipv6_process(void *arg)
                     }
                     else {
                         DEBUG("INFO: No TCP handler registered.\n");
+                        NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
                     }
 
                     break;
@@ -417,6 +647,7 @@ void *ipv6_process(void *arg)
                     }
                     else {
                         DEBUG("INFO: No UDP handler registered.\n");
+                        NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
                     }
 
                     break;
@@ -429,6 +660,7 @@ void *ipv6_process(void *arg)
 
                 default:
                     DEBUG("INFO: Unknown next header\n");
+                    NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
                     break;
             }
         }
@@ -436,7 +668,6 @@ void *ipv6_process(void *arg)
         else {
             DEBUG("That's not for me, destination is %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &ipv6_buf->destaddr));
             packet_length = IPV6_HDR_LEN + NTOHS(ipv6_buf->length);
-            ndp_neighbor_cache_t *nce;
 
             ipv6_addr_t *dest;
 
@@ -447,33 +678,37 @@ void *ipv6_process(void *arg)
                 dest = ip_get_next_hop(&ipv6_buf->destaddr);
             }
 
-            if ((dest == NULL) || ((--ipv6_buf->hoplimit) == 0)) {
+            if (dest == NULL) {
                 DEBUG("!!! Packet not for me, routing handler is set, but I "\
-                      " have no idea where to send or the hop limit is exceeded.\n");
-                msg_reply(&m_recv_lowpan, &m_send_lowpan);
+                      " have no idea where to send.\n");
+                fwd_stats.no_route++;
+                NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
+                net_stats_latency(NET_STATS_IPV6, start);
+                pktbuf_release(packet);
                 continue;
             }
 
-            nce = ndp_get_ll_address(dest);
+            if ((--ipv6_buf->hoplimit) == 0) {
+                DEBUG("!!! Packet not for me, hop limit is exceeded.\n");
+                fwd_stats.hop_limit_exceeded++;
+                NET_STATS_INC(NET_STATS_IPV6, rx_dropped);
+                net_stats_latency(NET_STATS_IPV6, start);
+                pktbuf_release(packet);
+                continue;
+            }
 
+#ifdef MODULE_IPV6_FWD_QUEUE
+            ipv6_fwd_enqueue(dest, ipv6_buf, packet_length);
+#else
             /* copy received packet to send buffer */
-            memcpy(ipv6_get_buf_send(), ipv6_get_buf(), packet_length);
-
-            /* send packet to node ID derived from dest IP */
-            if (nce != NULL) {
-                sixlowpan_lowpan_sendto(nce->if_id, &nce->lladdr,
-                                        nce->lladdr_len,
-                                        (uint8_t *)ipv6_get_buf_send(),
-                                        packet_length);
-            } else {
-                /* XXX: this is wrong, but until ND does work correctly,
-                 *      this is the only way (aka the old way)*/
-                uint16_t raddr = dest->uint16[7];
-                sixlowpan_lowpan_sendto(0, &raddr, 2, (uint8_t *)ipv6_get_buf_send(), packet_length);
-            }
+            memcpy(ipv6_get_buf_send(), ipv6_buf, packet_length);
+
+            ipv6_fwd_send(dest, (uint8_t *)ipv6_get_buf_send(), packet_length);
+#endif
         }
 
-        msg_reply(&m_recv_lowpan, &m_send_lowpan);
+        net_stats_latency(NET_STATS_IPV6, start);
+        pktbuf_release(packet);
     }
 }
 
@@ -820,3 +1055,13 @@ uint16_t ipv6_csum(ipv6_hdr_t *ipv6_header, uint8_t *buf, uint16_t len, uint8_t
     sum = csum(sum, buf, len);
     return (sum == 0) ? 0xffff : HTONS(sum);
 }
+
+uint16_t ipv6_csum_chain(ipv6_hdr_t *ipv6_header, const pktchain_t *chain,
+                         uint8_t proto)
+{
+    uint16_t sum = pktchain_len(chain) + proto;
+
+    sum = csum(sum, (uint8_t *)&ipv6_header->srcaddr, 2 * sizeof(ipv6_addr_t));
+    sum = pktchain_csum(sum, chain);
+    return (sum == 0) ? 0xffff : HTONS(sum);
+}
@@ -43,6 +43,19 @@
 #define SIXLOWIP_MAX_REGISTERED     (4)
 #define IP_PROCESS_STACKSIZE        (KERNEL_CONF_STACKSIZE_MAIN)
 
+#ifndef IPV6_RX_RING_SIZE
+/* received packets waiting for ipv6_process(), must be a power of two */
+#define IPV6_RX_RING_SIZE           (8)
+#endif
+
+#ifdef MODULE_IPV6_FWD_QUEUE
+#define IP_FWD_STACKSIZE            (KERNEL_CONF_STACKSIZE_MAIN)
+#ifndef IPV6_FWD_QUEUE_SIZE
+/* number of packets waiting to be forwarded, must be a power of two */
+#define IPV6_FWD_QUEUE_SIZE         (8)
+#endif
+#endif
+
 /* extern variables */
 extern uint8_t ipv6_ext_hdr_len;
 extern kernel_pid_t ip_process_pid;
@@ -84,6 +97,13 @@ typedef struct __attribute__((packed)) {
     uint32_t adv_retrans_timer;
 } ipv6_net_if_ext_t;
 
+/* link layer next hop */
+typedef struct {
+    int if_id;
+    uint8_t addr_len;
+    uint8_t addr[8];
+} ipv6_ll_hop_t;
+
 /* function prototypes */
 ipv6_net_if_ext_t *ipv6_net_if_get_ext(int if_id);
 
@@ -99,4 +119,27 @@ ipv6_net_if_hit_t *ipv6_net_if_addr_match(ipv6_net_if_hit_t *hit, const ipv6_add
 uint32_t get_remaining_time(timex_t *t);
 void set_remaining_time(timex_t *t, uint32_t time);
 
+/* Hands a received packet in pktbuf to ipv6_process(), which releases it.
+ * May only be called from the 6LoWPAN receive thread. Returns -1 if the
+ * queue is full. */
+int ipv6_rx_enqueue(ipv6_hdr_t *packet);
+
+/* Waits for the next packet handed over by ipv6_rx_enqueue(), the caller
+ * releases it. Only for the thread of ip_process_pid. */
+ipv6_hdr_t *ipv6_rx_dequeue(void);
+
+/* Copies a received packet to the buffer of ipv6_get_buf(), ICMPv6 works on
+ * that buffer and answers in place. */
+ipv6_hdr_t *ipv6_rx_to_buf(ipv6_hdr_t *packet);
+
+/* Looks up the link layer next hop for a packet to destaddr this node
+ * forwards. Returns 0 if the packet is for this
+ * node, multicast, there is no route or the next hop is not resolved yet,
+ * it is left to ipv6_process() then. */
+int ipv6_fwd_get_ll_hop(ipv6_addr_t *destaddr, ipv6_ll_hop_t *hop);
+
+/* Counts a forwarded packet as forwarded or, if res is negative, as failed
+ * to send, res is the result of the send function. */
+void ipv6_fwd_count(int res);
+
 #endif /* _SIXLOWPAN_IP_H*/
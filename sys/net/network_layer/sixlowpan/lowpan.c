@@ -19,12 +19,14 @@
  */
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <errno.h>
 
+#include "irq.h"
 #include "vtimer.h"
 #include "timex.h"
 #include "thread.h"
@@ -41,10 +43,15 @@
 #endif
 #include "ip.h"
 #include "icmp.h"
+#include "nbr_cache.h"
+#include "reas.h"
 
 #include "ieee802154_frame.h"
 #include "socket_base/in.h"
 #include "net_help.h"
+#include "net_stats.h"
+#include "pktbuf.h"
+#include "pktring.h"
 
 #define ENABLE_DEBUG    (0)
 #if ENABLE_DEBUG
@@ -58,73 +65,86 @@ char addr_str[IPV6_MAX_ADDR_STR_LEN];
 
 #define SIXLOWPAN_MAX_REGISTERED        (4)
 
-#define LOWPAN_REAS_BUF_TIMEOUT         (15 * 1000 * 1000)
-/* TODO: Set back to 3 * 1000 * (1000) */
-
 #define IPV6_LL_ADDR_LEN                (8)
 
 #define SIXLOWPAN_FRAG_HDR_MASK         (0xf8)
 
-typedef struct lowpan_interval_list_t {
-    uint8_t                         start;
-    uint8_t                         end;
-    struct lowpan_interval_list_t   *next;
-} lowpan_interval_list_t;
-
-/**
- * @brief   6LoWPAN reassembly buffer.
- *
- * @see <a href="http://tools.ietf.org/html/rfc4944#section-5.3">
- *          RFC 4944, section 5.3
- *      </a>
- */
-typedef struct lowpan_reas_buf_t {
-    net_if_eui64_t s_addr;      ///< Source address
-    net_if_eui64_t d_addr;      ///< Destination address
-    uint16_t tag;               ///< Fragment tag
-    timex_t timestamp;          ///< Timestamp of last packet fragment
-    /**
-     * @brief   Size of reassembled packet with possible IPHC header
-     */
-    uint16_t packet_size;
-    /**
-     * @brief   Additive size of currently already received fragments
-     */
-    uint16_t current_packet_size;
-    /**
-     * @brief   Pointer to allocated memory for reassembled packet + 6LoWPAN
-     *          Dispatch Byte
-     */
-    uint8_t *packet;
-    /**
-     * @brief   Pointer to list of intervals of received packet fragments
-     *          (if any)
-     */
-    lowpan_interval_list_t *interval_list_head;
-    struct lowpan_reas_buf_t *next;
-} lowpan_reas_buf_t;
-
 extern mutex_t lowpan_context_mutex;
 uint16_t tag = 0;
-uint8_t max_frag_initial = 0;
-uint8_t max_frag;
 
-static uint16_t packet_length;
 static sixlowpan_lowpan_iphc_status_t iphc_status = LOWPAN_IPHC_ENABLE;
 static ipv6_hdr_t *ipv6_buf;
-static lowpan_reas_buf_t *head = NULL;
-static lowpan_reas_buf_t *packet_fifo = NULL;
+/* complete datagrams, from the MAC thread to lowpan_transfer */
+static void *volatile lowpan_rx_slots[LOWPAN_RX_RING_SIZE];
+static pktring_t lowpan_rx_ring = PKTRING_INIT(lowpan_rx_slots);
+static sixlowpan_lowpan_frag_stats_t frag_stats;
+
+#ifdef MODULE_SIXLOWPAN_FRAG_QUEUE
+/* a datagram waiting to be fragmented, allocated in pktbuf (hence packed) */
+typedef struct __attribute__((packed)) {
+    kernel_pid_t sender;        ///< thread to notify, KERNEL_PID_UNDEF if none
+    int if_id;
+    uint8_t dest[8];
+    uint8_t dest_len;
+    uint8_t mcast;
+    uint8_t max_frame;
+    uint8_t uncompressed;       ///< starts with the IPv6 dispatch
+    uint16_t tag;
+    uint16_t data_len;          ///< length of the IPv6 packet
+    uint16_t len;
+    uint8_t datagram[];
+} lowpan_frag_dgram_t;
+
+static char lowpan_frag_buf[LOWPAN_FRAG_STACKSIZE];
+static msg_t lowpan_frag_msg_queue[LOWPAN_FRAG_QUEUE_SIZE];
+static kernel_pid_t lowpan_frag_pid = KERNEL_PID_UNDEF;
+static uint32_t frag_pacing = LOWPAN_FRAG_PACING;
+
+/* threads notified about their fragmented datagrams */
+static kernel_pid_t frag_reg[SIXLOWPAN_MAX_REGISTERED];
+#endif
+
+#ifdef MODULE_SIXLOWPAN_FRAG_FWD
+#ifndef LOWPAN_FRAG_FWD_NUMOF
+/* datagrams relayed at the same time */
+#define LOWPAN_FRAG_FWD_NUMOF           (4)
+#endif
+
+/* a datagram whose fragments are relayed without reassembly */
+typedef struct {
+    net_if_eui64_t s_addr;      ///< previous hop
+    uint16_t tag;               ///< tag towards this node
+    uint16_t size;              ///< datagram size
+    uint16_t new_tag;           ///< tag towards the next hop
+    uint16_t remaining;         ///< bytes not relayed yet, 0 if unused
+    uint32_t timestamp;         ///< last fragment (in s)
+    ipv6_ll_hop_t hop;          ///< next hop
+} lowpan_frag_fwd_t;
+
+static lowpan_frag_fwd_t frag_fwd[LOWPAN_FRAG_FWD_NUMOF];
+
+/* set while a datagram that gets fragmented is compressed, its header is
+ * then kept independent of the link so routers can relay the first fragment
+ * as it is */
+static uint8_t iphc_relayable = 0;
+#else
+#define iphc_relayable                  (0)
+#endif
+
+/* IPHC dispatch, CID, TF, NH, HLIM and both addresses inline */
+#define LOWPAN_IPHC_MAX_HDR_LEN         (2 + 1 + 4 + 1 + 1 + 16 + 16)
 
-/* length of compressed packet */
+/* a fragment of the largest frame, the first fragment of an uncompressed
+ * datagram carries the IPv6 dispatch in addition */
+#define LOWPAN_FRAG_BUF_SIZE            (PAYLOAD_SIZE + 1)
+
+/* length of compressed header */
 uint16_t comp_len;
 uint8_t frag_size;
-uint8_t reas_buf[512];
-uint8_t comp_buf[512];
+uint8_t comp_buf[LOWPAN_IPHC_MAX_HDR_LEN];
 uint8_t first_frag = 0;
-mutex_t fifo_mutex = MUTEX_INIT;
 
 kernel_pid_t ip_process_pid = KERNEL_PID_UNDEF;
-kernel_pid_t nd_nbr_cache_rem_pid = KERNEL_PID_UNDEF;
 kernel_pid_t contexts_rem_pid = KERNEL_PID_UNDEF;
 kernel_pid_t transfer_pid = KERNEL_PID_UNDEF;
 
@@ -143,26 +163,227 @@ uint16_t local_address = 0;
 
 int lowpan_init(int as_border);
 uint8_t lowpan_iphc_encoding(int if_id, const uint8_t *dest, int dest_len,
-                             ipv6_hdr_t *ipv6_buf_extra, uint8_t *ptr);
-void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
-                          net_if_eui64_t *d_addr);
-void add_fifo_packet(lowpan_reas_buf_t *current_packet);
-lowpan_reas_buf_t *collect_garbage_fifo(lowpan_reas_buf_t *current_buf);
-lowpan_reas_buf_t *collect_garbage(lowpan_reas_buf_t *current_buf);
-void init_reas_bufs(lowpan_reas_buf_t *buf);
-void check_timeout(void);
+                             ipv6_hdr_t *ipv6_buf_extra);
+static uint8_t lowpan_iphc_decode_hdr(ipv6_hdr_t *hdr, const uint8_t *data,
+                                      const net_if_eui64_t *s_addr,
+                                      const net_if_eui64_t *d_addr,
+                                      uint8_t *hlim_pos);
 void print_long_local_addr(net_if_eui64_t *saddr);
 
 lowpan_context_t *lowpan_context_lookup(ipv6_addr_t *addr);
 
+/* Sends the fragments of the datagram in chain one after the other, pausing
+ * pacing us between two. Gives up the rest if one cannot be sent. */
+static int lowpan_send_fragments(int if_id, const void *dest, int dest_len,
+                                 const pktchain_t *chain, uint16_t len,
+                                 uint8_t max_frame, uint8_t uncompressed,
+                                 uint16_t dgram_tag, uint8_t mcast,
+                                 uint32_t pacing)
+{
+    uint8_t fragbuf[LOWPAN_FRAG_BUF_SIZE];
+    uint16_t datagram_size = len;
+    /* first fragment */
+    uint16_t position = ((max_frame - SIXLOWPAN_FRAG1_HDR_LEN) / 8) * 8;
+    /* subsequent fragments */
+    uint8_t max_frag = ((max_frame - SIXLOWPAN_FRAGN_HDR_LEN) / 8) * 8;
+
+    if (uncompressed) {
+        /* XXX: weird, but only this way we get correct packet output */
+        position++;
+        datagram_size--;
+    }
+
+    pktchain_gather(chain, 0, &fragbuf[SIXLOWPAN_FRAG1_HDR_LEN], position);
+
+    fragbuf[0] = ((SIXLOWPAN_FRAG1_DISPATCH << 8) | datagram_size) >> 8;
+    fragbuf[1] = (SIXLOWPAN_FRAG1_DISPATCH << 8) | datagram_size;
+    fragbuf[2] = dgram_tag >> 8;
+    fragbuf[3] = dgram_tag;
+
+    if (sixlowpan_mac_send_ieee802154_frame(if_id, dest, dest_len, fragbuf,
+                                            position + SIXLOWPAN_FRAG1_HDR_LEN,
+                                            mcast) < 0) {
+        frag_stats.aborted++;
+        return -1;
+    }
+
+    frag_stats.fragments++;
+
+    /* the header only differs in the offset from here on */
+    fragbuf[0] = ((SIXLOWPAN_FRAGN_DISPATCH << 8) | datagram_size) >> 8;
+    fragbuf[1] = (SIXLOWPAN_FRAGN_DISPATCH << 8) | datagram_size;
+
+    while (position < len) {
+        /* the last fragment need not be a multiple of 8 */
+        uint8_t frag_len = ((len - position) > (max_frame - SIXLOWPAN_FRAGN_HDR_LEN)) ?
+                           max_frag : (len - position);
+
+        if (pacing) {
+            vtimer_usleep(pacing);
+        }
+
+        fragbuf[4] = position / 8;
+        pktchain_gather(chain, position, &fragbuf[SIXLOWPAN_FRAGN_HDR_LEN],
+                        frag_len);
+
+        if (sixlowpan_mac_send_ieee802154_frame(if_id, dest, dest_len, fragbuf,
+                                                frag_len + SIXLOWPAN_FRAGN_HDR_LEN,
+                                                mcast) < 0) {
+            DEBUG("fragment at %u of tag %u failed, aborting\n", position,
+                  dgram_tag);
+            frag_stats.aborted++;
+            return -1;
+        }
+
+        frag_stats.fragments++;
+        position += frag_len;
+    }
+
+    frag_stats.datagrams++;
+    return 0;
+}
+
+#ifdef MODULE_SIXLOWPAN_FRAG_QUEUE
+static void *lowpan_frag_process(void *arg)
+{
+    (void) arg;
+
+    msg_t m_recv, m_send;
+    pktchain_t chain;
+
+    msg_init_queue(lowpan_frag_msg_queue, LOWPAN_FRAG_QUEUE_SIZE);
+
+    while (1) {
+        msg_receive(&m_recv);
+
+        lowpan_frag_dgram_t *dgram = (lowpan_frag_dgram_t *) m_recv.content.ptr;
+
+        int res = lowpan_send_fragments(dgram->if_id, dgram->dest,
+                                        dgram->dest_len,
+                                        pktchain_prepend(&chain, dgram->datagram,
+                                                         dgram->len, NULL),
+                                        dgram->len, dgram->max_frame,
+                                        dgram->uncompressed, dgram->tag,
+                                        dgram->mcast, frag_pacing);
+
+        if (res < 0) {
+            NET_STATS_INC(NET_STATS_LOWPAN, tx_dropped);
+        }
+
+        if (dgram->sender != KERNEL_PID_UNDEF) {
+            m_send.type = LOWPAN_FRAG_SENT;
+            m_send.content.value = (res < 0) ? 0 : dgram->data_len;
+            msg_try_send(&m_send, dgram->sender);
+        }
+
+        pktbuf_release(dgram);
+    }
+
+    return NULL;
+}
+
+/* copies the datagram so the caller can go on while it is fragmented */
+static int lowpan_frag_enqueue(int if_id, const void *dest, int dest_len,
+                               const pktchain_t *chain, uint16_t len,
+                               uint8_t max_frame, uint8_t uncompressed,
+                               uint8_t mcast, uint16_t data_len)
+{
+    msg_t m_send;
+    kernel_pid_t sender = thread_getpid();
+    lowpan_frag_dgram_t *dgram = pktbuf_alloc(sizeof(lowpan_frag_dgram_t) + len);
+
+    if (dgram == NULL) {
+        DEBUG("no buffer left for datagram to fragment\n");
+        frag_stats.queue_full++;
+        return -1;
+    }
+
+    dgram->sender = KERNEL_PID_UNDEF;
+
+    for (int i = 0; i < SIXLOWPAN_MAX_REGISTERED; i++) {
+        if (frag_reg[i] == sender) {
+            dgram->sender = sender;
+            break;
+        }
+    }
+
+    dgram->if_id = if_id;
+    dgram->dest_len = dest_len;
+    memcpy(dgram->dest, dest, dest_len);
+    dgram->mcast = mcast;
+    dgram->max_frame = max_frame;
+    dgram->uncompressed = uncompressed;
+    dgram->tag = tag++;
+    dgram->data_len = data_len;
+    dgram->len = len;
+    pktchain_gather(chain, 0, dgram->datagram, len);
+
+    m_send.content.ptr = (char *) dgram;
+
+    if (msg_try_send(&m_send, lowpan_frag_pid) != 1) {
+        DEBUG("fragmentation queue is full\n");
+        frag_stats.queue_full++;
+        pktbuf_release(dgram);
+        return -1;
+    }
+
+    return 0;
+}
+
+uint8_t sixlowpan_lowpan_frag_register(kernel_pid_t pid)
+{
+    for (int i = 0; i < SIXLOWPAN_MAX_REGISTERED; i++) {
+        if ((frag_reg[i] == pid) || (frag_reg[i] == 0)) {
+            frag_reg[i] = pid;
+            return 1;
+        }
+    }
+
+    return ENOMEM;
+}
+
+void sixlowpan_lowpan_set_frag_pacing(uint32_t us)
+{
+    frag_pacing = us;
+}
+#endif
+
+void sixlowpan_lowpan_get_frag_stats(sixlowpan_lowpan_frag_stats_t *stats)
+{
+    *stats = frag_stats;
+}
+
 /* deliver packet to mac*/
 int sixlowpan_lowpan_sendto(int if_id, const void *dest, int dest_len,
                             uint8_t *data, uint16_t data_len)
+{
+    pktchain_t payload;
+
+    if (data_len < IPV6_HDR_LEN) {
+        return -1;
+    }
+
+    return sixlowpan_lowpan_sendto_chain(if_id, dest, dest_len,
+                                         (ipv6_hdr_t *)data,
+                                         pktchain_prepend(&payload,
+                                                          data + IPV6_HDR_LEN,
+                                                          data_len - IPV6_HDR_LEN,
+                                                          NULL));
+}
+
+int sixlowpan_lowpan_sendto_chain(int if_id, const void *dest, int dest_len,
+                                  ipv6_hdr_t *header, const pktchain_t *payload)
 {
     uint8_t mcast = 0;
+    uint8_t dispatch = SIXLOWPAN_IPV6_DISPATCH;
+    pktchain_t hdr_node, dispatch_node;
+    const pktchain_t *chain;
+    uint16_t data_len = IPV6_HDR_LEN + pktchain_len(payload);
+    uint16_t send_packet_length;
+
+    ipv6_buf = header;
 
-    ipv6_buf = (ipv6_hdr_t *) data;
-    uint16_t send_packet_length = data_len;
+    NET_STATS_INC(NET_STATS_LOWPAN, tx);
 
     if (ipv6_addr_is_multicast(&ipv6_buf->destaddr)) {
         /* send broadcast */
@@ -184,34 +405,40 @@ int sixlowpan_lowpan_sendto(int if_id, const void *dest, int dest_len,
 
     DEBUG("data: \n");
 
-    for (int i = 0; i < data_len; i++) {
-        printf("%02x ", data[i]);
+    for (int i = 0; i < IPV6_HDR_LEN; i++) {
+        printf("%02x ", ((uint8_t *)header)[i]);
+    }
 
-        if (!((i + 1) % 16) || i == data_len - 1) {
-            printf("\n");
+    for (chain = payload; chain != NULL; chain = chain->next) {
+        for (size_t i = 0; i < chain->len; i++) {
+            printf("%02x ", ((const uint8_t *)chain->data)[i]);
         }
     }
 
+    printf("\n");
 #endif
 
-
     if (iphc_status == LOWPAN_IPHC_ENABLE) {
-        if (!lowpan_iphc_encoding(if_id, dest, dest_len, ipv6_buf, data)) {
+#ifdef MODULE_SIXLOWPAN_FRAG_FWD
+        iphc_relayable = (data_len > PAYLOAD_SIZE - IEEE_802154_MAX_HDR_LEN);
+#endif
+
+        if (!lowpan_iphc_encoding(if_id, dest, dest_len, ipv6_buf)) {
+            NET_STATS_INC(NET_STATS_LOWPAN, tx_dropped);
             return -1;
         }
 
-        data = &comp_buf[0];
-        send_packet_length = comp_len;
+        /* the compressed header replaces the IPv6 header */
+        chain = pktchain_prepend(&hdr_node, comp_buf, comp_len, payload);
     }
     else {
-        memmove(data + 1, data, data_len);
-        data[0] = SIXLOWPAN_IPV6_DISPATCH;
-        send_packet_length++;
+        chain = pktchain_prepend(&hdr_node, header, IPV6_HDR_LEN, payload);
+        chain = pktchain_prepend(&dispatch_node, &dispatch, 1, chain);
     }
 
+    send_packet_length = pktchain_len(chain);
+
     if (send_packet_length > PAYLOAD_SIZE - IEEE_802154_MAX_HDR_LEN) {
-        uint16_t remaining;
-        uint16_t position, datagram_size = send_packet_length;
         uint8_t max_frame;
 
         if (net_if_get_interface(if_id)->transceivers & (IEEE802154_TRANSCEIVER)) {
@@ -221,73 +448,25 @@ int sixlowpan_lowpan_sendto(int if_id, const void *dest, int dest_len,
             max_frame = PAYLOAD_SIZE - IEEE_802154_MAX_HDR_LEN;
         }
 
-        uint8_t fragbuf[max_frame + 5];
-
-        /* first fragment */
-        max_frag_initial = ((max_frame - 4) / 8) * 8;
-
-        if (data[0] == (char)SIXLOWPAN_IPV6_DISPATCH) {
-            /* XXX: weird, but only this way we get correct packet output */
-            max_frag_initial++;
-            datagram_size--;
-        }
-
-        memcpy(&fragbuf[4], data, max_frag_initial);
-
-        fragbuf[0] = ((SIXLOWPAN_FRAG1_DISPATCH << 8) | datagram_size) >> 8;
-        fragbuf[1] = (SIXLOWPAN_FRAG1_DISPATCH << 8) | datagram_size;
-        fragbuf[2] = tag >> 8;
-        fragbuf[3] = tag;
-
-        sixlowpan_mac_send_ieee802154_frame(if_id, dest, dest_len,
-                                            &fragbuf,
-                                            max_frag_initial + 4,
-                                            mcast);
-
-        /* subsequent fragments */
-        position = max_frag_initial;
-        max_frag = ((max_frame - 5) / 8) * 8;
-
-        data += position;
-
-        while (send_packet_length - position > max_frame - 5) {
-            memset(&fragbuf[0], 0, sizeof(fragbuf));
-            memcpy(&fragbuf[5], data, max_frag);
-
-            fragbuf[0] = ((SIXLOWPAN_FRAGN_DISPATCH << 8) | datagram_size) >> 8;
-            fragbuf[1] = (SIXLOWPAN_FRAGN_DISPATCH << 8) | datagram_size;
-            fragbuf[2] = tag >> 8;
-            fragbuf[3] = tag;
-            fragbuf[4] = position / 8;
-
-            sixlowpan_mac_send_ieee802154_frame(if_id, dest, dest_len,
-                                                &fragbuf,
-                                                max_frag + 5, mcast);
-            data += max_frag;
-            position += max_frag;
+#ifdef MODULE_SIXLOWPAN_FRAG_QUEUE
+        if (lowpan_frag_enqueue(if_id, dest, dest_len, chain, send_packet_length,
+                                max_frame, chain == &dispatch_node, mcast,
+                                data_len) < 0) {
+            NET_STATS_INC(NET_STATS_LOWPAN, tx_dropped);
+            return -1;
         }
-
-        remaining = send_packet_length - position;
-
-        memset(&fragbuf[0], 0, sizeof(fragbuf));
-        memcpy(&fragbuf[5], data, remaining);
-
-        fragbuf[0] = ((SIXLOWPAN_FRAGN_DISPATCH << 8) | datagram_size) >> 8;
-        fragbuf[1] = (SIXLOWPAN_FRAGN_DISPATCH << 8) | datagram_size;
-        fragbuf[2] = tag >> 8;
-        fragbuf[3] = tag;
-        fragbuf[4] = position / 8;
-
-        tag++;
-
-        if (sixlowpan_mac_send_ieee802154_frame(if_id, dest, dest_len,
-                                                &fragbuf, remaining + 5, mcast) < 0) {
+#else
+        if (lowpan_send_fragments(if_id, dest, dest_len, chain,
+                                  send_packet_length, max_frame,
+                                  chain == &dispatch_node, tag++, mcast, 0) < 0) {
+            NET_STATS_INC(NET_STATS_LOWPAN, tx_dropped);
             return -1;
         }
+#endif
     }
     else {
-        return sixlowpan_mac_send_ieee802154_frame(if_id, dest, dest_len, data,
-                                                   send_packet_length, mcast);
+        return sixlowpan_mac_send_ieee802154_chain(if_id, dest, dest_len,
+                                                   chain, mcast);
     }
 
     return data_len;
@@ -308,485 +487,355 @@ void print_long_local_addr(net_if_eui64_t *saddr)
            ((uint8_t *)saddr)[6], ((uint8_t *)saddr)[7]);
 }
 
-void sixlowpan_lowpan_print_reassembly_buffers(void)
+static void print_reas_buf(lowpan_reas_buf_t *buf)
 {
-    lowpan_reas_buf_t *temp_buffer;
-    lowpan_interval_list_t *temp_interval;
-    temp_buffer = head;
+    print_long_local_addr(&buf->s_addr);
+    printf("Ident.: %i, Packet Size: %i/%i, Expires: %" PRIu32 "\n",
+           buf->tag, buf->current_packet_size, buf->packet_size, buf->expires);
 
-    printf("\n\n--- Reassembly Buffers ---\n");
-
-    while (temp_buffer != NULL) {
-        print_long_local_addr(&temp_buffer->s_addr);
-        printf("Ident.: %i, Packet Size: %i/%i, Timestamp: %"PRIu64"\n",
-               temp_buffer->tag, temp_buffer->current_packet_size,
-               temp_buffer->packet_size, timex_uint64(temp_buffer->timestamp));
-        temp_interval = temp_buffer->interval_list_head;
-
-        while (temp_interval != NULL) {
-            printf("\t%i - %i\n", temp_interval->start, temp_interval->end);
-            temp_interval = temp_interval->next;
+    for (unsigned i = 0; i < (LOWPAN_REAS_BITMAP_SIZE * 8); i++) {
+        if (buf->received[i / 8] & (1 << (i % 8))) {
+            printf("\t%u - %u\n", i * 8, (i * 8) + 7);
         }
+    }
+}
 
-        temp_buffer = temp_buffer->next;
+static void print_active_reas_buf(lowpan_reas_buf_t *buf)
+{
+    if (buf->state == LOWPAN_REAS_STATE_ACTIVE) {
+        print_reas_buf(buf);
     }
 }
 
+void sixlowpan_lowpan_print_reassembly_buffers(void)
+{
+    printf("\n\n--- Reassembly Buffers ---\n");
+    lowpan_reas_foreach(print_active_reas_buf);
+}
+
 void sixlowpan_lowpan_print_fifo_buffers(void)
 {
-    lowpan_reas_buf_t *temp_buffer;
-    lowpan_interval_list_t *temp_interval;
-    temp_buffer = packet_fifo;
+    printf("\n\n--- Complete Datagrams ---\n");
+    printf("%u waiting for decompression\n", pktring_avail(&lowpan_rx_ring));
+}
+#endif
 
-    printf("\n\n--- Reassembly Buffers ---\n");
+/* Copies the datagram in buf to pktbuf, decompressing the header on the way.
+ * Returns the IPv6 packet, NULL if it cannot be handled. */
+static ipv6_hdr_t *lowpan_rx_packet(lowpan_reas_buf_t *buf)
+{
+    const uint8_t *data = buf->packet;
+    uint16_t len = buf->packet_size;
+    ipv6_hdr_t hdr, *packet;
+    uint8_t hdr_pos;
+
+    if (data[0] == SIXLOWPAN_IPV6_DISPATCH) {
+        DEBUG("INFO: Uncompressed IPv6 dispatch (0x%02x) received\n", data[0]);
+        data++;
+        len--;
+    }
+    else if (((data[0] & 0xf0) == IPV6_VER) &&
+             (iphc_status == LOWPAN_IPHC_DISABLE)) {
+        DEBUG("INFO: IPv6 packet received\n");
+    }
+    else if (((data[0] & 0xe0) == SIXLOWPAN_IPHC1_DISPATCH) &&
+             (iphc_status == LOWPAN_IPHC_ENABLE)) {
+        DEBUG("INFO: IPHC1 dispatch 0x%02x received, decompress\n", data[0]);
+        hdr_pos = lowpan_iphc_decode_hdr(&hdr, data, &buf->s_addr, &buf->d_addr,
+                                         NULL);
+
+        if ((hdr_pos == 0) || (hdr_pos > len)) {
+            return NULL;
+        }
 
-    while (temp_buffer != NULL) {
-        print_long_local_addr(&temp_buffer->s_addr);
-        printf("Ident.: %i, Packet Size: %i/%i, Timestamp: %"PRIu64"\n",
-               temp_buffer->tag, temp_buffer->current_packet_size,
-               temp_buffer->packet_size, timex_uint64(temp_buffer->timestamp));
-        temp_interval = temp_buffer->interval_list_head;
+        len -= hdr_pos;
 
-        while (temp_interval != NULL) {
-            printf("\t%i - %i\n", temp_interval->start, temp_interval->end);
-            temp_interval = temp_interval->next;
+        /* ICMPv6 still needs it to fit the receive buffer */
+        if ((IPV6_HDR_LEN + len) > IPV6_MTU) {
+            return NULL;
+        }
+        packet = pktbuf_alloc(IPV6_HDR_LEN + len);
+
+        if (packet != NULL) {
+            memcpy(packet, &hdr, IPV6_HDR_LEN);
+            packet->length = HTONS(len);
+            memcpy(((uint8_t *) packet) + IPV6_HDR_LEN, &data[hdr_pos], len);
         }
 
-        temp_buffer = temp_buffer->next;
+        return packet;
     }
+    else {
+        DEBUG("ERROR: packet with unknown dispatch 0x%02x received\n", data[0]);
+        return NULL;
+    }
+
+    if ((len < IPV6_HDR_LEN) || (len > IPV6_MTU)) {
+        return NULL;
+    }
+
+    return pktbuf_insert(data, len);
 }
-#endif
 
 static void *lowpan_transfer(void *arg)
 {
     (void) arg;
 
-    msg_t m_recv, m_send;
-    ipv6_hdr_t *ipv6_buf;
     lowpan_reas_buf_t *current_buf;
 
     while (1) {
-        uint8_t gotosleep = 1;
-        mutex_lock(&fifo_mutex);
-        current_buf = packet_fifo;
-
-        if (current_buf != NULL) {
-            mutex_unlock(&fifo_mutex);
-
-            if (current_buf->packet[0] == SIXLOWPAN_IPV6_DISPATCH) {
-                DEBUG("INFO: Uncompressed IPv6 dispatch (0x%02x) received\n",
-                      current_buf->packet[0]);
-                ipv6_buf = ipv6_get_buf();
-                memcpy(ipv6_buf, (current_buf->packet) + 1, current_buf->packet_size - 1);
-                m_send.content.ptr = (char *)ipv6_buf;
-                packet_length = current_buf->packet_size - 1;
-                msg_send_receive(&m_send, &m_recv, ip_process_pid);
-            }
-            else if (((current_buf->packet[0] & 0xf0) == IPV6_VER) &&
-                     (iphc_status == LOWPAN_IPHC_DISABLE)) {
-                ipv6_buf = ipv6_get_buf();
-                memcpy(ipv6_buf, (current_buf->packet), current_buf->packet_size);
-                m_send.content.ptr = (char *)ipv6_buf;
-                packet_length = current_buf->packet_size;
-                msg_send_receive(&m_send, &m_recv, ip_process_pid);
-            }
-            else if (((current_buf->packet[0] & 0xe0) == SIXLOWPAN_IPHC1_DISPATCH) &&
-                     (iphc_status == LOWPAN_IPHC_ENABLE)) {
-                DEBUG("INFO: IPHC1 dispatch 0x%02x received, decompress\n",
-                      current_buf->packet[0]);
-                lowpan_iphc_decoding(current_buf->packet,
-                                     current_buf->packet_size,
-                                     &(current_buf->s_addr),
-                                     &(current_buf->d_addr));
-
-                ipv6_buf = ipv6_get_buf();
-                m_send.content.ptr = (char *) ipv6_buf;
-                msg_send_receive(&m_send, &m_recv, ip_process_pid);
-            }
-            else {
-                DEBUG("ERROR: packet with unknown dispatch 0x%02x received\n",
-                      current_buf->packet[0]);
-            }
-
-            collect_garbage_fifo(current_buf);
-            gotosleep = 0;
-        }
-
+        unsigned state = disableIRQ();
 
-        if (gotosleep == 1) {
-            mutex_unlock(&fifo_mutex);
+        /* the MAC thread wakes us up only if we are already sleeping */
+        if (pktring_avail(&lowpan_rx_ring) == 0) {
             thread_sleep();
         }
-    }
 
-    return NULL;
-}
+        restoreIRQ(state);
 
-uint8_t ll_get_addr_match(net_if_eui64_t *src, net_if_eui64_t *dst)
-{
-    uint8_t val = 0, xor;
+        while ((current_buf = pktring_get(&lowpan_rx_ring)) != NULL) {
+            ipv6_hdr_t *packet = lowpan_rx_packet(current_buf);
 
-    for (uint8_t i = 0; i < sizeof(net_if_eui64_t); i++) {
-        /* if bytes are equal add 8 */
-        if (src->uint8[i] == dst->uint8[i]) {
-            val += 8;
-        }
-        else {
-            xor = src->uint8[i] ^ dst->uint8[i];
+            /* free for the next datagram right away */
+            lowpan_reas_release(current_buf);
 
-            /* while bits from byte equal add 1 */
-            for (int j = 0; j < 8; j++) {
-                if ((xor & 0x80) == 0) {
-                    val++;
-                    xor = xor << 1;
-                }
-                else {
-                    break;
+            if ((packet == NULL) || (ipv6_rx_enqueue(packet) < 0)) {
+                DEBUG("ERROR: datagram dropped before IPv6\n");
+                NET_STATS_INC(NET_STATS_LOWPAN, rx_dropped);
+
+                if (packet != NULL) {
+                    pktbuf_release(packet);
                 }
             }
         }
     }
 
-    return val;
+    return NULL;
 }
 
-lowpan_reas_buf_t *new_packet_buffer(uint16_t datagram_size,
-                                     uint16_t datagram_tag,
-                                     net_if_eui64_t *s_addr,
-                                     net_if_eui64_t *d_addr,
-                                     lowpan_reas_buf_t *current_buf,
-                                     lowpan_reas_buf_t *temp_buf)
+/* hands a complete datagram to lowpan_transfer */
+static void lowpan_rx_enqueue(lowpan_reas_buf_t *buf)
 {
-    lowpan_reas_buf_t *new_buf = NULL;
-
-    /* Allocate new memory for a new packet to be reassembled */
-    new_buf = malloc(sizeof(lowpan_reas_buf_t));
-
-    if (new_buf != NULL) {
-        init_reas_bufs(new_buf);
-
-        new_buf->packet = malloc(datagram_size);
-
-        if (new_buf->packet != NULL) {
-            memcpy(&new_buf->s_addr, s_addr, 8);
-            memcpy(&new_buf->d_addr, d_addr, 8);
-
-            new_buf->tag = datagram_tag;
-            new_buf->packet_size = datagram_size;
-
-            vtimer_now(&new_buf->timestamp);
-
-            if ((current_buf == NULL) && (temp_buf == NULL)) {
-                head = new_buf;
-            }
-            else {
-                temp_buf->next = new_buf;
-            }
-
-            return new_buf;
-        }
-        else {
-            return NULL;
-        }
+    if (pktring_put(&lowpan_rx_ring, buf) < 0) {
+        DEBUG("ERROR: decompression queue is full\n");
+        NET_STATS_INC(NET_STATS_LOWPAN, rx_dropped);
+        lowpan_reas_release(buf);
+        return;
     }
-    else {
-        return NULL;
+
+    if (thread_getstatus(transfer_pid) == STATUS_SLEEPING) {
+        thread_wakeup(transfer_pid);
     }
 }
 
-lowpan_reas_buf_t *get_packet_frag_buf(uint16_t datagram_size,
-                                       uint16_t datagram_tag,
-                                       net_if_eui64_t *s_addr,
-                                       net_if_eui64_t *d_addr)
+void handle_packet_fragment(uint8_t *data, uint16_t datagram_offset,
+                            uint16_t datagram_size, uint16_t datagram_tag,
+                            net_if_eui64_t *s_addr, net_if_eui64_t *d_addr,
+                            uint8_t hdr_length, uint8_t frag_size)
 {
-    lowpan_reas_buf_t *current_buf = NULL, *temp_buf = NULL;
-    current_buf = head;
+    lowpan_reas_buf_t *current_buf;
+    int res = LOWPAN_REAS_INVALID;
 
-    while (current_buf != NULL) {
-        if (((ll_get_addr_match(&current_buf->s_addr, s_addr)) == 64) &&
-            ((ll_get_addr_match(&current_buf->d_addr, d_addr)) == 64) &&
-            (current_buf->packet_size == datagram_size) &&
-            (current_buf->tag == datagram_tag) &&
-            current_buf->interval_list_head != NULL) {
-            /* Found buffer for current packet fragment */
-            vtimer_now(&current_buf->timestamp);
-            return current_buf;
-        }
+    /* Is there already a reassembly buffer for this packet fragment? */
+    current_buf = lowpan_reas_get(datagram_size, datagram_tag, s_addr, d_addr);
 
-        temp_buf = current_buf;
-        current_buf = current_buf->next;
+    if (current_buf != NULL) {
+        /* Copy fragment bytes into corresponding packet space area */
+        res = lowpan_reas_add(current_buf, datagram_offset, data + hdr_length,
+                              frag_size);
     }
 
-    return new_packet_buffer(datagram_size, datagram_tag, s_addr, d_addr,
-                             current_buf, temp_buf);
-}
-
-uint8_t is_in_interval(uint8_t start1, uint8_t end1, uint8_t start2, uint8_t end2)
-{
-    /* 1: Interval 1 and 2 are the same or overlapping */
-    /* 0: Interval 1 and 2 are not overlapping or the same */
-
-    if (((start1 < start2) && (start2 <= end1)) ||
-        ((start2 < start1) && (start1 <= end2)) ||
-        ((start1 == start2) && (end1 == end2))) {
-        return 1;
-    }
-    else {
-        return 0;
+    if (res == LOWPAN_REAS_COMPLETE) {
+        lowpan_rx_enqueue(current_buf);
     }
-}
+    else if (res != LOWPAN_REAS_INCOMPLETE) {
+        /* No memory left or duplicate */
+        NET_STATS_INC(NET_STATS_LOWPAN, rx_dropped);
 
-uint8_t handle_packet_frag_interval(lowpan_reas_buf_t *current_buf,
-                                    uint8_t datagram_offset,  uint8_t frag_size)
-{
-    /* 0: Error, discard fragment */
-    /* 1: Finished correctly */
-    lowpan_interval_list_t *temp_interval = NULL, *current_interval = NULL, *new_interval = NULL;
-    current_interval = current_buf->interval_list_head;
-
-    while (current_interval != NULL) {
-        if (is_in_interval(current_interval->start, current_interval->end, datagram_offset, datagram_offset + frag_size) == 1) {
-            /* Interval is overlapping or the same as one of a previous fragment, discard fragment */
-            return 0;
+        if (current_buf == NULL) {
+            printf("ERROR: no memory left!\n");
         }
-
-        temp_interval = current_interval;
-        current_interval = current_interval->next;
-    }
-
-    new_interval = malloc(sizeof(lowpan_interval_list_t));
-
-    if (new_interval != NULL) {
-        new_interval->start = datagram_offset;
-        new_interval->end = datagram_offset + frag_size - 1;
-        new_interval->next = NULL;
-
-        if ((current_interval == NULL) && (temp_interval == NULL)) {
-            current_buf->interval_list_head = new_interval;
+        else if (res == LOWPAN_REAS_DUPLICATE) {
+            printf("ERROR: duplicate fragment!\n");
         }
         else {
-            temp_interval->next = new_interval;
+            printf("ERROR: fragment exceeds datagram!\n");
         }
-
-        return 1;
     }
-
-    return 0;
 }
 
-lowpan_reas_buf_t *collect_garbage_fifo(lowpan_reas_buf_t *current_buf)
+/* Register an upper layer thread */
+uint8_t sixlowpan_lowpan_register(kernel_pid_t pid)
 {
-    lowpan_interval_list_t *temp_list, *current_list;
-    lowpan_reas_buf_t *temp_buf, *my_buf, *return_buf;
-
-    mutex_lock(&fifo_mutex);
+    uint8_t i;
 
-    temp_buf = packet_fifo;
-    my_buf = temp_buf;
+    for (i = 0; (((i < SIXLOWPAN_MAX_REGISTERED) && sixlowpan_reg[i] != pid) &&
+                 (sixlowpan_reg[i] != 0)); i++) {
+        ;
+    }
 
-    if (packet_fifo == current_buf) {
-        packet_fifo = current_buf->next;
-        return_buf = packet_fifo;
+    if (i >= SIXLOWPAN_MAX_REGISTERED) {
+        return ENOMEM;
     }
     else {
-        while (temp_buf != current_buf) {
-            my_buf = temp_buf;
-            temp_buf = temp_buf->next;
-        }
-
-        my_buf->next = current_buf->next;
-
-        return_buf = my_buf->next;
+        sixlowpan_reg[i] = pid;
+        return 1;
     }
+}
 
-    mutex_unlock(&fifo_mutex);
-
-    current_list = current_buf->interval_list_head;
-    temp_list = current_list;
-
-    while (current_list != NULL) {
-        temp_list = current_list->next;
-        free(current_list);
-        current_list = temp_list;
+#ifdef MODULE_SIXLOWPAN_FRAG_FWD
+static lowpan_frag_fwd_t *frag_fwd_find(uint16_t datagram_size,
+                                        uint16_t datagram_tag,
+                                        const net_if_eui64_t *s_addr)
+{
+    for (unsigned i = 0; i < LOWPAN_FRAG_FWD_NUMOF; i++) {
+        if ((frag_fwd[i].remaining != 0) && (frag_fwd[i].tag == datagram_tag) &&
+            (frag_fwd[i].size == datagram_size) &&
+            (memcmp(&frag_fwd[i].s_addr, s_addr, sizeof(net_if_eui64_t)) == 0)) {
+            return &frag_fwd[i];
+        }
     }
 
-    free(current_buf->packet);
-    free(current_buf);
-
-    return return_buf;
+    return NULL;
 }
 
-lowpan_reas_buf_t *collect_garbage(lowpan_reas_buf_t *current_buf)
+/* an unused entry, else one that timed out or the least recently used */
+static lowpan_frag_fwd_t *frag_fwd_new(uint32_t now)
 {
-    lowpan_interval_list_t *temp_list, *current_list;
-    lowpan_reas_buf_t *temp_buf, *my_buf, *return_buf;
-
-    temp_buf = head;
-    my_buf = temp_buf;
+    lowpan_frag_fwd_t *oldest = &frag_fwd[0];
 
-    if (head == current_buf) {
-        head = current_buf->next;
-        return_buf = head;
-    }
-    else {
-        while (temp_buf != current_buf) {
-            my_buf = temp_buf;
-            temp_buf = temp_buf->next;
+    for (unsigned i = 0; i < LOWPAN_FRAG_FWD_NUMOF; i++) {
+        if ((frag_fwd[i].remaining == 0) ||
+            ((now - frag_fwd[i].timestamp) >= (LOWPAN_REAS_BUF_TIMEOUT / SEC_IN_USEC))) {
+            return &frag_fwd[i];
         }
 
-        my_buf->next = current_buf->next;
-
-        return_buf = my_buf->next;
-    }
-
-    current_list = current_buf->interval_list_head;
-    temp_list = current_list;
-
-    while (current_list != NULL) {
-        temp_list = current_list->next;
-        free(current_list);
-        current_list = temp_list;
+        if ((int32_t)(frag_fwd[i].timestamp - oldest->timestamp) < 0) {
+            oldest = &frag_fwd[i];
+        }
     }
 
-    free(current_buf->packet);
-    free(current_buf);
-
-    return return_buf;
+    return oldest;
 }
 
-void handle_packet_fragment(uint8_t *data, uint8_t datagram_offset,
-                            uint16_t datagram_size, uint16_t datagram_tag,
-                            net_if_eui64_t *s_addr, net_if_eui64_t *d_addr,
-                            uint8_t hdr_length, uint8_t frag_size)
+/* Relays a fragment of a datagram that is not for this node to the next hop
+ * without reassembling it. The first fragment is sent on with the hop limit
+ * decremented, which requires the hop limit inline and addresses that do not
+ * depend on the link layer. Offsets and size refer to the compressed
+ * datagram, so the header is not recompressed. Returns 0 if the fragment is
+ * left to reassembly. */
+static int lowpan_frag_fwd(uint8_t *data, uint8_t length,
+                           uint16_t datagram_size, uint16_t datagram_tag,
+                           uint8_t frag_size, net_if_eui64_t *s_addr,
+                           net_if_eui64_t *d_addr)
 {
-    lowpan_reas_buf_t *current_buf;
-    /* Is there already a reassembly buffer for this packet fragment? */
-    current_buf = get_packet_frag_buf(datagram_size, datagram_tag, s_addr,
-                                      d_addr);
+    lowpan_frag_fwd_t *fwd;
+    uint8_t frame[length];
+    int res;
+    timex_t now;
 
-    if ((current_buf != NULL) && (handle_packet_frag_interval(current_buf,
-                                  datagram_offset,
-                                  frag_size) == 1)) {
-        /* Copy fragment bytes into corresponding packet space area */
-        memcpy(current_buf->packet + datagram_offset, data + hdr_length, frag_size);
-        current_buf->current_packet_size += frag_size;
+    vtimer_now(&now);
 
-        if (current_buf->current_packet_size == current_buf->packet_size) {
-            add_fifo_packet(current_buf);
+    if ((data[0] & SIXLOWPAN_FRAG_HDR_MASK) == SIXLOWPAN_FRAG1_DISPATCH) {
+        ipv6_hdr_t hdr;
+        ipv6_ll_hop_t hop;
+        uint8_t hlim_pos;
 
-            if (thread_getstatus(transfer_pid) == STATUS_SLEEPING) {
-                thread_wakeup(transfer_pid);
+        if (data[4] == SIXLOWPAN_IPV6_DISPATCH) {
+            if (length < (5 + IPV6_HDR_LEN)) {
+                return 0;
             }
+
+            memcpy(&hdr, &data[5], IPV6_HDR_LEN);
+            hlim_pos = 5 + offsetof(ipv6_hdr_t, hoplimit);
         }
-    }
-    else {
-        /* No memory left or duplicate */
-        if (current_buf == NULL) {
-            printf("ERROR: no memory left!\n");
+        else if (((data[4] & 0xe0) == SIXLOWPAN_IPHC1_DISPATCH) &&
+                 ((data[5] & 0x30) != 0x30)) {
+            /* SAM 11 derives the source from the previous hop */
+            if (!lowpan_iphc_decode_hdr(&hdr, &data[4], s_addr, d_addr,
+                                        &hlim_pos) || (hlim_pos == 0)) {
+                return 0;
+            }
+
+            hlim_pos += 4;
         }
         else {
-            printf("ERROR: duplicate fragment!\n");
+            return 0;
         }
-    }
-}
 
-void check_timeout(void)
-{
-    lowpan_reas_buf_t *temp_buf, *smallest_time = NULL;
-    int count = 0;
-
-    timex_t now;
-    vtimer_now(&now);
-    temp_buf = head;
-
-    while (temp_buf != NULL) {
-        if ((timex_uint64(now) - timex_uint64(temp_buf->timestamp)) >= LOWPAN_REAS_BUF_TIMEOUT) {
-            printf("TIMEOUT!cur_time: %" PRIu64 ", temp_buf: %" PRIu64 "\n", timex_uint64(now),
-                   timex_uint64(temp_buf->timestamp));
-            temp_buf = collect_garbage(temp_buf);
+        /* an expiring hop limit is dropped and counted by ipv6_process() */
+        if ((hdr.hoplimit <= 1) || !ipv6_fwd_get_ll_hop(&hdr.destaddr, &hop)) {
+            return 0;
         }
-        else {
-            if (smallest_time == NULL) {
-                smallest_time = temp_buf;
-            }
-            else if (timex_cmp(temp_buf->timestamp, smallest_time->timestamp) < 0) {
-                smallest_time = temp_buf;
-            }
 
-            temp_buf = temp_buf->next;
-            count++;
+        /* a subsequent fragment that arrived first already started
+         * reassembly, the datagram can not be relayed anymore */
+        if (lowpan_reas_find(datagram_size, datagram_tag, s_addr,
+                             d_addr) != NULL) {
+            return 0;
         }
-    }
 
-    if ((count > 10) && (smallest_time != NULL)) {
-        collect_garbage(smallest_time);
-    }
-}
-
-void add_fifo_packet(lowpan_reas_buf_t *current_packet)
-{
-    lowpan_reas_buf_t *temp_buf, *my_buf;
+        fwd = frag_fwd_new(now.seconds);
+        memcpy(&fwd->s_addr, s_addr, sizeof(net_if_eui64_t));
+        fwd->tag = datagram_tag;
+        fwd->size = datagram_size;
+        fwd->new_tag = tag++;
+        fwd->remaining = datagram_size;
+        fwd->hop = hop;
 
-    if (head == current_packet) {
-        head = current_packet->next;
+        memcpy(frame, data, length);
+        frame[hlim_pos]--;
     }
     else {
-        temp_buf = head;
+        fwd = frag_fwd_find(datagram_size, datagram_tag, s_addr);
 
-        while (temp_buf != current_packet) {
-            my_buf = temp_buf;
-            temp_buf = temp_buf->next;
+        if (fwd == NULL) {
+            /* first fragment not seen or the datagram is for this node */
+            return 0;
         }
 
-        my_buf->next = current_packet->next;
+        memcpy(frame, data, length);
     }
 
-    mutex_lock(&fifo_mutex);
+    DEBUG("INFO: relaying fragment of tag %u as %u\n", datagram_tag,
+          fwd->new_tag);
 
-    if (packet_fifo == NULL) {
-        packet_fifo = current_packet;
-    }
-    else {
-        temp_buf = packet_fifo;
+    frame[2] = fwd->new_tag >> 8;
+    frame[3] = fwd->new_tag;
 
-        while (temp_buf != NULL) {
-            my_buf = temp_buf;
-            temp_buf = temp_buf->next;
-        }
+    fwd->timestamp = now.seconds;
+    fwd->remaining = (fwd->remaining > frag_size) ?
+                     (fwd->remaining - frag_size) : 0;
 
-        my_buf->next = current_packet;
-    }
-
-    mutex_unlock(&fifo_mutex);
-    current_packet->next = NULL;
-}
-
-/* Register an upper layer thread */
-uint8_t sixlowpan_lowpan_register(kernel_pid_t pid)
-{
-    uint8_t i;
-
-    for (i = 0; (((i < SIXLOWPAN_MAX_REGISTERED) && sixlowpan_reg[i] != pid) &&
-                 (sixlowpan_reg[i] != 0)); i++) {
-        ;
-    }
+    NET_STATS_INC(NET_STATS_LOWPAN, tx);
+    res = sixlowpan_mac_send_ieee802154_frame(fwd->hop.if_id, fwd->hop.addr,
+                                              fwd->hop.addr_len, frame,
+                                              length, 0);
 
-    if (i >= SIXLOWPAN_MAX_REGISTERED) {
-        return ENOMEM;
+    if (res < 0) {
+        /* the datagram is lost, its other fragments are not relayed */
+        NET_STATS_INC(NET_STATS_LOWPAN, tx_dropped);
+        fwd->remaining = 0;
+        ipv6_fwd_count(res);
     }
-    else {
-        sixlowpan_reg[i] = pid;
-        return 1;
+    else if (fwd->remaining == 0) {
+        /* the datagram is forwarded once its last fragment is sent */
+        ipv6_fwd_count(res);
     }
+
+    return 1;
 }
+#endif
 
 void lowpan_read(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
                  net_if_eui64_t *d_addr)
 {
     /* check if packet is fragmented */
     short i;
+    unsigned long start = net_stats_start();
+
+    NET_STATS_INC(NET_STATS_LOWPAN, rx);
 
-    check_timeout();
+    lowpan_reas_expire();
 
     for (i = 0; i < SIXLOWPAN_MAX_REGISTERED; i++) {
         if (sixlowpan_reg[i]) {
@@ -844,10 +893,20 @@ void lowpan_read(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         if ((frag_size % 8) != 0) {
             if ((byte_offset + frag_size) != datagram_size) {
                 printf("ERROR: received invalid fragment\n");
+                NET_STATS_INC(NET_STATS_LOWPAN, rx_dropped);
+                net_stats_latency(NET_STATS_LOWPAN, start);
                 return;
             }
         }
 
+#ifdef MODULE_SIXLOWPAN_FRAG_FWD
+        if (lowpan_frag_fwd(data, length, datagram_size, datagram_tag,
+                            frag_size, s_addr, d_addr)) {
+            net_stats_latency(NET_STATS_LOWPAN, start);
+            return;
+        }
+#endif
+
         handle_packet_fragment(data, byte_offset, datagram_size, datagram_tag,
                                s_addr, d_addr, hdr_length, frag_size);
     }
@@ -855,30 +914,31 @@ void lowpan_read(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
     else {
         DEBUG("INFO: unfragmentated packet with first byte 0x%02x received\n",
               data[0]);
-        lowpan_reas_buf_t *current_buf = get_packet_frag_buf(length, 0, s_addr, d_addr);
+        lowpan_reas_buf_t *current_buf = lowpan_reas_alloc();
 
-        if (current_buf && current_buf->packet) {
+        if (current_buf) {
             /* Copy packet bytes into corresponding packet space area */
+            memcpy(&current_buf->s_addr, s_addr, sizeof(net_if_eui64_t));
+            memcpy(&current_buf->d_addr, d_addr, sizeof(net_if_eui64_t));
             memcpy(current_buf->packet, data, length);
-            current_buf->current_packet_size += length;
-            add_fifo_packet(current_buf);
+            current_buf->packet_size = length;
+            current_buf->current_packet_size = length;
+            lowpan_rx_enqueue(current_buf);
         }
         else {
             DEBUG("ERROR: no memory left in packet buffer!\n");
-        }
-
-        if (thread_getstatus(transfer_pid) == STATUS_SLEEPING) {
-            thread_wakeup(transfer_pid);
+            NET_STATS_INC(NET_STATS_LOWPAN, rx_dropped);
         }
     }
 
+    net_stats_latency(NET_STATS_LOWPAN, start);
 }
 
-/* draft-ietf-6lowpan-hc-13#section-3.1 */
+/* draft-ietf-6lowpan-hc-13#section-3.1, compresses the header only, the
+ * payload is sent from where it is */
 uint8_t lowpan_iphc_encoding(int if_id, const uint8_t *dest, int dest_len,
-                             ipv6_hdr_t *ipv6_buf_extra, uint8_t *ptr)
+                             ipv6_hdr_t *ipv6_buf_extra)
 {
-    uint16_t payload_length = NTOHS(ipv6_buf->length);
     uint8_t lowpan_iphc[2];
     uint8_t *ipv6_hdr_fields = &comp_buf[2];
     lowpan_context_t *con = NULL;
@@ -954,8 +1014,9 @@ uint8_t lowpan_iphc_encoding(int if_id, const uint8_t *dest, int dest_len,
     ipv6_hdr_fields[hdr_pos] = ipv6_buf->nextheader;
     hdr_pos++;
 
-    /* HLIM: Hop Limit: */
-    switch (ipv6_buf->hoplimit) {
+    /* HLIM: Hop Limit: carried inline if routers need to decrement it
+     * without decompressing the header */
+    switch (iphc_relayable ? 0 : ipv6_buf->hoplimit) {
         case (1): {
             /* 01: The Hop Limit field is compressed and the hop limit is 1. */
             lowpan_iphc[0] |= 0x01;
@@ -1006,7 +1067,8 @@ uint8_t lowpan_iphc_encoding(int if_id, const uint8_t *dest, int dest_len,
 
         if (con || ipv6_addr_is_link_local(&ipv6_buf->srcaddr)) {
             /* 0: Source address compression uses stateless compression.*/
-            if (memcmp(&(ipv6_buf->srcaddr.uint8[8]), &own_iid, 8) == 0) {
+            if (!iphc_relayable &&
+                (memcmp(&(ipv6_buf->srcaddr.uint8[8]), &own_iid, 8) == 0)) {
                 /* 0 bits. The address is derived using context information
                  * and possibly the link-layer addresses.*/
                 lowpan_iphc[1] |= 0x30;
@@ -1146,28 +1208,21 @@ uint8_t lowpan_iphc_encoding(int if_id, const uint8_t *dest, int dest_len,
     comp_buf[0] = lowpan_iphc[0];
     comp_buf[1] = lowpan_iphc[1];
 
-    /*uint8_t *ptr;
-    if (ipv6_buf->nextheader == IPV6_PROTO_NUM_TCP)
-        {
-        ptr = get_payload_buf_send(ipv6_ext_hdr_len);
-        }
-    else
-        {
-        ptr = get_payload_buf(ipv6_ext_hdr_len);
-        }
-    */
-    memcpy(&ipv6_hdr_fields[hdr_pos], &ptr[IPV6_HDR_LEN], NTOHS(ipv6_buf->length));
-
-    comp_len = 2 + hdr_pos + payload_length;
+    comp_len = 2 + hdr_pos;
 
     return 1;
 }
 
-void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
-                          net_if_eui64_t *d_addr)
+/* Decompresses the IPHC header at data into hdr. Returns the length of the
+ * compressed header, 0 if it cannot be decompressed. If hlim_pos is given it
+ * is set to the position of an inline hop limit, 0 if it is elided. */
+static uint8_t lowpan_iphc_decode_hdr(ipv6_hdr_t *hdr, const uint8_t *data,
+                                      const net_if_eui64_t *s_addr,
+                                      const net_if_eui64_t *d_addr,
+                                      uint8_t *hlim_pos)
 {
     uint8_t hdr_pos = 0;
-    uint8_t *ipv6_hdr_fields = data;
+    const uint8_t *ipv6_hdr_fields = data;
     uint8_t lowpan_iphc[2];
     uint8_t cid = 0;
     uint8_t dci = 0;
@@ -1175,8 +1230,6 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
     uint8_t ll_prefix[2] = {0xfe, 0x80};
     lowpan_context_t *con = NULL;
 
-    ipv6_buf = ipv6_get_buf();
-
     lowpan_iphc[0] = ipv6_hdr_fields[0];
     lowpan_iphc[1] = ipv6_hdr_fields[1];
     hdr_pos += 2;
@@ -1192,41 +1245,41 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         /* flowlabel is elided */
         if (lowpan_iphc[0] & SIXLOWPAN_IPHC1_TC_C) {
             /* traffic class is elided */
-            ipv6_buf->version_trafficclass = 0x60;
-            ipv6_buf->trafficclass_flowlabel = 0;
-            ipv6_buf->flowlabel = 0;
+            hdr->version_trafficclass = 0x60;
+            hdr->trafficclass_flowlabel = 0;
+            hdr->flowlabel = 0;
         }
         else {
             /* toogle ecn/dscp order */
-            ipv6_buf->version_trafficclass = 0x60 | (0x0f &
-                                             (ipv6_hdr_fields[hdr_pos] >> 2));
-            ipv6_buf->trafficclass_flowlabel = ((ipv6_hdr_fields[hdr_pos] >> 2) & 0x30) |
-                                               ((ipv6_hdr_fields[hdr_pos] << 6) & 0xc0);
-            ipv6_buf->flowlabel = 0;
-            hdr_pos += 3;
+            hdr->version_trafficclass = 0x60 | (0x0f &
+                                        (ipv6_hdr_fields[hdr_pos] >> 2));
+            hdr->trafficclass_flowlabel = ((ipv6_hdr_fields[hdr_pos] >> 2) & 0x30) |
+                                          ((ipv6_hdr_fields[hdr_pos] << 6) & 0xc0);
+            hdr->flowlabel = 0;
+            hdr_pos++;
         }
     }
     else {
         /* flowlabel carried inline */
         if (lowpan_iphc[0] & SIXLOWPAN_IPHC1_TC_C) {
             /* traffic class is elided */
-            ipv6_buf->version_trafficclass = 0x60;
+            hdr->version_trafficclass = 0x60;
             /* ecn + 4 bit flowlabel*/
-            ipv6_buf->trafficclass_flowlabel = ((ipv6_hdr_fields[hdr_pos] >> 2) & 0x30) |
-                                               (ipv6_hdr_fields[hdr_pos] & 0x0f);
+            hdr->trafficclass_flowlabel = ((ipv6_hdr_fields[hdr_pos] >> 2) & 0x30) |
+                                          (ipv6_hdr_fields[hdr_pos] & 0x0f);
             hdr_pos++;
             /* copy 2byte flowlabel */
-            memcpy(&ipv6_buf->flowlabel, &ipv6_hdr_fields[hdr_pos], 2);
+            memcpy(&hdr->flowlabel, &ipv6_hdr_fields[hdr_pos], 2);
             hdr_pos += 2;
         }
         else {
-            ipv6_buf->version_trafficclass = 0x60 | (0x0f &
-                                             (ipv6_hdr_fields[hdr_pos] >> 2));
-            ipv6_buf->trafficclass_flowlabel = ((ipv6_hdr_fields[hdr_pos] >> 2) & 0x30) |
-                                               (ipv6_hdr_fields[hdr_pos] & 0x0f) |
-                                               (ipv6_hdr_fields[hdr_pos + 1] & 0x0f);
+            hdr->version_trafficclass = 0x60 | (0x0f &
+                                        (ipv6_hdr_fields[hdr_pos] >> 2));
+            hdr->trafficclass_flowlabel = ((ipv6_hdr_fields[hdr_pos] >> 2) & 0x30) |
+                                          (ipv6_hdr_fields[hdr_pos] & 0x0f) |
+                                          (ipv6_hdr_fields[hdr_pos + 1] & 0x0f);
             hdr_pos += 2;
-            memcpy(&ipv6_buf->trafficclass_flowlabel,
+            memcpy(&hdr->trafficclass_flowlabel,
                    &ipv6_hdr_fields[hdr_pos], 2);
             hdr_pos += 2;
         }
@@ -1237,25 +1290,29 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         // TODO: next header decompression
     }
     else {
-        ipv6_buf->nextheader = ipv6_hdr_fields[hdr_pos];
+        hdr->nextheader = ipv6_hdr_fields[hdr_pos];
         hdr_pos++;
     }
 
     /* HLIM: Hop Limit: */
+    if (hlim_pos) {
+        *hlim_pos = (lowpan_iphc[0] & 0x03) ? 0 : hdr_pos;
+    }
+
     if (lowpan_iphc[0] & 0x03) {
         switch (lowpan_iphc[0] & 0x03) {
             case (0x01): {
-                ipv6_buf->hoplimit = 1;
+                hdr->hoplimit = 1;
                 break;
             }
 
             case (0x02): {
-                ipv6_buf->hoplimit = 64;
+                hdr->hoplimit = 64;
                 break;
             }
 
             case (0x03): {
-                ipv6_buf->hoplimit = 255;
+                hdr->hoplimit = 255;
                 break;
             }
 
@@ -1264,7 +1321,7 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         }
     }
     else {
-        ipv6_buf->hoplimit = ipv6_hdr_fields[hdr_pos];
+        hdr->hoplimit = ipv6_hdr_fields[hdr_pos];
         hdr_pos++;
     }
 
@@ -1285,44 +1342,45 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         }
 
         if (con == NULL) {
+            mutex_unlock(&lowpan_context_mutex);
             printf("ERROR: context not found\n");
-            return;
+            return 0;
         }
 
         switch (((lowpan_iphc[1] & SIXLOWPAN_IPHC2_SAM) >> 4) & 0x03) {
             case (0x01): {
                 /* 64-bits */
-                memcpy(&(ipv6_buf->srcaddr.uint8[8]), &ipv6_hdr_fields[hdr_pos], 8);
+                memcpy(&(hdr->srcaddr.uint8[8]), &ipv6_hdr_fields[hdr_pos], 8);
                 /* By RFC 6282 3.1.1. Bits covered by context
                  * information are always used. */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]), &con->prefix, con->length);
+                memcpy(&(hdr->srcaddr.uint8[0]), &con->prefix, con->length / 8);
                 hdr_pos += 8;
                 break;
             }
 
             case (0x02): {
                 /* 16-bits */
-                memset(&(ipv6_buf->srcaddr.uint8[8]), 0, 6);
-                memcpy(&(ipv6_buf->srcaddr.uint8[14]), &ipv6_hdr_fields[hdr_pos], 2);
+                memset(&(hdr->srcaddr.uint8[8]), 0, 6);
+                memcpy(&(hdr->srcaddr.uint8[14]), &ipv6_hdr_fields[hdr_pos], 2);
                 /* By RFC 6282 3.1.1. Bits covered by context
                  * information are always used. */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]), &con->prefix, con->length);
+                memcpy(&(hdr->srcaddr.uint8[0]), &con->prefix, con->length / 8);
                 hdr_pos += 2;
                 break;
             }
 
             case (0x03): {
                 /* 0-bits */
-                memcpy(&(ipv6_buf->srcaddr.uint8[8]), &s_addr->uint8[0], 8);
+                memcpy(&(hdr->srcaddr.uint8[8]), &s_addr->uint8[0], 8);
                 /* By RFC 6282 3.1.1. Bits covered by context
                  * information are always used. */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]), &con->prefix, con->length);
+                memcpy(&(hdr->srcaddr.uint8[0]), &con->prefix, con->length / 8);
                 break;
             }
 
             default: {
                 /* unspecified address */
-                memset(&(ipv6_buf->srcaddr.uint8[0]), 0, 16);
+                memset(&(hdr->srcaddr.uint8[0]), 0, 16);
                 break;
             }
         }
@@ -1333,33 +1391,33 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         switch (((lowpan_iphc[1] & SIXLOWPAN_IPHC2_SAM) >> 4) & 0x03) {
             case (0x01): {
                 /* 64-bits */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]), &ll_prefix[0], 2);
-                memset(&(ipv6_buf->srcaddr.uint8[2]), 0, 6);
-                memcpy(&(ipv6_buf->srcaddr.uint8[8]), &ipv6_hdr_fields[hdr_pos], 8);
+                memcpy(&(hdr->srcaddr.uint8[0]), &ll_prefix[0], 2);
+                memset(&(hdr->srcaddr.uint8[2]), 0, 6);
+                memcpy(&(hdr->srcaddr.uint8[8]), &ipv6_hdr_fields[hdr_pos], 8);
                 hdr_pos += 8;
                 break;
             }
 
             case (0x02): {
                 /* 16-bits */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]), &ll_prefix[0], 2);
-                memset(&(ipv6_buf->srcaddr.uint8[2]), 0, 12);
-                memcpy(&(ipv6_buf->srcaddr.uint8[14]), &ipv6_hdr_fields[hdr_pos], 2);
+                memcpy(&(hdr->srcaddr.uint8[0]), &ll_prefix[0], 2);
+                memset(&(hdr->srcaddr.uint8[2]), 0, 12);
+                memcpy(&(hdr->srcaddr.uint8[14]), &ipv6_hdr_fields[hdr_pos], 2);
                 hdr_pos += 2;
                 break;
             }
 
             case (0x03): {
                 /* 0-bits */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]), &ll_prefix[0], 2);
-                memset(&(ipv6_buf->srcaddr.uint8[2]), 0, 20);
-                memcpy(&(ipv6_buf->srcaddr.uint8[8]), &s_addr->uint8[0], 8);
+                memcpy(&(hdr->srcaddr.uint8[0]), &ll_prefix[0], 2);
+                memset(&(hdr->srcaddr.uint8[2]), 0, 20);
+                memcpy(&(hdr->srcaddr.uint8[8]), &s_addr->uint8[0], 8);
                 break;
             }
 
             default: {
                 /* full address carried inline */
-                memcpy(&(ipv6_buf->srcaddr.uint8[0]),
+                memcpy(&(hdr->srcaddr.uint8[0]),
                        &ipv6_hdr_fields[hdr_pos], 16);
                 hdr_pos += 16;
                 break;
@@ -1385,8 +1443,9 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
             }
 
             if (con == NULL) {
+                mutex_unlock(&lowpan_context_mutex);
                 printf("ERROR: context not found\n");
-                return;
+                return 0;
             }
 
             // TODO:
@@ -1414,31 +1473,31 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
 
             switch (lowpan_iphc[1] & 0x03) {
                 case (0x01): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &m_prefix[0], 2);
-                    memset(&(ipv6_buf->destaddr.uint8[2]), 0, 9);
-                    memcpy(&(ipv6_buf->destaddr.uint8[11]), &ipv6_hdr_fields[hdr_pos], 5);
+                    memcpy(&(hdr->destaddr.uint8[0]), &m_prefix[0], 2);
+                    memset(&(hdr->destaddr.uint8[2]), 0, 9);
+                    memcpy(&(hdr->destaddr.uint8[11]), &ipv6_hdr_fields[hdr_pos], 5);
                     hdr_pos += 5;
                     break;
                 }
 
                 case (0x02): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &m_prefix[0], 2);
-                    memset(&(ipv6_buf->destaddr.uint8[2]), 0, 11);
-                    memcpy(&(ipv6_buf->destaddr.uint8[13]), &ipv6_hdr_fields[hdr_pos], 3);
+                    memcpy(&(hdr->destaddr.uint8[0]), &m_prefix[0], 2);
+                    memset(&(hdr->destaddr.uint8[2]), 0, 11);
+                    memcpy(&(hdr->destaddr.uint8[13]), &ipv6_hdr_fields[hdr_pos], 3);
                     hdr_pos += 3;
                     break;
                 }
 
                 case (0x03): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &m_prefix[0], 2);
-                    memset(&(ipv6_buf->destaddr.uint8[2]), 0, 13);
-                    memcpy(&(ipv6_buf->destaddr.uint8[15]), &ipv6_hdr_fields[hdr_pos], 1);
+                    memcpy(&(hdr->destaddr.uint8[0]), &m_prefix[0], 2);
+                    memset(&(hdr->destaddr.uint8[2]), 0, 13);
+                    memcpy(&(hdr->destaddr.uint8[15]), &ipv6_hdr_fields[hdr_pos], 1);
                     hdr_pos++;
                     break;
                 }
 
                 default: {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &ipv6_hdr_fields[hdr_pos], 16);
+                    memcpy(&(hdr->destaddr.uint8[0]), &ipv6_hdr_fields[hdr_pos], 16);
                     hdr_pos += 16;
                     break;
                 }
@@ -1461,33 +1520,34 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
             }
 
             if (con == NULL) {
+                mutex_unlock(&lowpan_context_mutex);
                 printf("ERROR: context not found\n");
-                return;
+                return 0;
             }
 
             switch ((lowpan_iphc[1] & SIXLOWPAN_IPHC2_DAM) & 0x03) {
                 case (0x01): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[8]), &ipv6_hdr_fields[hdr_pos], 8);
+                    memcpy(&(hdr->destaddr.uint8[8]), &ipv6_hdr_fields[hdr_pos], 8);
                     /* By draft-ietf-6lowpan-hc-15 3.1.1. Bits covered by context information are always used. */
-                    memcpy(&(ipv6_buf->srcaddr.uint8[0]), &con->prefix, con->length);
+                    memcpy(&(hdr->destaddr.uint8[0]), &con->prefix, con->length / 8);
                     hdr_pos += 8;
                     break;
                 }
 
                 case (0x02): {
-                    memset(&(ipv6_buf->destaddr.uint8[8]), 0, 6);
-                    memcpy(&(ipv6_buf->destaddr.uint8[14]), &ipv6_hdr_fields[hdr_pos], 2);
+                    memset(&(hdr->destaddr.uint8[8]), 0, 6);
+                    memcpy(&(hdr->destaddr.uint8[14]), &ipv6_hdr_fields[hdr_pos], 2);
                     /* By draft-ietf-6lowpan-hc-15 3.1.1. Bits covered by context information are always used. */
-                    memcpy(&(ipv6_buf->srcaddr.uint8[0]), &con->prefix, con->length);
+                    memcpy(&(hdr->destaddr.uint8[0]), &con->prefix, con->length / 8);
                     hdr_pos += 2;
                     break;
                 }
 
                 case (0x03): {
-                    memset(&(ipv6_buf->destaddr.uint8[0]), 0, 8);
-                    memcpy(&(ipv6_buf->destaddr.uint8[8]), &d_addr->uint8[0], 8);
+                    memset(&(hdr->destaddr.uint8[0]), 0, 8);
+                    memcpy(&(hdr->destaddr.uint8[8]), &d_addr->uint8[0], 8);
                     /* By draft-ietf-6lowpan-hc-15 3.1.1. Bits covered by context information are always used. */
-                    memcpy(&(ipv6_buf->srcaddr.uint8[0]), &con->prefix, con->length);
+                    memcpy(&(hdr->destaddr.uint8[0]), &con->prefix, con->length / 8);
                     break;
                 }
 
@@ -1500,32 +1560,32 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         else {
             switch ((lowpan_iphc[1] & SIXLOWPAN_IPHC2_DAM) & 0x03) {
                 case (0x01): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &ll_prefix[0], 2);
-                    memset(&(ipv6_buf->destaddr.uint8[2]), 0, 6);
-                    memcpy(&(ipv6_buf->destaddr.uint8[8]),
+                    memcpy(&(hdr->destaddr.uint8[0]), &ll_prefix[0], 2);
+                    memset(&(hdr->destaddr.uint8[2]), 0, 6);
+                    memcpy(&(hdr->destaddr.uint8[8]),
                            &ipv6_hdr_fields[hdr_pos], 8);
                     hdr_pos += 8;
                     break;
                 }
 
                 case (0x02): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &ll_prefix[0], 2);
-                    memset(&(ipv6_buf->destaddr.uint8[2]), 0, 12);
-                    memcpy(&(ipv6_buf->destaddr.uint8[14]),
+                    memcpy(&(hdr->destaddr.uint8[0]), &ll_prefix[0], 2);
+                    memset(&(hdr->destaddr.uint8[2]), 0, 12);
+                    memcpy(&(hdr->destaddr.uint8[14]),
                            &ipv6_hdr_fields[hdr_pos], 2);
                     hdr_pos += 2;
                     break;
                 }
 
                 case (0x03): {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]), &ll_prefix, 2);
-                    memset(&(ipv6_buf->destaddr.uint8[2]), 0, 14);
-                    memcpy(&(ipv6_buf->destaddr.uint8[8]), &d_addr->uint8[0], 8);
+                    memcpy(&(hdr->destaddr.uint8[0]), &ll_prefix, 2);
+                    memset(&(hdr->destaddr.uint8[2]), 0, 14);
+                    memcpy(&(hdr->destaddr.uint8[8]), &d_addr->uint8[0], 8);
                     break;
                 }
 
                 default: {
-                    memcpy(&(ipv6_buf->destaddr.uint8[0]),
+                    memcpy(&(hdr->destaddr.uint8[0]),
                            &ipv6_hdr_fields[hdr_pos], 16);
                     hdr_pos += 16;
                     break;
@@ -1534,13 +1594,7 @@ void lowpan_iphc_decoding(uint8_t *data, uint8_t length, net_if_eui64_t *s_addr,
         }
     }
 
-    uint8_t *ptr = get_payload_buf(ipv6_ext_hdr_len);
-
-    memcpy(ptr, &ipv6_hdr_fields[hdr_pos], length - hdr_pos);
-
-    /* ipv6 length */
-    ipv6_buf->length = HTONS(length - hdr_pos);
-    packet_length = IPV6_HDR_LEN + ipv6_buf->length;
+    return hdr_pos;
 }
 
 uint8_t lowpan_context_len(void)
@@ -1663,19 +1717,6 @@ static void *lowpan_context_auto_remove(void *arg)
     return NULL;
 }
 
-void init_reas_bufs(lowpan_reas_buf_t *buf)
-{
-    memset(&buf->s_addr, 0, sizeof(net_if_eui64_t));
-    memset(&buf->d_addr, 0, sizeof(net_if_eui64_t));
-    buf->tag = 0;
-    memset(&buf->timestamp, 0, sizeof(timex_t));
-    buf->packet_size = 0;
-    buf->current_packet_size = 0;
-    buf->packet = NULL;
-    buf->interval_list_head = NULL;
-    buf->next = NULL;
-}
-
 int sixlowpan_lowpan_init_adhoc_interface(int if_id, const ipv6_addr_t *prefix)
 {
     ipv6_addr_t tmp;
@@ -1783,6 +1824,8 @@ int sixlowpan_lowpan_init(void)
 {
     short i;
 
+    lowpan_reas_init();
+
     /* init mac-layer and radio transceiver */
     sixlowpan_mac_init();
 
@@ -1796,7 +1839,9 @@ int sixlowpan_lowpan_init(void)
         return 0;
     }
 
-    nbr_cache_auto_rem();
+    if (nbr_cache_init() < 0) {
+        return 0;
+    }
 
     contexts_rem_pid = thread_create(con_buf, CON_STACKSIZE,
                                      PRIORITY_MAIN + 1, CREATE_STACKTEST,
@@ -1814,6 +1859,16 @@ int sixlowpan_lowpan_init(void)
         return 0;
     }
 
+#ifdef MODULE_SIXLOWPAN_FRAG_QUEUE
+    lowpan_frag_pid = thread_create(lowpan_frag_buf, LOWPAN_FRAG_STACKSIZE,
+                                    PRIORITY_MAIN - 1, CREATE_STACKTEST,
+                                    lowpan_frag_process, NULL, "lowpan_frag");
+
+    if (lowpan_frag_pid == KERNEL_PID_UNDEF) {
+        return 0;
+    }
+#endif
+
     for (i = 0; i < SIXLOWIP_MAX_REGISTERED; i++) {
         sixlowip_reg[i] = 0;
     }
@@ -27,6 +27,23 @@
 
 #define IEEE802154_TRANSCEIVER      (TRANSCEIVER_AT86RF231 | TRANSCEIVER_CC2420 | TRANSCEIVER_MC1322X)
 
+#ifndef LOWPAN_RX_RING_SIZE
+/* complete datagrams waiting for decompression, must be a power of two */
+#define LOWPAN_RX_RING_SIZE         (8)
+#endif
+
+#ifdef MODULE_SIXLOWPAN_FRAG_QUEUE
+#define LOWPAN_FRAG_STACKSIZE       (KERNEL_CONF_STACKSIZE_DEFAULT)
+#ifndef LOWPAN_FRAG_QUEUE_SIZE
+/* number of datagrams waiting to be fragmented, must be a power of two */
+#define LOWPAN_FRAG_QUEUE_SIZE      (4)
+#endif
+#ifndef LOWPAN_FRAG_PACING
+/* default pause between two fragments (in us) */
+#define LOWPAN_FRAG_PACING          (5000)
+#endif
+#endif
+
 typedef struct {
     uint8_t num;
     ipv6_addr_t prefix;
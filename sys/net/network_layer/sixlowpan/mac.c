@@ -35,6 +35,7 @@
 #include "lowpan.h"
 #include "ieee802154_frame.h"
 #include "net_help.h"
+#include "pktchain.h"
 
 #define ENABLE_DEBUG    (0)
 #if ENABLE_DEBUG
@@ -206,9 +207,10 @@ void set_ieee802154_frame_values(int if_id, uint16_t dest_pan,
     macdsn++;
 }
 
-int sixlowpan_mac_prepare_ieee802144_frame(
-    ieee802154_frame_t *frame, int if_id, uint16_t dest_pan, const void *dest,
-    uint8_t dest_len, const void *payload, uint8_t length, uint8_t mcast)
+static int _prepare_frame(ieee802154_frame_t *frame, int if_id,
+                          uint16_t dest_pan, const void *dest,
+                          uint8_t dest_len, const pktchain_t *payload,
+                          uint8_t length, uint8_t mcast)
 {
     uint8_t src_mode = net_if_get_src_address_mode(if_id);
     uint8_t dest_mode;
@@ -248,13 +250,14 @@ int sixlowpan_mac_prepare_ieee802144_frame(
         memcpy(&frame->dest_addr[0], dest, dest_len);
     }
 
-    frame->payload = (uint8_t *)payload; // payload won't be changed so cast is legal.
     frame->payload_len = length;
     uint8_t hdrlen = ieee802154_frame_get_hdr_len(frame);
 
     memset(&lowpan_mac_buf, 0, PAYLOAD_SIZE);
     ieee802154_frame_init(frame, (uint8_t *)&lowpan_mac_buf);
-    memcpy(&lowpan_mac_buf[hdrlen], frame->payload, frame->payload_len);
+    /* the only copy of the payload on its way down the stack */
+    pktchain_gather(payload, 0, &lowpan_mac_buf[hdrlen], frame->payload_len);
+    frame->payload = &lowpan_mac_buf[hdrlen];
     /* set FCS */
 #ifdef MODULE_CC110X_LEGACY
     fcs = (uint16_t *)&lowpan_mac_buf[frame->payload_len + hdrlen+1];
@@ -269,6 +272,17 @@ int sixlowpan_mac_prepare_ieee802144_frame(
     return hdrlen;
 }
 
+int sixlowpan_mac_prepare_ieee802144_frame(
+    ieee802154_frame_t *frame, int if_id, uint16_t dest_pan, const void *dest,
+    uint8_t dest_len, const void *payload, uint8_t length, uint8_t mcast)
+{
+    pktchain_t node;
+
+    return _prepare_frame(frame, if_id, dest_pan, dest, dest_len,
+                          pktchain_prepend(&node, payload, length, NULL),
+                          length, mcast);
+}
+
 int sixlowpan_mac_send_data(int if_id,
                             const void *dest, uint8_t dest_len,
                             const void *payload,
@@ -298,19 +312,44 @@ int sixlowpan_mac_send_ieee802154_frame(int if_id,
                                         const void *payload,
                                         uint8_t payload_len, uint8_t mcast)
 {
+    pktchain_t node;
+
+    return sixlowpan_mac_send_ieee802154_chain(if_id, dest, dest_len,
+                                               pktchain_prepend(&node, payload,
+                                                                payload_len,
+                                                                NULL),
+                                               mcast);
+}
+
+int sixlowpan_mac_send_ieee802154_chain(int if_id,
+                                        const void *dest, uint8_t dest_len,
+                                        const pktchain_t *payload,
+                                        uint8_t mcast)
+{
+    size_t payload_len = pktchain_len(payload);
+
+    if (payload_len > PAYLOAD_SIZE) {
+        return -1;
+    }
+
     if (net_if_get_interface(if_id) &&
         net_if_get_interface(if_id)->transceivers & IEEE802154_TRANSCEIVER) {
-        return sixlowpan_mac_send_data(if_id, dest, dest_len, payload,
+        /* the transceiver frames the payload itself */
+        if (payload->next != NULL) {
+            pktchain_gather(payload, 0, lowpan_mac_buf, payload_len);
+            return sixlowpan_mac_send_data(if_id, dest, dest_len,
+                                           lowpan_mac_buf, payload_len, mcast);
+        }
+
+        return sixlowpan_mac_send_data(if_id, dest, dest_len, payload->data,
                                        payload_len, mcast);
     }
     else {
         ieee802154_frame_t frame;
         uint16_t dest_pan = HTONS(0xabcd);
         uint8_t length;
-        int hdrlen = sixlowpan_mac_prepare_ieee802144_frame(&frame, if_id,
-                                                            dest_pan, dest,
-                                                            dest_len, payload,
-                                                            payload_len, mcast);
+        int hdrlen = _prepare_frame(&frame, if_id, dest_pan, dest, dest_len,
+                                    payload, payload_len, mcast);
 
         if (hdrlen < 0) {
             return -1;
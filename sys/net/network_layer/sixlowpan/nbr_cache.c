@@ -0,0 +1,600 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup sixlowpan
+ * @{
+ * @file    nbr_cache.c
+ * @brief   Neighbor cache with hashed lookup, LRU replacement and neighbor
+ *          unreachability detection
+ * @}
+ */
+
+#include <string.h>
+
+#include "msg.h"
+#include "mutex.h"
+#include "thread.h"
+#include "vtimer.h"
+#include "pktbuf.h"
+#include "sixlowpan/lowpan.h"
+
+#include "icmp.h"
+#include "nbr_cache.h"
+
+#define ENABLE_DEBUG    (0)
+#if ENABLE_DEBUG
+#define DEBUG_ENABLED
+static char addr_str[IPV6_MAX_ADDR_STR_LEN];
+#endif
+#include "debug.h"
+
+static ndp_neighbor_cache_t nbr_cache[NBR_CACHE_SIZE];
+static uint8_t buckets[NBR_CACHE_HASH_SIZE];
+/* used entries, most recently used first */
+static uint8_t lru_head;
+static uint8_t lru_tail;
+/* unused entries are chained through hash_next */
+static uint8_t free_head;
+static mutex_t nbr_cache_mutex = MUTEX_INIT;
+
+static kernel_pid_t nbr_cache_pid = KERNEL_PID_UNDEF;
+static char nbr_cache_stack[NBR_CACHE_STACKSIZE];
+static msg_t nbr_cache_msg_queue[NBR_CACHE_MSG_QUEUE_SIZE];
+/* solicitations are built here, the IP thread works on the buffers of icmp.c */
+static uint8_t nbr_cache_sol_buf[ICMPV6_NBR_SOL_BUF_LEN] __attribute__((aligned(4)));
+
+static uint8_t _hash(const ipv6_addr_t *addr)
+{
+    uint32_t h = 0;
+
+    /* entries are packed, read the address bytewise */
+    for (unsigned i = 0; i < sizeof(ipv6_addr_t); i++) {
+        h = (h * 31) + addr->uint8[i];
+    }
+
+    h ^= h >> 16;
+    h ^= h >> 8;
+    return h & (NBR_CACHE_HASH_SIZE - 1);
+}
+
+static uint8_t _find(const ipv6_addr_t *addr)
+{
+    uint8_t idx = buckets[_hash(addr)];
+
+    while ((idx != NBR_CACHE_NONE) &&
+           (memcmp(&nbr_cache[idx].addr, addr, sizeof(ipv6_addr_t)) != 0)) {
+        idx = nbr_cache[idx].hash_next;
+    }
+
+    return idx;
+}
+
+static void _lru_unlink(uint8_t idx)
+{
+    ndp_neighbor_cache_t *nce = &nbr_cache[idx];
+
+    if (nce->lru_prev != NBR_CACHE_NONE) {
+        nbr_cache[nce->lru_prev].lru_next = nce->lru_next;
+    }
+    else {
+        lru_head = nce->lru_next;
+    }
+
+    if (nce->lru_next != NBR_CACHE_NONE) {
+        nbr_cache[nce->lru_next].lru_prev = nce->lru_prev;
+    }
+    else {
+        lru_tail = nce->lru_prev;
+    }
+}
+
+static void _lru_push(uint8_t idx)
+{
+    nbr_cache[idx].lru_prev = NBR_CACHE_NONE;
+    nbr_cache[idx].lru_next = lru_head;
+
+    if (lru_head != NBR_CACHE_NONE) {
+        nbr_cache[lru_head].lru_prev = idx;
+    }
+    else {
+        lru_tail = idx;
+    }
+
+    lru_head = idx;
+}
+
+static void _touch(uint8_t idx)
+{
+    if (idx != lru_head) {
+        _lru_unlink(idx);
+        _lru_push(idx);
+    }
+}
+
+static void _remove(uint8_t idx)
+{
+    ndp_neighbor_cache_t *nce = &nbr_cache[idx];
+    uint8_t *link = &buckets[_hash(&nce->addr)];
+
+    while (*link != idx) {
+        link = &nbr_cache[*link].hash_next;
+    }
+
+    *link = nce->hash_next;
+    _lru_unlink(idx);
+
+    if (nce->queued != NULL) {
+        pktbuf_release(nce->queued);
+    }
+
+    memset(nce, 0, sizeof(*nce));
+    nce->hash_next = free_head;
+    free_head = idx;
+}
+
+/* takes a free entry or replaces the least recently used one */
+static uint8_t _take(void)
+{
+    uint8_t idx = free_head;
+
+    if (idx == NBR_CACHE_NONE) {
+        /* registered entries belong to their host until it leaves */
+        for (idx = lru_tail; idx != NBR_CACHE_NONE; idx = nbr_cache[idx].lru_prev) {
+            if (nbr_cache[idx].type != NDP_NCE_TYPE_REGISTERED) {
+                break;
+            }
+        }
+
+        if (idx == NBR_CACHE_NONE) {
+            return NBR_CACHE_NONE;
+        }
+
+        DEBUG("nbr_cache: replacing %s\n",
+              ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &nbr_cache[idx].addr));
+        _remove(idx);
+    }
+
+    free_head = nbr_cache[idx].hash_next;
+    return idx;
+}
+
+static uint8_t _add(const ipv6_addr_t *addr)
+{
+    uint8_t idx = _take();
+
+    if (idx != NBR_CACHE_NONE) {
+        uint8_t bucket = _hash(addr);
+        ndp_neighbor_cache_t *nce = &nbr_cache[idx];
+
+        memset(nce, 0, sizeof(*nce));
+        memcpy(&nce->addr, addr, sizeof(ipv6_addr_t));
+        nce->hash_next = buckets[bucket];
+        buckets[bucket] = idx;
+        _lru_push(idx);
+    }
+
+    return idx;
+}
+
+/* keeps the newest packet if one waits already (RFC 4861, section 7.2.2) */
+static void _queue(ndp_neighbor_cache_t *nce, const pktchain_t *packet)
+{
+    if (packet == NULL) {
+        return;
+    }
+
+    if (nce->queued != NULL) {
+        pktbuf_release(nce->queued);
+    }
+
+    nce->queued = pktchain_to_pktbuf(packet);
+    nce->queued_len = (nce->queued != NULL) ? pktchain_len(packet) : 0;
+}
+
+static void _set_state(ndp_neighbor_cache_t *nce, ndp_nce_state_t state)
+{
+    nce->state = state;
+    nce->probes = 0;
+    nce->solicit = 0;
+
+    switch (state) {
+        case NDP_NCE_STATUS_INCOMPLETE:
+        case NDP_NCE_STATUS_PROBE:
+            nce->solicit = 1;
+            nce->timer = NBR_CACHE_RETRANS_TIMER;
+            break;
+
+        case NDP_NCE_STATUS_REACHABLE:
+            nce->timer = NBR_CACHE_REACHABLE_TIME;
+            break;
+
+        case NDP_NCE_STATUS_DELAY:
+            nce->timer = NBR_CACHE_DELAY_FIRST_PROBE_TIME;
+            break;
+
+        default:
+            nce->timer = 0;
+            break;
+    }
+}
+
+static void _fill_hop(const ndp_neighbor_cache_t *nce, ipv6_ll_hop_t *hop)
+{
+    hop->if_id = nce->if_id;
+    hop->addr_len = nce->lladdr_len;
+    memcpy(hop->addr, nce->lladdr, nce->lladdr_len);
+}
+
+/* link layer address a link-local address is derived from */
+static void _ll_hop_from_iid(const ipv6_addr_t *addr, ipv6_ll_hop_t *hop)
+{
+    static const uint8_t short_iid[] = { 0x00, 0x00, 0x00, 0xff, 0xfe, 0x00 };
+
+    hop->if_id = 0;
+
+    if (memcmp(&addr->uint8[8], short_iid, sizeof(short_iid)) == 0) {
+        hop->addr_len = 2;
+        memcpy(hop->addr, &addr->uint8[14], 2);
+    }
+    else {
+        hop->addr_len = 8;
+        memcpy(hop->addr, &addr->uint8[8], 8);
+        /* the universal/local bit is inverted in the IID */
+        hop->addr[0] ^= 0x02;
+    }
+}
+
+/* advances the timers of all entries by a second */
+static void _tick(void)
+{
+    for (uint8_t idx = 0; idx < NBR_CACHE_SIZE; idx++) {
+        ndp_neighbor_cache_t *nce = &nbr_cache[idx];
+
+        if (nce->type == 0) {
+            continue;
+        }
+
+        if ((nce->ltime != 0) && (nce->type != NDP_NCE_TYPE_GC) &&
+            (--nce->ltime == 0)) {
+            _remove(idx);
+            continue;
+        }
+
+        if ((nce->timer == 0) || (--nce->timer != 0)) {
+            continue;
+        }
+
+        switch (nce->state) {
+            case NDP_NCE_STATUS_INCOMPLETE:
+            case NDP_NCE_STATUS_PROBE:
+                if (nce->probes >= ((nce->state == NDP_NCE_STATUS_PROBE) ?
+                                    NBR_CACHE_MAX_UNICAST_SOLICIT :
+                                    NBR_CACHE_MAX_MULTICAST_SOLICIT)) {
+                    DEBUG("nbr_cache: %s unreachable\n",
+                          ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &nce->addr));
+                    _remove(idx);
+                }
+                else {
+                    nce->solicit = 1;
+                    nce->timer = NBR_CACHE_RETRANS_TIMER;
+                }
+
+                break;
+
+            case NDP_NCE_STATUS_REACHABLE:
+                _set_state(nce, NDP_NCE_STATUS_STALE);
+                break;
+
+            case NDP_NCE_STATUS_DELAY:
+                _set_state(nce, NDP_NCE_STATUS_PROBE);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/* finds the next entry from *idx on a solicitation is due for and counts
+ * it as sent, returns 0 if there is none */
+static int _next_solicit(uint8_t *idx, ipv6_addr_t *target, int *unicast)
+{
+    mutex_lock(&nbr_cache_mutex);
+
+    for (; *idx < NBR_CACHE_SIZE; (*idx)++) {
+        ndp_neighbor_cache_t *nce = &nbr_cache[*idx];
+
+        if (nce->solicit) {
+            memcpy(target, &nce->addr, sizeof(ipv6_addr_t));
+            *unicast = (nce->state == NDP_NCE_STATUS_PROBE);
+            nce->solicit = 0;
+            nce->probes++;
+
+            mutex_unlock(&nbr_cache_mutex);
+            return 1;
+        }
+    }
+
+    mutex_unlock(&nbr_cache_mutex);
+    return 0;
+}
+
+/* sends the solicitations that are due, without holding the cache */
+static void _solicit(void)
+{
+    ipv6_addr_t target;
+    int unicast;
+
+    for (uint8_t idx = 0; _next_solicit(&idx, &target, &unicast); idx++) {
+        /* unresolved neighbors are asked through their solicited-node
+         * multicast address */
+        icmpv6_send_nbr_sol_buf(nbr_cache_sol_buf, unicast ? &target : NULL,
+                                &target);
+    }
+}
+
+static void *nbr_cache_process(void *arg)
+{
+    (void) arg;
+
+    msg_t m;
+    vtimer_t timer;
+    timex_t interval = timex_set(1, 0);
+
+    msg_init_queue(nbr_cache_msg_queue, NBR_CACHE_MSG_QUEUE_SIZE);
+    vtimer_set_msg(&timer, interval, thread_getpid(), NULL);
+
+    while (1) {
+        msg_receive(&m);
+
+        if (m.type == MSG_TIMER) {
+            mutex_lock(&nbr_cache_mutex);
+            _tick();
+            mutex_unlock(&nbr_cache_mutex);
+            vtimer_set_msg(&timer, interval, thread_getpid(), NULL);
+        }
+
+        _solicit();
+    }
+
+    return NULL;
+}
+
+/* empties the cache, call with nbr_cache_mutex locked */
+static void _clear(void)
+{
+    for (uint8_t idx = 0; idx < NBR_CACHE_SIZE; idx++) {
+        if (nbr_cache[idx].queued != NULL) {
+            pktbuf_release(nbr_cache[idx].queued);
+        }
+    }
+
+    memset(nbr_cache, 0, sizeof(nbr_cache));
+    memset(buckets, NBR_CACHE_NONE, sizeof(buckets));
+    lru_head = NBR_CACHE_NONE;
+    lru_tail = NBR_CACHE_NONE;
+    free_head = NBR_CACHE_NONE;
+
+    for (int idx = NBR_CACHE_SIZE - 1; idx >= 0; idx--) {
+        nbr_cache[idx].hash_next = free_head;
+        free_head = idx;
+    }
+}
+
+int nbr_cache_init(void)
+{
+    mutex_lock(&nbr_cache_mutex);
+    _clear();
+    mutex_unlock(&nbr_cache_mutex);
+
+    if (nbr_cache_pid == KERNEL_PID_UNDEF) {
+        nbr_cache_pid = thread_create(nbr_cache_stack, NBR_CACHE_STACKSIZE,
+                                      PRIORITY_MAIN - 1, CREATE_STACKTEST,
+                                      nbr_cache_process, NULL, "nbr_cache");
+    }
+
+    return (nbr_cache_pid == KERNEL_PID_UNDEF) ? -1 : 0;
+}
+
+int nbr_cache_resolve(const ipv6_addr_t *addr, const pktchain_t *packet,
+                      ipv6_ll_hop_t *hop)
+{
+    mutex_lock(&nbr_cache_mutex);
+
+    uint8_t idx = _find(addr);
+
+    if (idx != NBR_CACHE_NONE) {
+        ndp_neighbor_cache_t *nce = &nbr_cache[idx];
+
+        _touch(idx);
+
+        if (nce->state == NDP_NCE_STATUS_INCOMPLETE) {
+            _queue(nce, packet);
+            mutex_unlock(&nbr_cache_mutex);
+            return 0;
+        }
+
+        if (nce->state == NDP_NCE_STATUS_STALE) {
+            /* give upper layers some time to confirm reachability */
+            _set_state(nce, NDP_NCE_STATUS_DELAY);
+        }
+
+        _fill_hop(nce, hop);
+        mutex_unlock(&nbr_cache_mutex);
+        return 1;
+    }
+
+    if (ipv6_addr_is_link_local(addr)) {
+        mutex_unlock(&nbr_cache_mutex);
+        _ll_hop_from_iid(addr, hop);
+        return 1;
+    }
+
+    idx = _add(addr);
+
+    if (idx == NBR_CACHE_NONE) {
+        mutex_unlock(&nbr_cache_mutex);
+        return -1;
+    }
+
+    nbr_cache[idx].type = NDP_NCE_TYPE_GC;
+    _set_state(&nbr_cache[idx], NDP_NCE_STATUS_INCOMPLETE);
+    _queue(&nbr_cache[idx], packet);
+
+    mutex_unlock(&nbr_cache_mutex);
+
+    DEBUG("nbr_cache: resolving %s\n",
+          ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, addr));
+
+    /* the first solicitation is not delayed until the next tick */
+    if (nbr_cache_pid != KERNEL_PID_UNDEF) {
+        msg_t m;
+        m.type = 0;
+        msg_try_send(&m, nbr_cache_pid);
+    }
+
+    return 0;
+}
+
+void nbr_cache_set_state(ndp_neighbor_cache_t *nce, ndp_nce_state_t state)
+{
+    void *queued = NULL;
+    uint16_t queued_len = 0;
+    ipv6_ll_hop_t hop;
+
+    mutex_lock(&nbr_cache_mutex);
+
+    if (nce->type == 0) {
+        mutex_unlock(&nbr_cache_mutex);
+        return;
+    }
+
+    _set_state(nce, state);
+
+    if ((state != NDP_NCE_STATUS_INCOMPLETE) && (nce->queued != NULL)) {
+        queued = nce->queued;
+        queued_len = nce->queued_len;
+        nce->queued = NULL;
+        _fill_hop(nce, &hop);
+    }
+
+    mutex_unlock(&nbr_cache_mutex);
+
+    if (queued != NULL) {
+        sixlowpan_lowpan_sendto(hop.if_id, hop.addr, hop.addr_len, queued,
+                                queued_len);
+        pktbuf_release(queued);
+    }
+}
+
+ndp_neighbor_cache_t *ndp_neighbor_cache_search(ipv6_addr_t *ipaddr)
+{
+    mutex_lock(&nbr_cache_mutex);
+    uint8_t idx = _find(ipaddr);
+    mutex_unlock(&nbr_cache_mutex);
+
+    return (idx != NBR_CACHE_NONE) ? &nbr_cache[idx] : NULL;
+}
+
+ndp_neighbor_cache_t *ndp_get_ll_address(ipv6_addr_t *ipaddr)
+{
+    ndp_neighbor_cache_t *nce = NULL;
+
+    mutex_lock(&nbr_cache_mutex);
+    uint8_t idx = _find(ipaddr);
+
+    if ((idx != NBR_CACHE_NONE) &&
+        (nbr_cache[idx].state != NDP_NCE_STATUS_INCOMPLETE)) {
+        _touch(idx);
+        nce = &nbr_cache[idx];
+    }
+
+    mutex_unlock(&nbr_cache_mutex);
+
+    return nce;
+}
+
+uint8_t ndp_neighbor_cache_add(int if_id, const ipv6_addr_t *ipaddr,
+                               const void *lladdr, uint8_t lladdr_len,
+                               uint8_t isrouter, ndp_nce_state_t state,
+                               ndp_nce_type_t type, uint32_t ltime)
+{
+    mutex_lock(&nbr_cache_mutex);
+
+    uint8_t idx = _find(ipaddr);
+
+    if (idx == NBR_CACHE_NONE) {
+        idx = _add(ipaddr);
+    }
+    else {
+        _touch(idx);
+    }
+
+    if (idx == NBR_CACHE_NONE) {
+        mutex_unlock(&nbr_cache_mutex);
+        DEBUG("ERROR: neighbor cache full\n");
+        return NDP_OPT_ARO_STATE_NBR_CACHE_FULL;
+    }
+
+    ndp_neighbor_cache_t *nce = &nbr_cache[idx];
+
+    nce->if_id = if_id;
+    memcpy(nce->lladdr, lladdr, lladdr_len);
+    nce->lladdr_len = lladdr_len;
+    nce->isrouter = isrouter;
+    nce->type = type;
+    nce->ltime = ltime;
+
+    mutex_unlock(&nbr_cache_mutex);
+
+    nbr_cache_set_state(nce, state);
+
+    return NDP_OPT_ARO_STATE_SUCCESS;
+}
+
+uint8_t ndp_neighbor_cache_remove(const ipv6_addr_t *ipaddr)
+{
+    mutex_lock(&nbr_cache_mutex);
+
+    uint8_t idx = _find(ipaddr);
+
+    if (idx != NBR_CACHE_NONE) {
+        _remove(idx);
+    }
+
+    mutex_unlock(&nbr_cache_mutex);
+
+    return (idx != NBR_CACHE_NONE);
+}
+
+#ifdef TEST_SUITES
+void nbr_cache_reset(void)
+{
+    mutex_lock(&nbr_cache_mutex);
+    _clear();
+    mutex_unlock(&nbr_cache_mutex);
+}
+
+unsigned nbr_cache_tick(void)
+{
+    ipv6_addr_t target;
+    int unicast;
+    unsigned due = 0;
+
+    mutex_lock(&nbr_cache_mutex);
+    _tick();
+    mutex_unlock(&nbr_cache_mutex);
+
+    for (uint8_t idx = 0; _next_solicit(&idx, &target, &unicast); idx++) {
+        due++;
+    }
+
+    return due;
+}
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup sixlowpan
+ * @{
+ * @file    network_layer/sixlowpan/nbr_cache.h
+ * @brief   Neighbor cache with neighbor unreachability detection
+ *
+ * Entries are found through a hash over the IPv6 address and kept in LRU
+ * order. A full cache replaces the least recently used entry that is not
+ * registered by a host.
+ *
+ * Unknown neighbors are resolved and the reachability of known ones is
+ * confirmed as described in RFC 4861, section 7.3. A packet to a neighbor
+ * that is being resolved waits in its entry until the neighbor advertisement
+ * arrives. Link-local addresses are not resolved, their link layer address
+ * is derived from the interface identifier (RFC 6775, section 5.6).
+ *
+ * Solicitations and timeouts are handled by the thread "nbr_cache", which
+ * ticks once per second.
+ * @}
+ */
+
+#ifndef _SIXLOWPAN_NBR_CACHE_H
+#define _SIXLOWPAN_NBR_CACHE_H
+
+#include <stdint.h>
+
+#include "pktchain.h"
+#include "sixlowpan/ndp.h"
+
+#include "ip.h"
+
+#ifndef NBR_CACHE_SIZE
+/* neighbors in the cache, at most 254 */
+#ifdef CPU_NATIVE
+#define NBR_CACHE_SIZE                      (64)
+#else
+#define NBR_CACHE_SIZE                      (16)
+#endif
+#endif
+
+#ifndef NBR_CACHE_HASH_SIZE
+/* number of hash buckets, must be a power of two */
+#ifdef CPU_NATIVE
+#define NBR_CACHE_HASH_SIZE                 (32)
+#else
+#define NBR_CACHE_HASH_SIZE                 (8)
+#endif
+#endif
+
+/* lifetime of tentative entries in s (RFC 6775, section 9) */
+#define NBR_CACHE_LTIME_TEN                 (20)
+
+/* protocol constants of RFC 4861, section 10, times in s */
+#define NBR_CACHE_MAX_MULTICAST_SOLICIT     (3)
+#define NBR_CACHE_MAX_UNICAST_SOLICIT       (3)
+#define NBR_CACHE_REACHABLE_TIME            (30)
+#define NBR_CACHE_RETRANS_TIMER             (1)
+#define NBR_CACHE_DELAY_FIRST_PROBE_TIME    (5)
+
+#define NBR_CACHE_STACKSIZE                 (KERNEL_CONF_STACKSIZE_MAIN)
+#define NBR_CACHE_MSG_QUEUE_SIZE            (4)
+
+/* index of no entry */
+#define NBR_CACHE_NONE                      (0xff)
+
+#if NBR_CACHE_SIZE >= NBR_CACHE_NONE
+#error "NBR_CACHE_SIZE must be less than 255"
+#endif
+
+/**
+ * @brief   Empties the cache and starts the thread handling its timers.
+ *
+ * @return  0 on success, -1 if the thread could not be started.
+ */
+int nbr_cache_init(void);
+
+/**
+ * @brief   Finds the link layer address to send a packet to a neighbor.
+ *
+ * @details Starts address resolution for an unknown neighbor, a neighbor
+ *          in state STALE is probed if it is not confirmed in time.
+ *
+ * @param[in] addr      IPv6 address of the neighbor.
+ * @param[in] packet    The IPv6 packet, it is copied to wait for the
+ *                      resolution. May be NULL.
+ * @param[out] hop      The link layer next hop.
+ *
+ * @return  1 if *hop* was filled in,
+ *          0 if the neighbor is being resolved, the packet waits for it,
+ *          -1 if the cache is full.
+ */
+int nbr_cache_resolve(const ipv6_addr_t *addr, const pktchain_t *packet,
+                      ipv6_ll_hop_t *hop);
+
+/**
+ * @brief   Moves an entry to a new state after a neighbor advertisement
+ *          or solicitation updated it.
+ *
+ * @details Restarts the timers of the entry and sends a waiting packet if
+ *          the link layer address of the neighbor is known now.
+ */
+void nbr_cache_set_state(ndp_neighbor_cache_t *nce, ndp_nce_state_t state);
+
+/* for testing */
+#ifdef TEST_SUITES
+/**
+ * @brief   Empties the cache without starting the thread.
+ */
+void nbr_cache_reset(void);
+
+/**
+ * @brief   Advances the timers by a second like the thread does.
+ *
+ * @return  The number of solicitations that are due, they are counted as
+ *          sent but not sent.
+ */
+unsigned nbr_cache_tick(void);
+#endif
+
+#endif /* _SIXLOWPAN_NBR_CACHE_H */
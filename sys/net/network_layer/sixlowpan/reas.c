@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup sixlowpan
+ * @{
+ * @file    reas.c
+ * @brief   6LoWPAN fragment reassembly in a fixed pool of buffers
+ * @}
+ */
+
+#include <string.h>
+
+#include "mutex.h"
+#include "timex.h"
+#include "vtimer.h"
+
+#include "reas.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#define TIMEOUT_TICKS   (LOWPAN_REAS_BUF_TIMEOUT / LOWPAN_REAS_WHEEL_TICK)
+
+/* a is not after b on the wheel */
+#define TICK_LEQ(a, b)  ((int32_t)((a) - (b)) <= 0)
+
+lowpan_reas_stats_t lowpan_reas_stats;
+
+static lowpan_reas_buf_t pool[LOWPAN_REAS_BUF_NUMOF];
+static uint8_t buckets[LOWPAN_REAS_HASH_SIZE];
+static uint8_t wheel[LOWPAN_REAS_WHEEL_SLOTS];
+/* tick up to which the wheel has been expired */
+static uint32_t wheel_now;
+
+/* free buffers are chained through hash_next, released ones come from the
+ * IPv6 side */
+static uint8_t free_head;
+static mutex_t free_mutex = MUTEX_INIT;
+
+static uint32_t _tick(void)
+{
+    timex_t now;
+    vtimer_now(&now);
+    return (uint32_t)(timex_uint64(now) / LOWPAN_REAS_WHEEL_TICK);
+}
+
+static uint8_t _hash(uint16_t datagram_size, uint16_t datagram_tag,
+                     const net_if_eui64_t *s_addr, const net_if_eui64_t *d_addr)
+{
+    uint32_t h = (((uint32_t) datagram_size) << 16) | datagram_tag;
+
+    /* addresses are packed, read them bytewise */
+    for (unsigned i = 0; i < sizeof(net_if_eui64_t); i++) {
+        h = (h * 31) + (s_addr->uint8[i] ^ (d_addr->uint8[i] << 4));
+    }
+
+    h ^= h >> 16;
+    h ^= h >> 8;
+    return h & (LOWPAN_REAS_HASH_SIZE - 1);
+}
+
+static void _hash_unlink(uint8_t idx)
+{
+    lowpan_reas_buf_t *buf = &pool[idx];
+    uint8_t *link = &buckets[_hash(buf->packet_size, buf->tag, &buf->s_addr,
+                                   &buf->d_addr)];
+
+    while (*link != idx) {
+        link = &pool[*link].hash_next;
+    }
+
+    *link = buf->hash_next;
+}
+
+static void _wheel_link(uint8_t idx)
+{
+    uint8_t slot = pool[idx].expires % LOWPAN_REAS_WHEEL_SLOTS;
+
+    pool[idx].wheel_prev = LOWPAN_REAS_NONE;
+    pool[idx].wheel_next = wheel[slot];
+
+    if (wheel[slot] != LOWPAN_REAS_NONE) {
+        pool[wheel[slot]].wheel_prev = idx;
+    }
+
+    wheel[slot] = idx;
+}
+
+static void _wheel_unlink(uint8_t idx)
+{
+    lowpan_reas_buf_t *buf = &pool[idx];
+
+    if (buf->wheel_prev != LOWPAN_REAS_NONE) {
+        pool[buf->wheel_prev].wheel_next = buf->wheel_next;
+    }
+    else {
+        wheel[buf->expires % LOWPAN_REAS_WHEEL_SLOTS] = buf->wheel_next;
+    }
+
+    if (buf->wheel_next != LOWPAN_REAS_NONE) {
+        pool[buf->wheel_next].wheel_prev = buf->wheel_prev;
+    }
+}
+
+static uint8_t _pop_free(void)
+{
+    mutex_lock(&free_mutex);
+    uint8_t idx = free_head;
+
+    if (idx != LOWPAN_REAS_NONE) {
+        free_head = pool[idx].hash_next;
+    }
+
+    mutex_unlock(&free_mutex);
+    return idx;
+}
+
+static void _push_free(uint8_t idx)
+{
+    mutex_lock(&free_mutex);
+    pool[idx].state = LOWPAN_REAS_STATE_FREE;
+    pool[idx].hash_next = free_head;
+    free_head = idx;
+    mutex_unlock(&free_mutex);
+}
+
+/* gives up a datagram in reassembly */
+static void _drop(uint8_t idx)
+{
+    _hash_unlink(idx);
+    _wheel_unlink(idx);
+    _push_free(idx);
+}
+
+static void _advance(uint32_t now)
+{
+    uint32_t t = wheel_now;
+
+    /* after a full turn every slot has been visited */
+    if ((now - t) > LOWPAN_REAS_WHEEL_SLOTS) {
+        t = now - LOWPAN_REAS_WHEEL_SLOTS;
+    }
+
+    while (t != now) {
+        t++;
+        uint8_t idx = wheel[t % LOWPAN_REAS_WHEEL_SLOTS];
+
+        while (idx != LOWPAN_REAS_NONE) {
+            uint8_t next = pool[idx].wheel_next;
+
+            if (TICK_LEQ(pool[idx].expires, now)) {
+                DEBUG("reas: tag %u timed out\n", pool[idx].tag);
+                _drop(idx);
+                lowpan_reas_stats.timeouts++;
+            }
+
+            idx = next;
+        }
+    }
+
+    wheel_now = now;
+}
+
+/* datagram in reassembly that times out first */
+static uint8_t _oldest(void)
+{
+    for (uint32_t t = wheel_now + 1; t != (wheel_now + 1 + LOWPAN_REAS_WHEEL_SLOTS); t++) {
+        uint8_t idx = wheel[t % LOWPAN_REAS_WHEEL_SLOTS];
+
+        if (idx != LOWPAN_REAS_NONE) {
+            return idx;
+        }
+    }
+
+    return LOWPAN_REAS_NONE;
+}
+
+static uint8_t _take(void)
+{
+    uint8_t idx = _pop_free();
+
+    if (idx == LOWPAN_REAS_NONE) {
+        idx = _oldest();
+
+        if (idx == LOWPAN_REAS_NONE) {
+            /* all buffers wait for the IPv6 layer */
+            lowpan_reas_stats.no_buf++;
+            return LOWPAN_REAS_NONE;
+        }
+
+        DEBUG("reas: tag %u evicted\n", pool[idx].tag);
+        _drop(idx);
+        lowpan_reas_stats.evicted++;
+        idx = _pop_free();
+    }
+
+    return idx;
+}
+
+/* mask of the bits first to last that lie in byte i of a bitmap */
+static uint8_t _range_mask(unsigned i, unsigned first, unsigned last)
+{
+    uint8_t mask = 0xff;
+
+    if (i == (first / 8)) {
+        mask &= 0xff << (first % 8);
+    }
+
+    if (i == (last / 8)) {
+        mask &= 0xff >> (7 - (last % 8));
+    }
+
+    return mask;
+}
+
+void lowpan_reas_init(void)
+{
+    memset(pool, 0, sizeof(pool));
+    memset(buckets, LOWPAN_REAS_NONE, sizeof(buckets));
+    memset(wheel, LOWPAN_REAS_NONE, sizeof(wheel));
+    memset(&lowpan_reas_stats, 0, sizeof(lowpan_reas_stats));
+    wheel_now = 0;
+    free_head = LOWPAN_REAS_NONE;
+
+    for (int i = LOWPAN_REAS_BUF_NUMOF - 1; i >= 0; i--) {
+        _push_free(i);
+    }
+}
+
+lowpan_reas_buf_t *lowpan_reas_find(uint16_t datagram_size,
+                                    uint16_t datagram_tag,
+                                    const net_if_eui64_t *s_addr,
+                                    const net_if_eui64_t *d_addr)
+{
+    _advance(_tick());
+
+    uint8_t bucket = _hash(datagram_size, datagram_tag, s_addr, d_addr);
+
+    for (uint8_t idx = buckets[bucket]; idx != LOWPAN_REAS_NONE;
+         idx = pool[idx].hash_next) {
+        lowpan_reas_buf_t *buf = &pool[idx];
+
+        if ((buf->tag == datagram_tag) && (buf->packet_size == datagram_size) &&
+            (memcmp(&buf->s_addr, s_addr, sizeof(net_if_eui64_t)) == 0) &&
+            (memcmp(&buf->d_addr, d_addr, sizeof(net_if_eui64_t)) == 0)) {
+            return buf;
+        }
+    }
+
+    return NULL;
+}
+
+lowpan_reas_buf_t *lowpan_reas_get(uint16_t datagram_size,
+                                   uint16_t datagram_tag,
+                                   const net_if_eui64_t *s_addr,
+                                   const net_if_eui64_t *d_addr)
+{
+    if ((datagram_size == 0) || (datagram_size > LOWPAN_REAS_BUF_SIZE)) {
+        return NULL;
+    }
+
+    lowpan_reas_buf_t *buf = lowpan_reas_find(datagram_size, datagram_tag,
+                                              s_addr, d_addr);
+
+    if (buf != NULL) {
+        return buf;
+    }
+
+    uint8_t idx = _take();
+
+    if (idx == LOWPAN_REAS_NONE) {
+        return NULL;
+    }
+
+    buf = &pool[idx];
+
+    memcpy(&buf->s_addr, s_addr, sizeof(net_if_eui64_t));
+    memcpy(&buf->d_addr, d_addr, sizeof(net_if_eui64_t));
+    buf->tag = datagram_tag;
+    buf->packet_size = datagram_size;
+    buf->current_packet_size = 0;
+    buf->state = LOWPAN_REAS_STATE_ACTIVE;
+    memset(buf->received, 0, sizeof(buf->received));
+
+    uint8_t bucket = _hash(datagram_size, datagram_tag, s_addr, d_addr);
+
+    buf->hash_next = buckets[bucket];
+    buckets[bucket] = idx;
+
+    buf->expires = wheel_now + TIMEOUT_TICKS;
+    _wheel_link(idx);
+
+    return buf;
+}
+
+int lowpan_reas_add(lowpan_reas_buf_t *buf, uint16_t offset,
+                    const uint8_t *data, uint16_t len)
+{
+    if ((buf->state != LOWPAN_REAS_STATE_ACTIVE) || (len == 0) ||
+        ((offset + len) > buf->packet_size)) {
+        return LOWPAN_REAS_INVALID;
+    }
+
+    unsigned first = offset / 8;
+    unsigned last = (offset + len - 1) / 8;
+
+    for (unsigned i = first / 8; i <= (last / 8); i++) {
+        if (buf->received[i] & _range_mask(i, first, last)) {
+            lowpan_reas_stats.duplicates++;
+            return LOWPAN_REAS_DUPLICATE;
+        }
+    }
+
+    for (unsigned i = first / 8; i <= (last / 8); i++) {
+        buf->received[i] |= _range_mask(i, first, last);
+    }
+
+    memcpy(buf->packet + offset, data, len);
+    buf->current_packet_size += len;
+
+    uint8_t idx = buf - pool;
+
+    _wheel_unlink(idx);
+
+    if (buf->current_packet_size == buf->packet_size) {
+        _hash_unlink(idx);
+        buf->state = LOWPAN_REAS_STATE_DONE;
+        lowpan_reas_stats.completed++;
+        return LOWPAN_REAS_COMPLETE;
+    }
+
+    /* the timeout restarts with every fragment */
+    buf->expires = wheel_now + TIMEOUT_TICKS;
+    _wheel_link(idx);
+
+    return LOWPAN_REAS_INCOMPLETE;
+}
+
+lowpan_reas_buf_t *lowpan_reas_alloc(void)
+{
+    uint8_t idx = _take();
+
+    if (idx == LOWPAN_REAS_NONE) {
+        return NULL;
+    }
+
+    lowpan_reas_buf_t *buf = &pool[idx];
+
+    buf->tag = 0;
+    buf->packet_size = 0;
+    buf->current_packet_size = 0;
+    buf->state = LOWPAN_REAS_STATE_DONE;
+
+    return buf;
+}
+
+void lowpan_reas_release(lowpan_reas_buf_t *buf)
+{
+    _push_free(buf - pool);
+}
+
+void lowpan_reas_expire(void)
+{
+    _advance(_tick());
+}
+
+void lowpan_reas_foreach(void (*cb)(lowpan_reas_buf_t *buf))
+{
+    for (unsigned i = 0; i < LOWPAN_REAS_BUF_NUMOF; i++) {
+        if (pool[i].state != LOWPAN_REAS_STATE_FREE) {
+            cb(&pool[i]);
+        }
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup sixlowpan
+ * @{
+ * @file    network_layer/sixlowpan/reas.h
+ * @brief   6LoWPAN fragment reassembly
+ *
+ * Datagrams are reassembled in a fixed pool of buffers. A buffer is found
+ * through a hash over source, destination, tag and size, received 8 byte
+ * units are tracked in a bitmap and buffers of incomplete datagrams are kept
+ * in a timer wheel, so handling a fragment does not depend on the number of
+ * datagrams in reassembly.
+ *
+ * All functions but lowpan_reas_release() must be called from the thread
+ * that receives the frames.
+ * @}
+ */
+
+#ifndef _SIXLOWPAN_REAS_H
+#define _SIXLOWPAN_REAS_H
+
+#include <stdint.h>
+
+#include "net_if.h"
+#include "sixlowpan/ip.h"
+
+#ifndef LOWPAN_REAS_BUF_NUMOF
+/* datagrams in reassembly or waiting for the IPv6 layer, at most 255 */
+#define LOWPAN_REAS_BUF_NUMOF           (4)
+#endif
+
+#ifndef LOWPAN_REAS_BUF_SIZE
+/* largest datagram that can be reassembled */
+#define LOWPAN_REAS_BUF_SIZE            (IPV6_MTU)
+#endif
+
+/* unfragmented frames are kept in the same buffers */
+#if LOWPAN_REAS_BUF_SIZE < 127
+#error "LOWPAN_REAS_BUF_SIZE must hold an IEEE 802.15.4 frame"
+#endif
+
+#ifndef LOWPAN_REAS_HASH_SIZE
+/* number of hash buckets, must be a power of two */
+#define LOWPAN_REAS_HASH_SIZE           (8)
+#endif
+
+/* time after the last fragment of a datagram it is given up (in us) */
+#define LOWPAN_REAS_BUF_TIMEOUT         (15 * 1000 * 1000)
+/* TODO: Set back to 3 * 1000 * (1000) */
+
+/* resolution of the timer wheel (in us) */
+#define LOWPAN_REAS_WHEEL_TICK          (1000 * 1000)
+/* slots of the timer wheel, must exceed the timeout in ticks */
+#define LOWPAN_REAS_WHEEL_SLOTS         (16)
+
+#if (LOWPAN_REAS_BUF_TIMEOUT / LOWPAN_REAS_WHEEL_TICK) >= LOWPAN_REAS_WHEEL_SLOTS
+#error "LOWPAN_REAS_WHEEL_SLOTS too small for LOWPAN_REAS_BUF_TIMEOUT"
+#endif
+
+/* one bit per 8 byte unit of the datagram */
+#define LOWPAN_REAS_BITMAP_SIZE         ((LOWPAN_REAS_BUF_SIZE + 63) / 64)
+
+/* index of no buffer */
+#define LOWPAN_REAS_NONE                (0xff)
+
+/* return values of lowpan_reas_add() */
+#define LOWPAN_REAS_INCOMPLETE          (0)
+#define LOWPAN_REAS_COMPLETE            (1)
+#define LOWPAN_REAS_DUPLICATE           (-1)
+#define LOWPAN_REAS_INVALID             (-2)
+
+typedef enum {
+    LOWPAN_REAS_STATE_FREE = 0,
+    LOWPAN_REAS_STATE_ACTIVE,       ///< fragments missing
+    LOWPAN_REAS_STATE_DONE,         ///< owned by the caller until released
+} lowpan_reas_state_t;
+
+/**
+ * @brief   6LoWPAN reassembly buffer.
+ *
+ * @see <a href="http://tools.ietf.org/html/rfc4944#section-5.3">
+ *          RFC 4944, section 5.3
+ *      </a>
+ */
+typedef struct lowpan_reas_buf_t {
+    net_if_eui64_t s_addr;      ///< Source address
+    net_if_eui64_t d_addr;      ///< Destination address
+    uint16_t tag;               ///< Fragment tag
+    /**
+     * @brief   Size of reassembled packet with possible IPHC header
+     */
+    uint16_t packet_size;
+    /**
+     * @brief   Additive size of currently already received fragments
+     */
+    uint16_t current_packet_size;
+    uint32_t expires;           ///< wheel tick the datagram is given up
+    uint8_t state;              ///< lowpan_reas_state_t
+    uint8_t hash_next;          ///< next buffer in the same bucket
+    uint8_t wheel_prev;         ///< neighbours in the same wheel slot
+    uint8_t wheel_next;
+    uint8_t received[LOWPAN_REAS_BITMAP_SIZE];  ///< received 8 byte units
+    uint8_t packet[LOWPAN_REAS_BUF_SIZE];       ///< the datagram
+} lowpan_reas_buf_t;
+
+typedef struct {
+    uint32_t completed;         ///< datagrams reassembled
+    uint32_t timeouts;          ///< datagrams given up after the timeout
+    uint32_t evicted;           ///< datagrams given up for a newer one
+    uint32_t duplicates;        ///< overlapping fragments dropped
+    uint32_t no_buf;            ///< datagrams not started, no buffer
+} lowpan_reas_stats_t;
+
+extern lowpan_reas_stats_t lowpan_reas_stats;
+
+/**
+ * @brief   Empties the pool.
+ */
+void lowpan_reas_init(void);
+
+/**
+ * @brief   Finds the buffer of a datagram that is being reassembled.
+ *
+ * @return  the buffer, NULL if no fragment of the datagram was received.
+ */
+lowpan_reas_buf_t *lowpan_reas_find(uint16_t datagram_size,
+                                    uint16_t datagram_tag,
+                                    const net_if_eui64_t *s_addr,
+                                    const net_if_eui64_t *d_addr);
+
+/**
+ * @brief   Finds the buffer a fragment belongs to, or starts reassembly of
+ *          a new datagram.
+ *
+ * @details If the pool is exhausted the datagram with the nearest timeout
+ *          is given up.
+ *
+ * @return  the buffer, NULL if datagram_size is too large or no buffer is
+ *          available.
+ */
+lowpan_reas_buf_t *lowpan_reas_get(uint16_t datagram_size,
+                                   uint16_t datagram_tag,
+                                   const net_if_eui64_t *s_addr,
+                                   const net_if_eui64_t *d_addr);
+
+/**
+ * @brief   Copies a fragment into its buffer.
+ *
+ * @details A completed buffer leaves the lookup and timeout structures and
+ *          belongs to the caller until lowpan_reas_release().
+ *
+ * @return  LOWPAN_REAS_COMPLETE if this was the last missing fragment,
+ *          LOWPAN_REAS_INCOMPLETE if more are missing,
+ *          LOWPAN_REAS_DUPLICATE if the fragment overlaps a received one,
+ *          LOWPAN_REAS_INVALID if it exceeds the datagram.
+ */
+int lowpan_reas_add(lowpan_reas_buf_t *buf, uint16_t offset,
+                    const uint8_t *data, uint16_t len);
+
+/**
+ * @brief   Takes a buffer for a datagram that is not fragmented.
+ *
+ * @return  a buffer in state LOWPAN_REAS_STATE_DONE, NULL if none is free.
+ */
+lowpan_reas_buf_t *lowpan_reas_alloc(void);
+
+/**
+ * @brief   Returns a completed buffer to the pool, may be called from any
+ *          thread.
+ */
+void lowpan_reas_release(lowpan_reas_buf_t *buf);
+
+/**
+ * @brief   Gives up all datagrams whose timeout passed.
+ */
+void lowpan_reas_expire(void);
+
+/**
+ * @brief   Calls cb for every buffer that is not free.
+ */
+void lowpan_reas_foreach(void (*cb)(lowpan_reas_buf_t *buf));
+
+#endif /* _SIXLOWPAN_REAS_H */
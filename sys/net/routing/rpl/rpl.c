@@ -172,7 +172,7 @@ void send_DIO(ipv6_addr_t *destination)
     mutex_unlock(&rpl_send_mutex);
 }
 
-void send_DAO(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index)
+void send_DAO(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint16_t start_index)
 {
     DEBUG("Send DAO to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, destination));
 
@@ -235,69 +235,293 @@ void recv_rpl_DAO_ACK(void)
 /* Routing related functions are obsolete and will be replaced in near future */
 /******************************************************************************/
 
-ipv6_addr_t *rpl_get_next_hop(ipv6_addr_t *addr)
+/*
+ * The routing table is indexed by a hash over (masked destination, prefix
+ * length). A lookup probes each prefix length that is in use, longest first,
+ * so host routes need a single probe no matter how large the table is.
+ * rt_mutex guards the index while entries are added, deleted or looked up.
+ * Entries handed out point into the table, they can be deleted and reused
+ * by the ageing in the trickle thread or by a DAO as soon as the lookup
+ * returned.
+ */
+
+/* index of no entry */
+#define RT_NONE         (0xffff)
+#define RT_HOST_LEN     (128)
+
+static uint16_t rt_buckets[RPL_ROUTING_HASH_SIZE];
+/* unused entries are chained through hash_next */
+static uint16_t rt_free;
+/* prefix lengths in use in descending order and the entries per length */
+static uint8_t rt_lens[RT_HOST_LEN + 1];
+static uint8_t rt_lens_numof;
+static uint16_t rt_len_refs[RT_HOST_LEN + 1];
+static mutex_t rt_mutex = MUTEX_INIT;
+
+static void rt_mask(ipv6_addr_t *dst, const ipv6_addr_t *src, uint8_t len)
 {
-    DEBUGF("looking up the next hop to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, addr));
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_routing_table[i].used) {
-            DEBUGF("checking %d: %s\n", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &rpl_routing_table[i].address));
+    for (uint8_t i = 0; i < sizeof(ipv6_addr_t); i++) {
+        if (len >= 8) {
+            dst->uint8[i] = src->uint8[i];
+            len -= 8;
         }
-        if (rpl_routing_table[i].used && rpl_equal_id(&rpl_routing_table[i].address, addr)) {
-            DEBUGF("found %d: %s\n", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &rpl_routing_table[i].next_hop));
-            return &rpl_routing_table[i].next_hop;
+        else {
+            dst->uint8[i] = src->uint8[i] & (uint8_t)(0xff << (8 - len));
+            len = 0;
         }
     }
+}
+
+static uint16_t rt_hash(const ipv6_addr_t *addr, uint8_t len)
+{
+    uint32_t h = len;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        h = (h ^ addr->uint32[i]) * 0x9e3779b1;
+    }
+
+    h ^= h >> 16;
+    return h & (RPL_ROUTING_HASH_SIZE - 1);
+}
+
+/* addr must be masked to len */
+static uint16_t rt_find(ipv6_addr_t *addr, uint8_t len, uint16_t bucket)
+{
+    uint16_t idx = rt_buckets[bucket];
+
+    while (idx != RT_NONE) {
+        rpl_routing_entry_t *entry = &rpl_routing_table[idx];
+
+        if ((entry->prefix_len == len) && rpl_equal_id(&entry->address, addr)) {
+            break;
+        }
+
+        idx = entry->hash_next;
+    }
+
+    return idx;
+}
+
+static void rt_len_ref(uint8_t len)
+{
+    if (rt_len_refs[len]++ > 0) {
+        return;
+    }
+
+    uint8_t i = rt_lens_numof++;
+
+    while ((i > 0) && (rt_lens[i - 1] < len)) {
+        rt_lens[i] = rt_lens[i - 1];
+        i--;
+    }
+
+    rt_lens[i] = len;
+}
+
+static void rt_len_unref(uint8_t len)
+{
+    if (--rt_len_refs[len] > 0) {
+        return;
+    }
+
+    uint8_t i = 0;
+
+    while (rt_lens[i] != len) {
+        i++;
+    }
+
+    rt_lens_numof--;
+
+    for (; i < rt_lens_numof; i++) {
+        rt_lens[i] = rt_lens[i + 1];
+    }
+}
+
+/* unlinks entry idx from its bucket and frees it, call with rt_mutex locked */
+static void rt_del(uint16_t idx)
+{
+    rpl_routing_entry_t *entry = &rpl_routing_table[idx];
+    uint16_t *link = &rt_buckets[rt_hash(&entry->address, entry->prefix_len)];
+
+    while (*link != idx) {
+        link = &rpl_routing_table[*link].hash_next;
+    }
+
+    *link = entry->hash_next;
+    rt_len_unref(entry->prefix_len);
+    memset(entry, 0, sizeof(*entry));
+    entry->hash_next = rt_free;
+    rt_free = idx;
+}
+
+static rpl_routing_entry_t *rt_lookup(ipv6_addr_t *addr)
+{
+    ipv6_addr_t masked;
+
+    for (uint8_t i = 0; i < rt_lens_numof; i++) {
+        uint8_t len = rt_lens[i];
+        ipv6_addr_t *key = addr;
+
+        if (len < RT_HOST_LEN) {
+            rt_mask(&masked, addr, len);
+            key = &masked;
+        }
+
+        uint16_t idx = rt_find(key, len, rt_hash(key, len));
+
+        if (idx != RT_NONE) {
+            return &rpl_routing_table[idx];
+        }
+    }
+
+    return NULL;
+}
+
+ipv6_addr_t *rpl_get_next_hop(ipv6_addr_t *addr)
+{
+    DEBUGF("looking up the next hop to %s\n", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, addr));
+
+    mutex_lock(&rt_mutex);
+    rpl_routing_entry_t *entry = rt_lookup(addr);
+    mutex_unlock(&rt_mutex);
+
+    if (entry != NULL) {
+        DEBUGF("found %d: %s\n", (int)(entry - rpl_routing_table),
+               ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &entry->next_hop));
+        return &entry->next_hop;
+    }
 
     return (rpl_get_my_preferred_parent());
 }
 
+rpl_routing_entry_t *rpl_lookup_routing_entry(ipv6_addr_t *addr)
+{
+    mutex_lock(&rt_mutex);
+    rpl_routing_entry_t *entry = rt_lookup(addr);
+    mutex_unlock(&rt_mutex);
+
+    return entry;
+}
+
+void rpl_add_prefix_routing_entry(ipv6_addr_t *prefix, uint8_t prefix_len,
+                                  ipv6_addr_t *next_hop, uint16_t lifetime)
+{
+    ipv6_addr_t masked;
+
+    if (prefix_len > RT_HOST_LEN) {
+        return;
+    }
+
+    rt_mask(&masked, prefix, prefix_len);
+    uint16_t bucket = rt_hash(&masked, prefix_len);
+
+    mutex_lock(&rt_mutex);
+    uint16_t idx = rt_find(&masked, prefix_len, bucket);
+
+    if (idx != RT_NONE) {
+        rpl_routing_table[idx].lifetime = lifetime;
+        mutex_unlock(&rt_mutex);
+        return;
+    }
+
+    idx = rt_free;
+
+    if (idx == RT_NONE) {
+        DEBUGF("routing table full\n");
+        mutex_unlock(&rt_mutex);
+        return;
+    }
+
+    rpl_routing_entry_t *entry = &rpl_routing_table[idx];
+    rt_free = entry->hash_next;
+
+    memcpy(&entry->address, &masked, sizeof(ipv6_addr_t));
+    memcpy(&entry->next_hop, next_hop, sizeof(ipv6_addr_t));
+    entry->lifetime = lifetime;
+    entry->prefix_len = prefix_len;
+    entry->used = 1;
+    entry->hash_next = rt_buckets[bucket];
+    rt_buckets[bucket] = idx;
+    rt_len_ref(prefix_len);
+
+    mutex_unlock(&rt_mutex);
+}
+
 void rpl_add_routing_entry(ipv6_addr_t *addr, ipv6_addr_t *next_hop, uint16_t lifetime)
 {
-    rpl_routing_entry_t *entry = rpl_find_routing_entry(addr);
+    rpl_add_prefix_routing_entry(addr, RT_HOST_LEN, next_hop, lifetime);
+}
 
-    if (entry != NULL) {
-        entry->lifetime = lifetime;
+void rpl_del_prefix_routing_entry(ipv6_addr_t *prefix, uint8_t prefix_len)
+{
+    ipv6_addr_t masked;
+
+    if (prefix_len > RT_HOST_LEN) {
         return;
     }
 
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (!rpl_routing_table[i].used) {
-            memcpy(&rpl_routing_table[i].address, addr, sizeof(ipv6_addr_t));
-            memcpy(&rpl_routing_table[i].next_hop, next_hop, sizeof(ipv6_addr_t));
-            rpl_routing_table[i].lifetime = lifetime;
-            rpl_routing_table[i].used = 1;
-            break;
-        }
+    rt_mask(&masked, prefix, prefix_len);
+    uint16_t bucket = rt_hash(&masked, prefix_len);
+
+    mutex_lock(&rt_mutex);
+    uint16_t idx = rt_find(&masked, prefix_len, bucket);
+
+    if (idx != RT_NONE) {
+        rt_del(idx);
     }
+
+    mutex_unlock(&rt_mutex);
 }
 
 void rpl_del_routing_entry(ipv6_addr_t *addr)
 {
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_routing_table[i].used && rpl_equal_id(&rpl_routing_table[i].address, addr)) {
-            memset(&rpl_routing_table[i], 0, sizeof(rpl_routing_table[i]));
-            return;
-        }
-    }
+    rpl_del_prefix_routing_entry(addr, RT_HOST_LEN);
 }
 
 rpl_routing_entry_t *rpl_find_routing_entry(ipv6_addr_t *addr)
 {
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        if (rpl_routing_table[i].used && rpl_equal_id(&rpl_routing_table[i].address, addr)) {
-            return &rpl_routing_table[i];
+    mutex_lock(&rt_mutex);
+    uint16_t idx = rt_find(addr, RT_HOST_LEN, rt_hash(addr, RT_HOST_LEN));
+    mutex_unlock(&rt_mutex);
+
+    return (idx != RT_NONE) ? &rpl_routing_table[idx] : NULL;
+}
+
+void rpl_age_routing_table(void)
+{
+    mutex_lock(&rt_mutex);
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (rpl_routing_table[i].used) {
+            if (rpl_routing_table[i].lifetime <= 1) {
+                rt_del(i);
+            }
+            else {
+                rpl_routing_table[i].lifetime--;
+            }
         }
     }
 
-    return NULL;
+    mutex_unlock(&rt_mutex);
 }
 
 void rpl_clear_routing_table(void)
 {
-    for (uint8_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
-        memset(&rpl_routing_table[i], 0, sizeof(rpl_routing_table[i]));
+    mutex_lock(&rt_mutex);
+
+    memset(rpl_routing_table, 0, sizeof(rpl_routing_table));
+    memset(rt_buckets, 0xff, sizeof(rt_buckets));
+    memset(rt_len_refs, 0, sizeof(rt_len_refs));
+    rt_lens_numof = 0;
+
+    for (uint16_t i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        rpl_routing_table[i].hash_next = i + 1;
     }
 
+    rpl_routing_table[RPL_MAX_ROUTING_ENTRIES - 1].hash_next = RT_NONE;
+    rt_free = 0;
+
+    mutex_unlock(&rt_mutex);
 }
 
 rpl_routing_entry_t *rpl_get_routing_table(void)
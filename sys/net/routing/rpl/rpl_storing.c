@@ -268,7 +268,7 @@ void send_DIO_mode(ipv6_addr_t *destination)
     rpl_send(destination, (uint8_t *)icmp_send_buf, plen, IPV6_PROTO_NUM_ICMPV6);
 }
 
-void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint8_t start_index)
+void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_lifetime, uint16_t start_index)
 {
     if (i_am_root) {
         return;
@@ -308,14 +308,14 @@ void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_life
     rpl_send_opt_target_buf = get_rpl_send_opt_target_buf(DAO_BASE_LEN);
     /* add all targets from routing table as targets */
     uint8_t entries = 0;
-    uint8_t continue_index = 0;
+    uint16_t continue_index = 0;
 
-    for (uint8_t i = start_index; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+    for (uint16_t i = start_index; i < RPL_MAX_ROUTING_ENTRIES; i++) {
         if (rpl_get_routing_table()[i].used) {
             rpl_send_opt_target_buf->type = RPL_OPT_TARGET;
             rpl_send_opt_target_buf->length = RPL_OPT_TARGET_LEN;
             rpl_send_opt_target_buf->flags = 0x00;
-            rpl_send_opt_target_buf->prefix_length = RPL_DODAG_ID_LEN;
+            rpl_send_opt_target_buf->prefix_length = rpl_get_routing_table()[i].prefix_len;
             memcpy(&rpl_send_opt_target_buf->target, &rpl_get_routing_table()[i].address, sizeof(ipv6_addr_t));
             opt_len += RPL_OPT_TARGET_LEN + 2;
             rpl_send_opt_transit_buf = get_rpl_send_opt_transit_buf(DAO_BASE_LEN + opt_len);
@@ -342,7 +342,7 @@ void send_DAO_mode(ipv6_addr_t *destination, uint8_t lifetime, bool default_life
     rpl_send_opt_target_buf->type = RPL_OPT_TARGET;
     rpl_send_opt_target_buf->length = RPL_OPT_TARGET_LEN;
     rpl_send_opt_target_buf->flags = 0x00;
-    rpl_send_opt_target_buf->prefix_length = RPL_DODAG_ID_LEN;
+    rpl_send_opt_target_buf->prefix_length = IPV6_ADDR_BIT_LEN;
     memcpy(&rpl_send_opt_target_buf->target, &my_address, sizeof(ipv6_addr_t));
     opt_len += RPL_OPT_TARGET_LEN + 2;
 
@@ -662,8 +662,8 @@ void recv_rpl_DAO_mode(void)
             case (RPL_OPT_TARGET): {
                 rpl_opt_target_buf = get_rpl_opt_target_buf(len);
 
-                if (rpl_opt_target_buf->prefix_length != RPL_DODAG_ID_LEN) {
-                    DEBUGF("prefixes are not supported yet\n");
+                if (rpl_opt_target_buf->prefix_length > IPV6_ADDR_BIT_LEN) {
+                    DEBUGF("invalid prefix length %u\n", rpl_opt_target_buf->prefix_length);
                     break;
                 }
 
@@ -682,7 +682,10 @@ void recv_rpl_DAO_mode(void)
                       ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &rpl_opt_target_buf->target),
                       ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN, &ipv6_buf->srcaddr),
                       (rpl_opt_transit_buf->path_lifetime * my_dodag->lifetime_unit));
-                rpl_add_routing_entry(&rpl_opt_target_buf->target, &ipv6_buf->srcaddr, rpl_opt_transit_buf->path_lifetime * my_dodag->lifetime_unit);
+                rpl_add_prefix_routing_entry(&rpl_opt_target_buf->target,
+                                             rpl_opt_target_buf->prefix_length,
+                                             &ipv6_buf->srcaddr,
+                                             rpl_opt_transit_buf->path_lifetime * my_dodag->lifetime_unit);
                 increment_seq = 1;
                 break;
             }
@@ -24,6 +24,7 @@
 
 #include "hwtimer.h"
 #include "ipv6.h"
+#include "irq.h"
 #include "thread.h"
 #include "vtimer.h"
 
@@ -37,6 +38,12 @@
 
 socket_internal_t socket_base_sockets[MAX_SOCKETS];
 
+/* bucket heads and chain links of the demultiplexing index, socket IDs */
+static uint8_t index_head[SOCKET_BASE_INDEX_SIZE];
+static uint8_t index_next[MAX_SOCKETS];
+/* bucket + 1 a socket is stored in, 0 if it is not indexed */
+static uint16_t index_bucket[MAX_SOCKETS];
+
 int __attribute__((weak)) tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
 {
     (void) socket;
@@ -96,6 +103,18 @@ int32_t __attribute__((weak)) udp_recvfrom(int s, void *buf, uint32_t len, int f
     return -1;
 }
 
+int32_t __attribute__((weak)) udp_recvfrom_pkt(int s, void **payload, int flags,
+                                               sockaddr6_t *from, uint32_t *fromlen)
+{
+    (void) s;
+    (void) payload;
+    (void) flags;
+    (void) from;
+    (void) fromlen;
+
+    return -1;
+}
+
 int32_t __attribute__((weak)) udp_sendto(int s, const void *buf, uint32_t len, int flags,
                               sockaddr6_t *to, uint32_t tolen)
 {
@@ -150,6 +169,11 @@ int __attribute__((weak)) tcp_teardown(socket_internal_t *current_socket)
     return -1;
 }
 
+void __attribute__((weak)) udp_teardown(socket_internal_t *current_socket)
+{
+    (void) current_socket;
+}
+
 void socket_base_print_socket(socket_t *current_socket)
 {
     char addr_str[IPV6_MAX_ADDR_STR_LEN];
@@ -179,6 +203,79 @@ void socket_base_print_internal_socket(socket_internal_t *current_socket_interna
     printf("\n--------------------------\n");
 }
 
+static unsigned index_hash(uint8_t type, uint16_t local_port,
+                           const ipv6_addr_t *foreign_addr, uint16_t foreign_port)
+{
+    uint32_t hash = type;
+
+    hash = (hash * 31) + local_port;
+    hash = (hash * 31) + foreign_port;
+    /* NULL hashes like the unspecified address of a listening socket */
+    hash = (hash * 31) + ((foreign_addr != NULL) ? foreign_addr->uint32[3] : 0);
+
+    hash ^= hash >> 16;
+    return hash % SOCKET_BASE_INDEX_SIZE;
+}
+
+void socket_base_index_add(int s)
+{
+    socket_t *current_socket = &socket_base_sockets[s - 1].socket_values;
+    unsigned bucket;
+
+    socket_base_index_remove(s);
+
+    if (current_socket->type == SOCK_STREAM) {
+        bucket = index_hash(SOCK_STREAM, current_socket->local_address.sin6_port,
+                            &current_socket->foreign_address.sin6_addr,
+                            current_socket->foreign_address.sin6_port);
+    }
+    else {
+        /* datagram sockets are demultiplexed by local port only */
+        bucket = index_hash(current_socket->type,
+                            current_socket->local_address.sin6_port, NULL, 0);
+    }
+
+    unsigned state = disableIRQ();
+    index_next[s - 1] = index_head[bucket];
+    index_head[bucket] = s;
+    index_bucket[s - 1] = bucket + 1;
+    restoreIRQ(state);
+}
+
+void socket_base_index_remove(int s)
+{
+    if ((s < 1) || (s > MAX_SOCKETS) || (index_bucket[s - 1] == 0)) {
+        return;
+    }
+
+    unsigned state = disableIRQ();
+    uint8_t *link = &index_head[index_bucket[s - 1] - 1];
+
+    while (*link != 0) {
+        if (*link == s) {
+            *link = index_next[s - 1];
+            break;
+        }
+
+        link = &index_next[*link - 1];
+    }
+
+    index_next[s - 1] = 0;
+    index_bucket[s - 1] = 0;
+    restoreIRQ(state);
+}
+
+int socket_base_index_first(uint8_t type, uint16_t local_port,
+                            const ipv6_addr_t *foreign_addr, uint16_t foreign_port)
+{
+    return index_head[index_hash(type, local_port, foreign_addr, foreign_port)];
+}
+
+int socket_base_index_next(int s)
+{
+    return index_next[s - 1];
+}
+
 int socket_base_exists_socket(int socket)
 {
     if (socket_base_sockets[socket - 1].socket_id == 0) {
@@ -216,6 +313,8 @@ int socket_base_close(int s)
     socket_internal_t *current_socket = socket_base_get_socket(s);
 
     if (udp_socket_compliancy(s)) {
+        socket_base_index_remove(s);
+        udp_teardown(current_socket);
         memset(current_socket, 0, sizeof(socket_internal_t));
         return 0;
     }
@@ -247,11 +346,11 @@ int socket_base_socket(int domain, int type, int protocol)
 {
     int i = 1;
 
-    while (socket_base_get_socket(i) != NULL) {
+    while ((i <= MAX_SOCKETS) && (socket_base_get_socket(i) != NULL)) {
         i++;
     }
 
-    if (i > MAX_SOCKETS + 1) {
+    if (i > MAX_SOCKETS) {
         return -1;
     }
     else {
@@ -262,6 +361,10 @@ int socket_base_socket(int domain, int type, int protocol)
         current_socket->protocol = protocol;
 #ifdef MODULE_TCP
         current_socket->tcp_control.state = 0;
+#endif
+#ifdef MODULE_UDP
+        cib_init(&socket_base_sockets[i - 1].udp_recv_cib, UDP_SOCKET_RECV_QUEUE_SIZE);
+        socket_base_sockets[i - 1].udp_recv_waiting = 0;
 #endif
         return socket_base_sockets[i - 1].socket_id;
     }
@@ -323,6 +426,17 @@ int32_t socket_base_recvfrom(int s, void *buf, uint32_t len, int flags,
     return -1;
 }
 
+int32_t socket_base_recvfrom_pkt(int s, void **payload, int flags,
+                                 sockaddr6_t *from, uint32_t *fromlen)
+{
+    if (udp_socket_compliancy(s)) {
+        return udp_recvfrom_pkt(s, payload, flags, from, fromlen);
+    }
+
+    printf("Socket Type not supported!\n");
+    return -1;
+}
+
 int32_t socket_base_sendto(int s, const void *buf, uint32_t len, int flags,
                               sockaddr6_t *to, uint32_t tolen)
 {
@@ -10,6 +10,7 @@
 #define _SOCKET_BASE_SOCKET
 
 #include "cpu.h"
+#include "cib.h"
 
 #include "socket_base/socket.h"
 
@@ -19,9 +20,28 @@
 
 #ifdef MODULE_TCP
 #include "tcp.h"
+#include "vtimer.h"
 #endif
 
+#ifndef MAX_SOCKETS
+/* at most 255, socket IDs are stored in an uint8_t */
 #define MAX_SOCKETS         5
+#endif
+
+#ifndef SOCKET_BASE_INDEX_SIZE
+/* number of buckets of the socket demultiplexing index */
+#define SOCKET_BASE_INDEX_SIZE  (MAX_SOCKETS)
+#endif
+
+#ifndef UDP_SOCKET_RECV_QUEUE_SIZE
+/* datagrams queued per UDP socket, must be a power of two */
+#define UDP_SOCKET_RECV_QUEUE_SIZE  (4)
+#endif
+
+#ifndef TCP_OOO_SEGMENTS
+/* number of disjoint byte ranges a TCP socket keeps beyond a hole */
+#define TCP_OOO_SEGMENTS    (4)
+#endif
 // #define MAX_QUEUED_SOCKETS   2
 
 #define INC_PACKET          0
@@ -51,6 +71,23 @@ typedef struct __attribute__((packed)) {
 
     timex_t             last_packet_time;
     uint8_t             no_of_retries;
+
+    /* segment timed for the RTT estimation, ended by an ACK of rtt_seq */
+    uint8_t             rtt_active;
+    uint32_t            rtt_seq;
+    timex_t             rtt_time;
+    /* counts ACKs that let tcp_send() go on */
+    uint8_t             ack_events;
+
+#ifdef MODULE_TCP_CC
+    uint16_t            cwnd;
+    uint16_t            ssthresh;
+    uint32_t            recover;        /* send_nxt when fast retransmit started */
+    uint8_t             dup_acks;
+    uint8_t             in_recovery;
+    uint8_t             retransmit;     /* fast retransmit of send_una pending */
+    uint8_t             ack_pending;    /* received segments not yet acknowledged */
+#endif
     uint16_t            mss;
 
     uint8_t             state;
@@ -63,6 +100,13 @@ typedef struct __attribute__((packed)) {
     tcp_hc_context_t    tcp_context;
 #endif
 } tcp_cb_t;
+
+/* byte range received beyond rcv_nxt, its data is already in the receive
+ * ring at the offset seq - rcv_nxt behind the in-order bytes */
+typedef struct {
+    uint32_t            seq;
+    uint16_t            len;
+} tcp_ooo_segment_t;
 #endif
 
 typedef struct {
@@ -81,10 +125,32 @@ typedef struct {
     uint8_t             recv_pid;
     uint8_t             send_pid;
     socket_t            socket_values;
+#ifdef MODULE_UDP
+    cib_t               udp_recv_cib;
+    volatile uint8_t    udp_recv_waiting;
+    uint8_t             *udp_recv_queue[UDP_SOCKET_RECV_QUEUE_SIZE];
+#endif
 #ifdef MODULE_TCP
-    uint8_t             tcp_input_buffer_end;
+    /* ring of received bytes, the first tcp_input_buffer_len of them are
+     * in order and readable, rcv_wnd is the remaining space */
+    uint16_t            tcp_input_buffer_start;
+    uint16_t            tcp_input_buffer_len;
     mutex_t             tcp_buffer_mutex;
     uint8_t             tcp_input_buffer[TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER];
+    /* out-of-order ranges sorted by sequence number */
+    uint8_t             tcp_ooo_count;
+    tcp_ooo_segment_t   tcp_ooo[TCP_OOO_SEGMENTS];
+    /* ring of sent but unacknowledged and of not yet sent bytes, the
+     * first one is send_una */
+    uint16_t            tcp_send_buffer_start;
+    uint16_t            tcp_send_buffer_len;
+    uint8_t             tcp_send_buffer[TRANSPORT_LAYER_SOCKET_TCP_SEND_BUFFER];
+    vtimer_t            tcp_timer;
+    uint8_t             tcp_timer_gen;
+#ifdef MODULE_TCP_CC
+    vtimer_t            tcp_delack_timer;
+    uint8_t             tcp_delack_gen;
+#endif
 #endif
 } socket_internal_t;
 
@@ -96,4 +162,20 @@ int socket_base_exists_socket(int socket);
 int socket_base_socket(int domain, int type, int protocol);
 void socket_base_print_sockets(void);
 
+/*
+ * Index for demultiplexing received packets. Sockets are hashed on their
+ * type, local port and foreign address and port, so a lookup only visits
+ * sockets that collide with the packet's tuple. Listening and UDP sockets
+ * are found by passing NULL and 0 as foreign address and port. Callers still
+ * have to compare the candidates against the packet.
+ */
+void socket_base_index_add(int s);
+void socket_base_index_remove(int s);
+int socket_base_index_first(uint8_t type, uint16_t local_port,
+                            const ipv6_addr_t *foreign_addr, uint16_t foreign_port);
+int socket_base_index_next(int s);
+
+/* releases resources held by a UDP socket, implemented by udp */
+void udp_teardown(socket_internal_t *current_socket);
+
 #endif /* _SOCKET_BASE_SOCKET */
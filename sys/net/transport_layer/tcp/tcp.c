@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "irq.h"
 #include "sixlowpan.h"
 #include "thread.h"
 #include "vtimer.h"
@@ -28,9 +29,11 @@
 #include "socket_base/in.h"
 
 #include "net_help.h"
+#include "net_stats.h"
 
 #include "msg_help.h"
 #include "socket.h"
+#include "tcp_cc.h"
 #include "tcp_hc.h"
 #include "tcp_timer.h"
 
@@ -195,6 +198,10 @@ int check_tcp_consistency(socket_t *current_tcp_socket, tcp_hdr_t *tcp_header, u
         /* segment repetition, maybe ACK got lost? */
         return SEQ_NO_TOO_SMALL;
     }
+    else if ((current_tcp_socket->tcp_control.rcv_nxt > 0) && (tcp_header->seq_nr > current_tcp_socket->tcp_control.rcv_nxt)) {
+        /* a segment before this one got lost, the sender goes back to it */
+        return SEQ_NO_TOO_BIG;
+    }
 
     return PACKET_OK;
 }
@@ -250,8 +257,9 @@ void set_tcp_packet(tcp_hdr_t *tcp_hdr, uint16_t src_port, uint16_t dst_port,
     tcp_hdr->window         = window;
 }
 
-int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
-             ipv6_hdr_t *temp_ipv6_header, uint8_t flags, uint8_t payload_length)
+int send_tcp_seq(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
+                 ipv6_hdr_t *temp_ipv6_header, uint8_t flags, uint32_t seq_nr,
+                 uint8_t payload_length)
 {
     socket_t *current_tcp_socket = &current_socket->socket_values;
     uint8_t header_length = TCP_HDR_LEN / 4;
@@ -268,8 +276,7 @@ int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
     }
 
     set_tcp_packet(current_tcp_packet, current_tcp_socket->local_address.sin6_port,
-                   current_tcp_socket->foreign_address.sin6_port,
-                   current_tcp_socket->tcp_control.send_una,
+                   current_tcp_socket->foreign_address.sin6_port, seq_nr,
                    (IS_TCP_ACK(flags) ? current_tcp_socket->tcp_control.rcv_nxt : 0x00), header_length, flags,
                    current_tcp_socket->tcp_control.rcv_wnd, 0, 0);
 
@@ -282,6 +289,14 @@ int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
 
     current_tcp_packet->checksum = ~tcp_csum(temp_ipv6_header, current_tcp_packet);
 
+    NET_STATS_INC(NET_STATS_TCP, tx);
+
+#ifdef MODULE_TCP_CC
+    if (IS_TCP_ACK(flags)) {
+        tcp_cc_ack_sent(current_socket);
+    }
+#endif
+
 #ifdef TCP_HC
     uint16_t compressed_size;
 
@@ -292,6 +307,7 @@ int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
 
     if (compressed_size == 0) {
         /* Error in compressing tcp packet header */
+        NET_STATS_INC(NET_STATS_TCP, tx_dropped);
         return -1;
     }
 
@@ -306,6 +322,14 @@ int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
 #endif
 }
 
+int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
+             ipv6_hdr_t *temp_ipv6_header, uint8_t flags, uint8_t payload_length)
+{
+    return send_tcp_seq(current_socket, current_tcp_packet, temp_ipv6_header,
+                        flags, current_socket->socket_values.tcp_control.send_una,
+                        payload_length);
+}
+
 bool is_four_touple(socket_internal_t *current_socket, ipv6_hdr_t *ipv6_header,
                     tcp_hdr_t *tcp_header)
 {
@@ -324,6 +348,23 @@ socket_internal_t *get_waiting_connection_socket(int socket,
     int i;
     socket_internal_t *listening_socket = socket_base_get_socket(socket);
 
+    /* Connection establishment ACK, Check for 4 touple and state */
+    if ((ipv6_header != NULL) && (tcp_header != NULL)) {
+        for (i = socket_base_index_first(SOCK_STREAM, tcp_header->dst_port,
+                                         &ipv6_header->srcaddr, tcp_header->src_port);
+             i != 0; i = socket_base_index_next(i)) {
+            socket_internal_t *current_socket = socket_base_get_socket(i);
+
+            if (current_socket &&
+                is_four_touple(current_socket, ipv6_header, tcp_header) &&
+                (current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD)) {
+                return current_socket;
+            }
+        }
+
+        return NULL;
+    }
+
     for (i = 1; i < MAX_SOCKETS + 1; i++) {
         socket_internal_t *current_socket = socket_base_get_socket(i);
 
@@ -331,20 +372,11 @@ socket_internal_t *get_waiting_connection_socket(int socket,
             continue;
         }
 
-        /* Connection establishment ACK, Check for 4 touple and state */
-        if ((ipv6_header != NULL) && (tcp_header != NULL)) {
-            if (is_four_touple(current_socket, ipv6_header, tcp_header) &&
-                (current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD)) {
-                return current_socket;
-            }
-        }
         /* Connection establishment SYN ACK, check only for port and state */
-        else {
-            if ((current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD) &&
-                (current_socket->socket_values.local_address.sin6_port ==
-                 listening_socket->socket_values.local_address.sin6_port)) {
-                return current_socket;
-            }
+        if ((current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD) &&
+            (current_socket->socket_values.local_address.sin6_port ==
+             listening_socket->socket_values.local_address.sin6_port)) {
+            return current_socket;
         }
     }
 
@@ -368,6 +400,7 @@ socket_internal_t *new_tcp_queued_socket(ipv6_hdr_t *ipv6_header,
     set_socket_address(&current_queued_socket->socket_values.local_address,
                        AF_INET6, tcp_header->dst_port, 0,
                        &ipv6_header->destaddr);
+    socket_base_index_add(queued_socket_id);
 
     /* Foreign TCP information */
     if ((tcp_header->data_offset * 4 > TCP_HDR_LEN) &&
@@ -382,12 +415,13 @@ socket_internal_t *new_tcp_queued_socket(ipv6_hdr_t *ipv6_header,
     current_queued_socket->socket_values.tcp_control.rcv_irs =
         tcp_header->seq_nr;
     mutex_lock(&global_sequence_counter_mutex);
+    global_sequence_counter += rand();
     current_queued_socket->socket_values.tcp_control.send_iss =
         global_sequence_counter;
     mutex_unlock(&global_sequence_counter_mutex);
     current_queued_socket->socket_values.tcp_control.state = TCP_SYN_RCVD;
     set_tcp_cb(&current_queued_socket->socket_values.tcp_control,
-               tcp_header->seq_nr + 1, TRANSPORT_LAYER_SOCKET_STATIC_WINDOW,
+               tcp_header->seq_nr + 1, TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER,
                current_queued_socket->socket_values.tcp_control.send_iss + 1,
                current_queued_socket->socket_values.tcp_control.send_iss,
                tcp_header->window);
@@ -397,76 +431,263 @@ socket_internal_t *new_tcp_queued_socket(ipv6_hdr_t *ipv6_header,
 
 socket_internal_t *get_tcp_socket(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header)
 {
-    uint8_t i = 1;
+    int i;
     socket_internal_t *current_socket = NULL;
     socket_internal_t *listening_socket = NULL;
-    uint8_t compare[16];
-    memset(compare, 0, 16);
 
-    while (i < MAX_SOCKETS + 1) {
+    /* Check for matching 4 touple, TCP_ESTABLISHED connection */
+    for (i = socket_base_index_first(SOCK_STREAM, tcp_header->dst_port,
+                                     &ipv6_header->srcaddr, tcp_header->src_port);
+         i != 0; i = socket_base_index_next(i)) {
         current_socket = socket_base_get_socket(i);
 
-        /* Check for matching 4 touple, TCP_ESTABLISHED connection */
         if (tcp_socket_compliancy(i) && is_four_touple(current_socket, ipv6_header,
                                                tcp_header)) {
             return current_socket;
         }
-        /* Sockets in TCP_LISTEN and TCP_SYN_RCVD state should only be tested on local TCP values */
-        else if (tcp_socket_compliancy(i) &&
-                 ((current_socket->socket_values.tcp_control.state == TCP_LISTEN) ||
-                  (current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD)) &&
-                 (current_socket->socket_values.local_address.sin6_addr.uint8[15] ==
-                  ipv6_header->destaddr.uint8[15]) &&
-                 (current_socket->socket_values.local_address.sin6_port ==
-                  tcp_header->dst_port) &&
-                 (current_socket->socket_values.foreign_address.sin6_addr.uint8[15] ==
-                  0x00) &&
-                 (current_socket->socket_values.foreign_address.sin6_port == 0)) {
+    }
+
+    /* Sockets in TCP_LISTEN and TCP_SYN_RCVD state should only be tested on local TCP values */
+    for (i = socket_base_index_first(SOCK_STREAM, tcp_header->dst_port, NULL, 0);
+         i != 0; i = socket_base_index_next(i)) {
+        current_socket = socket_base_get_socket(i);
+
+        if (tcp_socket_compliancy(i) &&
+            ((current_socket->socket_values.tcp_control.state == TCP_LISTEN) ||
+             (current_socket->socket_values.tcp_control.state == TCP_SYN_RCVD)) &&
+            (current_socket->socket_values.local_address.sin6_addr.uint8[15] ==
+             ipv6_header->destaddr.uint8[15]) &&
+            (current_socket->socket_values.local_address.sin6_port ==
+             tcp_header->dst_port) &&
+            (current_socket->socket_values.foreign_address.sin6_addr.uint8[15] ==
+             0x00) &&
+            (current_socket->socket_values.foreign_address.sin6_port == 0)) {
             listening_socket = current_socket;
         }
-
-        i++;
     }
 
     /* Return either NULL if nothing was matched or the listening 2 touple socket */
     return listening_socket;
 }
 
-uint8_t handle_payload(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
-                       socket_internal_t *tcp_socket, uint8_t *payload)
+void calculate_rto(tcp_cb_t *tcp_control, timex_t current_time)
 {
-    (void) tcp_header;
+    double rtt = (double) timex_uint64(timex_sub(current_time, tcp_control->rtt_time));
+    double srtt = tcp_control->srtt;
+    double rttvar = tcp_control->rttvar;
+    double rto = tcp_control->rto;
 
+    if ((srtt == 0) && (rttvar == 0)) {
+        /* First calculation */
+        srtt = rtt;
+        rttvar = 0.5 * rtt;
+        rto = rtt + (((4 * rttvar) < TCP_TIMER_RESOLUTION) ?
+                     (TCP_TIMER_RESOLUTION) : (4 * rttvar));
+    }
+    else {
+        /* every other calculation */
+        srtt = (1 - TCP_ALPHA) * srtt + TCP_ALPHA * rtt;
+        rttvar = (1 - TCP_BETA) * rttvar + TCP_BETA * abs(srtt - rtt);
+        rto = srtt + (((4 * rttvar) < TCP_TIMER_RESOLUTION) ?
+                      (TCP_TIMER_RESOLUTION) : (4 * rttvar));
+    }
+
+    if (rto < SECOND) {
+        rto = SECOND;
+    }
+
+    tcp_control->srtt = srtt;
+    tcp_control->rttvar = rttvar;
+    tcp_control->rto = rto;
+}
+
+/* copies len bytes into the receive ring, offset bytes behind its first
+ * unread byte */
+static void tcp_input_buffer_write(socket_internal_t *tcp_socket,
+                                   uint16_t offset, const uint8_t *src,
+                                   uint16_t len)
+{
+    uint16_t size = sizeof(tcp_socket->tcp_input_buffer);
+    uint16_t pos = (tcp_socket->tcp_input_buffer_start + offset) % size;
+
+    while (len > 0) {
+        uint16_t chunk = (len < (size - pos)) ? len : (size - pos);
+
+        memcpy(&tcp_socket->tcp_input_buffer[pos], src, chunk);
+        src += chunk;
+        len -= chunk;
+        pos = (pos + chunk) % size;
+    }
+}
+
+/* records [seq, seq + len) as received beyond a hole, merging it with
+ * overlapping and adjacent ranges, returns 0 if there is no free entry */
+static int tcp_ooo_add(socket_internal_t *tcp_socket, uint32_t seq,
+                       uint16_t len)
+{
+    tcp_ooo_segment_t *ooo = tcp_socket->tcp_ooo;
+    uint32_t end = seq + len;
+    uint8_t i = 0;
+
+    while (i < tcp_socket->tcp_ooo_count) {
+        uint32_t ooo_end = ooo[i].seq + ooo[i].len;
+
+        if (TCP_SEQ_LT(ooo_end, seq)) {
+            i++;
+            continue;
+        }
+
+        if (TCP_SEQ_LT(end, ooo[i].seq)) {
+            break;
+        }
+
+        /* absorb entry i, the ones after it move down */
+        if (TCP_SEQ_LT(ooo[i].seq, seq)) {
+            seq = ooo[i].seq;
+        }
+
+        if (TCP_SEQ_LT(end, ooo_end)) {
+            end = ooo_end;
+        }
+
+        tcp_socket->tcp_ooo_count--;
+        memmove(&ooo[i], &ooo[i + 1],
+                (tcp_socket->tcp_ooo_count - i) * sizeof(tcp_ooo_segment_t));
+    }
+
+    if (tcp_socket->tcp_ooo_count >= TCP_OOO_SEGMENTS) {
+        return 0;
+    }
+
+    memmove(&ooo[i + 1], &ooo[i],
+            (tcp_socket->tcp_ooo_count - i) * sizeof(tcp_ooo_segment_t));
+    ooo[i].seq = seq;
+    ooo[i].len = end - seq;
+    tcp_socket->tcp_ooo_count++;
+    return 1;
+}
+
+/* Stores the part of the segment that lies within the receive window. Data
+ * beyond a hole is kept in the ring and recorded in the out-of-order queue,
+ * once the hole is filled rcv_nxt moves over all contiguous bytes. Returns
+ * the number of bytes rcv_nxt advanced. */
+uint16_t handle_payload(tcp_hdr_t *tcp_header, socket_internal_t *tcp_socket,
+                        uint8_t *payload, uint16_t tcp_payload_len)
+{
     msg_t m_send_tcp, m_recv_tcp;
-    uint8_t tcp_payload_len = NTOHS(ipv6_header->length) - TCP_HDR_LEN;
-    uint8_t acknowledged_bytes = 0;
-
-    if (tcp_payload_len > tcp_socket->socket_values.tcp_control.rcv_wnd) {
-        mutex_lock(&tcp_socket->tcp_buffer_mutex);
-        memcpy(tcp_socket->tcp_input_buffer, payload,
-               tcp_socket->socket_values.tcp_control.rcv_wnd);
-        acknowledged_bytes = tcp_socket->socket_values.tcp_control.rcv_wnd;
-        tcp_socket->socket_values.tcp_control.rcv_wnd = 0;
-        tcp_socket->tcp_input_buffer_end = tcp_socket->tcp_input_buffer_end +
-                                           tcp_socket->socket_values.tcp_control.rcv_wnd;
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+    uint32_t seq = tcp_header->seq_nr;
+    uint16_t advanced = 0;
+
+    mutex_lock(&tcp_socket->tcp_buffer_mutex);
+
+    /* cut off what was received before */
+    if (TCP_SEQ_LT(seq, tcp_control->rcv_nxt)) {
+        uint32_t old = tcp_control->rcv_nxt - seq;
+
+        if (old >= tcp_payload_len) {
+            mutex_unlock(&tcp_socket->tcp_buffer_mutex);
+            return 0;
+        }
+
+        payload += old;
+        tcp_payload_len -= old;
+        seq = tcp_control->rcv_nxt;
+    }
+
+    /* and what does not fit into the window */
+    uint32_t offset = seq - tcp_control->rcv_nxt;
+
+    if (offset >= tcp_control->rcv_wnd) {
         mutex_unlock(&tcp_socket->tcp_buffer_mutex);
+        return 0;
     }
-    else {
-        mutex_lock(&tcp_socket->tcp_buffer_mutex);
-        memcpy(tcp_socket->tcp_input_buffer, payload, tcp_payload_len);
-        tcp_socket->socket_values.tcp_control.rcv_wnd =
-            tcp_socket->socket_values.tcp_control.rcv_wnd - tcp_payload_len;
-        acknowledged_bytes = tcp_payload_len;
-        tcp_socket->tcp_input_buffer_end = tcp_socket->tcp_input_buffer_end +
-                                           tcp_payload_len;
+
+    if ((offset + tcp_payload_len) > tcp_control->rcv_wnd) {
+        tcp_payload_len = tcp_control->rcv_wnd - offset;
+    }
+
+    if ((offset > 0) && !tcp_ooo_add(tcp_socket, seq, tcp_payload_len)) {
         mutex_unlock(&tcp_socket->tcp_buffer_mutex);
+        return 0;
     }
 
-    if (thread_getstatus(tcp_socket->recv_pid) == STATUS_RECEIVE_BLOCKED) {
+    tcp_input_buffer_write(tcp_socket, tcp_socket->tcp_input_buffer_len + offset,
+                           payload, tcp_payload_len);
+
+    if (offset == 0) {
+        uint32_t end = seq + tcp_payload_len;
+
+        /* queued ranges that now follow without a gap */
+        while ((tcp_socket->tcp_ooo_count > 0) &&
+               TCP_SEQ_LEQ(tcp_socket->tcp_ooo[0].seq, end)) {
+            uint32_t ooo_end = tcp_socket->tcp_ooo[0].seq +
+                               tcp_socket->tcp_ooo[0].len;
+
+            if (TCP_SEQ_LT(end, ooo_end)) {
+                end = ooo_end;
+            }
+
+            tcp_socket->tcp_ooo_count--;
+            memmove(&tcp_socket->tcp_ooo[0], &tcp_socket->tcp_ooo[1],
+                    tcp_socket->tcp_ooo_count * sizeof(tcp_ooo_segment_t));
+        }
+
+        advanced = end - tcp_control->rcv_nxt;
+        tcp_control->rcv_nxt = end;
+        tcp_socket->tcp_input_buffer_len += advanced;
+        tcp_control->rcv_wnd = sizeof(tcp_socket->tcp_input_buffer) -
+                               tcp_socket->tcp_input_buffer_len;
+    }
+
+    mutex_unlock(&tcp_socket->tcp_buffer_mutex);
+
+    if ((advanced > 0) &&
+        (thread_getstatus(tcp_socket->recv_pid) == STATUS_RECEIVE_BLOCKED)) {
         socket_base_net_msg_send_recv(&m_send_tcp, &m_recv_tcp, tcp_socket->recv_pid, UNDEFINED);
     }
 
-    return acknowledged_bytes;
+    return advanced;
+}
+
+/* Cumulative ACK: everything before ack_nr arrived, tcp_send() releases it
+ * from the send buffer and fills the opened window */
+void tcp_ack_received(socket_internal_t *tcp_socket, tcp_hdr_t *tcp_header)
+{
+    msg_t m_send_tcp;
+    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+    timex_t now;
+
+    vtimer_now(&now);
+
+    /* Karn: rtt_active is cleared when the timed segment is retransmitted */
+    if (tcp_control->rtt_active && TCP_SEQ_LEQ(tcp_control->rtt_seq, tcp_header->ack_nr)) {
+        calculate_rto(tcp_control, now);
+        tcp_control->rtt_active = 0;
+    }
+
+    unsigned state = disableIRQ();
+#ifdef MODULE_TCP_CC
+    tcp_cc_ack(tcp_control, tcp_header->ack_nr);
+#endif
+    tcp_control->send_una = tcp_header->ack_nr;
+    tcp_control->send_wnd = tcp_header->window;
+    tcp_control->no_of_retries = 0;
+    tcp_control->last_packet_time = now;
+    tcp_control->ack_events++;
+
+    if (tcp_control->send_una == tcp_control->send_nxt) {
+        tcp_timer_stop(tcp_socket);
+    }
+    else {
+        /* restart the retransmission timer for the remaining segments */
+        tcp_timer_set(tcp_socket, tcp_timer_rto(tcp_control));
+    }
+
+    restoreIRQ(state);
+
+    /* wakes tcp_send() if it waits for this ACK */
+    socket_base_net_msg_send(&m_send_tcp, tcp_socket->send_pid, 0, TCP_ACK);
 }
 
 void handle_tcp_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
@@ -476,6 +697,8 @@ void handle_tcp_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
 
     if (tcp_socket->socket_values.tcp_control.state == TCP_LAST_ACK) {
         uint8_t target_pid = tcp_socket->recv_pid;
+        tcp_timer_stop_all(tcp_socket);
+        socket_base_index_remove(tcp_socket->socket_id);
         memset(tcp_socket, 0, sizeof(socket_internal_t));
         msg_try_send(&m_send_tcp, target_pid);
         return;
@@ -492,10 +715,37 @@ void handle_tcp_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
         return;
     }
     else if (tcp_socket->socket_values.tcp_control.state == TCP_ESTABLISHED) {
-        if (check_tcp_consistency(&tcp_socket->socket_values, tcp_header, 0) == PACKET_OK) {
-            m_send_tcp.content.ptr = (char *)tcp_header;
-            socket_base_net_msg_send(&m_send_tcp, tcp_socket->send_pid, 0, TCP_ACK);
-            return;
+        switch (check_tcp_consistency(&tcp_socket->socket_values, tcp_header, 0)) {
+            case PACKET_OK:
+                tcp_ack_received(tcp_socket, tcp_header);
+                return;
+
+            case ACK_NO_TOO_SMALL:
+                /* duplicate ACK, acknowledges nothing new */
+#ifdef MODULE_TCP_CC
+                {
+                    tcp_cb_t *tcp_control = &tcp_socket->socket_values.tcp_control;
+                    unsigned state = disableIRQ();
+                    int wake = 0;
+
+                    if ((tcp_header->ack_nr == tcp_control->send_una) &&
+                        (tcp_control->send_nxt != tcp_control->send_una) &&
+                        tcp_cc_dup_ack(tcp_control)) {
+                        tcp_control->ack_events++;
+                        wake = 1;
+                    }
+
+                    restoreIRQ(state);
+
+                    if (wake) {
+                        socket_base_net_msg_send(&m_send_tcp, tcp_socket->send_pid, 0, TCP_ACK);
+                    }
+                }
+#endif
+                return;
+
+            default:
+                break;
         }
     }
 
@@ -602,6 +852,7 @@ void handle_tcp_fin_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
     tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
 
     current_tcp_socket->tcp_control.state = TCP_CLOSED;
+    tcp_timer_stop_all(tcp_socket);
 
     set_tcp_cb(&current_tcp_socket->tcp_control, tcp_header->seq_nr + 1,
                current_tcp_socket->tcp_control.send_wnd, tcp_header->ack_nr,
@@ -620,39 +871,49 @@ void handle_tcp_fin_ack_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
 void handle_tcp_no_flags_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
                                 socket_internal_t *tcp_socket, uint8_t *payload, uint8_t tcp_payload_len)
 {
+    (void) ipv6_header;
+
     socket_t *current_tcp_socket = &tcp_socket->socket_values;
     uint8_t send_buffer[BUFFER_SIZE];
     ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
     tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+    int consistency = check_tcp_consistency(current_tcp_socket, tcp_header, tcp_payload_len);
+    uint8_t had_hole = (tcp_socket->tcp_ooo_count > 0);
 
-    if (check_tcp_consistency(current_tcp_socket, tcp_header, tcp_payload_len) == PACKET_OK) {
-        uint8_t read_bytes = handle_payload(ipv6_header, tcp_header, tcp_socket, payload);
+    if (TCP_SEQ_LT(current_tcp_socket->tcp_control.send_una, tcp_header->ack_nr) &&
+        TCP_SEQ_LEQ(tcp_header->ack_nr, current_tcp_socket->tcp_control.send_nxt)) {
+        /* data of the peer acknowledges our data */
+        tcp_ack_received(tcp_socket, tcp_header);
+    }
 
-        /* Refresh TCP status values */
-        current_tcp_socket->tcp_control.state = TCP_ESTABLISHED;
+    /* trims repeated bytes and keeps the ones beyond a hole */
+    uint16_t read_bytes = handle_payload(tcp_header, tcp_socket, payload, tcp_payload_len);
 
-        set_tcp_cb(&current_tcp_socket->tcp_control,
-                   tcp_header->seq_nr + read_bytes,
-                   current_tcp_socket->tcp_control.rcv_wnd,
-                   current_tcp_socket->tcp_control.send_nxt,
-                   current_tcp_socket->tcp_control.send_una,
-                   current_tcp_socket->tcp_control.send_wnd);
+    /* Refresh TCP status values */
+    current_tcp_socket->tcp_control.state = TCP_ESTABLISHED;
 
-        /* Send packet */
-        //  block_continue_thread();
-#ifdef TCP_HC
-        current_tcp_socket->tcp_control.tcp_context.hc_type = COMPRESSED_HEADER;
-#endif
-        send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header, TCP_ACK, 0);
+#ifdef MODULE_TCP_CC
+    /* out-of-order, repeated and hole filling segments are acknowledged at
+     * once, duplicate ACKs trigger the peer's fast retransmit */
+    if ((consistency == PACKET_OK) && !had_hole &&
+        tcp_cc_delay_ack(tcp_socket)) {
+        /* acknowledged with the next segment or on expiry */
+        return;
     }
-    /* ACK packet probably got lost */
-    else {
-        //      block_continue_thread();
+#else
+    (void) consistency;
+    (void) had_hole;
+#endif
+
+    /* Send packet */
+    //  block_continue_thread();
 #ifdef TCP_HC
-        current_tcp_socket->tcp_control.tcp_context.hc_type = FULL_HEADER;
+    current_tcp_socket->tcp_control.tcp_context.hc_type =
+        (read_bytes > 0) ? COMPRESSED_HEADER : FULL_HEADER;
+#else
+    (void) read_bytes;
 #endif
-        send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header, TCP_ACK, 0);
-    }
+    send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header, TCP_ACK, 0);
 }
 
 void *tcp_packet_handler(void *arg)
@@ -665,6 +926,9 @@ void *tcp_packet_handler(void *arg)
     while (1) {
         msg_receive(&m_recv_ip);
 
+        unsigned long start = net_stats_start();
+        NET_STATS_INC(NET_STATS_TCP, rx);
+
         ipv6_hdr_t *ipv6_header = ((ipv6_hdr_t *)m_recv_ip.content.ptr);
         tcp_hdr_t *tcp_header = ((tcp_hdr_t *)(m_recv_ip.content.ptr + IPV6_HDR_LEN));
 #ifdef TCP_HC
@@ -742,6 +1006,13 @@ void *tcp_packet_handler(void *arg)
             }
         }
         else {
+            if (chksum != 0xffff) {
+                NET_STATS_INC(NET_STATS_TCP, csum_errors);
+            }
+            else {
+                NET_STATS_INC(NET_STATS_TCP, rx_dropped);
+            }
+
             printf("Wrong checksum (%x) or no corresponding socket found!\n",
                    chksum);
             printArrayRange(((uint8_t *)ipv6_header), IPV6_HDR_LEN +
@@ -750,6 +1021,7 @@ void *tcp_packet_handler(void *arg)
                              &tcp_socket->socket_values);
         }
 
+        net_stats_latency(NET_STATS_TCP, start);
         msg_reply(&m_recv_ip, &m_send_ip);
     }
 }
@@ -796,41 +1068,11 @@ int tcp_bind_socket(int s, sockaddr6_t *name, int namelen, uint8_t pid)
     sock->socket_values.local_address = *name;
     sock->socket_values.tcp_control.rto = TCP_INITIAL_ACK_TIMEOUT;
     sock->recv_pid = pid;
+    socket_base_index_add(s);
 
     return 0;
 }
 
-void calculate_rto(tcp_cb_t *tcp_control, timex_t current_time)
-{
-    double rtt = (double) timex_uint64(timex_sub(current_time, tcp_control->last_packet_time));
-    double srtt = tcp_control->srtt;
-    double rttvar = tcp_control->rttvar;
-    double rto = tcp_control->rto;
-
-    if ((srtt == 0) && (rttvar == 0) && (rto == TCP_INITIAL_ACK_TIMEOUT)) {
-        /* First calculation */
-        srtt = rtt;
-        rttvar = 0.5 * rtt;
-        rto = rtt + (((4 * rttvar) < TCP_TIMER_RESOLUTION) ?
-                     (TCP_TIMER_RESOLUTION) : (4 * rttvar));
-    }
-    else {
-        /* every other calculation */
-        srtt = (1 - TCP_ALPHA) * srtt + TCP_ALPHA * rtt;
-        rttvar = (1 - TCP_BETA) * rttvar + TCP_BETA * abs(srtt - rtt);
-        rto = srtt + (((4 * rttvar) < TCP_TIMER_RESOLUTION) ?
-                      (TCP_TIMER_RESOLUTION) : (4 * rttvar));
-    }
-
-    if (rto < SECOND) {
-        rto = SECOND;
-    }
-
-    tcp_control->srtt = srtt;
-    tcp_control->rttvar = rttvar;
-    tcp_control->rto = rto;
-}
-
 int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
                               socket_internal_t *server_socket, uint8_t pid)
 {
@@ -864,6 +1106,7 @@ int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
         /* Send packet */
         send_tcp(current_queued_int_socket, syn_ack_packet, temp_ipv6_header,
                  TCP_SYN_ACK, 0);
+        tcp_timer_set_synchro(current_queued_int_socket);
 
         /* wait for ACK from Client */
         msg_receive(&msg_recv_client_ack);
@@ -871,6 +1114,8 @@ int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
         if (msg_recv_client_ack.type == TCP_TIMEOUT) {
             /* Set status of internal socket back to TCP_LISTEN */
             server_socket->socket_values.tcp_control.state = TCP_LISTEN;
+            tcp_timer_stop_all(current_queued_int_socket);
+            socket_base_index_remove(current_queued_int_socket->socket_id);
             memset(current_queued_int_socket, 0, sizeof(socket_internal_t));
             return -1;
         }
@@ -878,6 +1123,7 @@ int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
 
     tcp_hdr_t *tcp_header;
 
+    tcp_timer_stop(current_queued_int_socket);
     tcp_header = ((tcp_hdr_t *)(msg_recv_client_ack.content.ptr));
 
     /* Check for consistency */
@@ -918,20 +1164,94 @@ int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
     return current_queued_int_socket->socket_id;
 }
 
+/* copies as much of buf as fits to the end of the send buffer */
+static uint32_t tcp_send_buffer_write(socket_internal_t *current_int_tcp_socket,
+                                      const uint8_t *buf, uint32_t len)
+{
+    uint16_t size = sizeof(current_int_tcp_socket->tcp_send_buffer);
+    uint16_t space = size - current_int_tcp_socket->tcp_send_buffer_len;
+    uint16_t pos = (current_int_tcp_socket->tcp_send_buffer_start +
+                    current_int_tcp_socket->tcp_send_buffer_len) % size;
+    uint32_t written = 0;
+
+    if (len > space) {
+        len = space;
+    }
+
+    while (written < len) {
+        uint16_t chunk = size - pos;
+
+        if ((len - written) < chunk) {
+            chunk = len - written;
+        }
+
+        memcpy(&current_int_tcp_socket->tcp_send_buffer[pos], buf + written, chunk);
+        written += chunk;
+        pos = (pos + chunk) % size;
+    }
+
+    current_int_tcp_socket->tcp_send_buffer_len += written;
+    return written;
+}
+
+/* copies len bytes starting offset bytes after send_una out of the send
+ * buffer */
+static void tcp_send_buffer_read(socket_internal_t *current_int_tcp_socket,
+                                 uint16_t offset, uint8_t *dst, uint16_t len)
+{
+    uint16_t size = sizeof(current_int_tcp_socket->tcp_send_buffer);
+    uint16_t pos = (current_int_tcp_socket->tcp_send_buffer_start + offset) % size;
+
+    while (len > 0) {
+        uint16_t chunk = (len < (size - pos)) ? len : (size - pos);
+
+        memcpy(dst, &current_int_tcp_socket->tcp_send_buffer[pos], chunk);
+        dst += chunk;
+        len -= chunk;
+        pos = (pos + chunk) % size;
+    }
+}
+
+/* releases acknowledged bytes */
+static void tcp_send_buffer_drop(socket_internal_t *current_int_tcp_socket,
+                                 uint16_t len)
+{
+    uint16_t size = sizeof(current_int_tcp_socket->tcp_send_buffer);
+
+    if (len > current_int_tcp_socket->tcp_send_buffer_len) {
+        len = current_int_tcp_socket->tcp_send_buffer_len;
+    }
+
+    current_int_tcp_socket->tcp_send_buffer_start =
+        (current_int_tcp_socket->tcp_send_buffer_start + len) % size;
+    current_int_tcp_socket->tcp_send_buffer_len -= len;
+}
+
+/* sends len bytes starting offset bytes into the send buffer, the first of
+ * them has sequence number seq_nr */
+static int tcp_send_segment(socket_internal_t *current_int_tcp_socket,
+                            uint16_t offset, uint32_t seq_nr, uint8_t len)
+{
+    uint8_t send_buffer[BUFFER_SIZE];
+    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
+    tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+
+    tcp_send_buffer_read(current_int_tcp_socket, offset,
+                         &send_buffer[IPV6_HDR_LEN + TCP_HDR_LEN], len);
+
+    return send_tcp_seq(current_int_tcp_socket, current_tcp_packet,
+                        temp_ipv6_header, TCP_ACK, seq_nr, len);
+}
+
 int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
 {
     (void) flags;
 
     /* Variables */
     msg_t recv_msg;
-    int32_t sent_bytes = 0;
     uint32_t total_sent_bytes = 0;
     socket_internal_t *current_int_tcp_socket;
-    socket_t *current_tcp_socket;
-    uint8_t send_buffer[BUFFER_SIZE];
-    memset(send_buffer, 0, BUFFER_SIZE);
-    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
-    tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+    tcp_cb_t *tcp_control;
 
     /* Check if socket exists and is TCP socket */
     if (!tcp_socket_compliancy(s)) {
@@ -939,157 +1259,182 @@ int32_t tcp_send(int s, const void *buf, uint32_t len, int flags)
     }
 
     current_int_tcp_socket = socket_base_get_socket(s);
-    current_tcp_socket = &current_int_tcp_socket->socket_values;
+    tcp_control = &current_int_tcp_socket->socket_values.tcp_control;
 
     /* Check for TCP_ESTABLISHED STATE */
-    if (current_tcp_socket->tcp_control.state != TCP_ESTABLISHED) {
+    if (tcp_control->state != TCP_ESTABLISHED) {
         return -1;
     }
 
     /* Add thread PID */
     current_int_tcp_socket->send_pid = thread_getpid();
 
-    recv_msg.type = UNDEFINED;
+    tcp_control->no_of_retries = 0;
+    tcp_control->rtt_active = 0;
+
+#ifdef MODULE_TCP_CC
+    if (tcp_control->cwnd == 0) {
+        /* first send on this connection */
+        tcp_cc_init(tcp_control);
+    }
+#endif
+
+    /* The send buffer is empty between two calls. tcp_ack_received() moves
+     * send_una, the acknowledged bytes are released here. */
+    uint32_t buffer_seq = tcp_control->send_una;
 
     while (1) {
-        current_tcp_socket->tcp_control.no_of_retries = 0;
+        unsigned state = disableIRQ();
+        uint32_t send_una = tcp_control->send_una;
+        uint32_t send_nxt = tcp_control->send_nxt;
+        uint32_t window = tcp_control->send_wnd;
+        uint8_t ack_events = tcp_control->ack_events;
+#ifdef MODULE_TCP_CC
+        uint8_t retransmit = tcp_control->retransmit;
+        tcp_control->retransmit = 0;
+
+        if (window > tcp_control->cwnd) {
+            window = tcp_control->cwnd;
+        }
+#endif
+        restoreIRQ(state);
+
+        tcp_send_buffer_drop(current_int_tcp_socket, send_una - buffer_seq);
+        buffer_seq = send_una;
+
+        total_sent_bytes += tcp_send_buffer_write(current_int_tcp_socket,
+                                                  (const uint8_t *) buf + total_sent_bytes,
+                                                  len - total_sent_bytes);
+
+        if ((total_sent_bytes == len) && (current_int_tcp_socket->tcp_send_buffer_len == 0)) {
+            /* Got ACK for every sent byte */
+            return len;
+        }
+
+        if (window > sizeof(current_int_tcp_socket->tcp_send_buffer)) {
+            window = sizeof(current_int_tcp_socket->tcp_send_buffer);
+        }
+        else if ((window == 0) && (send_nxt == send_una)) {
+            /* zero window probe, the retransmission timer keeps probing */
+            window = 1;
+        }
 
 #ifdef TCP_HC
-        current_tcp_socket->tcp_control.tcp_context.hc_type = COMPRESSED_HEADER;
-        /* Remember TCP Context for possible TCP_RETRY */
-        tcp_hc_context_t saved_tcp_context;
-        memcpy(&saved_tcp_context, &current_tcp_socket->tcp_control.tcp_context,
-               sizeof(tcp_hc_context_t) - 1);
+        tcp_control->tcp_context.hc_type = COMPRESSED_HEADER;
 #endif
 
-        while (recv_msg.type != TCP_ACK) {
-            /* Add packet data */
-            if (current_tcp_socket->tcp_control.send_wnd >
-                current_tcp_socket->tcp_control.mss) {
-                /* Window size > Maximum Segment Size */
-                if ((len - total_sent_bytes) > current_tcp_socket->tcp_control.mss) {
-                    memcpy(&send_buffer[IPV6_HDR_LEN + TCP_HDR_LEN], buf,
-                           current_tcp_socket->tcp_control.mss);
-                    sent_bytes = current_tcp_socket->tcp_control.mss;
-                    total_sent_bytes += sent_bytes;
-                }
-                else {
-                    memcpy(&send_buffer[IPV6_HDR_LEN + TCP_HDR_LEN],
-                           (uint8_t *) buf + total_sent_bytes, len - total_sent_bytes);
-                    sent_bytes = len - total_sent_bytes;
-                    total_sent_bytes = len;
-                }
-            }
-            else {
-                /* Window size <= Maximum Segment Size */
-                if ((len - total_sent_bytes) > current_tcp_socket->tcp_control.send_wnd) {
-                    memcpy(&send_buffer[IPV6_HDR_LEN + TCP_HDR_LEN], buf,
-                           current_tcp_socket->tcp_control.send_wnd);
-                    sent_bytes = current_tcp_socket->tcp_control.send_wnd;
-                    total_sent_bytes += sent_bytes;
-                }
-                else {
-                    memcpy(&send_buffer[IPV6_HDR_LEN + TCP_HDR_LEN],
-                           (uint8_t *) buf + total_sent_bytes, len - total_sent_bytes);
-                    sent_bytes = len - total_sent_bytes;
-                    total_sent_bytes = len;
-                }
+#ifdef MODULE_TCP_CC
+        if (retransmit && (send_nxt != send_una)) {
+            /* fast retransmit of the first unacknowledged segment */
+            uint32_t sent_bytes = send_nxt - send_una;
+
+            if (sent_bytes > tcp_control->mss) {
+                sent_bytes = tcp_control->mss;
             }
 
-            current_tcp_socket->tcp_control.send_nxt += sent_bytes;
-            current_tcp_socket->tcp_control.send_wnd -= sent_bytes;
+            tcp_control->rtt_active = 0;
 
-            if (send_tcp(current_int_tcp_socket, current_tcp_packet,
-                         temp_ipv6_header, TCP_ACK, sent_bytes) < 0) {
-                /* Error while sending tcp data */
-                current_tcp_socket->tcp_control.send_nxt -= sent_bytes;
-                current_tcp_socket->tcp_control.send_wnd += sent_bytes;
-#ifdef TCP_HC
-                memcpy(&current_tcp_socket->tcp_control.tcp_context,
-                       &saved_tcp_context, sizeof(tcp_hc_context_t));
-                current_tcp_socket->tcp_control.tcp_context.hc_type =
-                    COMPRESSED_HEADER;
+            if (tcp_send_segment(current_int_tcp_socket, 0, send_una, sent_bytes) < 0) {
+                tcp_timer_stop(current_int_tcp_socket);
+                tcp_control->send_nxt = tcp_control->send_una;
+                current_int_tcp_socket->tcp_send_buffer_len = 0;
+                printf("Error while sending, returning to application thread!\n");
+                return -1;
+            }
+        }
 #endif
+
+        /* Send everything the window and the buffer allow */
+        while (((send_nxt - send_una) < window) &&
+               ((send_nxt - send_una) < current_int_tcp_socket->tcp_send_buffer_len)) {
+            uint32_t sent_bytes = window - (send_nxt - send_una);
+
+            if (sent_bytes > current_int_tcp_socket->tcp_send_buffer_len - (send_nxt - send_una)) {
+                sent_bytes = current_int_tcp_socket->tcp_send_buffer_len - (send_nxt - send_una);
+            }
+
+            if (sent_bytes > tcp_control->mss) {
+                sent_bytes = tcp_control->mss;
+            }
+
+            if (send_nxt == send_una) {
+                vtimer_now(&tcp_control->last_packet_time);
+            }
+
+            if (!tcp_control->rtt_active) {
+                tcp_control->rtt_seq = send_nxt + sent_bytes;
+                vtimer_now(&tcp_control->rtt_time);
+                tcp_control->rtt_active = 1;
+            }
+
+            if (tcp_send_segment(current_int_tcp_socket, send_nxt - send_una,
+                                 send_nxt, sent_bytes) < 0) {
+                /* Error while sending tcp data, forget what was not acknowledged */
+                tcp_timer_stop(current_int_tcp_socket);
+                tcp_control->send_nxt = tcp_control->send_una;
+                current_int_tcp_socket->tcp_send_buffer_len = 0;
                 printf("Error while sending, returning to application thread!\n");
                 return -1;
             }
 
-            /* Remember current time */
-            vtimer_now(&current_tcp_socket->tcp_control.last_packet_time);
-            socket_base_net_msg_receive(&recv_msg);
+            send_nxt += sent_bytes;
 
-            switch (recv_msg.type) {
-                case TCP_ACK: {
-                    if (current_tcp_socket->tcp_control.no_of_retries == 0) {
-                        calculate_rto(&current_tcp_socket->tcp_control,
-                                      current_tcp_socket->tcp_control.last_packet_time);
-                    }
+            state = disableIRQ();
 
-                    tcp_hdr_t *tcp_header = ((tcp_hdr_t *)(recv_msg.content.ptr));
+            if (tcp_control->send_nxt == tcp_control->send_una) {
+                /* first byte in flight, start retransmission timer */
+                tcp_timer_set(current_int_tcp_socket, tcp_timer_rto(tcp_control));
+            }
 
-                    if ((current_tcp_socket->tcp_control.send_nxt ==
-                         tcp_header->ack_nr) && (total_sent_bytes == len)) {
-                        current_tcp_socket->tcp_control.send_una = tcp_header->ack_nr;
-                        current_tcp_socket->tcp_control.send_nxt = tcp_header->ack_nr;
-                        current_tcp_socket->tcp_control.send_wnd = tcp_header->window;
-                        /* Got ACK for every sent byte */
-#ifdef TCP_HC
-                        current_tcp_socket->tcp_control.tcp_context.hc_type =
-                            COMPRESSED_HEADER;
-#endif
-                        return sent_bytes;
-                    }
-                    else if ((current_tcp_socket->tcp_control.send_nxt ==
-                              tcp_header->ack_nr) && (total_sent_bytes != len)) {
-                        current_tcp_socket->tcp_control.send_una = tcp_header->ack_nr;
-                        current_tcp_socket->tcp_control.send_nxt = tcp_header->ack_nr;
-                        current_tcp_socket->tcp_control.send_wnd = tcp_header->window;
-                        /* Got ACK for every sent byte */
-#ifdef TCP_HC
-                        current_tcp_socket->tcp_control.tcp_context.hc_type =
-                            COMPRESSED_HEADER;
-#endif
-                        break;
-                    }
+            tcp_control->send_nxt = send_nxt;
+            restoreIRQ(state);
+        }
 
-                    /* else {
-                     *     TODO: If window size > MSS, ACK was valid only for
-                     *     a few segments, handle retransmit of missing
-                     *     segments
-                     *  break;
-                     * } */
-                    break;
-                }
+        /* Wait for an ACK, a retransmission or a timeout. A TCP_ACK may also
+         * be left over from an ACK we already saw above, so only block if
+         * no ACK arrived since. */
+        recv_msg.type = TCP_ACK;
+
+        state = disableIRQ();
+
+        if (tcp_control->ack_events == ack_events) {
+            socket_base_net_msg_receive(&recv_msg);
+        }
+
+        restoreIRQ(state);
 
-                case TCP_RETRY: {
-                    current_tcp_socket->tcp_control.send_nxt -= sent_bytes;
-                    current_tcp_socket->tcp_control.send_wnd += sent_bytes;
-                    total_sent_bytes -= sent_bytes;
+        switch (recv_msg.type) {
+            case TCP_RETRY: {
+                /* go back to the first unacknowledged byte */
+                state = disableIRQ();
+#ifdef MODULE_TCP_CC
+                if (tcp_control->send_wnd != 0) {
+                    tcp_cc_timeout(tcp_control);
+                }
+#endif
+                tcp_control->send_nxt = tcp_control->send_una;
+                tcp_control->rtt_active = 0;
+                restoreIRQ(state);
 #ifdef TCP_HC
-                    memcpy(&current_tcp_socket->tcp_control.tcp_context,
-                           $&saved_tcp_context, sizeof(tcp_hc_context_t));
-                    current_tcp_socket->tcp_control.tcp_context.hc_type =
-                        MOSTLY_COMPRESSED_HEADER;
+                tcp_control->tcp_context.hc_type = MOSTLY_COMPRESSED_HEADER;
 #endif
-                    break;
-                }
+                break;
+            }
 
-                case TCP_TIMEOUT: {
-                    current_tcp_socket->tcp_control.send_nxt -= sent_bytes;
-                    current_tcp_socket->tcp_control.send_wnd += sent_bytes;
+            case TCP_TIMEOUT: {
+                tcp_timer_stop(current_int_tcp_socket);
+                tcp_control->send_nxt = tcp_control->send_una;
+                current_int_tcp_socket->tcp_send_buffer_len = 0;
 #ifdef TCP_HC
-                    memcpy(&current_tcp_socket->tcp_control.tcp_context,
-                           &saved_tcp_context, sizeof(tcp_hc_context_t));
-                    current_tcp_socket->tcp_control.tcp_context.hc_type =
-                        COMPRESSED_HEADER;
+                tcp_control->tcp_context.hc_type = COMPRESSED_HEADER;
 #endif
-                    return -1;
-                }
+                return -1;
             }
+
+            default:
+                break;
         }
     }
-
-    return sent_bytes;
 }
 
 int tcp_accept(int s, sockaddr6_t *addr, uint32_t *addrlen)
@@ -1159,12 +1504,14 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
     /* Foreign address information */
     set_socket_address(&current_tcp_socket->foreign_address, addr->sin6_family,
                        addr->sin6_port, addr->sin6_flowinfo, &addr->sin6_addr);
+    socket_base_index_add(socket);
 
     /* Fill lcoal TCP socket information */
     srand(addr->sin6_port);
 
     current_tcp_socket->tcp_control.rcv_irs = 0;
     mutex_lock(&global_sequence_counter_mutex);
+    global_sequence_counter += rand();
     current_tcp_socket->tcp_control.send_iss = global_sequence_counter;
     mutex_unlock(&global_sequence_counter_mutex);
     current_tcp_socket->tcp_control.state = TCP_SYN_SENT;
@@ -1172,6 +1519,7 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
 #ifdef TCP_HC
     /* Choosing random number Context ID */
     mutex_lock(&global_context_counter_mutex);
+    global_context_counter += rand();
     current_tcp_socket->tcp_control.tcp_context.context_id = global_context_counter;
     mutex_unlock(&global_context_counter_mutex);
 
@@ -1183,7 +1531,7 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
            sizeof(tcp_hc_context_t));
 #endif
 
-    set_tcp_cb(&current_tcp_socket->tcp_control, 0, TRANSPORT_LAYER_SOCKET_STATIC_WINDOW,
+    set_tcp_cb(&current_tcp_socket->tcp_control, 0, TRANSPORT_LAYER_SOCKET_MAX_TCP_BUFFER,
                current_tcp_socket->tcp_control.send_iss + 1,
                current_tcp_socket->tcp_control.send_iss, 0);
 
@@ -1199,11 +1547,13 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
         /* Send packet */
         send_tcp(current_int_tcp_socket, current_tcp_packet, temp_ipv6_header,
                  TCP_SYN, 0);
+        tcp_timer_set_synchro(current_int_tcp_socket);
 
         /* wait for SYN ACK or RETRY */
         msg_receive(&msg_from_server);
 
         if (msg_from_server.type == TCP_TIMEOUT) {
+            tcp_timer_stop(current_int_tcp_socket);
 #ifdef TCP_HC
             /* We did not send anything successful so restore last context */
             memcpy(&current_tcp_socket->tcp_control.tcp_context,
@@ -1266,6 +1616,8 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
         /* Send packet */
         send_tcp(current_int_tcp_socket, current_tcp_packet, temp_ipv6_header,
                  TCP_ACK, 0);
+        /* no SYN-ACK until it expires means the ACK arrived */
+        tcp_timer_set_synchro(current_int_tcp_socket);
 
         msg_receive(&msg_from_server);
 #ifdef TCP_HC
@@ -1284,6 +1636,7 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
 #endif
     }
 
+    tcp_timer_stop(current_int_tcp_socket);
     current_tcp_socket->tcp_control.state = TCP_ESTABLISHED;
 
     current_int_tcp_socket->recv_pid = 255;
@@ -1292,31 +1645,35 @@ int tcp_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
     return 0;
 }
 
-uint8_t read_from_socket(socket_internal_t *current_int_tcp_socket,
-                         void *buf, int len)
+uint16_t read_from_socket(socket_internal_t *current_int_tcp_socket,
+                          void *buf, int len)
 {
-    if (len >= current_int_tcp_socket->tcp_input_buffer_end) {
-        mutex_lock(&current_int_tcp_socket->tcp_buffer_mutex);
-        uint8_t read_bytes = current_int_tcp_socket->tcp_input_buffer_end;
-        memcpy(buf, current_int_tcp_socket->tcp_input_buffer,
-               current_int_tcp_socket->tcp_input_buffer_end);
-        current_int_tcp_socket->tcp_input_buffer_end = 0;
-        current_int_tcp_socket->socket_values.tcp_control.rcv_wnd += read_bytes;
-        mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
-        return read_bytes;
+    uint16_t size = sizeof(current_int_tcp_socket->tcp_input_buffer);
+    uint8_t *dst = buf;
+
+    mutex_lock(&current_int_tcp_socket->tcp_buffer_mutex);
+
+    if (len > current_int_tcp_socket->tcp_input_buffer_len) {
+        len = current_int_tcp_socket->tcp_input_buffer_len;
     }
-    else {
-        mutex_lock(&current_int_tcp_socket->tcp_buffer_mutex);
-        memcpy(buf, current_int_tcp_socket->tcp_input_buffer, len);
-        memmove(current_int_tcp_socket->tcp_input_buffer,
-                (current_int_tcp_socket->tcp_input_buffer + len),
-                current_int_tcp_socket->tcp_input_buffer_end - len);
-        current_int_tcp_socket->tcp_input_buffer_end =
-            current_int_tcp_socket->tcp_input_buffer_end - len;
-        current_int_tcp_socket->socket_values.tcp_control.rcv_wnd += len;
-        mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
-        return len;
+
+    uint16_t read_bytes = len;
+    uint16_t pos = current_int_tcp_socket->tcp_input_buffer_start;
+
+    while (len > 0) {
+        uint16_t chunk = (len < (size - pos)) ? len : (size - pos);
+
+        memcpy(dst, &current_int_tcp_socket->tcp_input_buffer[pos], chunk);
+        dst += chunk;
+        len -= chunk;
+        pos = (pos + chunk) % size;
     }
+
+    current_int_tcp_socket->tcp_input_buffer_start = pos;
+    current_int_tcp_socket->tcp_input_buffer_len -= read_bytes;
+    current_int_tcp_socket->socket_values.tcp_control.rcv_wnd += read_bytes;
+    mutex_unlock(&current_int_tcp_socket->tcp_buffer_mutex);
+    return read_bytes;
 }
 
 int32_t tcp_recv(int s, void *buf, uint32_t len, int flags)
@@ -1338,14 +1695,14 @@ int32_t tcp_recv(int s, void *buf, uint32_t len, int flags)
     /* Setting Thread PID */
     current_int_tcp_socket->recv_pid = thread_getpid();
 
-    if (current_int_tcp_socket->tcp_input_buffer_end > 0) {
+    if (current_int_tcp_socket->tcp_input_buffer_len > 0) {
         return read_from_socket(current_int_tcp_socket, buf, len);
     }
 
     msg_receive(&m_recv);
 
-    if ((socket_base_exists_socket(s)) && (current_int_tcp_socket->tcp_input_buffer_end > 0)) {
-        uint8_t read_bytes = read_from_socket(current_int_tcp_socket, buf, len);
+    if ((socket_base_exists_socket(s)) && (current_int_tcp_socket->tcp_input_buffer_len > 0)) {
+        uint16_t read_bytes = read_from_socket(current_int_tcp_socket, buf, len);
         socket_base_net_msg_reply(&m_recv, &m_send, UNDEFINED);
         return read_bytes;
     }
@@ -1386,6 +1743,8 @@ int tcp_teardown(socket_internal_t *current_socket)
 
     /* Check for TCP_ESTABLISHED STATE */
     if (current_socket->socket_values.tcp_control.state != TCP_ESTABLISHED) {
+        tcp_timer_stop_all(current_socket);
+        socket_base_index_remove(current_socket->socket_id);
         memset(current_socket, 0, sizeof(socket_internal_t));
         return 0;
     }
@@ -1402,6 +1761,8 @@ int tcp_teardown(socket_internal_t *current_socket)
     send_tcp(current_socket, current_tcp_packet, temp_ipv6_header,
              TCP_FIN_ACK, 0);
     msg_receive(&m_recv);
+    tcp_timer_stop_all(current_socket);
+    socket_base_index_remove(current_socket->socket_id);
     memset(current_socket, 0, sizeof(socket_internal_t));
     return 1;
 }
@@ -1427,8 +1788,11 @@ int tcp_init_transport_layer(void)
 
     ipv6_register_next_header_handler(IPV6_PROTO_NUM_TCP, tcp_thread_pid);
 
-    if (thread_create(tcp_timer_stack, TCP_TIMER_STACKSIZE, PRIORITY_MAIN + 1,
-                      CREATE_STACKTEST, tcp_general_timer, NULL, "tcp_general_timer") < 0) {
+    tcp_timer_pid = thread_create(tcp_timer_stack, TCP_TIMER_STACKSIZE, PRIORITY_MAIN + 1,
+                                  CREATE_STACKTEST, tcp_general_timer, NULL,
+                                  "tcp_general_timer");
+
+    if (tcp_timer_pid < 0) {
         return -1;
     }
 
@@ -62,7 +62,8 @@ enum tcp_codes {
     CLOSE_CONN          = 2,
     SEQ_NO_TOO_SMALL    = 3,
     ACK_NO_TOO_SMALL    = 4,
-    ACK_NO_TOO_BIG      = 5
+    ACK_NO_TOO_BIG      = 5,
+    SEQ_NO_TOO_BIG      = 6
 };
 
 #define REMOVE_RESERVED         (0xFC)
@@ -74,6 +75,10 @@ enum tcp_codes {
 #define IS_TCP_FIN(a)           (((a) & TCP_FIN)      == TCP_FIN)
 #define IS_TCP_FIN_ACK(a)       (((a) & TCP_FIN_ACK)  == TCP_FIN_ACK)
 
+/* sequence number comparison modulo 2^32 */
+#define TCP_SEQ_LT(a, b)        ((int32_t)((uint32_t)(a) - (uint32_t)(b)) < 0)
+#define TCP_SEQ_LEQ(a, b)       ((int32_t)((uint32_t)(a) - (uint32_t)(b)) <= 0)
+
 #define SET_TCP_ACK(a)          (a) = TCP_ACK
 #define SET_TCP_RST(a)          (a) = TCP_RST
 #define SET_TCP_SYN(a)          (a) = TCP_SYN
@@ -108,6 +113,10 @@ int32_t tcp_recv(int s, void *buf, uint32_t len, int flags);
 bool tcp_socket_compliancy(int s);
 int tcp_teardown(socket_internal_t *current_socket);
 
+/* methods used by tcp_timer and tcp_cc */
+int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
+             ipv6_hdr_t *temp_ipv6_header, uint8_t flags, uint8_t payload_length);
+
 /**
  * @}
  */
@@ -0,0 +1,155 @@
+/**
+ * TCP congestion control
+ *
+ * Copyright (C) 2014  Freie Universität Berlin.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup transport_layer
+ * @{
+ * @file    tcp_cc.c
+ * @brief   NewReno congestion control and delayed ACKs, see RFC 5681 and
+ *          RFC 6582
+ * @}
+ */
+
+#include <stdint.h>
+
+#include "ipv6.h"
+
+#include "socket.h"
+#include "tcp.h"
+#include "tcp_timer.h"
+
+#include "tcp_cc.h"
+
+#ifdef MODULE_TCP_CC
+
+static uint16_t half_flight(tcp_cb_t *tcp_control)
+{
+    uint32_t half = (tcp_control->send_nxt - tcp_control->send_una) / 2;
+
+    if (half < 2 * (uint32_t) tcp_control->mss) {
+        half = 2 * tcp_control->mss;
+    }
+
+    return (half > UINT16_MAX) ? UINT16_MAX : half;
+}
+
+static void set_cwnd(tcp_cb_t *tcp_control, uint32_t cwnd)
+{
+    tcp_control->cwnd = (cwnd > UINT16_MAX) ? UINT16_MAX : cwnd;
+}
+
+void tcp_cc_init(tcp_cb_t *tcp_control)
+{
+    tcp_control->cwnd = TCP_CC_INITIAL_WINDOW(tcp_control->mss);
+    tcp_control->ssthresh = UINT16_MAX;
+    tcp_control->dup_acks = 0;
+    tcp_control->in_recovery = 0;
+    tcp_control->retransmit = 0;
+}
+
+void tcp_cc_ack(tcp_cb_t *tcp_control, uint32_t ack_nr)
+{
+    uint32_t acked = ack_nr - tcp_control->send_una;
+
+    tcp_control->dup_acks = 0;
+
+    if (tcp_control->in_recovery) {
+        if (TCP_SEQ_LEQ(tcp_control->recover, ack_nr)) {
+            /* full ACK, deflate the window */
+            tcp_control->in_recovery = 0;
+            tcp_control->cwnd = tcp_control->ssthresh;
+        }
+        else {
+            /* partial ACK, the segment after it got lost as well */
+            uint32_t cwnd = (tcp_control->cwnd > acked) ? tcp_control->cwnd - acked : 0;
+            set_cwnd(tcp_control, cwnd + tcp_control->mss);
+            tcp_control->retransmit = 1;
+        }
+
+        return;
+    }
+
+    if (tcp_control->cwnd < tcp_control->ssthresh) {
+        /* slow start */
+        set_cwnd(tcp_control, tcp_control->cwnd +
+                 ((acked < tcp_control->mss) ? acked : tcp_control->mss));
+    }
+    else {
+        /* congestion avoidance, about one MSS per RTT */
+        uint32_t inc = ((uint32_t) tcp_control->mss * tcp_control->mss) / tcp_control->cwnd;
+        set_cwnd(tcp_control, tcp_control->cwnd + (inc ? inc : 1));
+    }
+}
+
+int tcp_cc_dup_ack(tcp_cb_t *tcp_control)
+{
+    if (tcp_control->dup_acks < UINT8_MAX) {
+        tcp_control->dup_acks++;
+    }
+
+    if (tcp_control->in_recovery) {
+        /* a segment left the network, let another one in */
+        set_cwnd(tcp_control, tcp_control->cwnd + tcp_control->mss);
+        return 1;
+    }
+
+    if (tcp_control->dup_acks == TCP_CC_DUP_ACK_THRESHOLD) {
+        tcp_control->ssthresh = half_flight(tcp_control);
+        set_cwnd(tcp_control, tcp_control->ssthresh +
+                 TCP_CC_DUP_ACK_THRESHOLD * (uint32_t) tcp_control->mss);
+        tcp_control->recover = tcp_control->send_nxt;
+        tcp_control->in_recovery = 1;
+        tcp_control->retransmit = 1;
+        return 1;
+    }
+
+    return 0;
+}
+
+void tcp_cc_timeout(tcp_cb_t *tcp_control)
+{
+    tcp_control->ssthresh = half_flight(tcp_control);
+    tcp_control->cwnd = tcp_control->mss;
+    tcp_control->dup_acks = 0;
+    tcp_control->in_recovery = 0;
+    tcp_control->retransmit = 0;
+}
+
+int tcp_cc_delay_ack(socket_internal_t *current_socket)
+{
+    tcp_cb_t *tcp_control = &current_socket->socket_values.tcp_control;
+
+    if (++tcp_control->ack_pending < TCP_CC_DELACK_SEGMENTS) {
+        tcp_timer_set_delack(current_socket, TCP_CC_DELACK_TIMEOUT);
+        return 1;
+    }
+
+    return 0;
+}
+
+void tcp_cc_ack_sent(socket_internal_t *current_socket)
+{
+    if (current_socket->socket_values.tcp_control.ack_pending) {
+        current_socket->socket_values.tcp_control.ack_pending = 0;
+        tcp_timer_stop_delack(current_socket);
+    }
+}
+
+void tcp_cc_delack_expired(socket_internal_t *current_socket)
+{
+    uint8_t send_buffer[BUFFER_SIZE];
+    ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
+    tcp_hdr_t *current_tcp_packet = ((tcp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
+
+    if (current_socket->socket_values.tcp_control.ack_pending &&
+        (current_socket->socket_values.tcp_control.state == TCP_ESTABLISHED)) {
+        send_tcp(current_socket, current_tcp_packet, temp_ipv6_header, TCP_ACK, 0);
+    }
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2014  Freie Universität Berlin.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ * @file    tcp_cc.h
+ * @brief   TCP congestion control (NewReno) and delayed ACKs
+ *
+ * Enabled by the tcp_cc module. The sender limits its window to cwnd,
+ * which grows by slow start and congestion avoidance. Three duplicate ACKs
+ * trigger a fast retransmit and fast recovery, partial ACKs during recovery
+ * retransmit the next hole. Received segments are acknowledged every
+ * TCP_CC_DELACK_SEGMENTS segments or after TCP_CC_DELACK_TIMEOUT.
+ */
+#ifndef TCP_CC_H_
+#define TCP_CC_H_
+
+#include <stdint.h>
+
+#include "socket.h"
+
+#include "tcp.h"
+
+#ifdef MODULE_TCP_CC
+
+#define TCP_CC_INITIAL_WINDOW(mss)  (2 * (mss))
+#define TCP_CC_DUP_ACK_THRESHOLD    (3)
+
+#ifndef TCP_CC_DELACK_SEGMENTS
+#define TCP_CC_DELACK_SEGMENTS      (2)
+#endif
+
+#ifndef TCP_CC_DELACK_TIMEOUT
+#define TCP_CC_DELACK_TIMEOUT       (200 * 1000)
+#endif
+
+void tcp_cc_init(tcp_cb_t *tcp_control);
+/* new data acknowledged, call before send_una moves */
+void tcp_cc_ack(tcp_cb_t *tcp_control, uint32_t ack_nr);
+/* returns 1 if the sender can go on */
+int tcp_cc_dup_ack(tcp_cb_t *tcp_control);
+void tcp_cc_timeout(tcp_cb_t *tcp_control);
+
+/* returns 1 if the ACK for a received segment is delayed */
+int tcp_cc_delay_ack(socket_internal_t *current_socket);
+/* an ACK was sent, nothing is pending anymore */
+void tcp_cc_ack_sent(socket_internal_t *current_socket);
+void tcp_cc_delack_expired(socket_internal_t *current_socket);
+
+#endif
+#endif /* TCP_CC_H_ */
+/**
+ * @}
+ */
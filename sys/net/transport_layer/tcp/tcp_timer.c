@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "irq.h"
 #include "sixlowpan.h"
 #include "thread.h"
 #include "vtimer.h"
@@ -27,130 +28,205 @@
 #include "socket.h"
 
 #include "tcp.h"
+#include "tcp_cc.h"
 #include "tcp_timer.h"
 
+/* the expiry message carries the socket ID, the generation of the timer and
+ * whether it is the delayed ACK timer */
+#define TIMER_GEN_MASK      (0x7f)
+#define TIMER_DELACK        (0x8000)
+
+kernel_pid_t tcp_timer_pid = KERNEL_PID_UNDEF;
+
+static msg_t tcp_timer_msg_queue[TCP_TIMER_MSG_QUEUE_SIZE];
+
+static void timer_set(vtimer_t *timer, uint8_t *gen, unsigned value, uint64_t timeout)
+{
+    unsigned state = disableIRQ();
+
+    vtimer_remove(timer);
+    /* a message of the previous expiry may still be queued */
+    *gen = (*gen + 1) & TIMER_GEN_MASK;
+    vtimer_set_msg(timer, timex_from_uint64(timeout), tcp_timer_pid,
+                   (void *)(uintptr_t)(value | (*gen << 8)));
+
+    restoreIRQ(state);
+}
+
+static void timer_stop(vtimer_t *timer, uint8_t *gen)
+{
+    unsigned state = disableIRQ();
+
+    vtimer_remove(timer);
+    *gen = (*gen + 1) & TIMER_GEN_MASK;
+
+    restoreIRQ(state);
+}
+
+void tcp_timer_set(socket_internal_t *current_socket, uint64_t timeout)
+{
+    timer_set(&current_socket->tcp_timer, &current_socket->tcp_timer_gen,
+              current_socket->socket_id, timeout);
+}
+
+void tcp_timer_stop(socket_internal_t *current_socket)
+{
+    timer_stop(&current_socket->tcp_timer, &current_socket->tcp_timer_gen);
+}
+
+void tcp_timer_stop_all(socket_internal_t *current_socket)
+{
+    tcp_timer_stop(current_socket);
+#ifdef MODULE_TCP_CC
+    tcp_timer_stop_delack(current_socket);
+#endif
+}
+
+#ifdef MODULE_TCP_CC
+void tcp_timer_set_delack(socket_internal_t *current_socket, uint64_t timeout)
+{
+    timer_set(&current_socket->tcp_delack_timer, &current_socket->tcp_delack_gen,
+              current_socket->socket_id | TIMER_DELACK, timeout);
+}
+
+void tcp_timer_stop_delack(socket_internal_t *current_socket)
+{
+    timer_stop(&current_socket->tcp_delack_timer, &current_socket->tcp_delack_gen);
+}
+#endif
+
+uint64_t tcp_timer_rto(tcp_cb_t *tcp_control)
+{
+    uint64_t timeout = (tcp_control->rto < SECOND) ? SECOND : tcp_control->rto;
+
+    for (uint8_t i = 0; (i < tcp_control->no_of_retries) && (timeout <= TCP_ACK_MAX_TIMEOUT);
+         i++) {
+        timeout *= 2;
+    }
+
+    return timeout;
+}
+
+void tcp_timer_set_synchro(socket_internal_t *current_socket)
+{
+    tcp_timer_set(current_socket,
+                  current_socket->socket_values.tcp_control.no_of_retries ?
+                  TCP_SYN_TIMEOUT : TCP_SYN_INITIAL_TIMEOUT);
+}
+
 void handle_synchro_timeout(socket_internal_t *current_socket)
 {
     msg_t send;
 
-    if (thread_getstatus(current_socket->recv_pid) == STATUS_RECEIVE_BLOCKED) {
-        timex_t now;
-        vtimer_now(&now);
+    if (thread_getstatus(current_socket->recv_pid) != STATUS_RECEIVE_BLOCKED) {
+        /* busy with the last segment, try again soon */
+        tcp_timer_set(current_socket, TCP_TIMER_RESOLUTION);
+        return;
+    }
 
-        if ((current_socket->socket_values.tcp_control.no_of_retries == 0) &&
-            (timex_uint64(timex_sub(now, current_socket->socket_values.tcp_control.last_packet_time)) > TCP_SYN_INITIAL_TIMEOUT)) {
-            current_socket->socket_values.tcp_control.no_of_retries++;
-            socket_base_net_msg_send(&send, current_socket->recv_pid, 0, TCP_RETRY);
-        }
-        else if ((current_socket->socket_values.tcp_control.no_of_retries > 0) &&
-                 (timex_uint64(timex_sub(now, current_socket->socket_values.tcp_control.last_packet_time)) >
-                  (current_socket->socket_values.tcp_control.no_of_retries *
-                   TCP_SYN_TIMEOUT + TCP_SYN_INITIAL_TIMEOUT))) {
-            current_socket->socket_values.tcp_control.no_of_retries++;
-
-            if (current_socket->socket_values.tcp_control.no_of_retries >
-                TCP_MAX_SYN_RETRIES) {
-                socket_base_net_msg_send(&send, current_socket->recv_pid, 0, TCP_TIMEOUT);
-            }
-            else {
-                socket_base_net_msg_send(&send, current_socket->recv_pid, 0, TCP_RETRY);
-            }
-        }
+    current_socket->socket_values.tcp_control.no_of_retries++;
+
+    if (current_socket->socket_values.tcp_control.no_of_retries > TCP_MAX_SYN_RETRIES) {
+        socket_base_net_msg_send(&send, current_socket->recv_pid, 0, TCP_TIMEOUT);
+    }
+    else {
+        socket_base_net_msg_send(&send, current_socket->recv_pid, 0, TCP_RETRY);
     }
 }
 
 void handle_established(socket_internal_t *current_socket)
 {
     msg_t send;
-    double current_timeout = current_socket->socket_values.tcp_control.rto;
+    tcp_cb_t *tcp_control = &current_socket->socket_values.tcp_control;
 
-    if (current_timeout < SECOND) {
-        current_timeout = SECOND;
+    if (tcp_control->send_nxt == tcp_control->send_una) {
+        /* everything got acknowledged */
+        return;
     }
 
+    if (thread_getstatus(current_socket->send_pid) != STATUS_RECEIVE_BLOCKED) {
+        /* tcp_send() is still sending, it has to wait for the retry */
+        tcp_timer_set(current_socket, TCP_TIMER_RESOLUTION);
+        return;
+    }
 
-    if ((current_socket->socket_values.tcp_control.send_nxt >
-         current_socket->socket_values.tcp_control.send_una) &&
-        (thread_getstatus(current_socket->send_pid) == STATUS_RECEIVE_BLOCKED)) {
-        for (uint8_t i = 0; i < current_socket->socket_values.tcp_control.no_of_retries;
-             i++) {
-            current_timeout *= 2;
+    if (tcp_control->send_wnd == 0) {
+        /* persist: keep probing the zero window, do not give up */
+        if (tcp_timer_rto(tcp_control) <= TCP_ACK_MAX_TIMEOUT) {
+            tcp_control->no_of_retries++;
         }
 
-        timex_t now;
-        vtimer_now(&now);
-
-        if (current_timeout > TCP_ACK_MAX_TIMEOUT) {
-            socket_base_net_msg_send(&send, current_socket->send_pid, 0, TCP_TIMEOUT);
-        }
-        else if (timex_uint64(timex_sub(now, current_socket->socket_values.tcp_control.last_packet_time)) >
-                 current_timeout) {
-            current_socket->socket_values.tcp_control.no_of_retries++;
-            socket_base_net_msg_send(&send, current_socket->send_pid, 0, TCP_RETRY);
-        }
+        socket_base_net_msg_send(&send, current_socket->send_pid, 0, TCP_RETRY);
+        return;
     }
-}
 
-void check_sockets(void)
-{
-    uint8_t i = 1;
-
-    while (i < MAX_SOCKETS + 1) {
-        socket_internal_t *current_socket = socket_base_get_socket(i);
-
-        if (tcp_socket_compliancy(i)) {
-            switch (current_socket->socket_values.tcp_control.state) {
-                case TCP_ESTABLISHED: {
-                    handle_established(current_socket);
-                    break;
-                }
-
-                case TCP_SYN_SENT: {
-                    handle_synchro_timeout(current_socket);
-                    break;
-                }
-
-                case TCP_SYN_RCVD: {
-                    handle_synchro_timeout(current_socket);
-                    break;
-                }
-
-                default: {
-                    break;
-                }
-            }
-        }
+    tcp_control->no_of_retries++;
 
-        i++;
+    if (tcp_timer_rto(tcp_control) > TCP_ACK_MAX_TIMEOUT) {
+        socket_base_net_msg_send(&send, current_socket->send_pid, 0, TCP_TIMEOUT);
+    }
+    else {
+        socket_base_net_msg_send(&send, current_socket->send_pid, 0, TCP_RETRY);
     }
-}
-
-void inc_global_variables(void)
-{
-    mutex_lock(&global_sequence_counter_mutex);
-    global_sequence_counter += rand();
-    mutex_unlock(&global_sequence_counter_mutex);
-#ifdef TCP_HC
-    mutex_lock(&global_context_counter_mutex);
-    global_context_counter += rand();
-    mutex_unlock(&global_context_counter_mutex);
-#endif
 }
 
 void *tcp_general_timer(void *arg)
 {
     (void) arg;
 
-    vtimer_t tcp_vtimer;
-    timex_t interval = timex_set(0, TCP_TIMER_RESOLUTION);
+    msg_t m;
+
+    msg_init_queue(tcp_timer_msg_queue, TCP_TIMER_MSG_QUEUE_SIZE);
 
     while (1) {
-        inc_global_variables();
-        check_sockets();
+        msg_receive(&m);
 
-        vtimer_set_wakeup(&tcp_vtimer, interval, thread_getpid());
-        thread_sleep();
+        if (m.type != MSG_TIMER) {
+            continue;
+        }
+
+        int s = m.content.value & 0xff;
+        uint8_t gen = (m.content.value >> 8) & TIMER_GEN_MASK;
+        socket_internal_t *current_socket = socket_base_get_socket(s);
+
+        if (!tcp_socket_compliancy(s)) {
+            continue;
+        }
+
+#ifdef MODULE_TCP_CC
+        if (m.content.value & TIMER_DELACK) {
+            if (current_socket->tcp_delack_gen == gen) {
+                tcp_cc_delack_expired(current_socket);
+            }
 
-        vtimer_remove(&tcp_vtimer);
+            continue;
+        }
+#endif
+
+        if (current_socket->tcp_timer_gen != gen) {
+            /* timer restarted or stopped since */
+            continue;
+        }
+
+        switch (current_socket->socket_values.tcp_control.state) {
+            case TCP_ESTABLISHED: {
+                handle_established(current_socket);
+                break;
+            }
+
+            case TCP_SYN_SENT: {
+                handle_synchro_timeout(current_socket);
+                break;
+            }
+
+            case TCP_SYN_RCVD: {
+                handle_synchro_timeout(current_socket);
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
     }
 }
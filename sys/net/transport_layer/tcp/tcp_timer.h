@@ -15,10 +15,20 @@
 #ifndef TCP_TIMER_H_
 #define TCP_TIMER_H_
 
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "socket.h"
+
 #define TCP_TIMER_RESOLUTION        500*1000
 
 #define SECOND                      1000.0f*1000.0f
+#ifdef MODULE_TCP_CC
+/* sends delayed ACKs */
+#define TCP_TIMER_STACKSIZE         KERNEL_CONF_STACKSIZE_MAIN
+#else
 #define TCP_TIMER_STACKSIZE         KERNEL_CONF_STACKSIZE_DEFAULT
+#endif
 #define TCP_SYN_INITIAL_TIMEOUT     6*SECOND
 #define TCP_SYN_TIMEOUT             24*SECOND
 #define TCP_MAX_SYN_RETRIES         3
@@ -33,6 +43,43 @@
 #define TCP_TIMEOUT                 2
 #define TCP_CONTINUE                3
 
+/*
+ * Expiries waiting for the timer thread, must be a power of two. vtimer drops
+ * the message of an expiry if the queue is full and a lost retransmission
+ * timeout stalls the connection, so there is room for the retransmission and
+ * the delayed ACK timer of every socket and for expiries of stopped timers.
+ */
+#ifndef TCP_TIMER_MSG_QUEUE_SIZE
+#define TCP_TIMER_MSG_QUEUE_SIZE    16
+#endif
+
+#if TCP_TIMER_MSG_QUEUE_SIZE < (2 * MAX_SOCKETS + 4)
+#error "TCP_TIMER_MSG_QUEUE_SIZE is too small for MAX_SOCKETS"
+#endif
+
+#if (TCP_TIMER_MSG_QUEUE_SIZE & (TCP_TIMER_MSG_QUEUE_SIZE - 1)) != 0
+#error "TCP_TIMER_MSG_QUEUE_SIZE must be a power of two"
+#endif
+
+extern kernel_pid_t tcp_timer_pid;
+
+/*
+ * Every socket has one timer, it runs while a SYN, a SYN-ACK or data is not
+ * acknowledged. On expiry the timer thread sends TCP_RETRY or TCP_TIMEOUT to
+ * the thread waiting on the socket. Nothing runs while no timer is set.
+ */
+void tcp_timer_set(socket_internal_t *current_socket, uint64_t timeout);
+void tcp_timer_stop(socket_internal_t *current_socket);
+/* stops every timer of the socket, before it is cleared */
+void tcp_timer_stop_all(socket_internal_t *current_socket);
+void tcp_timer_set_synchro(socket_internal_t *current_socket);
+#ifdef MODULE_TCP_CC
+void tcp_timer_set_delack(socket_internal_t *current_socket, uint64_t timeout);
+void tcp_timer_stop_delack(socket_internal_t *current_socket);
+#endif
+/* retransmission timeout with exponential backoff */
+uint64_t tcp_timer_rto(tcp_cb_t *tcp_control);
+
 void *tcp_general_timer(void *);
 
 #endif /* TCP_TIMER_H_ */
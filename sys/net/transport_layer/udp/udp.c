@@ -20,13 +20,17 @@
 #include <string.h>
 
 #include "ipv6.h"
+#include "irq.h"
 #include "msg.h"
+#include "pktbuf.h"
+#include "pktchain.h"
 #include "sixlowpan.h"
 #include "thread.h"
 
 #include "socket_base/in.h"
 
 #include "net_help.h"
+#include "net_stats.h"
 
 #include "msg_help.h"
 #include "socket.h"
@@ -50,52 +54,106 @@ uint16_t udp_csum(ipv6_hdr_t *ipv6_header, udp_hdr_t *udp_header)
 
 socket_internal_t *get_udp_socket(udp_hdr_t *udp_header)
 {
-    uint8_t i = 1;
+    int i = socket_base_index_first(SOCK_DGRAM, udp_header->dst_port, NULL, 0);
 
-    while (i < MAX_SOCKETS + 1) {
+    while (i != 0) {
         if (udp_socket_compliancy(i) &&
             (socket_base_get_socket(i)->socket_values.local_address.sin6_port ==
              udp_header->dst_port)) {
             return socket_base_get_socket(i);
         }
 
-        i++;
+        i = socket_base_index_next(i);
     }
 
     return NULL;
 }
 
+/**
+ * @brief   Queue a received datagram at a socket and wake up its reader
+ *
+ * @details The packet is moved into the packet buffer (unless a lower layer
+ *          already put it there) so the IPv6 buffer can be handed back
+ *          right away. The reader is only woken up if it sleeps waiting for
+ *          data, so a busy application never blocks the UDP handler and no
+ *          message ends up in the application's queue.
+ */
+static void udp_enqueue(socket_internal_t *udp_socket, ipv6_hdr_t *ipv6_header)
+{
+    uint16_t pkt_len = IPV6_HDR_LEN + NTOHS(ipv6_header->length);
+    uint8_t *pkt;
+    uint8_t waiting = 0;
+    int idx;
+
+    if (pktbuf_contains(ipv6_header)) {
+        pktbuf_hold(ipv6_header);
+        pkt = (uint8_t *) ipv6_header;
+    }
+    else if ((pkt = pktbuf_insert(ipv6_header, pkt_len)) == NULL) {
+        printf("Dropped UDP Message because packet buffer is full!\n");
+        NET_STATS_INC(NET_STATS_UDP, rx_dropped);
+        return;
+    }
+
+    unsigned state = disableIRQ();
+    idx = cib_put(&udp_socket->udp_recv_cib);
+
+    if (idx >= 0) {
+        udp_socket->udp_recv_queue[idx] = pkt;
+        waiting = udp_socket->udp_recv_waiting;
+        udp_socket->udp_recv_waiting = 0;
+    }
+
+    restoreIRQ(state);
+
+    if (idx < 0) {
+        pktbuf_release(pkt);
+        printf("Dropped UDP Message because receive queue is full!\n");
+        NET_STATS_INC(NET_STATS_UDP, rx_dropped);
+        return;
+    }
+
+    if (waiting) {
+        thread_wakeup(udp_socket->recv_pid);
+    }
+}
+
 void *udp_packet_handler(void *arg)
 {
     (void) arg;
 
-    msg_t m_recv_ip, m_send_ip, m_recv_udp, m_send_udp;
+    msg_t m_recv_ip, m_send_ip;
     socket_internal_t *udp_socket = NULL;
 
     msg_init_queue(udp_msg_queue, UDP_PKT_RECV_BUF_SIZE);
 
     while (1) {
         msg_receive(&m_recv_ip);
+        unsigned long start = net_stats_start();
         ipv6_hdr_t *ipv6_header = ((ipv6_hdr_t *)m_recv_ip.content.ptr);
         udp_hdr_t *udp_header = ((udp_hdr_t *)(m_recv_ip.content.ptr + IPV6_HDR_LEN));
 
+        NET_STATS_INC(NET_STATS_UDP, rx);
+
         uint16_t chksum = ipv6_csum(ipv6_header, (uint8_t*) udp_header, NTOHS(udp_header->length), IPPROTO_UDP);
 
         if (chksum == 0xffff) {
             udp_socket = get_udp_socket(udp_header);
 
             if (udp_socket != NULL) {
-                m_send_udp.content.ptr = (char *)ipv6_header;
-                msg_send_receive(&m_send_udp, &m_recv_udp, udp_socket->recv_pid);
+                udp_enqueue(udp_socket, ipv6_header);
             }
             else {
                 printf("Dropped UDP Message because no thread ID was found for delivery!\n");
+                NET_STATS_INC(NET_STATS_UDP, rx_dropped);
             }
         }
         else {
             printf("Wrong checksum (%x)!\n", chksum);
+            NET_STATS_INC(NET_STATS_UDP, csum_errors);
         }
 
+        net_stats_latency(NET_STATS_UDP, start);
         msg_reply(&m_recv_ip, &m_send_ip);
     }
 }
@@ -131,44 +189,84 @@ int udp_bind_socket(int s, sockaddr6_t *name, int namelen, uint8_t pid)
 
     memcpy(&socket_base_get_socket(s)->socket_values.local_address, name, namelen);
     socket_base_get_socket(s)->recv_pid = pid;
+    socket_base_index_add(s);
     return 0;
 }
 
-int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *from, uint32_t *fromlen)
+int32_t udp_recvfrom_pkt(int s, void **payload, int flags, sockaddr6_t *from, uint32_t *fromlen)
 {
     (void) flags;
 
-    msg_t m_recv, m_send;
+    socket_internal_t *udp_socket = socket_base_get_socket(s);
     ipv6_hdr_t *ipv6_header;
     udp_hdr_t *udp_header;
-    uint8_t *payload;
-    socket_base_get_socket(s)->recv_pid = thread_getpid();
-
-    msg_receive(&m_recv);
-
-    ipv6_header = ((ipv6_hdr_t *)m_recv.content.ptr);
-    udp_header = ((udp_hdr_t *)(m_recv.content.ptr + IPV6_HDR_LEN));
-    payload = (uint8_t *)(m_recv.content.ptr + IPV6_HDR_LEN + UDP_HDR_LEN);
-
-    memset(buf, 0, len);
-    /* cppcheck: the memset sets parts of the buffer to 0 even though it will
-     * be overwritten by the next memcpy. However without the memset the buffer
-     * could contain stale data (if the copied data is less then the buffer
-     * length) and setting just the left over part of the buffer to 0 would
-     * introduce overhead (calculation how much needs to be zeroed).
-     */
-    /* cppcheck-suppress redundantCopy */
-    memcpy(buf, payload, NTOHS(udp_header->length) - UDP_HDR_LEN);
+    uint8_t *pkt = NULL;
+
+    if (udp_socket == NULL) {
+        return -1;
+    }
+
+    udp_socket->recv_pid = thread_getpid();
+
+    while (pkt == NULL) {
+        unsigned state = disableIRQ();
+        int idx = cib_get(&udp_socket->udp_recv_cib);
+
+        if (idx >= 0) {
+            pkt = udp_socket->udp_recv_queue[idx];
+        }
+        else {
+            /* udp_enqueue wakes us up, other messages stay queued */
+            udp_socket->udp_recv_waiting = 1;
+            thread_sleep();
+        }
+
+        restoreIRQ(state);
+    }
+
+    ipv6_header = ((ipv6_hdr_t *) pkt);
+    udp_header = ((udp_hdr_t *)(pkt + IPV6_HDR_LEN));
+
     memcpy(&from->sin6_addr, &ipv6_header->srcaddr, 16);
     from->sin6_family = AF_INET6;
     from->sin6_flowinfo = 0;
     from->sin6_port = udp_header->src_port;
     *fromlen = sizeof(sockaddr6_t);
 
-    msg_reply(&m_recv, &m_send);
+    *payload = pkt + IPV6_HDR_LEN + UDP_HDR_LEN;
     return NTOHS(udp_header->length) - UDP_HDR_LEN;
 }
 
+int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *from, uint32_t *fromlen)
+{
+    void *payload;
+    int32_t payload_len = udp_recvfrom_pkt(s, &payload, flags, from, fromlen);
+
+    if (payload_len < 0) {
+        return payload_len;
+    }
+
+    if ((uint32_t) payload_len > len) {
+        payload_len = len;
+    }
+
+    memcpy(buf, payload, payload_len);
+    /* callers rely on the rest of the buffer being zeroed */
+    memset(((uint8_t *) buf) + payload_len, 0, len - payload_len);
+    pktbuf_release(payload);
+
+    return payload_len;
+}
+
+void udp_teardown(socket_internal_t *current_socket)
+{
+    int idx;
+
+    while ((idx = cib_get(&current_socket->udp_recv_cib)) >= 0) {
+        pktbuf_release(current_socket->udp_recv_queue[idx]);
+    }
+}
+
 int32_t udp_sendto(int s, const void *buf, uint32_t len, int flags,
                               sockaddr6_t *to, uint32_t tolen)
 {
@@ -176,32 +274,37 @@ int32_t udp_sendto(int s, const void *buf, uint32_t len, int flags,
     (void) tolen;
 
     if (udp_socket_compliancy(s) &&
-        (socket_base_get_socket(s)->socket_values.foreign_address.sin6_port == 0)) {
-        uint8_t send_buffer[BUFFER_SIZE];
+        (socket_base_get_socket(s)->socket_values.foreign_address.sin6_port == 0) &&
+        (len <= IPV6_MTU - IPV6_HDR_LEN - UDP_HDR_LEN)) {
+        ipv6_hdr_t temp_ipv6_header;
+        udp_hdr_t udp_header;
+        pktchain_t udp_node, payload_node;
+        pktchain_t *chain;
 
-        ipv6_hdr_t *temp_ipv6_header = ((ipv6_hdr_t *)(&send_buffer));
-        udp_hdr_t *current_udp_packet = ((udp_hdr_t *)(&send_buffer[IPV6_HDR_LEN]));
-        uint8_t *payload = &send_buffer[IPV6_HDR_LEN + UDP_HDR_LEN];
+        /* the payload is sent from the caller's buffer */
+        chain = pktchain_prepend(&payload_node, buf, len, NULL);
+        chain = pktchain_prepend(&udp_node, &udp_header, UDP_HDR_LEN, chain);
 
-        memcpy(&(temp_ipv6_header->destaddr), &to->sin6_addr, 16);
-        ipv6_net_if_get_best_src_addr(&(temp_ipv6_header->srcaddr), &(temp_ipv6_header->destaddr));
+        memcpy(&(temp_ipv6_header.destaddr), &to->sin6_addr, 16);
+        ipv6_net_if_get_best_src_addr(&(temp_ipv6_header.srcaddr), &(temp_ipv6_header.destaddr));
 
-        current_udp_packet->src_port = socket_base_get_free_source_port(IPPROTO_UDP);
-        current_udp_packet->dst_port = to->sin6_port;
-        current_udp_packet->checksum = 0;
+        udp_header.src_port = socket_base_get_free_source_port(IPPROTO_UDP);
+        udp_header.dst_port = to->sin6_port;
+        udp_header.length = HTONS(UDP_HDR_LEN + len);
+        udp_header.checksum = 0;
 
-        memcpy(payload, buf, len);
-        current_udp_packet->length = HTONS(UDP_HDR_LEN + len);
-        temp_ipv6_header->length = UDP_HDR_LEN + len;
+        udp_header.checksum = ~ipv6_csum_chain(&temp_ipv6_header, chain,
+                                               IPPROTO_UDP);
 
-        current_udp_packet->checksum = ~ipv6_csum(temp_ipv6_header,
-                                       (uint8_t *) current_udp_packet,
-                                       UDP_HDR_LEN + len,
-                                       IPPROTO_UDP);
+        NET_STATS_INC(NET_STATS_UDP, tx);
+
+        int32_t res = ipv6_sendto_chain(&to->sin6_addr, IPPROTO_UDP, chain);
+
+        if (res < 0) {
+            NET_STATS_INC(NET_STATS_UDP, tx_dropped);
+        }
 
-        return ipv6_sendto(&to->sin6_addr, IPPROTO_UDP,
-                           (uint8_t *)(current_udp_packet),
-                           NTOHS(current_udp_packet->length));
+        return res;
     }
     else {
         return -1;
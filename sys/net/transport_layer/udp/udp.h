@@ -26,6 +26,7 @@
 
 int udp_bind_socket(int s, sockaddr6_t *name, int namelen, uint8_t pid);
 int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *from, uint32_t *fromlen);
+int32_t udp_recvfrom_pkt(int s, void **payload, int flags, sockaddr6_t *from, uint32_t *fromlen);
 int32_t udp_sendto(int s, const void *buf, uint32_t len, int flags, sockaddr6_t *to, uint32_t tolen);
 bool udp_socket_compliancy(int s);
 int32_t udp_recvfrom(int s, void *buf, uint32_t len, int flags, sockaddr6_t *from, uint32_t *fromlen);
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup shell_commands
+ * @{
+ * @file    sc_net_stats.c
+ * @brief   provides a shell command to show the network statistics
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "net_stats.h"
+
+#ifdef MODULE_SIXLOWPAN
+#include "sixlowpan/ip.h"
+#endif
+
+static const char *layer_names[NET_STATS_LAYER_NUMOF] = {
+    "6lowpan", "ipv6", "udp", "tcp"
+};
+
+static void print_histogram(net_stats_t *stats)
+{
+    for (unsigned i = 0; i < NET_STATS_HIST_BUCKETS; i++) {
+        if (stats->latency_hist[i] == 0) {
+            continue;
+        }
+
+        if (i == (NET_STATS_HIST_BUCKETS - 1)) {
+            printf("    >= %6lu us: %" PRIu32 "\n", 1UL << i, stats->latency_hist[i]);
+        }
+        else {
+            printf("    <  %6lu us: %" PRIu32 "\n", 2UL << i, stats->latency_hist[i]);
+        }
+    }
+}
+
+void _net_stats_handler(int argc, char **argv)
+{
+    if ((argc > 1) && (strcmp(argv[1], "reset") == 0)) {
+        net_stats_reset();
+        return;
+    }
+    else if (argc > 1) {
+        printf("usage: %s [reset]\n", argv[0]);
+        return;
+    }
+
+    printf("%-8s %10s %10s %8s %8s %6s %8s\n", "layer", "rx", "tx", "rx_drop",
+           "tx_drop", "csum", "max_us");
+
+    for (unsigned i = 0; i < NET_STATS_LAYER_NUMOF; i++) {
+        net_stats_t *stats = &net_stats[i];
+
+        printf("%-8s %10" PRIu32 " %10" PRIu32 " %8" PRIu32 " %8" PRIu32
+               " %6" PRIu32 " %8" PRIu32 "\n", layer_names[i], stats->rx,
+               stats->tx, stats->rx_dropped, stats->tx_dropped,
+               stats->csum_errors, stats->latency_max);
+    }
+
+    for (unsigned i = 0; i < NET_STATS_LAYER_NUMOF; i++) {
+        if (net_stats[i].rx) {
+            printf("%s receive latency:\n", layer_names[i]);
+            print_histogram(&net_stats[i]);
+        }
+    }
+
+#ifdef MODULE_SIXLOWPAN
+    ipv6_fwd_stats_t fwd;
+    ipv6_get_fwd_stats(&fwd);
+
+    printf("forwarded %" PRIu32 " (%" PRIu32 "/s), dropped: no route %" PRIu32
+           ", hop limit %" PRIu32 ", no buffer %" PRIu32 ", send failed %"
+           PRIu32 "\n", fwd.forwarded, ipv6_get_fwd_rate(), fwd.no_route,
+           fwd.hop_limit_exceeded, fwd.no_buffer, fwd.send_failed);
+#endif
+}
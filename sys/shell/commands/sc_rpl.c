@@ -40,6 +40,9 @@ void _rpl_route_handler(int argc, char **argv)
             c++;
             printf(" %03d: %-18s  ", i, ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
                                             (&rtable[i].address)));
+            if (rtable[i].prefix_len < 128) {
+                printf("/%u ", rtable[i].prefix_len);
+            }
             printf("%-18s  ", ipv6_addr_to_str(addr_str, IPV6_MAX_ADDR_STR_LEN,
                                             (&rtable[i].next_hop)));
             printf("%d\n", rtable[i].lifetime);
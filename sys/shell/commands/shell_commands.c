@@ -108,6 +108,10 @@ extern void _transceiver_set_ignore_handler(int argc, char **argv);
 extern void _net_if_ifconfig(int argc, char **argv);
 #endif
 
+#ifdef MODULE_NET_STATS
+extern void _net_stats_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_RPL
 extern void _rpl_route_handler(int argc, char **argv);
 #endif
@@ -180,6 +184,9 @@ const shell_command_t _shell_command_list[] = {
 #ifdef MODULE_NET_IF
     {"ifconfig", "Configures a network interface", _net_if_ifconfig},
 #endif
+#ifdef MODULE_NET_STATS
+    {"netstat", "Shows or resets the network statistics", _net_stats_handler},
+#endif
 #ifdef MODULE_RPL
     {"route", "Shows the routing table", _rpl_route_handler},
 #endif
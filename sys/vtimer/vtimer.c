@@ -22,7 +22,6 @@
 #include <inttypes.h>
 
 #include "irq.h"
-#include "priority_queue.h"
 #include "timex.h"
 #include "hwtimer.h"
 #include "msg.h"
@@ -50,8 +49,58 @@ static int vtimer_set(vtimer_t *timer);
 static int set_longterm(vtimer_t *timer);
 static int set_shortterm(vtimer_t *timer);
 
-static priority_queue_t longterm_priority_queue_root = PRIORITY_QUEUE_INIT;
-static priority_queue_t shortterm_priority_queue_root = PRIORITY_QUEUE_INIT;
+#ifdef MODULE_VTIMER_HEAP
+typedef pairing_heap_t vtimer_queue_t;
+typedef pairing_heap_node_t vtimer_queue_node_t;
+#define VTIMER_QUEUE_INIT PAIRING_HEAP_INIT
+
+static inline vtimer_queue_node_t *queue_first(vtimer_queue_t *root)
+{
+    return pairing_heap_peek(root);
+}
+
+static inline void queue_add(vtimer_queue_t *root, vtimer_queue_node_t *node)
+{
+    pairing_heap_add(root, node);
+}
+
+static inline vtimer_queue_node_t *queue_remove_head(vtimer_queue_t *root)
+{
+    return pairing_heap_remove_head(root);
+}
+
+static inline void queue_remove(vtimer_queue_t *root, vtimer_queue_node_t *node)
+{
+    pairing_heap_remove(root, node);
+}
+#else
+typedef priority_queue_t vtimer_queue_t;
+typedef priority_queue_node_t vtimer_queue_node_t;
+#define VTIMER_QUEUE_INIT PRIORITY_QUEUE_INIT
+
+static inline vtimer_queue_node_t *queue_first(vtimer_queue_t *root)
+{
+    return root->first;
+}
+
+static inline void queue_add(vtimer_queue_t *root, vtimer_queue_node_t *node)
+{
+    priority_queue_add(root, node);
+}
+
+static inline vtimer_queue_node_t *queue_remove_head(vtimer_queue_t *root)
+{
+    return priority_queue_remove_head(root);
+}
+
+static inline void queue_remove(vtimer_queue_t *root, vtimer_queue_node_t *node)
+{
+    priority_queue_remove(root, node);
+}
+#endif
+
+static vtimer_queue_t longterm_priority_queue_root = VTIMER_QUEUE_INIT;
+static vtimer_queue_t shortterm_priority_queue_root = VTIMER_QUEUE_INIT;
 
 static vtimer_t longterm_tick_timer;
 static uint32_t longterm_tick_start;
@@ -62,7 +111,7 @@ static uint32_t hwtimer_next_absolute;
 
 static uint32_t seconds = 0;
 
-static inline priority_queue_node_t *timer_get_node(vtimer_t *timer)
+static inline vtimer_queue_node_t *timer_get_node(vtimer_t *timer)
 {
     if (!timer) {
         return NULL;
@@ -70,7 +119,7 @@ static inline priority_queue_node_t *timer_get_node(vtimer_t *timer)
     return &timer->priority_queue_entry;
 }
 
-static inline vtimer_t *node_get_timer(priority_queue_node_t *node)
+static inline vtimer_t *node_get_timer(vtimer_queue_node_t *node)
 {
     if (!node) {
         return NULL;
@@ -81,20 +130,22 @@ static inline vtimer_t *node_get_timer(priority_queue_node_t *node)
 static int set_longterm(vtimer_t *timer)
 {
     timer->priority_queue_entry.priority = timer->absolute.seconds;
-    priority_queue_add(&longterm_priority_queue_root, timer_get_node(timer));
+    queue_add(&longterm_priority_queue_root, timer_get_node(timer));
     return 0;
 }
 
 static int update_shortterm(void)
 {
-    if (shortterm_priority_queue_root.first == NULL) {
+    vtimer_queue_node_t *first = queue_first(&shortterm_priority_queue_root);
+
+    if (first == NULL) {
         /* there is no vtimer to schedule, queue is empty */
         DEBUG("update_shortterm: shortterm_priority_queue_root.next == NULL - dont know what to do here\n");
         return 0;
     }
     if (hwtimer_id != -1) {
         /* there is a running hwtimer for us */
-        if (hwtimer_next_absolute != shortterm_priority_queue_root.first->priority) {
+        if (hwtimer_next_absolute != first->priority) {
             /* the next timer in the vtimer queue is not the next hwtimer */
             /* we have to remove the running hwtimer (and schedule a new one) */
             hwtimer_remove(hwtimer_id);
@@ -106,7 +157,7 @@ static int update_shortterm(void)
     }
 
     /* short term part of the next vtimer */
-    hwtimer_next_absolute = shortterm_priority_queue_root.first->priority;
+    hwtimer_next_absolute = first->priority;
 
     uint32_t next = hwtimer_next_absolute;
 
@@ -114,7 +165,7 @@ static int update_shortterm(void)
     uint32_t now = HWTIMER_TICKS_TO_US(hwtimer_now());
 
     /* make sure the longterm_tick_timer does not get truncated */
-    if (node_get_timer(shortterm_priority_queue_root.first)->action != vtimer_callback_tick) {
+    if (node_get_timer(first)->action != vtimer_callback_tick) {
         /* the next vtimer to schedule is the long term tick */
         /* it has a shortterm offset of longterm_tick_start */
         next += longterm_tick_start;
@@ -142,11 +193,11 @@ void vtimer_callback_tick(vtimer_t *timer)
     longterm_tick_timer.absolute.microseconds += MICROSECONDS_PER_TICK;
     set_shortterm(&longterm_tick_timer);
 
-    while (longterm_priority_queue_root.first) {
-        vtimer_t *timer = node_get_timer(longterm_priority_queue_root.first);
+    while (queue_first(&longterm_priority_queue_root)) {
+        vtimer_t *timer = node_get_timer(queue_first(&longterm_priority_queue_root));
 
         if (timer->absolute.seconds == seconds) {
-            priority_queue_remove_head(&longterm_priority_queue_root);
+            queue_remove_head(&longterm_priority_queue_root);
             set_shortterm(timer);
         }
         else {
@@ -178,7 +229,7 @@ static int set_shortterm(vtimer_t *timer)
 {
     DEBUG("set_shortterm(): Absolute: %" PRIu32 " %" PRIu32 "\n", timer->absolute.seconds, timer->absolute.microseconds);
     timer->priority_queue_entry.priority = timer->absolute.microseconds;
-    priority_queue_add(&shortterm_priority_queue_root, timer_get_node(timer));
+    queue_add(&shortterm_priority_queue_root, timer_get_node(timer));
     return 1;
 }
 
@@ -191,7 +242,7 @@ void vtimer_callback(void *ptr)
     hwtimer_id = -1;
 
     /* get the vtimer that fired */
-    vtimer_t *timer = node_get_timer(priority_queue_remove_head(&shortterm_priority_queue_root));
+    vtimer_t *timer = node_get_timer(queue_remove_head(&shortterm_priority_queue_root));
 
     if (timer) {
 #if ENABLE_DEBUG
@@ -374,8 +425,8 @@ int vtimer_remove(vtimer_t *t)
 {
     unsigned irq_state = disableIRQ();
 
-    priority_queue_remove(&shortterm_priority_queue_root, timer_get_node(t));
-    priority_queue_remove(&longterm_priority_queue_root, timer_get_node(t));
+    queue_remove(&shortterm_priority_queue_root, timer_get_node(t));
+    queue_remove(&longterm_priority_queue_root, timer_get_node(t));
     update_shortterm();
 
     restoreIRQ(irq_state);
@@ -413,6 +464,7 @@ int vtimer_msg_receive_timeout(msg_t *m, timex_t timeout) {
 
 #if ENABLE_DEBUG
 
+#ifndef MODULE_VTIMER_HEAP
 void vtimer_print_short_queue(){
     priority_queue_print(&shortterm_priority_queue_root);
 }
@@ -420,6 +472,7 @@ void vtimer_print_short_queue(){
 void vtimer_print_long_queue(){
     priority_queue_print(&longterm_priority_queue_root);
 }
+#endif
 
 void vtimer_print(vtimer_t *t)
 {
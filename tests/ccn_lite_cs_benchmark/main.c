@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the interest throughput of a CCN-lite relay for
+ *              different content store sizes
+ *
+ * A local client asks for chunks of a popular content, small chunk numbers
+ * are asked for more often. Interests that are not answered from the
+ * content store are forwarded and answered by a producer behind the
+ * transceiver face, so every interest is satisfied. The packets are fed
+ * into the relay directly, nothing is sent.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "hwtimer.h"
+
+#include "ccnl-includes.h"
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-pdu.h"
+#include "ccnl-riot-compat.h"
+
+#define CHUNKS          (256)
+#define INTERESTS       (5000)
+#define CHUNK_SIZE      (64)
+
+#define CLIENT_ID       (1)
+#define PRODUCER_ID     (2)
+
+static struct ccnl_relay_s relay;
+static unsigned char pkt[CHUNK_SIZE + 100];
+static char chunk[CHUNK_SIZE];
+static unsigned int nonce;
+static uint32_t rand_state = 1;
+static unsigned forwarded;
+
+static int count_tx(uint8_t *buf, uint16_t size, uint16_t to)
+{
+    (void) size;
+    (void) to;
+
+    if (buf[0] == 0x01 && buf[1] == 0xd2) {
+        forwarded++;
+    }
+
+    return 0;
+}
+
+static unsigned next_chunk(void)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    unsigned a = (rand_state >> 16) % CHUNKS;
+    rand_state = rand_state * 1103515245 + 12345;
+    unsigned b = (rand_state >> 16) % CHUNKS;
+
+    /* skewed towards the first chunks */
+    return (a * b) / CHUNKS;
+}
+
+static void request(unsigned n)
+{
+    char seq[8];
+    char *name[] = { "riot", "bench", seq, NULL };
+    unsigned before = forwarded;
+
+    snprintf(seq, sizeof(seq), "%u", n);
+
+    nonce++;
+    int len = mkInterest(name, &nonce, pkt);
+    ccnl_core_RX(&relay, RIOT_MSG_IDX, pkt, len, CLIENT_ID);
+
+    if (forwarded != before) {
+        /* not in the content store, the producer answers */
+        len = mkContent(name, chunk, sizeof(chunk), pkt);
+        ccnl_core_RX(&relay, RIOT_TRANS_IDX, pkt, len, PRODUCER_ID);
+    }
+}
+
+static void run(int max_cache_bytes)
+{
+    while (relay.contents) {
+        ccnl_content_remove(&relay, relay.contents);
+    }
+
+    relay.max_cache_bytes = max_cache_bytes;
+
+    /* warm up the content store */
+    for (unsigned i = 0; i < INTERESTS; i++) {
+        request(next_chunk());
+    }
+
+    forwarded = 0;
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < INTERESTS; i++) {
+        request(next_chunk());
+    }
+
+    uint32_t us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+
+    printf("cache_bytes=%d contents=%d used_bytes=%d interests=%u hits=%u "
+           "us=%" PRIu32 " interests_per_sec=%" PRIu32 "\n",
+           max_cache_bytes, relay.contentcnt, relay.contentbytes, INTERESTS,
+           INTERESTS - forwarded, us,
+           (uint32_t)((INTERESTS * 1000000ULL) / (us ? us : 1)));
+}
+
+int main(void)
+{
+    printf("CCN-lite content store benchmark: %u chunks of %u bytes\n",
+           CHUNKS, CHUNK_SIZE);
+
+    memset(chunk, 'x', sizeof(chunk));
+
+    relay.ifs[RIOT_MSG_IDX].sendfunc = count_tx;
+    relay.ifs[RIOT_TRANS_IDX].sendfunc = count_tx;
+    relay.ifcount = 2;
+
+    struct ccnl_face_s *f = ccnl_get_face_or_create(&relay, RIOT_TRANS_IDX,
+                                                    RIOT_BROADCAST);
+    f->flags |= CCNL_FACE_FLAGS_STATIC;
+    relay.ifs[RIOT_TRANS_IDX].broadcast_face = f;
+
+    run(0);
+    run(4 * 1024);
+    run(16 * 1024);
+    run(64 * 1024);
+    run(-1);
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures how fast a CCN-lite relay drops a flood of
+ *              duplicate interests
+ *
+ * Every interest of a client comes back several times over other faces, as
+ * it happens with broadcast loops. The copies carry the same nonce and have
+ * to be dropped. A producer answers the interest after the flood. The
+ * packets are fed into the relay directly, nothing is sent.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "hwtimer.h"
+
+#include "ccnl-includes.h"
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-pdu.h"
+#include "ccnl-riot-compat.h"
+
+#define INTERESTS       (2000)
+#define NAMES           (64)
+#define CHUNK_SIZE      (32)
+#define LOOKUPS         (100000)
+
+#define CLIENT_ID       (1)
+#define PRODUCER_ID     (2)
+#define FIRST_PEER_ID   (3)
+
+static struct ccnl_relay_s relay;
+static unsigned char ipkt[CHUNK_SIZE + 100];
+static unsigned char cpkt[CHUNK_SIZE + 100];
+static char chunk[CHUNK_SIZE];
+static unsigned int nonce;
+static unsigned forwarded;
+
+static int count_tx(uint8_t *buf, uint16_t size, uint16_t to)
+{
+    (void) size;
+    (void) to;
+
+    if (buf[0] == 0x01 && buf[1] == 0xd2) {
+        forwarded++;
+    }
+
+    return 0;
+}
+
+static void flood(unsigned copies)
+{
+    char seq[8];
+    char *name[] = { "riot", "flood", seq, NULL };
+    unsigned long start;
+    uint32_t us;
+
+    forwarded = 0;
+    start = hwtimer_now();
+
+    for (unsigned i = 0; i < INTERESTS; i++) {
+        snprintf(seq, sizeof(seq), "%u", i % NAMES);
+
+        nonce++;
+        int len = mkInterest(name, &nonce, ipkt);
+        ccnl_core_RX(&relay, RIOT_MSG_IDX, ipkt, len, CLIENT_ID);
+
+        for (unsigned k = 0; k < copies; k++) {
+            ccnl_core_RX(&relay, RIOT_TRANS_IDX, ipkt, len, FIRST_PEER_ID + k);
+        }
+
+        len = mkContent(name, chunk, sizeof(chunk), cpkt);
+        ccnl_core_RX(&relay, RIOT_TRANS_IDX, cpkt, len, PRODUCER_ID);
+    }
+
+    us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+
+    printf("copies=%u interests=%u forwarded=%u dropped=%u us=%" PRIu32
+           " interests_per_sec=%" PRIu32 "\n", copies, INTERESTS * (copies + 1),
+           forwarded, INTERESTS * (copies + 1) - forwarded, us,
+           (uint32_t)((INTERESTS * (copies + 1) * 1000000ULL) / (us ? us : 1)));
+}
+
+static void lookups(void)
+{
+    static union {
+        struct ccnl_buf_s buf;
+        unsigned char mem[sizeof(struct ccnl_buf_s) + sizeof(uint32_t)];
+    } n;
+    unsigned dups = 0;
+    unsigned long start;
+    uint32_t us;
+
+    ccnl_nonce_flush(&relay);
+    n.buf.datalen = sizeof(uint32_t);
+    start = hwtimer_now();
+
+    for (uint32_t i = 0; i < LOOKUPS; i++) {
+        /* every nonce shows up twice, the second time while still known */
+        uint32_t v = (i >> 1) * 2654435761u;
+        memcpy(n.buf.data, &v, sizeof(v));
+
+        if (ccnl_nonce_find_or_append(&relay, &n.buf)) {
+            dups++;
+        }
+    }
+
+    us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+
+    printf("nonce table: lookups=%u dups=%u us=%" PRIu32
+           " lookups_per_sec=%" PRIu32 "\n", LOOKUPS, dups, us,
+           (uint32_t)((LOOKUPS * 1000000ULL) / (us ? us : 1)));
+}
+
+int main(void)
+{
+    printf("CCN-lite duplicate interest benchmark: %u nonces kept\n",
+           CCNL_MAX_NONCES);
+
+    memset(chunk, 'x', sizeof(chunk));
+
+    relay.ifs[RIOT_MSG_IDX].sendfunc = count_tx;
+    relay.ifs[RIOT_TRANS_IDX].sendfunc = count_tx;
+    relay.ifcount = 2;
+
+    struct ccnl_face_s *f = ccnl_get_face_or_create(&relay, RIOT_TRANS_IDX,
+                                                    RIOT_BROADCAST);
+    f->flags |= CCNL_FACE_FLAGS_STATIC;
+    relay.ifs[RIOT_TRANS_IDX].broadcast_face = f;
+
+    flood(0);
+    flood(1);
+    flood(4);
+    flood(16);
+
+    lookups();
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compares the throughput of csum() with the previous 16 bit
+ *              per iteration implementation and of an incremental update
+ *              with recomputing the checksum
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "hwtimer.h"
+#include "net_help.h"
+
+#define ROUNDS      (1000)
+#define MAX_LEN     (1280)
+
+static uint32_t buf_storage[(MAX_LEN + 4) / 4];
+
+static const uint16_t lens[] = { 8, 40, 127, 1280 };
+
+/* the implementation csum() replaced */
+static uint16_t csum_16bit(uint16_t sum, uint8_t *buf, uint16_t len)
+{
+    int count = len >> 1;
+
+    if (count) {
+        uint16_t carry = 0;
+
+        do {
+            uint16_t t = (*buf << 8) + *(buf + 1);
+            count--;
+            buf += 2;
+            sum += carry;
+            sum += t;
+            carry = (t > sum);
+        } while (count);
+
+        sum += carry;
+    }
+
+    if (len & 1) {
+        uint16_t u = (*buf << 8);
+        sum += (*buf << 8);
+
+        if (sum < u) {
+            sum++;
+        }
+    }
+
+    return sum;
+}
+
+/* returns KiB/s */
+static uint32_t run(uint16_t (*fn)(uint16_t, uint8_t *, uint16_t), uint8_t *buf,
+                    uint16_t len, uint16_t *result)
+{
+    volatile uint16_t sum = 0;
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        sum = fn(0, buf, len);
+    }
+
+    uint32_t us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+    *result = sum;
+
+    if (us == 0) {
+        us = 1;
+    }
+
+    return (uint32_t)(((uint64_t) len * ROUNDS * 1000000) / 1024 / us);
+}
+
+/* cost of updating a checksum after a 16 bit field changed */
+static void bench_incremental(uint8_t *buf, uint16_t len)
+{
+    volatile uint16_t check = ~csum(0, buf, len);
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        check = csum_replace16(check, i, i + 1);
+    }
+
+    uint32_t replace_us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+
+    start = hwtimer_now();
+
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        check = ~csum(0, buf, len);
+    }
+
+    uint32_t full_us = HWTIMER_TICKS_TO_US(hwtimer_now() - start);
+
+    printf("update len=%u replace16_ns=%" PRIu32 " recompute_ns=%" PRIu32 "\n",
+           len, (replace_us * 1000) / ROUNDS, (full_us * 1000) / ROUNDS);
+}
+
+int main(void)
+{
+    uint8_t *buf = (uint8_t *) buf_storage;
+
+    puts("checksum benchmark");
+
+    for (unsigned i = 0; i < sizeof(buf_storage); i++) {
+        buf[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    for (unsigned i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        for (unsigned off = 0; off < 2; off++) {
+            uint16_t old_sum, new_sum;
+            uint32_t old_rate = run(csum_16bit, buf + off, lens[i], &old_sum);
+            uint32_t new_rate = run(csum, buf + off, lens[i], &new_sum);
+
+            printf("len=%u offset=%u old_kib_s=%" PRIu32 " new_kib_s=%" PRIu32 "%s\n",
+                   lens[i], off, old_rate, new_rate,
+                   (old_sum == new_sum) ? "" : " MISMATCH");
+        }
+    }
+
+    bench_incremental(buf, 40);
+    bench_incremental(buf, MAX_LEN);
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,417 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the cost of the IPC and scheduling primitives
+ *
+ * Every measurement runs ITERATIONS operations between two hwtimer reads
+ * and prints one CSV line, lines starting with '#' are comments:
+ *
+ *     name,threads,priority,iterations,total_us,ns_per_op,cycles_per_op
+ *
+ * *threads* is the number of threads taking part, *priority* the priority
+ * of the partner thread relative to main (higher, same, lower or - if there
+ * is none). cycles_per_op is derived from F_CPU and 0 on boards that do not
+ * define it. The numbers include the loop overhead, which is measured as
+ * `loop` to be subtracted.
+ *
+ * The `_many` variants move QUEUE_SIZE messages per call of
+ * msg_send_many() and msg_receive_many() and report the cost per message.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "hwtimer.h"
+#include "irq.h"
+#include "kernel.h"
+#include "msg.h"
+#include "mutex.h"
+#include "sched.h"
+#include "thread.h"
+
+#ifndef ITERATIONS
+#define ITERATIONS      (10000)
+#endif
+
+#define QUEUE_SIZE      (16)
+#define MAX_YIELDERS    (8)
+#define STACKSIZE       (KERNEL_CONF_STACKSIZE_DEFAULT)
+
+/* message types understood by the servers */
+#define BENCH_ECHO      (1)     /* reply with the same message */
+#define BENCH_SINK      (2)     /* just receive */
+#define BENCH_MUTEX     (3)     /* lock and unlock the benchmark mutex */
+
+typedef struct {
+    const char *name;           /* priority relative to main */
+    char priority;              /* offset to PRIORITY_MAIN */
+    msg_t *queue;               /* message queue of the server or NULL */
+    char batched;               /* server uses msg_receive_many() */
+    kernel_pid_t pid;
+    char stack[STACKSIZE];
+} server_t;
+
+static msg_t server_queue[QUEUE_SIZE];
+static msg_t batched_queue[QUEUE_SIZE];
+static msg_t main_queue[QUEUE_SIZE];
+
+/* messages of a msg_receive_many() call in the batched server and of the
+ * _many benchmarks in main */
+static msg_t server_batch[QUEUE_SIZE];
+static msg_t main_batch[QUEUE_SIZE];
+
+static server_t servers[] = {
+    { "higher", -1, NULL, 0, KERNEL_PID_UNDEF, { 0 } },
+    { "same",    0, NULL, 0, KERNEL_PID_UNDEF, { 0 } },
+    { "lower",   1, NULL, 0, KERNEL_PID_UNDEF, { 0 } },
+    { "lower",   1, server_queue, 0, KERNEL_PID_UNDEF, { 0 } },
+    { "lower",   1, batched_queue, 1, KERNEL_PID_UNDEF, { 0 } },
+};
+
+#define SERVER_HIGHER   (&servers[0])
+#define SERVER_SAME     (&servers[1])
+#define SERVER_LOWER    (&servers[2])
+#define SERVER_QUEUED   (&servers[3])
+#define SERVER_BATCHED  (&servers[4])
+
+static char yield_stacks[MAX_YIELDERS][STACKSIZE];
+static volatile int yield_stop;
+
+static mutex_t shared_mutex = MUTEX_INIT;
+
+static void report(const char *name, unsigned threads, const char *priority,
+                   unsigned long iterations, unsigned long ticks)
+{
+    uint64_t us = HWTIMER_TICKS_TO_US((uint64_t) ticks);
+    uint32_t ns = (uint32_t)((us * 1000) / iterations);
+#ifdef F_CPU
+    uint32_t cycles = (uint32_t)((us * (F_CPU / 1000000)) / iterations);
+#else
+    uint32_t cycles = 0;
+#endif
+
+    printf("%s,%u,%s,%lu,%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n", name,
+           threads, priority, iterations, (uint32_t) us, ns, cycles);
+}
+
+static void *server(void *arg)
+{
+    server_t *self = arg;
+
+    if (self->queue) {
+        msg_init_queue(self->queue, QUEUE_SIZE);
+    }
+
+    while (1) {
+        msg_t single, *m = &single;
+        int n = 1;
+
+        if (self->batched) {
+            m = server_batch;
+            n = msg_receive_many(m, QUEUE_SIZE);
+        }
+        else {
+            msg_receive(m);
+        }
+
+        for (int i = 0; i < n; i++) {
+            switch (m[i].type) {
+                case BENCH_ECHO:
+                    msg_reply(&m[i], &m[i]);
+                    break;
+
+                case BENCH_MUTEX:
+                    mutex_lock(&shared_mutex);
+                    mutex_unlock(&shared_mutex);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void *yielder(void *arg)
+{
+    (void) arg;
+
+    while (!yield_stop) {
+        thread_yield();
+    }
+
+    return NULL;
+}
+
+static void bench_loop(void)
+{
+    unsigned long start = hwtimer_now();
+
+    for (volatile unsigned i = 0; i < ITERATIONS; i++) {
+    }
+
+    report("loop", 1, "-", ITERATIONS, hwtimer_now() - start);
+}
+
+/* receiver blocked in msg_receive, the message is copied directly */
+static void bench_send_receive(server_t *s)
+{
+    msg_t m;
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        m.type = BENCH_ECHO;
+        msg_send_receive(&m, &m, s->pid);
+    }
+
+    report("msg_send_receive", 2, s->name, ITERATIONS, hwtimer_now() - start);
+}
+
+/* msg_send to a receiver blocked in msg_receive */
+static void bench_send_direct(server_t *s)
+{
+    msg_t m;
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        m.type = BENCH_SINK;
+        msg_send(&m, s->pid);
+    }
+
+    report("msg_send", 2, s->name, ITERATIONS, hwtimer_now() - start);
+}
+
+/* sender of higher priority fills the queue of the receiver, which empties
+ * it while main waits for the echo. *cycle* covers sending, receiving and
+ * the echo. */
+static void bench_send_queued(server_t *s)
+{
+    msg_t m;
+    unsigned long ticks = 0, cycle_ticks = 0, sent = 0;
+
+    while (sent < ITERATIONS) {
+        unsigned long start = hwtimer_now();
+
+        /* the first message of a batch is delivered directly */
+        if (s->batched) {
+            for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+                main_batch[i].type = BENCH_SINK;
+            }
+
+            msg_send_many(main_batch, QUEUE_SIZE, s->pid);
+        }
+        else {
+            for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+                m.type = BENCH_SINK;
+                msg_send(&m, s->pid);
+            }
+        }
+
+        unsigned long sent_at = hwtimer_now();
+        ticks += sent_at - start;
+        sent += QUEUE_SIZE;
+
+        m.type = BENCH_ECHO;
+        msg_send_receive(&m, &m, s->pid);
+        cycle_ticks += hwtimer_now() - start;
+    }
+
+    if (s->batched) {
+        report("msg_send_many", 2, s->name, sent, ticks);
+        report("msg_queue_cycle_many", 2, s->name, sent, cycle_ticks);
+    }
+    else {
+        report("msg_send_queued", 2, s->name, sent, ticks);
+        report("msg_queue_cycle", 2, s->name, sent, cycle_ticks);
+    }
+}
+
+/* cib enqueue and dequeue without a context switch */
+static void bench_queue_self(void)
+{
+    msg_t m;
+    unsigned long send_ticks = 0, recv_ticks = 0, n = 0;
+
+    while (n < ITERATIONS) {
+        unsigned long start = hwtimer_now();
+
+        for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+            msg_send_to_self(&m);
+        }
+
+        send_ticks += hwtimer_now() - start;
+        start = hwtimer_now();
+
+        for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+            msg_receive(&m);
+        }
+
+        recv_ticks += hwtimer_now() - start;
+        n += QUEUE_SIZE;
+    }
+
+    report("msg_send_to_self", 1, "-", n, send_ticks);
+    report("msg_receive_queued", 1, "-", n, recv_ticks);
+}
+
+/* same as bench_queue_self() with one call per QUEUE_SIZE messages */
+static void bench_queue_self_many(void)
+{
+    kernel_pid_t me = thread_getpid();
+    unsigned long send_ticks = 0, recv_ticks = 0, n = 0;
+
+    while (n < ITERATIONS) {
+        unsigned long start = hwtimer_now();
+
+        msg_send_many(main_batch, QUEUE_SIZE, me);
+
+        send_ticks += hwtimer_now() - start;
+        start = hwtimer_now();
+
+        msg_receive_many(main_batch, QUEUE_SIZE);
+
+        recv_ticks += hwtimer_now() - start;
+        n += QUEUE_SIZE;
+    }
+
+    report("msg_send_many_self", 1, "-", n, send_ticks);
+    report("msg_receive_many_queued", 1, "-", n, recv_ticks);
+}
+
+static void bench_mutex(void)
+{
+    msg_t m;
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        mutex_lock(&shared_mutex);
+        mutex_unlock(&shared_mutex);
+    }
+
+    report("mutex_lock_unlock", 1, "-", ITERATIONS, hwtimer_now() - start);
+
+    /* the server blocks on the mutex held by main and gets it on unlock */
+    start = hwtimer_now();
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        mutex_lock(&shared_mutex);
+        m.type = BENCH_MUTEX;
+        msg_send(&m, SERVER_HIGHER->pid);
+        mutex_unlock(&shared_mutex);
+    }
+
+    report("mutex_contended", 2, SERVER_HIGHER->name, ITERATIONS,
+           hwtimer_now() - start);
+}
+
+static void bench_yield(unsigned yielders)
+{
+    kernel_pid_t pids[MAX_YIELDERS];
+
+    yield_stop = 0;
+
+    for (unsigned i = 0; i < yielders; i++) {
+        pids[i] = thread_create(yield_stacks[i], STACKSIZE, PRIORITY_MAIN,
+                                CREATE_WOUT_YIELD | CREATE_STACKTEST, yielder,
+                                NULL, "yielder");
+    }
+
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        thread_yield();
+    }
+
+    /* every yield of main passes through all yielders */
+    report("thread_yield", yielders + 1, yielders ? "same" : "-",
+           ITERATIONS * (yielders + 1), hwtimer_now() - start);
+
+    yield_stop = 1;
+
+    for (unsigned i = 0; i < yielders; i++) {
+        while (thread_getstatus(pids[i]) != STATUS_NOT_FOUND) {
+            thread_yield();
+        }
+    }
+}
+
+/* main is the only runnable thread of the highest priority, so sched_run()
+ * decides to keep it */
+static void bench_sched_run(void)
+{
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        unsigned state = disableIRQ();
+        sched_run();
+        restoreIRQ(state);
+    }
+
+    report("sched_run", sizeof(servers) / sizeof(servers[0]) + 1, "-",
+           ITERATIONS, hwtimer_now() - start);
+}
+
+int main(void)
+{
+    msg_init_queue(main_queue, QUEUE_SIZE);
+
+    for (unsigned i = 0; i < sizeof(servers) / sizeof(servers[0]); i++) {
+        servers[i].pid = thread_create(servers[i].stack, STACKSIZE,
+                                       PRIORITY_MAIN + servers[i].priority,
+                                       CREATE_STACKTEST, server, &servers[i],
+                                       "server");
+    }
+
+    /* let every server set up and wait in msg_receive() */
+    for (unsigned i = 0; i < sizeof(servers) / sizeof(servers[0]); i++) {
+        msg_t m;
+
+        m.type = BENCH_ECHO;
+        msg_send_receive(&m, &m, servers[i].pid);
+    }
+
+    puts("# ipc_benchmark");
+    puts("# name,threads,priority,iterations,total_us,ns_per_op,cycles_per_op");
+
+    bench_loop();
+
+    bench_send_receive(SERVER_HIGHER);
+    bench_send_receive(SERVER_SAME);
+    bench_send_receive(SERVER_LOWER);
+
+    /* direct copy, the higher receiver runs right away */
+    bench_send_direct(SERVER_HIGHER);
+    /* sender blocks until the lower receiver takes the message */
+    bench_send_direct(SERVER_LOWER);
+    bench_send_queued(SERVER_QUEUED);
+    bench_send_queued(SERVER_BATCHED);
+    bench_queue_self();
+    bench_queue_self_many();
+
+    bench_mutex();
+
+    for (unsigned yielders = 0; yielders <= MAX_YIELDERS;
+         yielders = yielders ? yielders * 2 : 1) {
+        bench_yield(yielders);
+    }
+
+    bench_sched_run();
+
+    puts("# done");
+    return 0;
+}
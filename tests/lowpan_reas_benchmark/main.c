@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Feeds storms of 6LoWPAN fragments into the reassembly engine
+ *
+ * Every round each sender starts one datagram, the fragments of all senders
+ * arrive interleaved. With more senders than reassembly buffers datagrams
+ * are evicted before they are complete. For every scenario the time per
+ * fragment and the counters of the engine are printed.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "hwtimer.h"
+#include "reas.h"
+
+#define ROUNDS          (200)
+#define FRAG_SIZE       (64)
+#define DATAGRAM_SIZE   (LOWPAN_REAS_BUF_SIZE - 16)
+#define FRAGS           ((DATAGRAM_SIZE + FRAG_SIZE - 1) / FRAG_SIZE)
+
+static uint8_t payload[FRAG_SIZE];
+static net_if_eui64_t dst = { .uint8 = { 0x02, 0, 0, 0xff, 0xfe, 0, 0, 1 } };
+
+static void deliver(unsigned sender, uint16_t tag, unsigned frag)
+{
+    net_if_eui64_t src = { .uint8 = { 0x02, 0, 0, 0xff, 0xfe, 0, 0x10, 0 } };
+    uint16_t offset = frag * FRAG_SIZE;
+    uint16_t len = FRAG_SIZE;
+
+    src.uint8[7] = sender;
+
+    if ((offset + len) > DATAGRAM_SIZE) {
+        len = DATAGRAM_SIZE - offset;
+    }
+
+    lowpan_reas_buf_t *buf = lowpan_reas_get(DATAGRAM_SIZE, tag, &src, &dst);
+
+    if (buf && (lowpan_reas_add(buf, offset, payload, len) == LOWPAN_REAS_COMPLETE)) {
+        /* the IPv6 layer is done with it */
+        lowpan_reas_release(buf);
+    }
+}
+
+static void storm(const char *name, unsigned senders, int reverse, int copies)
+{
+    unsigned fragments = 0;
+
+    lowpan_reas_init();
+
+    unsigned long start = hwtimer_now();
+
+    for (uint16_t round = 0; round < ROUNDS; round++) {
+        for (unsigned f = 0; f < FRAGS; f++) {
+            unsigned frag = reverse ? (FRAGS - 1 - f) : f;
+
+            for (unsigned s = 0; s < senders; s++) {
+                for (int c = 0; c < copies; c++) {
+                    deliver(s, round, frag);
+                    fragments++;
+                }
+            }
+        }
+    }
+
+    uint32_t ns = (HWTIMER_TICKS_TO_US(hwtimer_now() - start) * 1000) / fragments;
+
+    printf("%s senders=%u fragments=%u ns_per_fragment=%" PRIu32
+           " completed=%" PRIu32 " evicted=%" PRIu32 " duplicates=%" PRIu32
+           " no_buf=%" PRIu32 "\n", name, senders, fragments, ns,
+           lowpan_reas_stats.completed, lowpan_reas_stats.evicted,
+           lowpan_reas_stats.duplicates, lowpan_reas_stats.no_buf);
+}
+
+int main(void)
+{
+    printf("6LoWPAN reassembly benchmark: %u buffers, %u byte datagrams in %u fragments\n",
+           LOWPAN_REAS_BUF_NUMOF, DATAGRAM_SIZE, FRAGS);
+
+    memset(payload, 0xa5, sizeof(payload));
+
+    storm("sequential", 1, 0, 1);
+    storm("interleaved", LOWPAN_REAS_BUF_NUMOF, 0, 1);
+    storm("reverse", LOWPAN_REAS_BUF_NUMOF, 1, 1);
+    storm("duplicates", LOWPAN_REAS_BUF_NUMOF, 0, 2);
+    storm("overload", 4 * LOWPAN_REAS_BUF_NUMOF, 0, 1);
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures next hop lookups in the RPL routing table
+ *
+ * The table is filled with host routes of downstream nodes as a storing mode
+ * root would learn them from DAOs, optionally together with a few prefix
+ * routes. For every table size the time per lookup of the indexed table is
+ * printed next to a linear scan over the same entries.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "hwtimer.h"
+#include "rpl.h"
+
+#define LOOKUPS         (20000)
+
+static ipv6_addr_t next_hop;
+
+static void node_addr(ipv6_addr_t *addr, unsigned node)
+{
+    ipv6_addr_init(addr, 0xfd00, 0, 0, 0, 0, 0x00ff, 0xfe00, node + 1);
+}
+
+/* the table as it was searched before it was indexed */
+static ipv6_addr_t *linear_next_hop(ipv6_addr_t *addr)
+{
+    rpl_routing_entry_t *rt = rpl_get_routing_table();
+
+    for (unsigned i = 0; i < RPL_MAX_ROUTING_ENTRIES; i++) {
+        if (rt[i].used && rpl_equal_id(&rt[i].address, addr)) {
+            return &rt[i].next_hop;
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t measure(ipv6_addr_t *(*lookup)(ipv6_addr_t *), unsigned spread,
+                        unsigned *found)
+{
+    ipv6_addr_t addr;
+
+    *found = 0;
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < LOOKUPS; i++) {
+        node_addr(&addr, (i * 7919) % spread);
+
+        if (lookup(&addr) == &next_hop) {
+            (*found)++;
+        }
+    }
+
+    return (HWTIMER_TICKS_TO_US(hwtimer_now() - start) * 1000) / LOOKUPS;
+}
+
+static ipv6_addr_t *indexed_next_hop(ipv6_addr_t *addr)
+{
+    rpl_routing_entry_t *entry = rpl_lookup_routing_entry(addr);
+    return entry ? &entry->next_hop : NULL;
+}
+
+static void run(unsigned nodes, int prefixes)
+{
+    ipv6_addr_t addr;
+    unsigned found;
+
+    rpl_clear_routing_table();
+
+    for (unsigned n = 0; n < nodes; n++) {
+        node_addr(&addr, n);
+        rpl_add_routing_entry(&addr, &next_hop, 0xffff);
+    }
+
+    if (prefixes) {
+        /* external prefixes behind border routers in the DODAG */
+        ipv6_addr_init(&addr, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+        rpl_add_prefix_routing_entry(&addr, 64, &next_hop, 0xffff);
+        ipv6_addr_init(&addr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 0);
+        rpl_add_prefix_routing_entry(&addr, 32, &next_hop, 0xffff);
+    }
+
+    /* half of the lookups miss the host routes */
+    uint32_t hashed = measure(indexed_next_hop, 2 * nodes, &found);
+    printf("nodes=%u prefixes=%d hashed_ns=%" PRIu32 " matched=%u", nodes,
+           prefixes, hashed, found);
+
+    if (!prefixes) {
+        uint32_t linear = measure(linear_next_hop, 2 * nodes, &found);
+        printf(" linear_ns=%" PRIu32 " matched=%u", linear, found);
+    }
+
+    puts("");
+}
+
+int main(void)
+{
+    printf("RPL routing table benchmark: %u entries, %u buckets\n",
+           RPL_MAX_ROUTING_ENTRIES, RPL_ROUTING_HASH_SIZE);
+
+    for (unsigned nodes = 16; nodes < RPL_MAX_ROUTING_ENTRIES; nodes *= 4) {
+        run(nodes, 0);
+        run(nodes, 1);
+    }
+
+    run(RPL_MAX_ROUTING_ENTRIES - 2, 0);
+    run(RPL_MAX_ROUTING_ENTRIES - 2, 1);
+
+    puts("done");
+    return 0;
+}
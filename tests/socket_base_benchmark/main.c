@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the cost of demultiplexing a received UDP datagram
+ *              to its socket for growing numbers of bound sockets
+ *
+ * For every table size the lookup through the socket index is compared with
+ * a linear scan over all sockets, which is how sockets were found before the
+ * index existed. Lookups are done for the first and the last bound port and
+ * for a port no socket is bound to.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "hwtimer.h"
+#include "net_help.h"
+#include "socket_base/socket.h"
+#include "socket.h"
+
+#define LOOKUPS         (1000)
+#define BASE_PORT       (10000)
+
+socket_internal_t *get_udp_socket(udp_hdr_t *udp_header);
+bool udp_socket_compliancy(int s);
+
+static const unsigned sizes[] = { 8, 64, MAX_SOCKETS };
+
+static socket_internal_t *linear_lookup(udp_hdr_t *udp_header)
+{
+    for (int i = 1; i < MAX_SOCKETS + 1; i++) {
+        if (udp_socket_compliancy(i) &&
+            (socket_base_get_socket(i)->socket_values.local_address.sin6_port ==
+             udp_header->dst_port)) {
+            return socket_base_get_socket(i);
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t time_lookup(socket_internal_t *(*lookup)(udp_hdr_t *), uint16_t port)
+{
+    udp_hdr_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.dst_port = HTONS(port);
+
+    unsigned long start = hwtimer_now();
+
+    for (unsigned i = 0; i < LOOKUPS; ++i) {
+        lookup(&hdr);
+    }
+
+    /* ns per lookup */
+    return (HWTIMER_TICKS_TO_US(hwtimer_now() - start) * 1000) / LOOKUPS;
+}
+
+static int bind_sockets(unsigned n)
+{
+    sockaddr6_t sa;
+
+    for (unsigned i = 0; i < n; ++i) {
+        int s = socket_base_socket(PF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+
+        if (s < 0) {
+            return -1;
+        }
+
+        memset(&sa, 0, sizeof(sa));
+        sa.sin6_family = AF_INET6;
+        sa.sin6_port = HTONS(BASE_PORT + i);
+
+        if (socket_base_bind(s, &sa, sizeof(sa)) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void close_sockets(void)
+{
+    for (int s = 1; s < MAX_SOCKETS + 1; s++) {
+        if (socket_base_exists_socket(s)) {
+            socket_base_close(s);
+        }
+    }
+}
+
+static void bench(unsigned n)
+{
+    static const char *names[] = { "first", "last", "miss" };
+    uint16_t ports[] = { BASE_PORT, BASE_PORT + n - 1, BASE_PORT + n };
+
+    if (bind_sockets(n) < 0) {
+        printf("n=%u: could not bind sockets\n", n);
+        close_sockets();
+        return;
+    }
+
+    for (unsigned i = 0; i < sizeof(ports) / sizeof(ports[0]); ++i) {
+        if (get_udp_socket(&(udp_hdr_t) { .dst_port = HTONS(ports[i]) }) !=
+            linear_lookup(&(udp_hdr_t) { .dst_port = HTONS(ports[i]) })) {
+            printf("n=%u %s: lookup mismatch\n", n, names[i]);
+        }
+
+        printf("n=%u %s index_ns=%" PRIu32 " linear_ns=%" PRIu32 "\n", n, names[i],
+               time_lookup(get_udp_socket, ports[i]),
+               time_lookup(linear_lookup, ports[i]));
+    }
+
+    close_sockets();
+}
+
+int main(void)
+{
+    puts("socket_base demultiplexing benchmark");
+
+    for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        bench(sizes[i]);
+    }
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures TCP throughput between two native instances
+ *
+ * Node 2 sends TOTAL_BYTES to node 1 and prints the time it took until
+ * everything was acknowledged. Node 1 checks the received pattern.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "net_help.h"
+#include "net_if.h"
+#include "sixlowpan.h"
+#include "socket_base/socket.h"
+#include "vtimer.h"
+
+#ifndef R_ADDR
+#define R_ADDR          (1)
+#endif
+
+#ifndef TOTAL_BYTES
+#define TOTAL_BYTES     (4096)
+#endif
+
+#define PORT            (1234)
+#define CHUNK_SIZE      (TRANSPORT_LAYER_SOCKET_TCP_SEND_BUFFER)
+
+static uint8_t data[CHUNK_SIZE];
+
+static int init_local_address(uint16_t r_addr)
+{
+    ipv6_addr_t std_addr;
+    ipv6_addr_init(&std_addr, 0xabcd, 0xef12, 0, 0, 0x1034, 0x00ff, 0xfe00,
+                   0);
+    net_if_set_src_address_mode(0, NET_IF_TRANS_ADDR_M_SHORT);
+    return net_if_set_hardware_address(0, r_addr) &&
+           sixlowpan_lowpan_init_adhoc_interface(0, &std_addr);
+}
+
+static void set_addr(sockaddr6_t *sa, uint16_t r_addr, uint16_t port)
+{
+    memset(sa, 0, sizeof(*sa));
+    sa->sin6_family = AF_INET6;
+    sa->sin6_port = HTONS(port);
+    ipv6_addr_init(&sa->sin6_addr, 0xabcd, 0xef12, 0, 0, 0x1034, 0x00ff,
+                   0xfe00, r_addr);
+}
+
+static void receiver(void)
+{
+    sockaddr6_t sa;
+    socklen_t sa_len = sizeof(sa);
+    uint32_t received = 0, errors = 0;
+
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+    set_addr(&sa, R_ADDR, PORT);
+    sa.sin6_addr.uint16[7] = 0;
+
+    if ((s < 0) || (socket_base_bind(s, &sa, sizeof(sa)) < 0) ||
+        (socket_base_listen(s, 1) < 0)) {
+        puts("could not listen");
+        return;
+    }
+
+    int c = socket_base_accept(s, &sa, &sa_len);
+
+    if (c < 0) {
+        puts("accept failed");
+        return;
+    }
+
+    while (received < TOTAL_BYTES) {
+        int32_t n = socket_base_recv(c, data, sizeof(data), 0);
+
+        if (n <= 0) {
+            break;
+        }
+
+        for (int32_t i = 0; i < n; i++) {
+            if (data[i] != (uint8_t)(received + i)) {
+                errors++;
+            }
+        }
+
+        received += n;
+    }
+
+    printf("received %" PRIu32 " bytes, %" PRIu32 " corrupted\n", received, errors);
+    socket_base_close(c);
+    socket_base_close(s);
+}
+
+static void sender(void)
+{
+    sockaddr6_t sa;
+    timex_t start, end;
+    uint32_t sent = 0;
+
+    int s = socket_base_socket(PF_INET6, SOCK_STREAM, IPPROTO_TCP);
+    set_addr(&sa, 1, PORT);
+
+    if ((s < 0) || (socket_base_connect(s, &sa, sizeof(sa)) < 0)) {
+        puts("could not connect");
+        return;
+    }
+
+    vtimer_now(&start);
+
+    while (sent < TOTAL_BYTES) {
+        uint32_t len = TOTAL_BYTES - sent;
+
+        if (len > sizeof(data)) {
+            len = sizeof(data);
+        }
+
+        for (uint32_t i = 0; i < len; i++) {
+            data[i] = (uint8_t)(sent + i);
+        }
+
+        if (socket_base_send(s, data, len, 0) < 0) {
+            puts("send failed");
+            break;
+        }
+
+        sent += len;
+    }
+
+    vtimer_now(&end);
+
+    uint64_t us = timex_uint64(timex_sub(end, start));
+    printf("send buffer %u bytes: sent %" PRIu32 " bytes in %" PRIu32 " ms, %"
+           PRIu32 " byte/s\n", TRANSPORT_LAYER_SOCKET_TCP_SEND_BUFFER, sent,
+           (uint32_t)(us / 1000), us ? (uint32_t)((sent * 1000000ULL) / us) : 0);
+    socket_base_close(s);
+}
+
+int main(void)
+{
+    if (!init_local_address(R_ADDR)) {
+        printf("Can not initialize IP for hardware address %d.\n", R_ADDR);
+        return 1;
+    }
+
+    if (R_ADDR == 1) {
+        receiver();
+    }
+    else {
+        sender();
+    }
+
+    puts("done");
+    return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file    tests-ccn_lite.c
+ */
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "ccnl-includes.h"
+#include "ccnl.h"
+#include "ccnl-core.h"
+
+#include "tests-ccn_lite.h"
+
+static struct ccnl_relay_s relay;
+
+static union {
+    struct ccnl_buf_s buf;
+    unsigned char mem[sizeof(struct ccnl_buf_s) + 2 * CCNL_MAX_NONCE_LEN];
+} nonce_mem;
+
+static struct ccnl_buf_s *nonce(uint32_t v, unsigned int len)
+{
+    struct ccnl_buf_s *n = &nonce_mem.buf;
+
+    memset(n->data, 0, len);
+    memcpy(n->data, &v, len < sizeof(v) ? len : sizeof(v));
+    n->datalen = len;
+    return n;
+}
+
+static int find_or_append(uint32_t v)
+{
+    return ccnl_nonce_find_or_append(&relay, nonce(v, sizeof(v)));
+}
+
+static void set_up(void)
+{
+    ccnl_nonce_flush(&relay);
+}
+
+static void test_ccnl_nonce_new_then_known(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32));
+    TEST_ASSERT_EQUAL_INT(-1, find_or_append(TEST_UINT32));
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32 + 1));
+    TEST_ASSERT_EQUAL_INT(2, relay.nonces.cnt);
+}
+
+static void test_ccnl_nonce_length_matters(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, ccnl_nonce_find_or_append(&relay, nonce(TEST_UINT32, 4)));
+    TEST_ASSERT_EQUAL_INT(0, ccnl_nonce_find_or_append(&relay, nonce(TEST_UINT32, 6)));
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_nonce_find_or_append(&relay, nonce(TEST_UINT32, 4)));
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_nonce_find_or_append(&relay, nonce(TEST_UINT32, 6)));
+}
+
+static void test_ccnl_nonce_long(void)
+{
+    struct ccnl_buf_s *n = nonce(TEST_UINT32, 2 * CCNL_MAX_NONCE_LEN);
+
+    TEST_ASSERT_EQUAL_INT(0, ccnl_nonce_find_or_append(&relay, n));
+    TEST_ASSERT_EQUAL_INT(-1, ccnl_nonce_find_or_append(&relay, n));
+
+    /* differs beyond the stored bytes */
+    n->data[2 * CCNL_MAX_NONCE_LEN - 1] = 1;
+    TEST_ASSERT_EQUAL_INT(0, ccnl_nonce_find_or_append(&relay, n));
+}
+
+static void test_ccnl_nonce_oldest_dropped(void)
+{
+    for (uint32_t i = 0; i <= CCNL_MAX_NONCES; i++) {
+        TEST_ASSERT_EQUAL_INT(0, find_or_append(i));
+    }
+
+    TEST_ASSERT_EQUAL_INT(CCNL_MAX_NONCES, relay.nonces.cnt);
+    TEST_ASSERT_EQUAL_INT(-1, find_or_append(CCNL_MAX_NONCES));
+    TEST_ASSERT_EQUAL_INT(-1, find_or_append(1));
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(0));
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(1));
+}
+
+static void test_ccnl_nonce_wrap(void)
+{
+    /* go around the ring a few times, nonces share index slots */
+    for (uint32_t i = 0; i < 5 * CCNL_MAX_NONCES; i++) {
+        TEST_ASSERT_EQUAL_INT(0, find_or_append(i * CCNL_NONCE_HASH_SIZE));
+    }
+
+    for (uint32_t i = 4 * CCNL_MAX_NONCES; i < 5 * CCNL_MAX_NONCES; i++) {
+        TEST_ASSERT_EQUAL_INT(-1, find_or_append(i * CCNL_NONCE_HASH_SIZE));
+    }
+
+    TEST_ASSERT_EQUAL_INT(CCNL_MAX_NONCES, relay.nonces.cnt);
+}
+
+static void test_ccnl_nonce_timeout(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32));
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32 + 1));
+
+    ccnl_do_nonce_timeout(&relay, NULL);
+    TEST_ASSERT_EQUAL_INT(2, relay.nonces.cnt);
+
+    /* let the first one expire */
+    relay.nonces.ring[relay.nonces.first].created.tv_sec -= 10;
+    ccnl_do_nonce_timeout(&relay, NULL);
+    TEST_ASSERT_EQUAL_INT(1, relay.nonces.cnt);
+    TEST_ASSERT_EQUAL_INT(-1, find_or_append(TEST_UINT32 + 1));
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32));
+}
+
+static void test_ccnl_nonce_flush(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32));
+    ccnl_nonce_flush(&relay);
+    TEST_ASSERT_EQUAL_INT(0, relay.nonces.cnt);
+    TEST_ASSERT_EQUAL_INT(0, find_or_append(TEST_UINT32));
+}
+
+static void test_ccnl_buf_dup_shares(void)
+{
+    unsigned int used = ccnl_pools[CCNL_POOL_SMALL_BUF].used;
+    struct ccnl_buf_s *b = ccnl_buf_new("abc", 3);
+
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT(buf_dup(b) == b);
+    TEST_ASSERT_EQUAL_INT(2, b->refs);
+    TEST_ASSERT_EQUAL_INT(used + 1, ccnl_pools[CCNL_POOL_SMALL_BUF].used);
+
+    ccnl_buf_free(b);
+    TEST_ASSERT_EQUAL_INT(1, b->refs);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(b->data, "abc", 3));
+
+    ccnl_buf_free(b);
+    TEST_ASSERT_EQUAL_INT(used, ccnl_pools[CCNL_POOL_SMALL_BUF].used);
+}
+
+static void test_ccnl_buf_sizes(void)
+{
+    struct ccnl_buf_s *b;
+
+    b = ccnl_buf_new(NULL, CCNL_BUF_SMALL_SIZE);
+    TEST_ASSERT_EQUAL_INT(CCNL_POOL_SMALL_BUF, b->pool);
+    ccnl_buf_free(b);
+
+    b = ccnl_buf_new(NULL, CCNL_BUF_SMALL_SIZE + 1);
+    TEST_ASSERT_EQUAL_INT(CCNL_POOL_LARGE_BUF, b->pool);
+    ccnl_buf_free(b);
+
+    b = ccnl_buf_new(NULL, CCNL_BUF_LARGE_SIZE + 1);
+    TEST_ASSERT_EQUAL_INT(CCNL_POOL_HEAP, b->pool);
+    TEST_ASSERT_EQUAL_INT(CCNL_BUF_LARGE_SIZE + 1, b->datalen);
+    ccnl_buf_free(b);
+}
+
+static void test_ccnl_pool_exhausted(void)
+{
+    static void *fwd[CCNL_POOL_FORWARDS];
+    struct ccnl_pool_s *p = ccnl_pools + CCNL_POOL_FORWARD;
+    unsigned int failed = p->failed;
+
+    for (int k = 0; k < CCNL_POOL_FORWARDS; k++) {
+        fwd[k] = ccnl_pool_alloc(CCNL_POOL_FORWARD);
+        TEST_ASSERT_NOT_NULL(fwd[k]);
+    }
+
+    TEST_ASSERT_NULL(ccnl_pool_alloc(CCNL_POOL_FORWARD));
+    TEST_ASSERT_EQUAL_INT(failed + 1, p->failed);
+    TEST_ASSERT_EQUAL_INT(CCNL_POOL_FORWARDS, p->highwater);
+
+    for (int k = 0; k < CCNL_POOL_FORWARDS; k++) {
+        ccnl_pool_free(CCNL_POOL_FORWARD, fwd[k]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, p->used);
+    fwd[0] = ccnl_pool_alloc(CCNL_POOL_FORWARD);
+    TEST_ASSERT_NOT_NULL(fwd[0]);
+    ccnl_pool_free(CCNL_POOL_FORWARD, fwd[0]);
+}
+
+static void test_ccnl_prefix_new(void)
+{
+    struct ccnl_prefix_s *p = ccnl_prefix_new();
+
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_INT(0, p->compcnt);
+    TEST_ASSERT_NULL(p->path);
+
+    /* room for every component */
+    p->comp[CCNL_MAX_NAME_COMP - 1] = NULL;
+    p->complen[CCNL_MAX_NAME_COMP - 1] = 0;
+    free_prefix(p);
+}
+
+static unsigned int bufs_used(void)
+{
+    return ccnl_pools[CCNL_POOL_SMALL_BUF].used +
+           ccnl_pools[CCNL_POOL_LARGE_BUF].used;
+}
+
+static void test_ccnl_trie_long_component(void)
+{
+    struct ccnl_pool_s *pool = ccnl_pools + CCNL_POOL_TRIE_NODE;
+    unsigned int used = pool->used, bufs = bufs_used();
+    unsigned char a[CCNL_TRIE_COMP_SIZE + 1], b[CCNL_TRIE_COMP_SIZE + 1];
+    struct ccnl_prefix_s *p = ccnl_prefix_new();
+    struct ccnl_forward_s fwd;
+
+    /* differs beyond the stored bytes */
+    memset(a, 'a', sizeof(a));
+    memcpy(b, a, sizeof(b));
+    b[CCNL_TRIE_COMP_SIZE] = 'b';
+
+    TEST_ASSERT_NOT_NULL(p);
+    p->comp[0] = a;
+    p->complen[0] = sizeof(a);
+    p->compcnt = 1;
+
+    memset(&fwd, 0, sizeof(fwd));
+    fwd.prefix = p;
+    fwd.flags = CCNL_FORWARD_FLAGS_STATIC;
+
+    TEST_ASSERT_EQUAL_INT(0, ccnl_trie_add_forward(&relay, &fwd));
+    TEST_ASSERT_EQUAL_INT(used + 1, pool->used);
+    /* the node keeps a copy of the whole component */
+    TEST_ASSERT_EQUAL_INT(bufs + 1, bufs_used());
+    TEST_ASSERT(ccnl_trie_lookup(&relay, p, 1) == fwd.node);
+
+    p->comp[0] = b;
+    TEST_ASSERT_NULL(ccnl_trie_lookup(&relay, p, 1));
+
+    ccnl_trie_remove_forward(&relay, &fwd);
+    TEST_ASSERT_EQUAL_INT(used, pool->used);
+    TEST_ASSERT_EQUAL_INT(bufs, bufs_used());
+    p->comp[0] = a;
+    TEST_ASSERT_NULL(ccnl_trie_lookup(&relay, p, 1));
+
+    free_prefix(p);
+}
+
+static void test_ccnl_trie_hash_collision(void)
+{
+    unsigned char a[40], b[40];
+    struct ccnl_prefix_s *pa = ccnl_prefix_new(), *pb = ccnl_prefix_new();
+    struct ccnl_forward_s fa, fb;
+
+    /* different components with the same hash below the root */
+    memset(a, 'a', sizeof(a));
+    memcpy(b, a, sizeof(b));
+    memcpy(a + 32, "noxsxlwf", 8);
+    memcpy(b + 32, "dfgjnpsw", 8);
+    TEST_ASSERT(ccnl_hash_comp(relay.trie.hash, a, sizeof(a)) ==
+                ccnl_hash_comp(relay.trie.hash, b, sizeof(b)));
+
+    TEST_ASSERT_NOT_NULL(pa);
+    TEST_ASSERT_NOT_NULL(pb);
+    pa->comp[0] = a;
+    pa->complen[0] = sizeof(a);
+    pa->compcnt = 1;
+    pb->comp[0] = b;
+    pb->complen[0] = sizeof(b);
+    pb->compcnt = 1;
+
+    memset(&fa, 0, sizeof(fa));
+    fa.prefix = pa;
+    fa.flags = CCNL_FORWARD_FLAGS_STATIC;
+    memcpy(&fb, &fa, sizeof(fb));
+    fb.prefix = pb;
+
+    TEST_ASSERT_EQUAL_INT(0, ccnl_trie_add_forward(&relay, &fa));
+    TEST_ASSERT_NULL(ccnl_trie_lookup(&relay, pb, 1));
+
+    TEST_ASSERT_EQUAL_INT(0, ccnl_trie_add_forward(&relay, &fb));
+    TEST_ASSERT(fa.node != fb.node);
+    TEST_ASSERT(ccnl_trie_lookup(&relay, pa, 1) == fa.node);
+    TEST_ASSERT(ccnl_trie_lookup(&relay, pb, 1) == fb.node);
+
+    ccnl_trie_remove_forward(&relay, &fa);
+    ccnl_trie_remove_forward(&relay, &fb);
+    free_prefix(pa);
+    free_prefix(pb);
+}
+
+Test *tests_ccn_lite_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ccnl_nonce_new_then_known),
+        new_TestFixture(test_ccnl_nonce_length_matters),
+        new_TestFixture(test_ccnl_nonce_long),
+        new_TestFixture(test_ccnl_nonce_oldest_dropped),
+        new_TestFixture(test_ccnl_nonce_wrap),
+        new_TestFixture(test_ccnl_nonce_timeout),
+        new_TestFixture(test_ccnl_nonce_flush),
+        new_TestFixture(test_ccnl_buf_dup_shares),
+        new_TestFixture(test_ccnl_buf_sizes),
+        new_TestFixture(test_ccnl_pool_exhausted),
+        new_TestFixture(test_ccnl_prefix_new),
+        new_TestFixture(test_ccnl_trie_long_component),
+        new_TestFixture(test_ccnl_trie_hash_collision),
+    };
+
+    EMB_UNIT_TESTCALLER(ccn_lite_tests, set_up, NULL, fixtures);
+
+    return (Test *)&ccn_lite_tests;
+}
+
+void tests_ccn_lite(void)
+{
+    TESTS_RUN(tests_ccn_lite_tests());
+}
+/** @} */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include "embUnit/embUnit.h"
+
+#include "kernel.h"
+#include "msg.h"
+#include "sched.h"
+#include "tcb.h"
+#include "thread.h"
+
+#include "tests-core.h"
+
+#define TEST_MSG_QUEUE_SIZE     (4)
+#define TEST_MSG_SENDERS        (2)
+
+static msg_t queue[TEST_MSG_QUEUE_SIZE];
+static char stacks[TEST_MSG_SENDERS][KERNEL_CONF_STACKSIZE_DEFAULT];
+static kernel_pid_t main_pid;
+
+static void set_up(void)
+{
+    main_pid = thread_getpid();
+    msg_init_queue(queue, TEST_MSG_QUEUE_SIZE);
+}
+
+static void tear_down(void)
+{
+    /* other tests must not find messages queued for them */
+    ((tcb_t *) sched_active_thread)->msg_array = NULL;
+}
+
+static void fill(msg_t *m, int num, uint32_t first)
+{
+    for (int i = 0; i < num; i++) {
+        m[i].type = 0;
+        m[i].content.value = first + i;
+        /* must be overwritten on send */
+        m[i].sender_pid = KERNEL_PID_UNDEF;
+    }
+}
+
+static void *sender(void *arg)
+{
+    msg_t m;
+
+    fill(&m, 1, (uint32_t) (uintptr_t) arg);
+    msg_send(&m, main_pid);
+
+    return NULL;
+}
+
+static void test_msg_send_many_self(void)
+{
+    msg_t m[TEST_MSG_QUEUE_SIZE];
+
+    fill(m, TEST_MSG_QUEUE_SIZE, TEST_UINT16);
+    TEST_ASSERT_EQUAL_INT(TEST_MSG_QUEUE_SIZE,
+                          msg_send_many(m, TEST_MSG_QUEUE_SIZE, main_pid));
+
+    /* the queue is full */
+    TEST_ASSERT_EQUAL_INT(0, msg_send_many(m, 1, main_pid));
+
+    fill(m, TEST_MSG_QUEUE_SIZE, 0);
+    TEST_ASSERT_EQUAL_INT(TEST_MSG_QUEUE_SIZE,
+                          msg_receive_many(m, TEST_MSG_QUEUE_SIZE));
+
+    for (int i = 0; i < TEST_MSG_QUEUE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(TEST_UINT16 + i, m[i].content.value);
+        TEST_ASSERT_EQUAL_INT(main_pid, m[i].sender_pid);
+    }
+}
+
+static void test_msg_send_many_partly_full(void)
+{
+    msg_t m[TEST_MSG_QUEUE_SIZE * 2];
+
+    fill(m, TEST_MSG_QUEUE_SIZE - 1, 0);
+
+    for (int i = 0; i < TEST_MSG_QUEUE_SIZE - 1; i++) {
+        TEST_ASSERT_EQUAL_INT(1, msg_send_to_self(&m[i]));
+    }
+
+    /* only the first one fits */
+    fill(m, 3, TEST_MSG_QUEUE_SIZE - 1);
+    TEST_ASSERT_EQUAL_INT(1, msg_send_many(m, 3, main_pid));
+
+    TEST_ASSERT_EQUAL_INT(TEST_MSG_QUEUE_SIZE,
+                          msg_receive_many(m, TEST_MSG_QUEUE_SIZE * 2));
+
+    for (int i = 0; i < TEST_MSG_QUEUE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(i, m[i].content.value);
+        TEST_ASSERT_EQUAL_INT(main_pid, m[i].sender_pid);
+    }
+}
+
+static void test_msg_receive_many_blocked_senders(void)
+{
+    msg_t m[TEST_MSG_QUEUE_SIZE + TEST_MSG_SENDERS + 1];
+    kernel_pid_t pids[TEST_MSG_SENDERS];
+    int i;
+
+    fill(m, TEST_MSG_QUEUE_SIZE, 0);
+    TEST_ASSERT_EQUAL_INT(TEST_MSG_QUEUE_SIZE,
+                          msg_send_many(m, TEST_MSG_QUEUE_SIZE, main_pid));
+
+    /* the senders run right away and block on the full queue, in order */
+    for (i = 0; i < TEST_MSG_SENDERS; i++) {
+        pids[i] = thread_create(stacks[i], sizeof(stacks[i]), PRIORITY_MAIN - 1,
+                                0, sender,
+                                (void *) (uintptr_t) (TEST_MSG_QUEUE_SIZE + i),
+                                "msg_sender");
+        TEST_ASSERT(pids[i] > KERNEL_PID_UNDEF);
+        TEST_ASSERT_EQUAL_INT(STATUS_SEND_BLOCKED, sched_threads[pids[i]]->status);
+    }
+
+    TEST_ASSERT_EQUAL_INT(TEST_MSG_QUEUE_SIZE + TEST_MSG_SENDERS,
+                          msg_receive_many(m, TEST_MSG_QUEUE_SIZE + TEST_MSG_SENDERS + 1));
+
+    for (i = 0; i < TEST_MSG_QUEUE_SIZE + TEST_MSG_SENDERS; i++) {
+        TEST_ASSERT_EQUAL_INT(i, m[i].content.value);
+
+        if (i < TEST_MSG_QUEUE_SIZE) {
+            TEST_ASSERT_EQUAL_INT(main_pid, m[i].sender_pid);
+        }
+        else {
+            TEST_ASSERT_EQUAL_INT(pids[i - TEST_MSG_QUEUE_SIZE], m[i].sender_pid);
+        }
+    }
+
+    /* let the senders return from msg_send() and exit */
+    thread_yield();
+}
+
+Test *tests_core_msg_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_msg_send_many_self),
+        new_TestFixture(test_msg_send_many_partly_full),
+        new_TestFixture(test_msg_receive_many_blocked_senders),
+    };
+
+    EMB_UNIT_TESTCALLER(core_msg_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&core_msg_tests;
+}
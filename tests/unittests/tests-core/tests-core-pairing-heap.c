@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "pairing_heap.h"
+
+#include "tests-core.h"
+
+#define H_LEN (16)
+
+static pairing_heap_t h = PAIRING_HEAP_INIT;
+static pairing_heap_t h2 = PAIRING_HEAP_INIT;
+static pairing_heap_node_t he[H_LEN];
+
+static void set_up(void)
+{
+    pairing_heap_init(&h);
+    pairing_heap_init(&h2);
+    for (unsigned i = 0; i < sizeof(he)/sizeof(pairing_heap_node_t); ++i) {
+        pairing_heap_node_init(&(he[i]));
+    }
+}
+
+static void test_pairing_heap_remove_head_empty(void)
+{
+    TEST_ASSERT_NULL(pairing_heap_remove_head(&h));
+    TEST_ASSERT_NULL(pairing_heap_peek(&h));
+}
+
+static void test_pairing_heap_add_one(void)
+{
+    pairing_heap_node_t *elem = &(he[1]);
+
+    elem->priority = 713643658;
+
+    pairing_heap_add(&h, elem);
+
+    TEST_ASSERT(pairing_heap_peek(&h) == elem);
+    TEST_ASSERT(pairing_heap_remove_head(&h) == elem);
+    TEST_ASSERT_NULL(pairing_heap_remove_head(&h));
+}
+
+static void test_pairing_heap_add_two_distinct(void)
+{
+    pairing_heap_node_t *elem1 = &(he[1]), *elem2 = &(he[2]);
+
+    elem1->priority = 4567;
+    elem2->priority = 1234;
+
+    pairing_heap_add(&h, elem1);
+    pairing_heap_add(&h, elem2);
+
+    TEST_ASSERT(pairing_heap_remove_head(&h) == elem2);
+    TEST_ASSERT(pairing_heap_remove_head(&h) == elem1);
+    TEST_ASSERT_NULL(pairing_heap_remove_head(&h));
+}
+
+static void test_pairing_heap_sorted(void)
+{
+    /* insert a permutation of 0..H_LEN-1 */
+    for (unsigned i = 0; i < H_LEN; ++i) {
+        he[i].priority = (i * 7) % H_LEN;
+        pairing_heap_add(&h, &(he[i]));
+    }
+
+    for (unsigned i = 0; i < H_LEN; ++i) {
+        pairing_heap_node_t *res = pairing_heap_remove_head(&h);
+        TEST_ASSERT_NOT_NULL(res);
+        TEST_ASSERT_EQUAL_INT(i, res->priority);
+    }
+
+    TEST_ASSERT_NULL(pairing_heap_remove_head(&h));
+}
+
+static void test_pairing_heap_remove(void)
+{
+    for (unsigned i = 0; i < H_LEN; ++i) {
+        he[i].priority = (i * 5) % H_LEN;
+        pairing_heap_add(&h, &(he[i]));
+    }
+
+    /* force some structure, then remove head, inner nodes and leaves */
+    TEST_ASSERT_EQUAL_INT(0, pairing_heap_remove_head(&h)->priority);
+    pairing_heap_add(&h, &(he[0]));
+
+    for (unsigned i = 0; i < H_LEN; i += 2) {
+        pairing_heap_remove(&h, &(he[i]));
+    }
+
+    uint32_t last = 0;
+    unsigned count = 0;
+    pairing_heap_node_t *res;
+
+    while ((res = pairing_heap_remove_head(&h))) {
+        TEST_ASSERT((res - he) % 2 == 1);
+        TEST_ASSERT(res->priority >= last);
+        last = res->priority;
+        ++count;
+    }
+
+    TEST_ASSERT_EQUAL_INT(H_LEN / 2, count);
+}
+
+static void test_pairing_heap_remove_foreign(void)
+{
+    pairing_heap_node_t *elem1 = &(he[1]), *elem2 = &(he[2]);
+
+    elem1->priority = 10;
+    elem2->priority = 20;
+
+    pairing_heap_add(&h, elem1);
+    pairing_heap_add(&h2, elem2);
+
+    pairing_heap_remove(&h, elem2);
+    pairing_heap_remove(&h, &(he[3]));
+
+    TEST_ASSERT(pairing_heap_peek(&h) == elem1);
+    TEST_ASSERT(pairing_heap_peek(&h2) == elem2);
+}
+
+Test *tests_core_pairing_heap_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_pairing_heap_remove_head_empty),
+        new_TestFixture(test_pairing_heap_add_one),
+        new_TestFixture(test_pairing_heap_add_two_distinct),
+        new_TestFixture(test_pairing_heap_sorted),
+        new_TestFixture(test_pairing_heap_remove),
+        new_TestFixture(test_pairing_heap_remove_foreign),
+    };
+
+    EMB_UNIT_TESTCALLER(core_pairing_heap_tests, set_up, NULL,
+                        fixtures);
+
+    return (Test *)&core_pairing_heap_tests;
+}
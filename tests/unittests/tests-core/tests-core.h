@@ -71,6 +71,13 @@ Test *tests_core_lifo_tests(void);
  */
 Test *tests_core_priority_queue_tests(void);
 
+/**
+ * @brief   Generates tests for pairing_heap.h
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_core_pairing_heap_tests(void);
+
 /**
  * @brief   Generates tests for byteorder.h
  *
@@ -78,6 +85,13 @@ Test *tests_core_priority_queue_tests(void);
  */
 Test *tests_core_byteorder_tests(void);
 
+/**
+ * @brief   Generates tests for msg.h
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_core_msg_tests(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file    tests-nbr_cache.c
+ */
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "net_help.h"
+
+#include "pktbuf.h"
+#include "pktchain.h"
+
+#include "nbr_cache.h"
+
+#include "tests-nbr_cache.h"
+
+static const uint8_t lladdr[] = { 0x12, 0x34 };
+
+/* fd00::i, a global address that has to be resolved */
+static ipv6_addr_t *addr(ipv6_addr_t *a, uint16_t i)
+{
+    memset(a, 0, sizeof(ipv6_addr_t));
+    a->uint8[0] = 0xfd;
+    a->uint8[14] = i >> 8;
+    a->uint8[15] = i & 0xff;
+
+    return a;
+}
+
+static uint8_t add(uint16_t i, ndp_nce_state_t state, ndp_nce_type_t type,
+                   uint32_t ltime)
+{
+    ipv6_addr_t a;
+
+    return ndp_neighbor_cache_add(0, addr(&a, i), lladdr, sizeof(lladdr), 0,
+                                  state, type, ltime);
+}
+
+static ndp_neighbor_cache_t *search(uint16_t i)
+{
+    ipv6_addr_t a;
+
+    return ndp_neighbor_cache_search(addr(&a, i));
+}
+
+static void set_up(void)
+{
+    nbr_cache_reset();
+}
+
+static void tear_down(void)
+{
+    nbr_cache_reset();
+    pktbuf_reset();
+}
+
+static void test_nbr_cache_hash_collisions(void)
+{
+    /* more entries than buckets, so some have to share one */
+    for (uint16_t i = 0; i < NBR_CACHE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                              add(i, NDP_NCE_STATUS_REACHABLE,
+                                  NDP_NCE_TYPE_GC, 0));
+    }
+
+    for (uint16_t i = 0; i < NBR_CACHE_SIZE; i += 2) {
+        ipv6_addr_t a;
+
+        TEST_ASSERT_EQUAL_INT(1, ndp_neighbor_cache_remove(addr(&a, i)));
+    }
+
+    for (uint16_t i = 0; i < NBR_CACHE_SIZE; i++) {
+        ndp_neighbor_cache_t *nce = search(i);
+
+        if (i & 1) {
+            ipv6_addr_t a;
+
+            TEST_ASSERT_NOT_NULL(nce);
+            TEST_ASSERT(ipv6_addr_is_equal(&nce->addr, addr(&a, i)));
+        }
+        else {
+            TEST_ASSERT_NULL(nce);
+        }
+    }
+
+    TEST_ASSERT_NULL(search(NBR_CACHE_SIZE));
+}
+
+static void test_nbr_cache_lru_skips_registered(void)
+{
+    TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                          add(0, NDP_NCE_STATUS_REACHABLE,
+                              NDP_NCE_TYPE_REGISTERED, 0));
+
+    for (uint16_t i = 1; i < NBR_CACHE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                              add(i, NDP_NCE_STATUS_REACHABLE,
+                                  NDP_NCE_TYPE_GC, 0));
+    }
+
+    /* entry 1 is the least recently used one that is not registered */
+    TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                          add(NBR_CACHE_SIZE, NDP_NCE_STATUS_REACHABLE,
+                              NDP_NCE_TYPE_GC, 0));
+    TEST_ASSERT_NOT_NULL(search(0));
+    TEST_ASSERT_NULL(search(1));
+    TEST_ASSERT_NOT_NULL(search(2));
+    TEST_ASSERT_NOT_NULL(search(NBR_CACHE_SIZE));
+
+    /* using entry 2 makes entry 3 the next one to go */
+    TEST_ASSERT_NOT_NULL(ndp_get_ll_address(&search(2)->addr));
+    TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                          add(NBR_CACHE_SIZE + 1, NDP_NCE_STATUS_REACHABLE,
+                              NDP_NCE_TYPE_GC, 0));
+    TEST_ASSERT_NOT_NULL(search(2));
+    TEST_ASSERT_NULL(search(3));
+}
+
+static void test_nbr_cache_full_of_registered(void)
+{
+    for (uint16_t i = 0; i < NBR_CACHE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                              add(i, NDP_NCE_STATUS_REACHABLE,
+                                  NDP_NCE_TYPE_REGISTERED, 0));
+    }
+
+    TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_NBR_CACHE_FULL,
+                          add(NBR_CACHE_SIZE, NDP_NCE_STATUS_REACHABLE,
+                              NDP_NCE_TYPE_GC, 0));
+    TEST_ASSERT_NOT_NULL(search(0));
+}
+
+static void test_nbr_cache_resolve_delivers_queued(void)
+{
+    uint8_t packet[IPV6_HDR_LEN + 4];
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)packet;
+    pktchain_t chain;
+    ipv6_ll_hop_t hop;
+    ipv6_addr_t a;
+
+    memset(packet, 0, sizeof(packet));
+    hdr->version_trafficclass = IPV6_VER;
+    hdr->length = HTONS(4);
+    hdr->nextheader = IPV6_PROTO_NUM_NONE;
+    hdr->hoplimit = 64;
+    addr(&hdr->destaddr, 1);
+
+    TEST_ASSERT_EQUAL_INT(0, nbr_cache_resolve(addr(&a, 1),
+                                               pktchain_prepend(&chain, packet,
+                                                                sizeof(packet),
+                                                                NULL), &hop));
+    TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_INCOMPLETE, search(1)->state);
+    TEST_ASSERT_EQUAL_INT(1, pktbuf_packets_allocated());
+
+    /* the first solicitation is due right away */
+    TEST_ASSERT_EQUAL_INT(1, nbr_cache_tick());
+    TEST_ASSERT_EQUAL_INT(0, nbr_cache_resolve(&a, NULL, &hop));
+
+    /* the neighbor advertisement arrives */
+    TEST_ASSERT_EQUAL_INT(NDP_OPT_ARO_STATE_SUCCESS,
+                          add(1, NDP_NCE_STATUS_REACHABLE, NDP_NCE_TYPE_GC, 0));
+    TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_REACHABLE, search(1)->state);
+    TEST_ASSERT_NULL(search(1)->queued);
+    TEST_ASSERT(pktbuf_is_empty());
+
+    TEST_ASSERT_EQUAL_INT(1, nbr_cache_resolve(&a, NULL, &hop));
+    TEST_ASSERT_EQUAL_INT(sizeof(lladdr), hop.addr_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(hop.addr, lladdr, sizeof(lladdr)));
+}
+
+static void test_nbr_cache_resolve_incomplete_timeout(void)
+{
+    ipv6_ll_hop_t hop;
+    ipv6_addr_t a;
+    unsigned solicitations = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, nbr_cache_resolve(addr(&a, 1), NULL, &hop));
+
+    for (unsigned i = 0; i < NBR_CACHE_MAX_MULTICAST_SOLICIT; i++) {
+        TEST_ASSERT_NOT_NULL(search(1));
+        solicitations += nbr_cache_tick();
+    }
+
+    TEST_ASSERT_EQUAL_INT(NBR_CACHE_MAX_MULTICAST_SOLICIT, solicitations);
+    TEST_ASSERT_EQUAL_INT(0, nbr_cache_tick());
+    TEST_ASSERT_NULL(search(1));
+}
+
+static void test_nbr_cache_unreachability_detection(void)
+{
+    ipv6_ll_hop_t hop;
+    ipv6_addr_t a;
+    unsigned solicitations = 0;
+
+    add(1, NDP_NCE_STATUS_REACHABLE, NDP_NCE_TYPE_GC, 0);
+
+    for (unsigned i = 0; i < NBR_CACHE_REACHABLE_TIME; i++) {
+        TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_REACHABLE, search(1)->state);
+        TEST_ASSERT_EQUAL_INT(0, nbr_cache_tick());
+    }
+
+    TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_STALE, search(1)->state);
+    TEST_ASSERT_EQUAL_INT(0, nbr_cache_tick());
+
+    /* sending to a stale neighbor gives upper layers time to confirm it */
+    TEST_ASSERT_EQUAL_INT(1, nbr_cache_resolve(addr(&a, 1), NULL, &hop));
+    TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_DELAY, search(1)->state);
+
+    for (unsigned i = 0; i < NBR_CACHE_DELAY_FIRST_PROBE_TIME - 1; i++) {
+        TEST_ASSERT_EQUAL_INT(0, nbr_cache_tick());
+        TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_DELAY, search(1)->state);
+    }
+
+    /* unconfirmed, it is probed by unicast solicitations */
+    for (unsigned i = 0; i < NBR_CACHE_MAX_UNICAST_SOLICIT; i++) {
+        solicitations += nbr_cache_tick();
+        TEST_ASSERT_EQUAL_INT(NDP_NCE_STATUS_PROBE, search(1)->state);
+    }
+
+    TEST_ASSERT_EQUAL_INT(NBR_CACHE_MAX_UNICAST_SOLICIT, solicitations);
+    TEST_ASSERT_EQUAL_INT(0, nbr_cache_tick());
+    TEST_ASSERT_NULL(search(1));
+}
+
+static void test_nbr_cache_ltime_expiry(void)
+{
+    add(1, NDP_NCE_STATUS_REACHABLE, NDP_NCE_TYPE_REGISTERED, 3);
+    add(2, NDP_NCE_STATUS_REACHABLE, NDP_NCE_TYPE_TENTATIVE, 1);
+    /* the lifetime of garbage-collectible entries is ignored */
+    add(3, NDP_NCE_STATUS_REACHABLE, NDP_NCE_TYPE_GC, 1);
+
+    nbr_cache_tick();
+    TEST_ASSERT_NOT_NULL(search(1));
+    TEST_ASSERT_NULL(search(2));
+    TEST_ASSERT_NOT_NULL(search(3));
+
+    nbr_cache_tick();
+    TEST_ASSERT_NOT_NULL(search(1));
+
+    nbr_cache_tick();
+    TEST_ASSERT_NULL(search(1));
+    TEST_ASSERT_NOT_NULL(search(3));
+}
+
+Test *tests_nbr_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_nbr_cache_hash_collisions),
+        new_TestFixture(test_nbr_cache_lru_skips_registered),
+        new_TestFixture(test_nbr_cache_full_of_registered),
+        new_TestFixture(test_nbr_cache_resolve_delivers_queued),
+        new_TestFixture(test_nbr_cache_resolve_incomplete_timeout),
+        new_TestFixture(test_nbr_cache_unreachability_detection),
+        new_TestFixture(test_nbr_cache_ltime_expiry),
+    };
+
+    EMB_UNIT_TESTCALLER(nbr_cache_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&nbr_cache_tests;
+}
+
+void tests_nbr_cache(void)
+{
+    TESTS_RUN(tests_nbr_cache_tests());
+}
+/** @} */
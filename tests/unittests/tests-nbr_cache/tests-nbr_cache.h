@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-nbr_cache.h
+ * @brief       Unittests for the neighbor cache of the ``sixlowpan`` module
+ */
+#ifndef __TESTS_NBR_CACHE_H_
+#define __TESTS_NBR_CACHE_H_
+
+#include "../unittests.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_nbr_cache(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TESTS_NBR_CACHE_H_ */
+/** @} */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdint.h>
+
+#include "tests-net_help.h"
+
+#include "net_help.h"
+
+#define BUF_LEN (75)
+
+/* aligned storage, tests slice it at various offsets */
+static uint32_t buf_storage[(BUF_LEN + 8) / 4];
+
+/* straightforward big endian word sum to compare against */
+static uint16_t ref_csum(uint16_t sum, const uint8_t *buf, uint16_t len)
+{
+    uint32_t acc = sum;
+
+    for (uint16_t i = 0; i < len; i++) {
+        acc += (i & 1) ? buf[i] : (buf[i] << 8);
+    }
+
+    while (acc >> 16) {
+        acc = (acc & 0xffff) + (acc >> 16);
+    }
+
+    return acc;
+}
+
+/* value stored in the checksum field of a header covering buf */
+static uint16_t checksum_field(uint8_t *buf, uint16_t len)
+{
+    return ~csum(0, buf, len);
+}
+
+static uint8_t *fill_buf(void)
+{
+    uint8_t *buf = (uint8_t *) buf_storage;
+
+    for (unsigned i = 0; i < sizeof(buf_storage); i++) {
+        buf[i] = (uint8_t)((i * 73) + 0xf1);
+    }
+
+    return buf;
+}
+
+static void test_csum_rfc1071_example(void)
+{
+    /* RFC 1071, 3. */
+    uint8_t data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+
+    TEST_ASSERT_EQUAL_INT(0xddf2, csum(0, data, sizeof(data)));
+}
+
+static void test_csum_empty(void)
+{
+    TEST_ASSERT_EQUAL_INT(0x1234, csum(0x1234, fill_buf(), 0));
+}
+
+static void test_csum_all_offsets_and_lengths(void)
+{
+    uint8_t *buf = fill_buf();
+
+    for (unsigned off = 0; off < 4; off++) {
+        for (uint16_t len = 0; len <= BUF_LEN; len++) {
+            TEST_ASSERT_EQUAL_INT(ref_csum(0, buf + off, len),
+                                  csum(0, buf + off, len));
+        }
+    }
+}
+
+static void test_csum_chained(void)
+{
+    uint8_t *buf = fill_buf();
+
+    /* like the IPv6 pseudo header followed by the payload */
+    uint16_t sum = csum(0x11 + BUF_LEN, buf, 32);
+    sum = csum(sum, buf + 32, BUF_LEN - 32);
+
+    TEST_ASSERT_EQUAL_INT(ref_csum(0x11 + BUF_LEN, buf, BUF_LEN), sum);
+}
+
+static void test_csum_no_lost_carries(void)
+{
+    uint8_t *buf = (uint8_t *) buf_storage;
+
+    memset(buf_storage, 0xff, sizeof(buf_storage));
+    TEST_ASSERT_EQUAL_INT(0xffff, csum(0xffff, buf, BUF_LEN + 1));
+    TEST_ASSERT_EQUAL_INT(0xffff, csum(0, buf + 1, BUF_LEN - 1));
+}
+
+static void test_csum_replace16(void)
+{
+    uint8_t *buf = fill_buf();
+    uint16_t check = checksum_field(buf, BUF_LEN);
+    uint16_t old_val = (buf[10] << 8) | buf[11];
+
+    buf[10] = 0xab;
+    buf[11] = 0xcd;
+
+    check = csum_replace16(check, old_val, 0xabcd);
+    TEST_ASSERT_EQUAL_INT(checksum_field(buf, BUF_LEN), check);
+}
+
+static void test_csum_replace16_hop_to_zero(void)
+{
+    /* RFC 1624, 3.: eqn. 3 must not produce -0 for a sum that becomes 0 */
+    uint8_t data[] = { 0xcd, 0x7a, 0x55, 0x55 };
+    uint16_t check = checksum_field(data, sizeof(data));
+
+    data[0] = 0x32;
+    data[1] = 0x85;
+
+    check = csum_replace16(check, 0xcd7a, 0x3285);
+    TEST_ASSERT_EQUAL_INT(checksum_field(data, sizeof(data)), check);
+}
+
+static void test_csum_replace32(void)
+{
+    uint8_t *buf = fill_buf();
+    uint16_t check = checksum_field(buf, BUF_LEN);
+    uint32_t old_val = ((uint32_t) buf[20] << 24) | ((uint32_t) buf[21] << 16) |
+                       (buf[22] << 8) | buf[23];
+
+    buf[20] = 0xfe;
+    buf[21] = 0x80;
+    buf[22] = 0x00;
+    buf[23] = 0x01;
+
+    check = csum_replace32(check, old_val, 0xfe800001);
+    TEST_ASSERT_EQUAL_INT(checksum_field(buf, BUF_LEN), check);
+}
+
+Test *tests_net_help_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_csum_rfc1071_example),
+        new_TestFixture(test_csum_empty),
+        new_TestFixture(test_csum_all_offsets_and_lengths),
+        new_TestFixture(test_csum_chained),
+        new_TestFixture(test_csum_no_lost_carries),
+        new_TestFixture(test_csum_replace16),
+        new_TestFixture(test_csum_replace16_hop_to_zero),
+        new_TestFixture(test_csum_replace32),
+    };
+
+    EMB_UNIT_TESTCALLER(net_help_tests, NULL, NULL, fixtures);
+
+    return (Test *)&net_help_tests;
+}
+
+void tests_net_help(void)
+{
+    TESTS_RUN(tests_net_help_tests());
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-net_help.h
+ * @brief       Unittests for the ``net_help`` module
+ */
+#ifndef __TESTS_NET_HELP_H_
+#define __TESTS_NET_HELP_H_
+
+#include "../unittests.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_net_help(void);
+
+/**
+ * @brief   Generates tests for net_help
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_net_help_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TESTS_NET_HELP_H_ */
+/** @} */
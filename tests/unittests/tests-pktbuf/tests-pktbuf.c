@@ -13,9 +13,11 @@
  */
 #include <errno.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "embUnit/embUnit.h"
 
+#include "hwtimer.h"
 #include "pktbuf.h"
 
 #include "tests-pktbuf.h"
@@ -41,6 +43,7 @@ static void test_pktbuf_alloc_0(void)
     TEST_ASSERT_NULL(pktbuf_alloc(0));
 }
 
+#ifndef MODULE_PKTBUF_SLAB
 static void test_pktbuf_alloc_memfull(void)
 {
     for (int i = 0; i < 9; i++) {
@@ -63,6 +66,7 @@ static void test_pktbuf_alloc_success(void)
         data_prev = data;
     }
 }
+#endif
 
 static void test_pktbuf_realloc_0(void)
 {
@@ -78,6 +82,7 @@ static void test_pktbuf_realloc_memfull(void)
     TEST_ASSERT_NULL(pktbuf_realloc(data, PKTBUF_SIZE + 1));
 }
 
+#ifndef MODULE_PKTBUF_SLAB
 static void test_pktbuf_realloc_memfull2(void)
 {
     void *data = pktbuf_alloc(512);
@@ -86,6 +91,7 @@ static void test_pktbuf_realloc_memfull2(void)
     TEST_ASSERT_NOT_NULL(pktbuf_alloc(512));
     TEST_ASSERT_NULL(pktbuf_realloc(data, PKTBUF_SIZE - 512));
 }
+#endif
 
 static void test_pktbuf_realloc_memfull3(void)
 {
@@ -113,6 +119,7 @@ static void test_pktbuf_realloc_smaller(void)
     TEST_ASSERT(data == pktbuf_realloc(data, 128));
 }
 
+#ifndef MODULE_PKTBUF_SLAB
 static void test_pktbuf_realloc_memenough(void)
 {
     void *data;
@@ -141,6 +148,7 @@ static void test_pktbuf_realloc_memenough2(void)
 
     TEST_ASSERT(data == pktbuf_realloc(data, 200));
 }
+#endif
 
 static void test_pktbuf_realloc_nomemenough(void)
 {
@@ -459,6 +467,7 @@ static void test_pktbuf_insert_packed_struct(void)
     TEST_ASSERT_EQUAL_INT(data.s64, data_cpy->s64);
 }
 
+#ifndef MODULE_PKTBUF_SLAB
 static void test_pktbuf_alloc_off_by_one1(void)
 {
     char *data1, *data2, *data3, *data4;
@@ -484,20 +493,253 @@ static void test_pktbuf_alloc_off_by_one1(void)
     TEST_ASSERT_EQUAL_INT(3, pktbuf_packets_allocated());
     TEST_ASSERT_EQUAL_INT(44 + 4 + 13, pktbuf_bytes_allocated());
 }
+#endif
+
+static void test_pktbuf_churn(void)
+{
+    static const uint16_t sizes[] = { 3, 40, 17, 100, 250, 8, 64, 1, 300, 33 };
+    uint8_t *pkts[8] = { NULL };
+    unsigned seed = 1;
+
+    for (int i = 0; i < 500; i++) {
+        unsigned j = (seed >> 8) % 8;
+        uint16_t size = sizes[(seed >> 4) % 10];
+
+        seed = seed * 1103515245 + 12345;
+
+        if (pkts[j] == NULL) {
+            pkts[j] = (uint8_t *)pktbuf_alloc(size);
+
+            TEST_ASSERT_NOT_NULL(pkts[j]);
+
+            pkts[j][0] = j;
+            pkts[j][size - 1] = j;
+        }
+        else {
+            TEST_ASSERT_EQUAL_INT(j, pkts[j][0]);
+
+            pktbuf_hold(pkts[j]);
+            pktbuf_release(pkts[j]);
+            pktbuf_release(pkts[j]);
+            pkts[j] = NULL;
+        }
+    }
+
+    for (int j = 0; j < 8; j++) {
+        if (pkts[j] != NULL) {
+            TEST_ASSERT_EQUAL_INT(j, pkts[j][0]);
+            pktbuf_release(pkts[j]);
+        }
+    }
+
+    TEST_ASSERT(pktbuf_is_empty());
+}
+
+#define BENCH_HELD      (12)
+#define BENCH_ROUNDS    (10000)
+
+/* a full-MTU packet in the IPv6 forwarding queue, see ipv6_fwd_enqueue() */
+#define BENCH_FWD_SIZE  (16 + 1280 + 1)
+
+/* bisects the size of the largest packet that can still be allocated */
+static size_t _largest_alloc(void)
+{
+    size_t lo = 0, hi = PKTBUF_SIZE;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        void *pkt = pktbuf_alloc(mid);
+
+        if (pkt != NULL) {
+            pktbuf_release(pkt);
+            lo = mid;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+
+    return lo;
+}
+
+static void test_pktbuf_benchmark(void)
+{
+    static const uint16_t sizes[] = { 3, 40, 17, 100, 250, 8, 64, 1, 200, 33 };
+    uint8_t *pkts[BENCH_HELD] = { NULL };
+    unsigned seed = 1;
+    unsigned long start, ticks;
+    size_t largest;
+
+    start = hwtimer_now();
+
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        unsigned j = (seed >> 8) % BENCH_HELD;
+        uint16_t size = sizes[(seed >> 4) % 10];
+
+        seed = seed * 1103515245 + 12345;
+
+        if (pkts[j] == NULL) {
+            pkts[j] = (uint8_t *)pktbuf_alloc(size);
+
+            TEST_ASSERT_NOT_NULL(pkts[j]);
+        }
+        else {
+            pktbuf_hold(pkts[j]);
+            pktbuf_release(pkts[j]);
+            pktbuf_release(pkts[j]);
+            pkts[j] = NULL;
+        }
+    }
+
+    ticks = hwtimer_now() - start;
+
+    for (int j = 0; j < BENCH_HELD; j++) {
+        if (pkts[j] == NULL) {
+            pkts[j] = (uint8_t *)pktbuf_alloc(sizes[j % 10]);
+
+            TEST_ASSERT_NOT_NULL(pkts[j]);
+        }
+    }
+
+    /* the held packets split the free space left by the churn */
+    largest = _largest_alloc();
+
+#ifdef MODULE_PKTBUF_SLAB
+    printf("\npktbuf_slab: ");
+#else
+    printf("\npktbuf: ");
+#endif
+    printf("%d rounds of alloc/release in %lu us, %u packets held, "
+           "largest allocation %u of %u bytes\n", BENCH_ROUNDS,
+           (unsigned long)HWTIMER_TICKS_TO_US(ticks),
+           (unsigned)pktbuf_packets_allocated(), (unsigned)largest,
+           (unsigned)PKTBUF_SIZE);
+
+    for (int j = 0; j < BENCH_HELD; j++) {
+        pktbuf_release(pkts[j]);
+    }
+
+    TEST_ASSERT(pktbuf_is_empty());
+#ifdef MODULE_PKTBUF_SLAB
+    /* small packets never take the slot of a full-MTU packet */
+    TEST_ASSERT(largest >= BENCH_FWD_SIZE);
+#endif
+}
+
+static void test_pktbuf_alloc_rx_and_fwd_copy(void)
+{
+    /* a full-MTU packet received, see lowpan_rx_packet() */
+    void *rx = pktbuf_alloc(1280);
+    void *fwd, *frag;
+
+    TEST_ASSERT_NOT_NULL(rx);
+
+    /* forwarding it copies it to the IPv6 forwarding queue while it is
+     * still held, and another datagram may wait in the fragmentation
+     * queue of 6LoWPAN */
+    fwd = pktbuf_alloc(BENCH_FWD_SIZE);
+    TEST_ASSERT_NOT_NULL(fwd);
+    frag = pktbuf_alloc(1280 + 32);
+    TEST_ASSERT_NOT_NULL(frag);
+
+    pktbuf_release(rx);
+    pktbuf_release(fwd);
+    pktbuf_release(frag);
+    TEST_ASSERT(pktbuf_is_empty());
+}
+
+#ifdef MODULE_PKTBUF_SLAB
+static void test_pktbuf_slab_alloc_memfull(void)
+{
+    size_t i = 0;
+
+    /* small packets fall back to larger classes until everything is taken */
+    while (pktbuf_alloc(4) != NULL) {
+        i++;
+    }
+
+    TEST_ASSERT(i > 1);
+    TEST_ASSERT(i == pktbuf_packets_allocated());
+    TEST_ASSERT_NULL(pktbuf_alloc(1));
+}
+
+static void test_pktbuf_slab_alloc_too_large(void)
+{
+    TEST_ASSERT_NULL(pktbuf_alloc(PKTBUF_SIZE));
+    TEST_ASSERT(pktbuf_is_empty());
+}
+
+static void test_pktbuf_slab_alloc_full_mtu(void)
+{
+    /* a full-MTU packet with the meta data of the 6LoWPAN fragmentation
+     * queue in front of it */
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_NOT_NULL(pktbuf_alloc(1280 + 64));
+    }
+
+    TEST_ASSERT_NULL(pktbuf_alloc(1280 + 64));
+}
+
+static void test_pktbuf_slab_alloc_aligned(void)
+{
+    void *data;
+    size_t i = 0;
+
+    /* fill every slot of every class */
+    while ((data = pktbuf_alloc((i % 20) + 1)) != NULL) {
+        TEST_ASSERT_EQUAL_INT(0, (((uintptr_t)data) & 0x3));
+        i++;
+    }
+
+    TEST_ASSERT(i == pktbuf_packets_allocated());
+}
+
+static void test_pktbuf_slab_alloc_reuse(void)
+{
+    void *data = pktbuf_alloc(12);
+
+    TEST_ASSERT_NOT_NULL(data);
+    pktbuf_release(data);
+
+    TEST_ASSERT(data == pktbuf_alloc(13));
+}
+
+static void test_pktbuf_slab_realloc_in_slot(void)
+{
+    char *data = (char *)pktbuf_insert("abcd", 5), *data2;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT(data == pktbuf_realloc(data, 9));
+    TEST_ASSERT_EQUAL_INT(9, pktbuf_bytes_allocated());
+
+    data2 = (char *)pktbuf_realloc(data, 1280);
+
+    TEST_ASSERT_NOT_NULL(data2);
+    TEST_ASSERT(data != data2);
+    TEST_ASSERT_EQUAL_STRING("abcd", data2);
+    TEST_ASSERT_EQUAL_INT(1, pktbuf_packets_allocated());
+}
+#endif
 
 Test *tests_pktbuf_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
         new_TestFixture(test_pktbuf_alloc_0),
+#ifndef MODULE_PKTBUF_SLAB
         new_TestFixture(test_pktbuf_alloc_memfull),
         new_TestFixture(test_pktbuf_alloc_success),
+#endif
         new_TestFixture(test_pktbuf_realloc_0),
         new_TestFixture(test_pktbuf_realloc_memfull),
+#ifndef MODULE_PKTBUF_SLAB
         new_TestFixture(test_pktbuf_realloc_memfull2),
+#endif
         new_TestFixture(test_pktbuf_realloc_memfull3),
         new_TestFixture(test_pktbuf_realloc_smaller),
+#ifndef MODULE_PKTBUF_SLAB
         new_TestFixture(test_pktbuf_realloc_memenough),
         new_TestFixture(test_pktbuf_realloc_memenough2),
+#endif
         new_TestFixture(test_pktbuf_realloc_nomemenough),
         new_TestFixture(test_pktbuf_realloc_unknown_ptr),
         new_TestFixture(test_pktbuf_insert_size_0),
@@ -523,7 +765,20 @@ Test *tests_pktbuf_tests(void)
         new_TestFixture(test_pktbuf_release_success3),
         new_TestFixture(test_pktbuf_release_success4),
         new_TestFixture(test_pktbuf_insert_packed_struct),
+#ifndef MODULE_PKTBUF_SLAB
         new_TestFixture(test_pktbuf_alloc_off_by_one1),
+#endif
+        new_TestFixture(test_pktbuf_churn),
+        new_TestFixture(test_pktbuf_benchmark),
+        new_TestFixture(test_pktbuf_alloc_rx_and_fwd_copy),
+#ifdef MODULE_PKTBUF_SLAB
+        new_TestFixture(test_pktbuf_slab_alloc_memfull),
+        new_TestFixture(test_pktbuf_slab_alloc_too_large),
+        new_TestFixture(test_pktbuf_slab_alloc_full_mtu),
+        new_TestFixture(test_pktbuf_slab_alloc_aligned),
+        new_TestFixture(test_pktbuf_slab_alloc_reuse),
+        new_TestFixture(test_pktbuf_slab_realloc_in_slot),
+#endif
     };
 
     EMB_UNIT_TESTCALLER(pktbuf_tests, NULL, tear_down, fixtures);
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file    tests-pktchain.c
+ */
+#include <string.h>
+
+#include "embUnit/embUnit.h"
+
+#include "net_help.h"
+#include "pktchain.h"
+
+#include "tests-pktchain.h"
+
+#define DATA_LEN    (23)
+
+static uint8_t data[DATA_LEN];
+static pktchain_t nodes[3];
+
+static void set_up(void)
+{
+    for (int i = 0; i < DATA_LEN; i++) {
+        data[i] = (i * 37) + 11;
+    }
+}
+
+/* splits data into three nodes at a and b */
+static const pktchain_t *split(size_t a, size_t b)
+{
+    const pktchain_t *chain;
+
+    chain = pktchain_prepend(&nodes[2], &data[b], DATA_LEN - b, NULL);
+    chain = pktchain_prepend(&nodes[1], &data[a], b - a, chain);
+    return pktchain_prepend(&nodes[0], data, a, chain);
+}
+
+static void test_pktchain_len(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, pktchain_len(NULL));
+    TEST_ASSERT_EQUAL_INT(DATA_LEN, pktchain_len(split(3, 10)));
+    TEST_ASSERT_EQUAL_INT(DATA_LEN, pktchain_len(split(0, 0)));
+}
+
+static void test_pktchain_gather(void)
+{
+    uint8_t out[DATA_LEN];
+
+    for (size_t a = 0; a <= DATA_LEN; a++) {
+        for (size_t b = a; b <= DATA_LEN; b += 3) {
+            const pktchain_t *chain = split(a, b);
+
+            memset(out, 0, sizeof(out));
+            TEST_ASSERT_EQUAL_INT(DATA_LEN, pktchain_gather(chain, 0, out, DATA_LEN));
+            TEST_ASSERT_EQUAL_INT(0, memcmp(data, out, DATA_LEN));
+
+            memset(out, 0, sizeof(out));
+            TEST_ASSERT_EQUAL_INT(8, pktchain_gather(chain, 5, out, 8));
+            TEST_ASSERT_EQUAL_INT(0, memcmp(&data[5], out, 8));
+        }
+    }
+}
+
+static void test_pktchain_gather_beyond_end(void)
+{
+    uint8_t out[DATA_LEN];
+
+    TEST_ASSERT_EQUAL_INT(3, pktchain_gather(split(4, 9), DATA_LEN - 3, out, 10));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&data[DATA_LEN - 3], out, 3));
+    TEST_ASSERT_EQUAL_INT(0, pktchain_gather(split(4, 9), DATA_LEN, out, 10));
+}
+
+static void test_pktchain_csum_odd_nodes(void)
+{
+    uint16_t expected = csum(0x1234, data, DATA_LEN);
+
+    for (size_t a = 0; a <= DATA_LEN; a++) {
+        for (size_t b = a; b <= DATA_LEN; b++) {
+            TEST_ASSERT_EQUAL_INT(expected, pktchain_csum(0x1234, split(a, b)));
+        }
+    }
+}
+
+Test *tests_pktchain_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_pktchain_len),
+        new_TestFixture(test_pktchain_gather),
+        new_TestFixture(test_pktchain_gather_beyond_end),
+        new_TestFixture(test_pktchain_csum_odd_nodes),
+    };
+
+    EMB_UNIT_TESTCALLER(pktchain_tests, set_up, NULL, fixtures);
+
+    return (Test *)&pktchain_tests;
+}
+
+void tests_pktchain(void)
+{
+    TESTS_RUN(tests_pktchain_tests());
+}
+/** @} */
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-pktchain.h
+ * @brief       Unittests for the ``pktchain`` module
+ */
+#ifndef __TESTS_PKTCHAIN_H_
+#define __TESTS_PKTCHAIN_H_
+
+#include "../unittests.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_pktchain(void);
+
+/**
+ * @brief   Generates tests for pktchain
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_pktchain_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TESTS_PKTCHAIN_H_ */
+/** @} */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file    tests-pktring.c
+ */
+#include "embUnit/embUnit.h"
+
+#include "pktring.h"
+
+#include "tests-pktring.h"
+
+#define R_LEN (4)
+
+static void *volatile slots[R_LEN];
+static pktring_t r = PKTRING_INIT(slots);
+
+static void set_up(void)
+{
+    pktring_init(&r, slots, R_LEN);
+}
+
+static void test_pktring_get_empty(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, pktring_avail(&r));
+    TEST_ASSERT_NULL(pktring_get(&r));
+}
+
+static void test_pktring_put_get_one(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, pktring_put(&r, (void *)62801));
+    TEST_ASSERT_EQUAL_INT(1, pktring_avail(&r));
+    TEST_ASSERT(((void *)62801) == pktring_get(&r));
+    TEST_ASSERT_EQUAL_INT(0, pktring_avail(&r));
+    TEST_ASSERT_NULL(pktring_get(&r));
+}
+
+static void test_pktring_put_full(void)
+{
+    for (unsigned i = 1; i <= R_LEN; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pktring_put(&r, (void *)i));
+    }
+
+    TEST_ASSERT_EQUAL_INT(R_LEN, pktring_avail(&r));
+    TEST_ASSERT_EQUAL_INT(-1, pktring_put(&r, (void *)62801));
+    TEST_ASSERT(((void *)1) == pktring_get(&r));
+    TEST_ASSERT_EQUAL_INT(0, pktring_put(&r, (void *)62801));
+}
+
+static void test_pktring_fifo_wrap(void)
+{
+    /* run the counters around the slots a few times */
+    for (unsigned i = 1; i <= (3 * R_LEN); i++) {
+        TEST_ASSERT_EQUAL_INT(0, pktring_put(&r, (void *)i));
+        TEST_ASSERT_EQUAL_INT(0, pktring_put(&r, (void *)(i + 1000)));
+        TEST_ASSERT(((void *)i) == pktring_get(&r));
+        TEST_ASSERT(((void *)(i + 1000)) == pktring_get(&r));
+    }
+
+    TEST_ASSERT_NULL(pktring_get(&r));
+}
+
+static void test_pktring_counter_overflow(void)
+{
+    r.head = -2;
+    r.tail = -2;
+
+    for (unsigned i = 1; i <= R_LEN; i++) {
+        TEST_ASSERT_EQUAL_INT(0, pktring_put(&r, (void *)i));
+    }
+
+    TEST_ASSERT_EQUAL_INT(R_LEN, pktring_avail(&r));
+    TEST_ASSERT_EQUAL_INT(-1, pktring_put(&r, (void *)62801));
+
+    for (unsigned i = 1; i <= R_LEN; i++) {
+        TEST_ASSERT(((void *)i) == pktring_get(&r));
+    }
+
+    TEST_ASSERT_NULL(pktring_get(&r));
+}
+
+Test *tests_pktring_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_pktring_get_empty),
+        new_TestFixture(test_pktring_put_get_one),
+        new_TestFixture(test_pktring_put_full),
+        new_TestFixture(test_pktring_fifo_wrap),
+        new_TestFixture(test_pktring_counter_overflow),
+    };
+
+    EMB_UNIT_TESTCALLER(pktring_tests, set_up, NULL, fixtures);
+
+    return (Test *)&pktring_tests;
+}
+
+void tests_pktring(void)
+{
+    TESTS_RUN(tests_pktring_tests());
+}
+/** @} */
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file        tests-pktring.h
+ * @brief       Unittests for the ``pktring`` module
+ */
+#ifndef __TESTS_PKTRING_H_
+#define __TESTS_PKTRING_H_
+
+#include "../unittests.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_pktring(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TESTS_PKTRING_H_ */
+/** @} */
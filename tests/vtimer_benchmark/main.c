@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2014 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the cost of vtimer_set(), vtimer_remove() and the
+ *              latency of fired timers for growing numbers of pending timers
+ *
+ * Build once as is and once with `VTIMER_HEAP=1` to compare the sorted list
+ * with the pairing heap backend. The duration of a vtimer_set() or
+ * vtimer_remove() call is an upper bound of the time the call spends with
+ * interrupts disabled, so the maximum printed for each is the worst case
+ * interrupt latency added by the timer queue.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "hwtimer.h"
+#include "msg.h"
+#include "thread.h"
+#include "timex.h"
+#include "vtimer.h"
+
+#define MAX_TIMERS      (1000)
+#define MSG_QUEUE_SIZE  (1024)
+
+/* short term timers must stay within the first vtimer tick (4096 s) */
+#define FAR_S           (1000)
+#define FIRE_START_US   (200000)
+#define FIRE_SPACING_US (500)
+
+static vtimer_t timers[MAX_TIMERS];
+static timex_t deadlines[MAX_TIMERS];
+static msg_t msg_queue[MSG_QUEUE_SIZE];
+
+static const unsigned sizes[] = { 10, 100, 1000 };
+
+static uint32_t lcg_state = 1;
+
+static uint32_t lcg(void)
+{
+    lcg_state = lcg_state * 1103515245 + 12345;
+    return lcg_state >> 8;
+}
+
+typedef struct {
+    uint32_t sum;
+    uint32_t max;
+    unsigned count;
+} stat_t;
+
+static void stat_add(stat_t *s, uint32_t us)
+{
+    s->sum += us;
+    if (us > s->max) {
+        s->max = us;
+    }
+    s->count++;
+}
+
+static void stat_print(const char *name, unsigned n, stat_t *s)
+{
+    printf("%s n=%u avg_us=%" PRIu32 " max_us=%" PRIu32 "\n", name, n,
+           s->count ? s->sum / s->count : 0, s->max);
+}
+
+static void bench_set_remove(unsigned n)
+{
+    stat_t set = { 0, 0, 0 }, rem = { 0, 0, 0 };
+
+    for (unsigned i = 0; i < n; ++i) {
+        timex_t interval = timex_set(FAR_S, lcg() % SEC_IN_USEC);
+
+        unsigned long start = hwtimer_now();
+        vtimer_set_msg(&timers[i], interval, sched_active_pid, &timers[i]);
+        stat_add(&set, HWTIMER_TICKS_TO_US(hwtimer_now() - start));
+    }
+
+    /* remove in a different order than the timers were set */
+    for (unsigned i = 0; i < n; ++i) {
+        unsigned idx = (i * 7) % n;
+
+        if (n % 7 == 0) {
+            idx = i;
+        }
+
+        unsigned long start = hwtimer_now();
+        vtimer_remove(&timers[idx]);
+        stat_add(&rem, HWTIMER_TICKS_TO_US(hwtimer_now() - start));
+    }
+
+    stat_print("set", n, &set);
+    stat_print("remove", n, &rem);
+}
+
+static void bench_fire(unsigned n)
+{
+    stat_t late = { 0, 0, 0 };
+    timex_t now;
+
+    for (unsigned i = 0; i < n; ++i) {
+        /* distinct deadlines, set in shuffled order */
+        unsigned slot = (lcg() % n);
+        timex_t interval = timex_set(0, FIRE_START_US + slot * FIRE_SPACING_US +
+                                     (i % FIRE_SPACING_US));
+
+        vtimer_now(&now);
+        deadlines[i] = timex_add(now, interval);
+        vtimer_set_msg(&timers[i], interval, sched_active_pid, &timers[i]);
+    }
+
+    for (unsigned i = 0; i < n; ++i) {
+        msg_t m;
+        msg_receive(&m);
+        vtimer_now(&now);
+
+        vtimer_t *t = (vtimer_t *) m.content.ptr;
+        timex_t *deadline = &deadlines[t - timers];
+
+        if (timex_cmp(now, *deadline) > 0) {
+            stat_add(&late, (uint32_t) timex_uint64(timex_sub(now, *deadline)));
+        }
+        else {
+            stat_add(&late, 0);
+        }
+    }
+
+    stat_print("fire_latency", n, &late);
+}
+
+int main(void)
+{
+    msg_init_queue(msg_queue, MSG_QUEUE_SIZE);
+
+#ifdef MODULE_VTIMER_HEAP
+    puts("vtimer benchmark: pairing heap backend");
+#else
+    puts("vtimer benchmark: priority queue backend");
+#endif
+
+    for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        bench_set_remove(sizes[i]);
+        bench_fire(sizes[i]);
+    }
+
+    puts("done");
+    return 0;
+}